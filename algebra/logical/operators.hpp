@@ -542,6 +542,14 @@ public:
             _table(table)
     { }
 
+    /// \brief Creates a diff scan, which produces the tuples of the branch that differ from the compared branch
+    TableScan(IUFactory &iuFactory, Table & table, branch_id_t branchId, branch_id_t diffBranchId) :
+            NullaryOperator(iuFactory),
+            _table(table),
+            branchId(branchId),
+            diffBranchId(diffBranchId)
+    { }
+
     ~TableScan() override { }
 
     void accept(OperatorVisitor & visitor) override;
@@ -550,12 +558,16 @@ public:
 
     branch_id_t getBranchId() { return branchId; }
 
+    /// \returns The branch which a diff scan compares to; invalid_branch_id for plain scans
+    branch_id_t getDiffBranchId() { return diffBranchId; }
+
 protected:
     void computeProduced() override;
     void computeRequired() override;
 
     Table & _table;
     branch_id_t branchId;
+    branch_id_t diffBranchId = invalid_branch_id;
 };
 
 //-----------------------------------------------------------------------------
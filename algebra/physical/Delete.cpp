@@ -4,6 +4,7 @@
 #include "sql/SqlUtils.hpp"
 #include "sql/SqlValues.hpp"
 #include "foundations/version_management.hpp"
+#include "foundations/WriteAheadLog.hpp"
 
 using namespace Sql;
 
@@ -35,6 +36,10 @@ namespace Algebra {
 #if !USE_DATA_VERSIONING
         void delete_tuple_without_versioning(tid_t tid, Table & table, QueryContext & ctx) {
             table.removeRow(tid);
+
+            if (auto log = table.getDatabase().getWriteAheadLog()) {
+                ctx.executionContext.commitLsn = log->logDelete(table, master_branch_id, tid);
+            }
         }
 #endif
 
@@ -175,9 +175,33 @@ enum Side : size_t { Left = 0, Right = 1 };
 
 using join_pair_vec_t = HashJoin::join_pair_vec_t;
 
+/// \returns The dictionary which encodes the given expression's values or nullptr
+static StringDictionary * getDictionary(const Expressions::Expression & expr)
+{
+    auto identifier = dynamic_cast<const Expressions::Identifier *>(&expr);
+    if (identifier == nullptr || identifier->_iu->iuType != InformationUnit::Type::ColumnRef) {
+        return nullptr;
+    }
+    return identifier->_iu->columnInformation->dictionary;
+}
+
+/// \returns The code of the given dictionary-encoded join attribute as SQL Integer
+///
+/// Values which are absent from the dictionary yield invalid_code, they are not added at runtime.
+static value_op_t genJoinCode(StringDictionary::cg_code_t code)
+{
+    return Integer::fromRawValues({ code.getValue() });
+}
+
+static value_op_t genJoinCode(StringDictionary & dictionary, const Value & value)
+{
+    return genJoinCode(genStringDictionaryLookup(dictionary, value));
+}
+
 /// \brief Calculates the joint hash of all join attributes
 template<Side side>
-static cg_hash_t genJoinHash(const join_pair_vec_t & joinPairs, const iu_value_mapping_t & values)
+static cg_hash_t genJoinHash(const join_pair_vec_t & joinPairs, const std::vector<StringDictionary *> & pairDictionaries,
+        const iu_value_mapping_t & values)
 {
 #ifdef __APPLE__
     cg_hash_t seed(0ull);
@@ -187,10 +211,14 @@ static cg_hash_t genJoinHash(const join_pair_vec_t & joinPairs, const iu_value_m
 
     // iterate over each join pair and calculate the combined hash
     bool first = true;
-    for (auto & joinPair : joinPairs) {
+    for (size_t i = 0; i < joinPairs.size(); ++i) {
         // pair structure: (left expr, right expr)
-        auto& expr = std::get<side>(joinPair);
+        auto& expr = std::get<side>(joinPairs[i]);
         auto sqlValue = expr->evaluate(values);
+        if (pairDictionaries[i] != nullptr) {
+            // both sides share the dictionary, hence the codes can be hashed instead of the strings
+            sqlValue = genJoinCode(*pairDictionaries[i], *sqlValue);
+        }
         if (first) {
             seed = sqlValue->hash();
             first = false;
@@ -208,6 +236,14 @@ HashJoin::HashJoin(const logical_operator_t & logicalOperator,
         BinaryOperator(std::move(logicalOperator), std::move(left), std::move(right), queryContext),
         joinPairs(std::move(pairs))
 {
+    for (auto & joinPair : joinPairs) {
+        StringDictionary * dictionary = getDictionary(*joinPair.first);
+        if (dictionary != getDictionary(*joinPair.second)) {
+            dictionary = nullptr;
+        }
+        pairDictionaries.push_back(dictionary);
+    }
+
     // sanity check:
 #ifndef NDEBUG
     const auto & leftRequired = _leftChild->getRequired();
@@ -274,7 +310,18 @@ void HashJoin::probeCandidate(cg_voidptr_t rawNodePtr)
     }
 
     cg_bool_t match(true);
-    for (auto & joinPair : joinPairs) {
+    for (size_t i = 0; i < joinPairs.size(); ++i) {
+        auto & joinPair = joinPairs[i];
+        if (pairDictionaries[i] != nullptr) {
+            // compare the stored code of the build side with the code of the probe side
+            auto rightExprValue = joinPair.second->evaluate(*rightIncoming);
+            auto rightCode = genStringDictionaryLookup(*pairDictionaries[i], *rightExprValue);
+            // distinct values which are both absent from the dictionary share invalid_code
+            match = match && cg_bool_t(rightCode != StringDictionary::cg_code_t(StringDictionary::invalid_code));
+            match = match && tuple->values[codeMapping[i]]->equals(*genJoinCode(rightCode));
+            continue;
+        }
+
         auto leftExprValue = joinPair.first->evaluate(values); // build side
         auto rightExprValue = joinPair.second->evaluate(*rightIncoming); // probe side
 /*
@@ -356,6 +403,19 @@ void HashJoin::consumeLeft(const iu_value_mapping_t & values)
         tupleMapping[iu] = i++;
     }
 
+    // the codes of dictionary-encoded join attributes are stored alongside the tuple
+    codeMapping.assign(joinPairs.size(), 0);
+    for (size_t pairIdx = 0; pairIdx < joinPairs.size(); ++pairIdx) {
+        if (pairDictionaries[pairIdx] == nullptr) {
+            continue;
+        }
+        auto leftExprValue = joinPairs[pairIdx].first->evaluate(values);
+        value_op_t code = genJoinCode(*pairDictionaries[pairIdx], *leftExprValue);
+        storedTypes.push_back(code->type);
+        leftTupleValues.push_back( std::move(code) );
+        codeMapping[pairIdx] = i++;
+    }
+
     SqlTuple tuple( std::move(leftTupleValues) );
 //    genPrintSqlTuple(tuple);
 
@@ -363,7 +423,7 @@ void HashJoin::consumeLeft(const iu_value_mapping_t & values)
     listNodeTy = getListNodeTy( tuple.getType() );
 
     // add the left tuple to the list
-    cg_hash_t h = genJoinHash<Left>(joinPairs, values);
+    cg_hash_t h = genJoinHash<Left>(joinPairs, pairDictionaries, values);
     genAppendEntryToList(memoryPool, listHeaderPtr, listNodeTy, h, tuple);
 }
 
@@ -371,7 +431,7 @@ void HashJoin::consumeRight(const iu_value_mapping_t & values)
 {
     rightIncoming = &values;
 
-    cg_hash_t h = genJoinHash<Right>(joinPairs, values);
+    cg_hash_t h = genJoinHash<Right>(joinPairs, pairDictionaries, values);
 
     // create the bucket iteration code:
     // genStaticHashtableIter() will pass the current element to probeCandidate(),
@@ -29,6 +29,11 @@ private:
 
     join_pair_vec_t joinPairs;
 
+    /// the shared dictionary of each join pair whose sides are encoded by the same dictionary (nullptr otherwise);
+    /// such pairs are hashed and compared by their codes
+    std::vector<StringDictionary *> pairDictionaries;
+    std::vector<size_t> codeMapping; // join pair index -> index of the stored code within storedTypes
+
     cg_voidptr_t memoryPool;
     cg_voidptr_t joinTable;
     llvm::Value * listHeaderPtr;
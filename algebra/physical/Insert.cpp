@@ -2,6 +2,7 @@
 #include "sql/SqlUtils.hpp"
 #include "sql/SqlValues.hpp"
 #include "foundations/version_management.hpp"
+#include "foundations/WriteAheadLog.hpp"
 #include <llvm/IR/TypeBuilder.h>
 
 #include <iostream>
@@ -26,13 +27,17 @@ namespace Algebra {
 
             // store tuple
             table.addRow(0);
+            tid = table.size() - 1;
             size_t column_idx = 0;
             for (auto & value : tuple.values) {
-                void * ptr = const_cast<void *>(table.getColumn(column_idx).back());
-                value->store(ptr);
+                store_master_value(tid, column_idx, *value, table);
                 column_idx += 1;
             }
 
+            if (auto log = table.getDatabase().getWriteAheadLog()) {
+                ctx.executionContext.commitLsn = log->logInsert(table, master_branch_id, tuple);
+            }
+
             return tid;
         }
 #endif
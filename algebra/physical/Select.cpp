@@ -1,7 +1,9 @@
 #include "algebra/physical/Select.hpp"
+#include "algebra/physical/TableScan.hpp"
 #include "foundations/exceptions.hpp"
 #include "sql/SqlValues.hpp"
 #include "sql/SqlUtils.hpp"
+#include "utils/general.hpp"
 
 using namespace Sql;
 
@@ -11,7 +13,11 @@ namespace Physical {
 Select::Select(const logical_operator_t & logicalOperator, std::unique_ptr<Operator> input, Expressions::exp_op_t exp, QueryContext &queryContext) :
         UnaryOperator(std::move(logicalOperator), std::move(input), queryContext),
         _exp(std::move(exp))
-{ }
+{
+    if (auto scan = dynamic_cast<TableScan *>(child.get())) {
+        pushDownBlockFilters(*_exp, *scan);
+    }
+}
 
 Select::~Select()
 { }
@@ -21,6 +27,52 @@ void Select::produce()
     child->produce();
 }
 
+void Select::pushDownBlockFilters(Expressions::Expression & exp, TableScan & scan)
+{
+    using namespace Expressions;
+
+    if (auto conjunction = dynamic_cast<And *>(&exp)) {
+        pushDownBlockFilters(*conjunction->_left, scan);
+        pushDownBlockFilters(*conjunction->_right, scan);
+        return;
+    }
+
+    // only "column op constant" and "constant op column" are considered
+    auto comparison = dynamic_cast<Comparison *>(&exp);
+    if (comparison == nullptr) {
+        return;
+    }
+    auto mode = comparison->_mode;
+    auto identifier = dynamic_cast<Identifier *>(comparison->_left.get());
+    auto constant = dynamic_cast<Constant *>(comparison->_right.get());
+    if (identifier == nullptr && constant == nullptr) {
+        identifier = dynamic_cast<Identifier *>(comparison->_right.get());
+        constant = dynamic_cast<Constant *>(comparison->_left.get());
+        mode = mirror(mode);
+    }
+    if (identifier == nullptr || constant == nullptr) {
+        return;
+    }
+
+    int64_t key;
+    if (!ZoneMap::getConstantKey(*constant->_value, key)) {
+        return;
+    }
+    scan.addBlockFilter(identifier->_iu, mode, key);
+}
+
+ComparisonMode Select::mirror(ComparisonMode mode)
+{
+    switch (mode) {
+        case ComparisonMode::less: return ComparisonMode::gtr;
+        case ComparisonMode::leq: return ComparisonMode::geq;
+        case ComparisonMode::eq: return ComparisonMode::eq;
+        case ComparisonMode::geq: return ComparisonMode::leq;
+        case ComparisonMode::gtr: return ComparisonMode::less;
+        default: unreachable();
+    }
+}
+
 void Select::consume(const iu_value_mapping_t & values, const Operator & src)
 {
     value_op_t match = _exp->evaluate(values);
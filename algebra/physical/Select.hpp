@@ -7,6 +7,8 @@
 namespace Algebra {
 namespace Physical {
 
+class TableScan;
+
 /// The selection operator
 class Select : public UnaryOperator {
 public:
@@ -20,6 +22,12 @@ public:
     void consume(const iu_value_mapping_t & values, const Operator & src) override;
 
 private:
+    /// \brief Registers the comparisons of the conjunction which the scan can check against its zone maps
+    static void pushDownBlockFilters(Expressions::Expression & exp, TableScan & scan);
+
+    /// \returns The mode which yields the same result if both operands are swapped
+    static Sql::ComparisonMode mirror(Sql::ComparisonMode mode);
+
     std::string constant;
     Expressions::exp_op_t _exp;
 };
@@ -5,21 +5,90 @@
 #include "algebra/physical/TableScan.hpp"
 
 #include <llvm/IR/TypeBuilder.h>
+#include "foundations/exceptions.hpp"
 #include "foundations/version_management.hpp"
 #include <unordered_map>
 
-#include "sql/SqlTuple.hpp"
-
 using namespace Sql;
 
 namespace Algebra {
 namespace Physical {
 
-TableScan::TableScan(const logical_operator_t & logicalOperator, Table & table, branch_id_t branchId, QueryContext &queryContext) :
+/// Keeps a materialized branch alive until the query has been executed, even if a write replaces it meanwhile
+struct MaterializedBranchResource : public ExecutionResource {
+    virtual ~MaterializedBranchResource() { }
+
+    std::shared_ptr<const MaterializedBranch> materialized;
+};
+
+/// Holds the differing tuples of a diff scan until the query has been executed
+struct BranchDiffResource : public ExecutionResource {
+    virtual ~BranchDiffResource() { }
+
+    Table * table;
+    branch_id_t base;
+    branch_id_t branch;
+    std::vector<tid_t> tids;
+};
+
+/// Holds the unpacked values of a bit-packed column for the scanned chunk, hence the buffer is allocated once per query
+struct PackedColumnResource : public ExecutionResource {
+    virtual ~PackedColumnResource() { }
+
+    PackedIntegerColumn::BlockDescriptor block;
+    std::unique_ptr<int64_t[]> values;
+};
+
+/// \returns The number of differing tuples
+static size_t collectBranchDiff(BranchDiffResource * resource)
+{
+    resource->tids = diff_branches(*resource->table, resource->base, resource->branch);
+    return resource->tids.size();
+}
+
+static tid_t getBranchDiffTid(BranchDiffResource * resource, size_t idx)
+{
+    return resource->tids[idx];
+}
+
+TableScan::TableScan(const logical_operator_t & logicalOperator, Table & table, branch_id_t branchId, QueryContext &queryContext,
+        branch_id_t diffBranchId) :
         NullaryOperator(std::move(logicalOperator), queryContext),
         table(table),
-        branchId(branchId)
+        branchId(branchId),
+        diffBranchId(diffBranchId)
 {
+#if USE_DATA_VERSIONING
+    if (diffBranchId != invalid_branch_id) {
+        auto resource = std::make_unique<BranchDiffResource>();
+        resource->table = &table;
+        resource->base = diffBranchId;
+        resource->branch = branchId;
+        diffResource = resource.get();
+        queryContext.executionContext.acquireResource(std::move(resource));
+    }
+    if (branchId != master_branch_id) {
+        branchColumns = table.getBranchColumns(branchId);
+    }
+    // the differing tuples are read by random access, which would have to wait for the rebuild of a stale copy
+    if (branchId != master_branch_id && branchColumns == nullptr && diffResource == nullptr) {
+        materialized = table.getMaterializedBranch(branchId);
+    }
+    if (materialized != nullptr) {
+        auto resource = std::make_unique<MaterializedBranchResource>();
+        resource->materialized = materialized;
+        queryContext.executionContext.acquireResource(std::move(resource));
+        branchColumns = &materialized->columns;
+    }
+    if (branchId != master_branch_id && branchColumns == nullptr) {
+        modifiedTids = table.getModifiedTids(branchId);
+    }
+#else
+    if (diffBranchId != invalid_branch_id) {
+        throw NotImplementedException("branches can only be compared with data versioning");
+    }
+#endif
+
     // collect all information which is necessary to access the columns
     for (auto iu : getRequired()) {
         auto ci = getColumnInformation(iu);
@@ -35,10 +104,12 @@ TableScan::TableScan(const logical_operator_t & logicalOperator, Table & table,
             storedSqlType = ci->type;
         }
 
-        size_t tableSize = table.size();
+        // the chunk pointer is loaded within the scan loop
         llvm::Type * elemTy = toLLVMTy(storedSqlType);
-        llvm::Type * columnTy = llvm::ArrayType::get(elemTy, tableSize);
-        llvm::Value * columnPtr = createPointerValue(ci->column->front(), columnTy);
+        if (ci->dictionary != nullptr) {
+            // dictionary-encoded columns store the codes
+            elemTy = StringDictionary::cg_code_t::getType();
+        }
         size_t columnIndex = 0;
         for (int i = 0; i<table.getColumnCount(); i++) {
             if (table.getColumnNames()[i].compare(ci->columnName) == 0) {
@@ -47,7 +118,18 @@ TableScan::TableScan(const logical_operator_t & logicalOperator, Table & table,
             }
         }
 
-        columns.emplace_back(ci, columnTy, columnPtr, columnIndex, nullptr);
+        if (branchColumns != nullptr) {
+            // the columns of the branch are read like the master columns
+            ci = (*branchColumns)[columnIndex].get();
+        }
+        columns.emplace_back(ci, elemTy, nullptr, columnIndex, nullptr);
+
+        if (ci->packed != nullptr && packedResources.count(ci) == 0) {
+            auto resource = std::make_unique<PackedColumnResource>();
+            resource->values.reset(new int64_t[PackedIntegerColumn::blockCapacity]);
+            packedResources[ci] = resource.get();
+            queryContext.executionContext.acquireResource(std::move(resource));
+        }
     }
 }
 
@@ -58,31 +140,181 @@ void TableScan::produce()
 {
     auto & funcGen = _codeGen.getCurrentFunctionGen();
 
-    size_t tableSize = table.size();
+    if (diffResource != nullptr) {
+        produceDiff();
+        return;
+    }
+
+    size_t tableSize = (materialized != nullptr) ? materialized->rowCount : table.size();
     if (tableSize < 1) return;  // nothing to produce
 
-    // iterate over all tuples
+    // iterate over all chunks; all columns of a table share the default chunk size
+    const unsigned chunkShift = Vector::defaultChunkShift;
+    const size_t chunkCapacity = static_cast<size_t>(1) << chunkShift;
+    size_t chunkCount = (tableSize + chunkCapacity - 1) >> chunkShift;
 #ifdef __APPLE__
-    LoopGen scanLoop(funcGen, {{"index", cg_size_t(0ull)}});
+    LoopGen chunkLoop(funcGen, {{"chunkIndex", cg_size_t(0ull)}});
 #else
-    LoopGen scanLoop(funcGen, {{"index", cg_size_t(0ul)}});
+    LoopGen chunkLoop(funcGen, {{"chunkIndex", cg_size_t(0ul)}});
 #endif
-    cg_size_t tid(scanLoop.getLoopVar(0));
+    cg_size_t chunkIndex(chunkLoop.getLoopVar(0));
     {
-        LoopBodyGen bodyGen(scanLoop);
+        LoopBodyGen chunkBodyGen(chunkLoop);
 
-#if USE_DATA_VERSIONING
-        IfGen visibilityCheck(isVisible(tid, branchId));
+        if (blockFilters.empty()) {
+            produceChunk(chunkIndex, tableSize);
+        } else {
+            // chunks whose zones rule out one of the pushed down predicates are skipped as a whole
+            IfGen zoneCheck(genBlockFilterCheck(chunkIndex));
+            {
+                produceChunk(chunkIndex, tableSize);
+            }
+            zoneCheck.EndIf();
+        }
+    }
+    cg_size_t nextChunkIndex = chunkIndex + 1ul;
+    chunkLoop.loopDone(nextChunkIndex < cg_size_t(chunkCount), {nextChunkIndex});
+}
+
+void TableScan::produceChunk(cg_size_t chunkIndex, size_t tableSize)
+{
+    auto & funcGen = _codeGen.getCurrentFunctionGen();
+
+    const unsigned chunkShift = Vector::defaultChunkShift;
+    const size_t chunkCapacity = static_cast<size_t>(1) << chunkShift;
+
+    cg_tid_t chunkBegin = chunkIndex << cg_size_t(chunkShift);
+    cg_tid_t chunkEnd = chunkBegin + chunkCapacity;
+    cg_tid_t limit( _codeGen->CreateSelect(chunkEnd < cg_size_t(tableSize), chunkEnd, cg_size_t(tableSize)) );
+    chunkBeginValue = chunkBegin.getValue();
+
+    // chunks are never relocated, so each chunk address has to be loaded only once
+    for (auto & column : columns) {
+        ci_p_t ci = std::get<0>(column);
+        llvm::Type * elemPtrTy = llvm::PointerType::getUnqual(std::get<1>(column));
+        if (ci->packed != nullptr) {
+            // the scanned rows of a bit-packed block are unpacked at full width, then the chunk is accessed like a plain one
+            static_assert(PackedIntegerColumn::blockShift == Vector::defaultChunkShift,
+                    "packed blocks have to match the scan chunks");
+            PackedColumnResource * resource = packedResources.at(ci);
+            cg_voidptr_t bufferPtr = cg_voidptr_t::fromRawPointer(resource->values.get());
+            genPackedIntegerColumnUnpack(*ci->packed, resource->block, chunkIndex, limit - chunkBegin, bufferPtr);
+            std::get<2>(column) = _codeGen->CreatePointerCast(bufferPtr, elemPtrTy);
+            continue;
+        }
+        cg_voidptr_t chunkPtr = genVectorChunkLoad(*ci->column, chunkIndex);
+        std::get<2>(column) = _codeGen->CreatePointerCast(chunkPtr, elemPtrTy);
+    }
+
+    // iterate over the words of the branch visibility bitvector which cover the current chunk;
+    // words without any visible tuple are skipped as a whole (unversioned tables only use the master
+    // branch, whose bits mark the rows which have not been deleted yet)
+    static_assert((static_cast<size_t>(1) << Vector::defaultChunkShift) % BitmapTable::wordBits == 0,
+            "chunks have to be aligned to bitmap words");
+    cg_size_t wordBegin = chunkBegin >> cg_size_t(6);
+    cg_size_t wordEnd = (limit + cg_size_t(BitmapTable::wordBits - 1)) >> cg_size_t(6);
+
+    // the modified tuples of the whole chunk are fetched at once, all other tuples skip their version chains
+    llvm::Value * modifiedWords = nullptr;
+    if (modifiedTids != nullptr) {
+        const size_t chunkWords = chunkCapacity / BitmapTable::wordBits;
+        modifiedWords = createEntryBlockAlloca(cg_u64_t::getType(), cg_size_t(chunkWords));
+        cg_voidptr_t wordsPtr( _codeGen->CreatePointerCast(modifiedWords, cg_voidptr_t::getType()) );
+        genTidSetGetWordsCall(*modifiedTids, wordBegin, chunkWords, wordsPtr);
+    }
+    LoopGen wordLoop(funcGen, {{"wordIndex", wordBegin}});
+    cg_size_t wordIndex(wordLoop.getLoopVar(0));
+    {
+        LoopBodyGen wordBodyGen(wordLoop);
+
+        // the table may have grown since the scan has been compiled
+        cg_tid_t wordTid = wordIndex << cg_size_t(6);
+        cg_size_t remaining = limit - wordTid;
+        cg_u64_t partialMask = (cg_u64_t(1ul) << remaining) - cg_u64_t(1ul);
+        cg_u64_t mask( _codeGen->CreateSelect(remaining < cg_size_t(BitmapTable::wordBits),
+                partialMask, cg_u64_t(~0ul)) );
+        cg_u64_t word = getVisibilityWord(wordIndex, branchId) & mask;
+        if (modifiedWords != nullptr) {
+            cg_size_t offset = wordIndex - wordBegin;
+            llvm::Value * modifiedAddr = _codeGen->CreateGEP(cg_u64_t::getType(), modifiedWords, offset.getValue());
+            modifiedWordValue = _codeGen->CreateLoad(cg_u64_t::getType(), modifiedAddr);
+        }
+
+        // visit only the set bits
+        LoopGen bitLoop(funcGen, word != cg_u64_t(0ul), {{"word", word}});
+        cg_u64_t currentWord(bitLoop.getLoopVar(0));
         {
+            LoopBodyGen bitBodyGen(bitLoop);
+
+            cg_tid_t tid = wordTid + countTrailingZeros(currentWord);
+#if USE_DATA_VERSIONING
             produce(tid, branchId);
+#else
+            produce(tid);
+#endif
         }
-        visibilityCheck.EndIf();
+        cg_u64_t nextWord = currentWord & (currentWord - cg_u64_t(1ul)); // clear the lowest set bit
+        bitLoop.loopDone(nextWord != cg_u64_t(0ul), {nextWord});
+    }
+    cg_size_t nextWordIndex = wordIndex + 1ul;
+    wordLoop.loopDone(nextWordIndex < wordEnd, {nextWordIndex});
+
+    chunkBeginValue = nullptr;
+    modifiedWordValue = nullptr;
+}
+
+void TableScan::produceDiff()
+{
+#if USE_DATA_VERSIONING
+    auto & funcGen = _codeGen.getCurrentFunctionGen();
+    auto & context = _codeGen.getLLVMContext();
+
+    // the branches are compared when the query is executed, afterwards the differing tuples are visited
+    llvm::FunctionType * collectTy = llvm::TypeBuilder<size_t (void *), false>::get(context);
+    cg_size_t tidCount( _codeGen.CreateCall(&collectBranchDiff, collectTy, {cg_voidptr_t::fromRawPointer(diffResource)}) );
+
+#ifdef __APPLE__
+    LoopGen tidLoop(funcGen, tidCount != cg_size_t(0ull), {{"index", cg_size_t(0ull)}});
 #else
-        produce(tid);
+    LoopGen tidLoop(funcGen, tidCount != cg_size_t(0ul), {{"index", cg_size_t(0ul)}});
+#endif
+    cg_size_t index(tidLoop.getLoopVar(0));
+    {
+        LoopBodyGen tidBodyGen(tidLoop);
+
+        llvm::FunctionType * getTy = llvm::TypeBuilder<size_t (void *, size_t), false>::get(context);
+        cg_tid_t tid( _codeGen.CreateCall(&getBranchDiffTid, getTy, {cg_voidptr_t::fromRawPointer(diffResource), index}) );
+        produce(tid, branchId);
+    }
+    cg_size_t nextIndex = index + 1ul;
+    tidLoop.loopDone(nextIndex < tidCount, {nextIndex});
 #endif
+}
+
+bool TableScan::addBlockFilter(iu_p_t iu, ComparisonMode mode, int64_t constant)
+{
+    if (iu->iuType != InformationUnit::Type::ColumnRef || getRequired().count(iu) == 0) {
+        return false;
+    }
+    ci_p_t ci = getColumnInformation(iu);
+    if (ci->zoneMap == nullptr) {
+        return false;
     }
-    cg_size_t nextIndex = tid + 1ul;
-    scanLoop.loopDone(nextIndex < tableSize, {nextIndex});
+
+    blockFilters.emplace_back(ci, mode, constant);
+    return true;
+}
+
+cg_bool_t TableScan::genBlockFilterCheck(cg_size_t chunkIndex)
+{
+    static_assert(ZoneMap::zoneShift == Vector::defaultChunkShift, "zones have to match the scan chunks");
+
+    cg_bool_t mayMatch(true);
+    for (auto & [ci, mode, constant] : blockFilters) {
+        cg_bool_t zoneMayMatch = genZoneMayMatch(*ci->zoneMap, chunkIndex, mode, constant);
+        mayMatch = cg_bool_t( _codeGen->CreateAnd(mayMatch, zoneMayMatch) );
+    }
+    return mayMatch;
 }
 
 
@@ -96,8 +328,31 @@ void TableScan::produce(cg_tid_t tid, branch_id_t branchId) {
 
     cg_voidptr_t resultPtr;
     cg_bool_t ptrIsNotNull(false);
-    if (branchId != master_branch_id) {
-        resultPtr = genGetLatestEntryCall(tid,branchId);
+    if (branchId != master_branch_id && branchColumns == nullptr) {
+        // the lineages are constructed before the query is compiled
+        auto & executionContext = _context.executionContext;
+        if (executionContext.branch_lineages.count(branchId) == 0) {
+            table.getDatabase().constructBranchLineage(branchId, executionContext);
+        }
+        const BranchLineage & lineage = executionContext.branch_lineages.at(branchId);
+        if (modifiedWordValue == nullptr) {
+            resultPtr = genLatestChainElementLookup(table, tid, lineage);
+        } else {
+            // tuples without any version within the lineage are read from the master row
+            auto & funcGen = _codeGen.getCurrentFunctionGen();
+            cg_voidptr_t nullElement( llvm::ConstantPointerNull::get(llvm::cast<llvm::PointerType>(cg_voidptr_t::getType())) );
+            cg_u64_t modifiedBit = (cg_u64_t(modifiedWordValue) >> (tid & cg_size_t(BitmapTable::wordBits - 1))) & cg_u64_t(1ul);
+            IfGen lookup(funcGen, modifiedBit != cg_u64_t(0ul), {{"element", nullElement}});
+            {
+                lookup.setVar(0, genLatestChainElementLookup(table, tid, lineage));
+            }
+            lookup.Else();
+            {
+                lookup.setVar(0, nullElement);
+            }
+            lookup.EndIf();
+            resultPtr = cg_voidptr_t( lookup.getResult(0) );
+        }
         ptrIsNotNull = nullPointerCheck(resultPtr);
     }
 
@@ -119,10 +374,11 @@ void TableScan::produce(cg_tid_t tid, branch_id_t branchId) {
             ci_p_t ci = std::get<0>(column);
 
             llvm::Value *elemPtr;
-            if (branchId != master_branch_id) {
+            llvm::Value *code = nullptr;
+            if (branchId != master_branch_id && branchColumns == nullptr) {
                 elemPtr = getBranchElemPtr(tid,column,resultPtr,ptrIsNotNull);
             } else {
-                elemPtr = getMasterElemPtr(tid,column);
+                elemPtr = getMasterElemPtr(tid,column,&code);
             }
 
             // calculate the SQL value pointer
@@ -130,13 +386,17 @@ void TableScan::produce(cg_tid_t tid, branch_id_t branchId) {
             if (ci->type.nullable) {
                 assert(ci->nullIndicatorType == ColumnInformation::NullIndicatorType::Column);
                 // load null indicator
-                cg_bool_t isNull = genNullIndicatorLoad(nullIndicatorTable, tid, cg_unsigned_t(ci->nullColumnIndex));
+                cg_bool_t isNull = genNullIndicatorLoad(nullIndicatorTable, tid, ci->nullColumnIndex);
                 SqlType notNullableType = toNotNullableTy(ci->type);
                 auto loadedValue = Value::load(elemPtr, notNullableType);
                 std::get<4>(column) = NullableValue::create(std::move(loadedValue), isNull);
             } else {
                 // load the SQL value
                 std::get<4>(column) = Value::load(elemPtr, ci->type);
+                if (code != nullptr) {
+                    // predicates and joins on this value may compare the code instead
+                    static_cast<BasicString &>(*std::get<4>(column)).setDictionaryCode(ci->dictionary, code);
+                }
             }
 
             // map the value to the according iu
@@ -172,20 +432,25 @@ void TableScan::produce(cg_tid_t tid) {
 
             ci_p_t ci = std::get<0>(column);
 
-            llvm::Value *elemPtr = getMasterElemPtr(tid,column);
+            llvm::Value *code = nullptr;
+            llvm::Value *elemPtr = getMasterElemPtr(tid,column,&code);
 
             // calculate the SQL value pointer
 
             if (ci->type.nullable) {
                 assert(ci->nullIndicatorType == ColumnInformation::NullIndicatorType::Column);
                 // load null indicator
-                cg_bool_t isNull = genNullIndicatorLoad(nullIndicatorTable, tid, cg_unsigned_t(ci->nullColumnIndex));
+                cg_bool_t isNull = genNullIndicatorLoad(nullIndicatorTable, tid, ci->nullColumnIndex);
                 SqlType notNullableType = toNotNullableTy(ci->type);
                 auto loadedValue = Value::load(elemPtr, notNullableType);
                 std::get<4>(column) = NullableValue::create(std::move(loadedValue), isNull);
             } else {
                 // load the SQL value
                 std::get<4>(column) = Value::load(elemPtr, ci->type);
+                if (code != nullptr) {
+                    // predicates and joins on this value may compare the code instead
+                    static_cast<BasicString &>(*std::get<4>(column)).setDictionaryCode(ci->dictionary, code);
+                }
             }
 
             // map the value to the according iu
@@ -199,39 +464,68 @@ void TableScan::produce(cg_tid_t tid) {
 }
 #endif
 
-llvm::Value *TableScan::getMasterElemPtr(cg_tid_t &tid, column_t &column) {
-#ifdef __APPLE__
-    llvm::Value * elemPtr = _codeGen->CreateGEP(std::get<1>(column), std::get<2>(column), { cg_size_t(0ull), tid });
-#else
-    llvm::Value * elemPtr = _codeGen->CreateGEP(std::get<1>(column), std::get<2>(column), { cg_size_t(0ul), tid });
-#endif
-    return elemPtr;
+llvm::Value *TableScan::getMasterElemPtr(cg_tid_t &tid, column_t &column, llvm::Value **code) {
+    ci_p_t ci = std::get<0>(column);
+    llvm::Type * elemTy = std::get<1>(column);
+    llvm::Value * elemPtr;
+    if (chunkBeginValue == nullptr && ci->packed != nullptr) {
+        // random access to a single packed value
+        cg_i64_t value = genPackedIntegerColumnGetCall(*ci->packed, tid);
+        elemPtr = createEntryBlockAlloca(elemTy);
+        _codeGen->CreateStore(_codeGen->CreateTrunc(value, elemTy), elemPtr);
+    } else if (chunkBeginValue == nullptr) {
+        // random access outside of the chunk loop
+        cg_voidptr_t rawPtr = genVectorElementPtr(*ci->column, tid);
+        elemPtr = _codeGen->CreatePointerCast(rawPtr, llvm::PointerType::getUnqual(elemTy));
+    } else {
+        llvm::Value * offset = _codeGen->CreateSub(tid, chunkBeginValue);
+        elemPtr = _codeGen->CreateGEP(elemTy, std::get<2>(column), offset);
+    }
+
+    if (ci->dictionary == nullptr) {
+        return elemPtr;
+    }
+
+    // resolve the code to the address of the actual value
+    StringDictionary::cg_code_t codeValue( _codeGen->CreateLoad(elemTy, elemPtr) );
+    if (code != nullptr) {
+        *code = codeValue.getValue();
+    }
+    cg_voidptr_t valuePtr = genStringDictionaryDecode(*ci->dictionary, codeValue);
+    return _codeGen->CreatePointerCast(valuePtr, llvm::PointerType::getUnqual(toLLVMTy(ci->type)));
 }
 
 llvm::Value *TableScan::getBranchElemPtr(cg_tid_t &tid, column_t &column, cg_voidptr_t &resultPtr, cg_bool_t &ptrIsNotNull) {
-    IfGen check( _codeGen.getCurrentFunctionGen(), ptrIsNotNull, {{"elemPtr", cg_int_t(0)}} );
+    auto & funcGen = _codeGen.getCurrentFunctionGen();
+    ci_p_t ci = std::get<0>(column);
+    SqlType storedSqlType = ci->type.nullable ? toNotNullableTy(ci->type) : ci->type;
+    llvm::Type * valuePtrTy = llvm::PointerType::getUnqual(toLLVMTy(storedSqlType));
+
+    // the versions only hold the columns which they have changed, tuples without any version are not resolved
+    IfGen resolve( funcGen, ptrIsNotNull, {{"versionValuePtr", cg_int_t(0)}} );
     {
-        llvm::Value * valuePtr = tupleToElemPtr(resultPtr,column);
-        check.setVar(0, valuePtr);
+        resolve.setVar(0, genVersionValueLookup(table, tid, resultPtr, std::get<3>(column)));
+    }
+    resolve.Else();
+    {
+        resolve.setVar(0, resultPtr);
+    }
+    resolve.EndIf();
+    cg_voidptr_t versionValuePtr( resolve.getResult(0) );
+
+    IfGen check( funcGen, nullPointerCheck(versionValuePtr), {{"elemPtr", cg_int_t(0)}} );
+    {
+        check.setVar(0, _codeGen->CreatePointerCast(versionValuePtr, valuePtrTy));
     }
     check.Else();
     {
         llvm::Value *elemPtr = getMasterElemPtr(tid,column);
-        check.setVar(0, elemPtr);
+        check.setVar(0, _codeGen->CreatePointerCast(elemPtr, valuePtrTy));
     }
     check.EndIf();
     return check.getResult(0);
 }
 
-cg_voidptr_t TableScan::genGetLatestEntryCall(cg_tid_t tid, branch_id_t branchId) {
-    llvm::FunctionType * funcTy = llvm::TypeBuilder<void * (size_t, void * , void* , void *), false>::get(_codeGen.getLLVMContext());
-    llvm::Function * func = llvm::cast<llvm::Function>( getThreadLocalCodeGen().getCurrentModuleGen().getModule().getOrInsertFunction("get_latest_entry", funcTy) );
-    getThreadLocalCodeGen().getCurrentModuleGen().addFunctionMapping(func,(void *)&get_latest_entry);
-    llvm::CallInst * result = _codeGen->CreateCall(func, {tid, cg_ptr8_t::fromRawPointer(&table), cg_u32_t(branchId), _codeGen.getCurrentFunctionGen().getArg(1)});
-
-    return cg_voidptr_t( llvm::cast<llvm::Value>(result) );
-}
-
 cg_bool_t TableScan::nullPointerCheck(cg_voidptr_t &ptr) {
 #ifdef __APPLE__
     return cg_bool_t(cg_size_t(_codeGen->CreatePtrToInt(ptr, _codeGen->getIntNTy(64))) != cg_size_t(0ull));
@@ -240,18 +534,26 @@ cg_bool_t TableScan::nullPointerCheck(cg_voidptr_t &ptr) {
 #endif
 }
 
-llvm::Value *TableScan::tupleToElemPtr(cg_voidptr_t &ptr, column_t &column) {
-    llvm::Type * tupleTy = Sql::SqlTuple::getType(table.getTupleType());
-    llvm::Type * tuplePtrTy = llvm::PointerType::getUnqual(tupleTy);
-    llvm::Value * tuplePtr = _codeGen->CreatePointerCast(ptr, tuplePtrTy);
-
-    return _codeGen->CreateStructGEP(tupleTy, tuplePtr, std::get<3>(column));
+llvm::Value *TableScan::createEntryBlockAlloca(llvm::Type *type, llvm::Value *arraySize)
+{
+    // allocas within the entry block are only executed once per query
+    llvm::BasicBlock & entryBlock = _codeGen.getCurrentFunctionGen().getFunction()->getEntryBlock();
+    llvm::IRBuilder<> entryBuilder(&entryBlock, entryBlock.begin());
+    return entryBuilder.CreateAlloca(type, arraySize);
 }
 
-cg_bool_t TableScan::isVisible(cg_tid_t tid, cg_branch_id_t branchId)
+cg_u64_t TableScan::getVisibilityWord(cg_size_t wordIndex, branch_id_t branchId)
 {
     auto & branchBitmap = table.getBranchBitmap();
-    return isVisibleInBranch(branchBitmap, tid, branchId);
+    return genBitmapWordLoad(branchBitmap, wordIndex, branchId);
+}
+
+cg_size_t TableScan::countTrailingZeros(cg_u64_t word)
+{
+    llvm::Module & module = _codeGen.getCurrentModule();
+    llvm::Function * cttz = llvm::Intrinsic::getDeclaration(&module, llvm::Intrinsic::cttz, {cg_u64_t::getType()});
+    // the word is never zero here, so the result may be undefined for zero (lowers to tzcnt/bsf)
+    return cg_size_t( _codeGen->CreateCall(cttz, {word.getValue(), _codeGen->getTrue()}) );
 }
 
 } // end namespace Physical
@@ -8,10 +8,16 @@
 namespace Algebra {
 namespace Physical {
 
+struct BranchDiffResource;
+struct PackedColumnResource;
+
 /// The table scan operator
 class TableScan : public NullaryOperator {
 public:
-    TableScan(const logical_operator_t & logicalOperator, Table & table, branch_id_t branchId, QueryContext &queryContext);
+    /// \param diffBranchId The branch which the scanned one is compared to, see diff_branches(); a diff scan only produces
+    ///        the tuples of the scanned branch which differ from this branch
+    TableScan(const logical_operator_t & logicalOperator, Table & table, branch_id_t branchId, QueryContext &queryContext,
+            branch_id_t diffBranchId = invalid_branch_id);
 
     virtual ~TableScan();
 
@@ -23,21 +29,63 @@ public:
     void produce(cg_tid_t tid);
 #endif
 
+    /// \brief Skips all chunks whose zone map rules out "column mode constant"
+    ///
+    /// The predicate itself still has to be evaluated by the parent operator.
+    /// \returns false if the iu is not produced by this operator or its column has no zone map
+    bool addBlockFilter(iu_p_t iu, Sql::ComparisonMode mode, int64_t constant);
+
 private:
+    /// (column information, element type, current chunk pointer, column index, loaded value)
     using column_t = std::tuple<ci_p_t, llvm::Type *, llvm::Value *, size_t, Sql::value_op_t>;
 
-    cg_voidptr_t genGetLatestEntryCall(cg_tid_t tid, branch_id_t branchId);
+    /// (column information, comparison mode, constant key)
+    using block_filter_t = std::tuple<ci_p_t, Sql::ComparisonMode, int64_t>;
+
+    void produceChunk(cg_size_t chunkIndex, size_t tableSize);
+
+    /// \brief Produces the tuples which differ from the compared branch by random access
+    void produceDiff();
+    cg_bool_t genBlockFilterCheck(cg_size_t chunkIndex);
+
     cg_bool_t nullPointerCheck(cg_voidptr_t &pointer);
-    llvm::Value *tupleToElemPtr(cg_voidptr_t &ptr, column_t &column);
 
-    cg_bool_t isVisible(cg_tid_t tid, cg_branch_id_t branchId);
-    llvm::Value *getMasterElemPtr(cg_tid_t &tid, column_t &column);
+    llvm::Value *createEntryBlockAlloca(llvm::Type *type, llvm::Value *arraySize = nullptr);
+
+    cg_u64_t getVisibilityWord(cg_size_t wordIndex, branch_id_t branchId);
+    cg_size_t countTrailingZeros(cg_u64_t word);
+    /// \param code Receives the loaded code if the column is dictionary-encoded
+    llvm::Value *getMasterElemPtr(cg_tid_t &tid, column_t &column, llvm::Value **code = nullptr);
     llvm::Value *getBranchElemPtr(cg_tid_t &tid, column_t &column, cg_voidptr_t &resultPtr, cg_bool_t &ptrIsNotNull);
 
     Table & table;
     branch_id_t branchId;
+    branch_id_t diffBranchId;
+
+    /// the differing tuples of a diff scan, which are collected when the query is executed
+    BranchDiffResource * diffResource = nullptr;
+
+    /// the buffers which the current chunk of each bit-packed column is unpacked into
+    std::unordered_map<ci_p_t, PackedColumnResource *> packedResources;
+
+    /// the columnar copy of the branch if it is materialized
+    std::shared_ptr<const MaterializedBranch> materialized;
+
+    /// the columns of a branch which are read like the master columns: the forks of a table which is
+    /// versioned by pages or the materialized copy; nullptr if the version chains have to be resolved
+    const std::vector<std::unique_ptr<ColumnInformation>> * branchColumns = nullptr;
+
+    /// the tuples whose version chains a scan of the branch has to resolve; nullptr if all are resolved
+    const TidSet * modifiedTids = nullptr;
+
+    /// the first tid of the chunk which is currently being scanned
+    llvm::Value * chunkBeginValue = nullptr;
+
+    /// the modified tuples among the ones of the current visibility word
+    llvm::Value * modifiedWordValue = nullptr;
 
     std::vector<column_t> columns;
+    std::vector<block_filter_t> blockFilters;
     Sql::value_op_t tidSqlValue;
 };
 
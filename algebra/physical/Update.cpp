@@ -9,6 +9,7 @@
 #include "sql/SqlValues.hpp"
 #include "sql/SqlTuple.hpp"
 #include "foundations/version_management.hpp"
+#include "foundations/WriteAheadLog.hpp"
 #include "sql/ValueTranslator.hpp"
 
 using namespace Sql;
@@ -39,12 +40,18 @@ namespace Algebra {
                 std::unique_ptr<Sql::Value> sqlValue = nullptr;
                 if (iuPairs.second.compare("") != 0) {
                     sqlValue = Sql::Value::castString(iuPairs.second,storedSqlType);
+                    if (ci->dictionary != nullptr) {
+                        // encode the new value once during compilation
+                        auto code = ci->dictionary->encode(iuPairs.second);
+                        static_cast<BasicString &>(*sqlValue).setDictionaryCode(ci->dictionary,
+                                StringDictionary::cg_code_t(code).getValue());
+                    }
                 }
 
-                size_t tableSize = table.size();
                 llvm::Type * elemTy = toLLVMTy(storedSqlType);
-                llvm::Type * columnTy = llvm::ArrayType::get(elemTy, tableSize);
-                llvm::Value * columnPtr = createPointerValue(ci->column->front(), columnTy);
+                if (ci->dictionary != nullptr) {
+                    elemTy = StringDictionary::cg_code_t::getType();
+                }
                 size_t columnIndex = 0;
                 for (int i = 0; i<table.getColumnCount(); i++) {
                     if (table.getColumnNames()[i].compare(ci->columnName) == 0) {
@@ -53,7 +60,7 @@ namespace Algebra {
                     }
                 }
 
-                columns.emplace_back(ci, columnTy, columnPtr, columnIndex, std::move(sqlValue));
+                columns.emplace_back(ci, elemTy, nullptr, columnIndex, std::move(sqlValue));
             }
         }
 
@@ -125,16 +132,31 @@ namespace Algebra {
                 Sql::Value *sqlValue = std::get<4>(column).get();
                 if (sqlValue == nullptr) continue;
 
+                ci_p_t ci = std::get<0>(column);
+                if (ci->zoneMap != nullptr) {
+                    genZoneMapIncludeCall(*ci->zoneMap, tid, *sqlValue);
+                }
+                if (ci->packed != nullptr) {
+                    genPackedIntegerColumnSetCall(*ci->packed, tid, *sqlValue);
+                    continue;
+                }
+
                 // calculate the SQL value pointer
-#ifdef __APPLE__
-                llvm::Value * elemPtr = _codeGen->CreateGEP(std::get<1>(column), std::get<2>(column), { cg_size_t(0ull), tid });
-#else
-                llvm::Value * elemPtr = _codeGen->CreateGEP(std::get<1>(column), std::get<2>(column), { cg_size_t(0ul), tid });
-#endif
+                cg_voidptr_t rawElemPtr = genVectorElementPtr(*ci->column, tid);
+                llvm::Value * elemPtr = _codeGen->CreatePointerCast(rawElemPtr, llvm::PointerType::getUnqual(std::get<1>(column)));
                 // map the value to the according iu
 
                 // Store the new value at desired position
-                sqlValue->store(elemPtr);
+                if (ci->dictionary != nullptr) {
+                    StringDictionary::cg_code_t code = genStringDictionaryEncode(*ci->dictionary, *sqlValue);
+                    _codeGen->CreateStore(code, elemPtr);
+                } else {
+                    sqlValue->store(elemPtr);
+                }
+            }
+
+            if (auto log = table.getDatabase().getWriteAheadLog()) {
+                genWriteAheadLogUpdateCall(*log, table, tid, _codeGen.getCurrentFunctionGen().getArg(1));
             }
 #endif
 
@@ -171,6 +171,11 @@ public:
         auto leftChild = std::move( _translated.top() );
         _translated.pop();
 
+        if (exp._mode == Logical::Expressions::ComparisonMode::eq) {
+            encodeConstant(exp.getLeftChild(), exp.getRightChild(), *rightChild);
+            encodeConstant(exp.getRightChild(), exp.getLeftChild(), *leftChild);
+        }
+
         _translated.push( std::make_unique<Physical::Expressions::Comparison>(
                 exp.getType(),
                 exp._mode,
@@ -196,6 +201,34 @@ public:
     }
 
 private:
+    /// \brief Attaches the dictionary code to a string constant which is compared to a dictionary-encoded column
+    void encodeConstant(Logical::Expressions::Expression & column, Logical::Expressions::Expression & constant,
+            Physical::Expressions::Expression & translatedConstant)
+    {
+        auto identifier = dynamic_cast<Logical::Expressions::Identifier *>(&column);
+        auto logicalConstant = dynamic_cast<Logical::Expressions::Constant *>(&constant);
+        auto constantExp = dynamic_cast<Physical::Expressions::Constant *>(&translatedConstant);
+        if (identifier == nullptr || logicalConstant == nullptr || constantExp == nullptr) {
+            return;
+        }
+
+        iu_p_t iu = identifier->_iu;
+        if (iu->iuType != InformationUnit::Type::ColumnRef || iu->columnInformation->dictionary == nullptr) {
+            return;
+        }
+
+        StringDictionary & dictionary = *iu->columnInformation->dictionary;
+        if (!Sql::equals(constantExp->_value->type, dictionary.getType(), Sql::SqlTypeEqualsMode::WithoutNullable)) {
+            return;
+        }
+
+        // a constant which is absent from the dictionary receives invalid_code, which no stored value carries;
+        // the statement is compiled on each execution, hence the code cannot become stale
+        auto code = dictionary.lookup(logicalConstant->_value);
+        static_cast<Sql::BasicString &>(*constantExp->_value).setDictionaryCode(&dictionary,
+                StringDictionary::cg_code_t(code).getValue());
+    }
+
     std::stack<physical_expression_op_t> _translated;
 };
 
@@ -468,7 +501,8 @@ public:
             op,
             op.getTable(),
             op.getBranchId(),
-            _queryContext
+            _queryContext,
+            op.getDiffBranchId()
         ) );
     }
 
@@ -60,9 +60,9 @@ void update_tuples_once(branch_id_t branch, size_t cnt, Database & db, Table & t
         VersionEntry * version_entry;
         if (is_marked_as_dangling_tid(tid)) {
             tid_t unmarked = unmark_dangling_tid(tid);
-            version_entry = table._dangling_version_mgmt_column[unmarked].get();
+            version_entry = &table._dangling_version_mgmt_column[unmarked];
         } else {
-            version_entry = table._version_mgmt_column[tid].get();
+            version_entry = &table._version_mgmt_column[tid];
         }
         if (!has_lineage_intersection(ctx, version_entry)) {
             continue;
@@ -141,6 +141,8 @@ void perform_bunch_updates(Database & db, Table & table) {
     size_t chunk_size = total_cnt/branches_dist.size();
     for (branch_id_t branch : branches_dist) {
         update_tuples(branch, chunk_size, db, table);
+        // like statements, each batch gives the collections a chance to run
+        db.collectIfDue();
     }
     total_updates += total_cnt;
 }
@@ -174,8 +176,8 @@ int64_t measure_master_scan_yielding_latest(branch_id_t branch, Database & db, T
     auto scan_items = std::make_tuple<
         ScanItem<Register<Integer>>, ScanItem<Register<Integer>>, ScanItem<Register<Integer>>>(
         {column0, 0},
-        {column1, 4},
-        {column2, 8});
+        {column1, 1},
+        {column2, 2});
 
     tuple_cnt = 0;
 
@@ -200,8 +202,8 @@ int64_t measure_master_scan_yielding_earliest(branch_id_t branch, Database & db,
     auto scan_items = std::make_tuple<
         ScanItem<Register<Integer>>, ScanItem<Register<Integer>>, ScanItem<Register<Integer>>>(
         {column0, 0},
-        {column1, 4},
-        {column2, 8});
+        {column1, 1},
+        {column2, 2});
 
     tuple_cnt = 0;
 
@@ -275,6 +277,10 @@ void run_benchmark() {
     }
 
     printf("update insert ratio: %f\n", static_cast<double>(total_updates)/static_cast<double>(total_inserts));
+
+    auto stats = bench_table.getVersionAllocatorStats();
+    printf("version allocator: %lu bytes per version, %lu live versions (%lu oversized), %lu slabs, %lu bytes reserved, %lu allocations, %lu releases\n",
+        stats.elementSize, stats.liveElements, stats.oversizedElements, stats.slabCount, stats.reservedBytes, stats.allocations, stats.releases);
 }
 
 int main(int argc, char * argv[]) {
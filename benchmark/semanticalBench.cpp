@@ -17,6 +17,7 @@
 
 #include "codegen/CodeGen.hpp"
 #include "foundations/Database.hpp"
+#include "foundations/Snapshot.hpp"
 #include "queryExecutor/queryExecutor.hpp"
 #include "queryCompiler/queryCompiler.hpp"
 #include "foundations/version_management.hpp"
@@ -40,6 +41,9 @@ DEFINE_double(d, 0.5, "distribution");
 DEFINE_uint64(r, 1, "runs");
 DEFINE_uint64(lowerBound, 1, "lowerBound");
 DEFINE_uint64(upperBound, 30303, "upperBound");
+DEFINE_string(snapshot, "", "snapshot file; restored if it exists, otherwise written after loading");
+DEFINE_string(materialize, "", "branch which is materialized before the statements are run");
+DEFINE_string(engine, "chains", "versioning engine of the tables: chains or pages");
 
 static bool ValidateDatabase(const char *flagname, const std::string &value) {
     return value.compare("wikidb") == 0;
@@ -50,7 +54,12 @@ static bool ValidateDistribution(const char *flagname, const std::string &value)
     return distributions.size() == 2;
 }
 
+static bool ValidateEngine(const char *flagname, const std::string &value) {
+    return value.compare("chains") == 0 || value.compare("pages") == 0;
+}
+
 DEFINE_validator(l, &ValidateDatabase);
+DEFINE_validator(engine, &ValidateEngine);
 
 #if USE_DATA_VERSIONING
 void loadWikiDb(Database *db, int lowerBound, int upperBound)
@@ -403,11 +412,8 @@ void loadWikiDb(Database *db, int lowerBound, int upperBound)
 
 void storeTextGen(char *dest, const uint8_t * bytes, size_t len) {
     if (len > 15) {
-        std::unique_ptr<uint8_t[]> data(new uint8_t[len]);
-        std::memcpy(data.get(), bytes, len);
-        auto & storedStr = StringPool::instance().put(sql_string_t(len, std::move(data)));
-        uint8_t * beginPtr = storedStr.second.get();
-        uint8_t * endPtr = beginPtr+len;
+        const uint8_t * beginPtr = StringPool::instance().put(bytes, len);
+        const uint8_t * endPtr = beginPtr+len;
 
         uintptr_t first_value = reinterpret_cast<uintptr_t>(beginPtr);
         first_value ^= static_cast<uintptr_t>(1) << (8*sizeof(uintptr_t)-1);
@@ -581,6 +587,8 @@ void loadTable(std::istream & stream, Table* table, int tableType)
 
         tid++;
     }
+
+    table->refreshZoneMaps();
 }
 
 void loadWikiDb(Database *db, int lowerBound, int upperBound)
@@ -699,7 +707,7 @@ void prompt(Database &database, unsigned runs)
 }
 
 int main(int argc, char * argv[]) {
-    gflags::SetUsageMessage("semanticalBench [-b] [-l <Database Name>] [-d <Master Share>] [-r <Runs per Statement>]");
+    gflags::SetUsageMessage("semanticalBench [-b] [-l <Database Name>] [-d <Master Share>] [-r <Runs per Statement>] [-snapshot <File>] [-materialize <Branch>] [-engine <chains|pages>]");
     gflags::ParseCommandLineFlags(&argc, &argv, true);
 
     llvm::InitializeNativeTarget();
@@ -707,8 +715,27 @@ int main(int argc, char * argv[]) {
     llvm::InitializeNativeTargetAsmParser();
 
     std::unique_ptr<Database> db = std::make_unique<Database>();
+    if (FLAGS_engine.compare("pages") == 0) {
+        db->setDefaultVersioningEngine(Table::VersioningEngine::Pages);
+    }
 
-    loadWikiDb(db.get(),FLAGS_lowerBound,FLAGS_upperBound);
+    if (!FLAGS_snapshot.empty() && std::ifstream(FLAGS_snapshot)) {
+        ModuleGen moduleGen("LoadSnapshotModule");
+        auto start = std::chrono::high_resolution_clock::now();
+        Snapshot::load(*db, FLAGS_snapshot);
+        auto end = std::chrono::high_resolution_clock::now();
+        std::cout << "Snapshot load time: " << std::chrono::duration_cast<std::chrono::microseconds>(end - start).count() << "us\n";
+    } else {
+        loadWikiDb(db.get(),FLAGS_lowerBound,FLAGS_upperBound);
+        if (!FLAGS_snapshot.empty()) {
+            ModuleGen moduleGen("SaveSnapshotModule");
+            Snapshot::save(*db, FLAGS_snapshot);
+        }
+    }
+
+    if (!FLAGS_materialize.empty()) {
+        QueryCompiler::compileAndExecute("MATERIALIZE BRANCH " + FLAGS_materialize + ";",*db);
+    }
 
     prompt(*db,FLAGS_r);
 
@@ -846,15 +873,11 @@ void loadTable(std::istream & stream, Table* table, std::discrete_distribution<i
     while (std::getline(stream, rowStr)) {
         int branchId = distribution(generator);
 
-        table->_version_mgmt_column.push_back(std::make_unique<VersionEntry>());
-        VersionEntry * version_entry = table->_version_mgmt_column.back().get();
-        version_entry->first = version_entry;
-        version_entry->next = nullptr;
-        version_entry->next_in_branch = nullptr;
+        table->_version_mgmt_column.emplace_back();
+        VersionEntry * version_entry = &table->_version_mgmt_column.back();
 
         // branch visibility
         version_entry->branch_id = branchId;
-        version_entry->branch_visibility.resize(distribution.probabilities().size(), false);
         version_entry->branch_visibility.set(branchId);
         version_entry->creation_ts = distribution.probabilities().size();
 
@@ -874,6 +897,8 @@ void loadTable(std::istream & stream, Table* table, std::discrete_distribution<i
         // load row
         f(row.data());
     }
+
+    table->refreshZoneMaps();
 }
 
 void loadWikiTable(std::istream & stream, bool isDistributing, Table* table, std::discrete_distribution<int> distribution, int groupByColumn)
@@ -920,15 +945,11 @@ void loadWikiTable(std::istream & stream, bool isDistributing, Table* table, std
             assert(pageRows.size() == branchMappings.size());
             std::sort(branchMappings.begin(),branchMappings.end());
             for (int j=0; j<pageRows.size(); j++) {
-                table->_version_mgmt_column.push_back(std::make_unique<VersionEntry>());
-                VersionEntry * version_entry = table->_version_mgmt_column.back().get();
-                version_entry->first = version_entry;
-                version_entry->next = nullptr;
-                version_entry->next_in_branch = nullptr;
+                table->_version_mgmt_column.emplace_back();
+                VersionEntry * version_entry = &table->_version_mgmt_column.back();
 
                 // branch visibility
                 version_entry->branch_id = branchMappings[j];
-                version_entry->branch_visibility.resize(distribution.probabilities().size(), false);
                 version_entry->branch_visibility.set(branchMappings[j]);
                 version_entry->creation_ts = distribution.probabilities().size();
 
@@ -963,15 +984,11 @@ void loadWikiTable(std::istream & stream, bool isDistributing, Table* table, std
 
     assert(pageRows.size() == branchMappings.size());
     for (int j=0; j<pageRows.size(); j++) {
-        table->_version_mgmt_column.push_back(std::make_unique<VersionEntry>());
-        VersionEntry * version_entry = table->_version_mgmt_column.back().get();
-        version_entry->first = version_entry;
-        version_entry->next = nullptr;
-        version_entry->next_in_branch = nullptr;
+        table->_version_mgmt_column.emplace_back();
+        VersionEntry * version_entry = &table->_version_mgmt_column.back();
 
         // branch visibility
         version_entry->branch_id = branchMappings[j];
-        version_entry->branch_visibility.resize(distribution.probabilities().size(), false);
         version_entry->branch_visibility.set(branchMappings[j]);
         version_entry->creation_ts = distribution.probabilities().size();
 
@@ -989,6 +1006,8 @@ void loadWikiTable(std::istream & stream, bool isDistributing, Table* table, std
         // load row
         f(row.data());
     }
+
+    table->refreshZoneMaps();
 }
 
 std::unique_ptr<Database> loadTPCC() {
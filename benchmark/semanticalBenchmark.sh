@@ -16,7 +16,7 @@ COMMIT_ID=$(git rev-parse --verify HEAD)
 
 benchmark_input() {
     # Execute benchmark program and write output to file
-    (./semanticalBench "-d=$5" "-r=$4" "--lowerBound=$6" "--upperBound=$7" < $1) | cat > output.txt
+    (./semanticalBench "-d=$5" "-r=$4" "--lowerBound=$6" "--upperBound=$7" $8 < $1) | cat > output.txt
 
     # Declare metric arrays
     declare -a parsing_times
@@ -188,7 +188,7 @@ benchmark_input_for_distributions() {
 #    insertLimit=$(bc -l <<<"${insertLimit}*2")
 #    insertLimit=$(bc -l <<<"${insertLimit}+1")
 
-    benchmark_input $(echo "./benchmarkStatements/$1_23910821_23927983.txt") $2 $3 $4 "0.5" 23910821 23927983
+    benchmark_input $(echo "./benchmarkStatements/$1_23910821_23927983.txt") $2 $3 $4 "0.5" 23910821 23927983 $5
 
 #    rm buffer_file.txt
 }
@@ -222,3 +222,11 @@ benchmark_input_for_distributions md_statements $OUTPUT_FILE 12 1
 echo "Benchmark Delete Statements with branching..."
 benchmark_input_for_distributions b1d_statements $OUTPUT_FILE 13 1
 benchmark_input_for_distributions b2d_statements $OUTPUT_FILE 14 1
+echo "Benchmark Select and Merge Statements on a materialized branch..."
+benchmark_input_for_distributions b1s_statements $OUTPUT_FILE 15 3 "--materialize=branch1"
+benchmark_input_for_distributions b1m_statements $OUTPUT_FILE 16 1 "--materialize=branch1"
+echo "Benchmark Statements with branching on tables which are versioned by pages..."
+benchmark_input_for_distributions b1s_statements $OUTPUT_FILE 17 3 "--engine=pages"
+benchmark_input_for_distributions b1m_statements $OUTPUT_FILE 18 1 "--engine=pages"
+benchmark_input_for_distributions b1u_statements $OUTPUT_FILE 19 3 "--engine=pages"
+benchmark_input_for_distributions b1d_statements $OUTPUT_FILE 20 1 "--engine=pages"
@@ -0,0 +1,95 @@
+#include "foundations/Database.hpp"
+#include "foundations/version_management.hpp"
+#include "foundations/WriteAheadLog.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <unistd.h>
+
+#include "native/sql/SqlValues.hpp"
+#include "native/sql/SqlTuple.hpp"
+
+static constexpr size_t default_thread_cnt = 8;
+static constexpr size_t default_statements_per_thread = 2'000;
+static const char * log_path = "wal_bench.log";
+
+using namespace Native::Sql;
+
+// every statement inserts a single tuple and commits it
+void run_statements(Database & db, Table & table, size_t cnt) {
+    ModuleGen moduleGen("WalBenchModule");
+    QueryContext ctx(db);
+    ctx.executionContext.branchId = master_branch_id;
+
+    std::vector<value_op_t> values;
+    values.push_back(std::make_unique<Integer>(1));
+    values.push_back(std::make_unique<Integer>(2));
+    values.push_back(std::make_unique<Integer>(3));
+    SqlTuple tuple(std::move(values));
+
+    WriteAheadLog * log = db.getWriteAheadLog();
+    for (size_t i = 0; i < cnt; ++i) {
+        insert_tuple(tuple, table, ctx);
+        if (log != nullptr) {
+            log->commit(ctx.executionContext.commitLsn);
+        }
+    }
+}
+
+void run_benchmark(const char * name, const WriteAheadLog::Durability * durability, size_t thread_cnt, size_t statements_per_thread) {
+    unlink(log_path);
+    auto db = std::make_unique<Database>();
+
+    // statements of different threads touch different tables, hence they only contend on the log
+    std::vector<Table *> tables;
+    {
+        ModuleGen moduleGen("WalBenchModule");
+        for (size_t i = 0; i < thread_cnt; ++i) {
+            auto & table = db->createTable("bench_table" + std::to_string(i));
+            table.addColumn("a", Sql::getIntegerTy());
+            table.addColumn("b", Sql::getIntegerTy());
+            table.addColumn("c", Sql::getIntegerTy());
+            tables.push_back(&table);
+        }
+    }
+    if (durability != nullptr) {
+        db->setWriteAheadLog(std::make_unique<WriteAheadLog>(log_path, *durability));
+    }
+
+    using namespace std::chrono;
+    const auto start = high_resolution_clock::now();
+    std::vector<std::thread> threads;
+    for (size_t i = 0; i < thread_cnt; ++i) {
+        threads.emplace_back(run_statements, std::ref(*db), std::ref(*tables[i]), statements_per_thread);
+    }
+    for (auto & thread : threads) {
+        thread.join();
+    }
+    const auto duration = duration_cast<microseconds>(high_resolution_clock::now() - start).count();
+
+    uint64_t sync_cnt = 0;
+    if (auto log = db->getWriteAheadLog()) {
+        sync_cnt = log->getSyncCount();
+    }
+    double statements = static_cast<double>(thread_cnt*statements_per_thread);
+    printf("%-8s %12.0f statements/s %10lu syncs\n", name, statements/(duration/1.e6), sync_cnt);
+
+    db.reset();
+    unlink(log_path);
+}
+
+int main(int argc, char * argv[]) {
+    size_t thread_cnt = (argc > 1) ? std::strtoul(argv[1], nullptr, 10) : default_thread_cnt;
+    size_t statements_per_thread = (argc > 2) ? std::strtoul(argv[2], nullptr, 10) : default_statements_per_thread;
+    printf("%lu threads, %lu statements per thread\n", thread_cnt, statements_per_thread);
+
+    run_benchmark("none", nullptr, thread_cnt, statements_per_thread);
+    for (auto durability : { WriteAheadLog::Durability::Sync, WriteAheadLog::Durability::Group, WriteAheadLog::Durability::Async }) {
+        run_benchmark(WriteAheadLog::getDurabilityName(durability), &durability, thread_cnt, statements_per_thread);
+    }
+}
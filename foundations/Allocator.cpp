@@ -0,0 +1,312 @@
+#include "foundations/Allocator.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include "foundations/exceptions.hpp"
+#include "utils/general.hpp"
+
+// memory policies of mbind(2), the numaif.h header of libnuma is not required
+static constexpr int mpolPreferred = 1;
+static constexpr int mpolInterleave = 3;
+
+static size_t roundUp(size_t size, size_t alignment)
+{
+    return (size + alignment - 1) & ~(alignment - 1);
+}
+
+/// \returns The size of the carved block which serves an allocation of the given size
+static size_t getBlockSize(size_t size)
+{
+    return roundUp(std::max<size_t>(size, 1), Allocator::blockAlignment);
+}
+
+/// \returns The mask of all online NUMA nodes (up to 64), parsed from e.g. "0-1,3"
+static unsigned long getOnlineNodeMask()
+{
+    static const unsigned long mask = []() {
+        unsigned long mask = 0;
+        std::ifstream in("/sys/devices/system/node/online");
+        std::string range;
+        while (std::getline(in, range, ',')) {
+            unsigned first = 0;
+            unsigned last = 0;
+            char dash;
+            std::istringstream rangeIn(range);
+            rangeIn >> first;
+            last = (rangeIn >> dash >> last) ? last : first;
+            for (unsigned node = first; node <= last && node < 64; ++node) {
+                mask |= 1ul << node;
+            }
+        }
+        return (mask == 0) ? 1ul : mask;
+    }();
+    return mask;
+}
+
+/// \brief Applies the NUMA placement to the given (untouched) mapping
+static void applyPlacement(void * addr, size_t size, const AllocationPolicy & policy)
+{
+    unsigned long mask;
+    int mode;
+    switch (policy.placement) {
+        case AllocationPolicy::Placement::FirstTouch:
+            return;
+        case AllocationPolicy::Placement::Interleaved:
+            mask = getOnlineNodeMask();
+            mode = mpolInterleave;
+            break;
+        case AllocationPolicy::Placement::Node:
+            mask = 1ul << policy.node;
+            mode = mpolPreferred;
+            break;
+    }
+    // the placement is only a hint: machines without NUMA support simply ignore it
+    syscall(SYS_mbind, addr, size, mode, &mask, 8*sizeof(mask) + 1, 0);
+}
+
+//-----------------------------------------------------------------------------
+// AllocationPolicy
+
+AllocationPolicy AllocationPolicy::parse(const std::string & spec)
+{
+    AllocationPolicy policy;
+    std::istringstream in(spec);
+    std::string part;
+    while (std::getline(in, part, ',')) {
+        if (part == "regular") {
+            policy.pages = Pages::Regular;
+        } else if (part == "thp") {
+            policy.pages = Pages::TransparentHuge;
+        } else if (part == "huge") {
+            policy.pages = Pages::ExplicitHuge;
+        } else if (part == "firsttouch") {
+            policy.placement = Placement::FirstTouch;
+        } else if (part == "interleave") {
+            policy.placement = Placement::Interleaved;
+        } else if (part.compare(0, 4, "node") == 0 && part.size() > 4 &&
+                part.find_first_not_of("0123456789", 4) == std::string::npos) {
+            policy.placement = Placement::Node;
+            policy.node = static_cast<unsigned>(std::stoul(part.substr(4)));
+            if (policy.node >= 64) {
+                throw InvalidOperationException("unsupported NUMA node '" + part + "'");
+            }
+        } else {
+            throw InvalidOperationException("unknown allocation policy '" + part + "'");
+        }
+    }
+    return policy;
+}
+
+std::string AllocationPolicy::toString() const
+{
+    std::string str;
+    switch (pages) {
+        case Pages::Regular: str = "regular"; break;
+        case Pages::TransparentHuge: str = "thp"; break;
+        case Pages::ExplicitHuge: str = "huge"; break;
+    }
+    switch (placement) {
+        case Placement::FirstTouch: str += ",firsttouch"; break;
+        case Placement::Interleaved: str += ",interleave"; break;
+        case Placement::Node: str += ",node" + std::to_string(node); break;
+    }
+    return str;
+}
+
+//-----------------------------------------------------------------------------
+// Allocator
+
+Allocator & Allocator::instance()
+{
+    // never destroyed: storage owned by other static objects may be released during exit
+    static Allocator * allocator = new Allocator();
+    return *allocator;
+}
+
+size_t Allocator::getPolicyKey(const AllocationPolicy & policy)
+{
+    return (static_cast<size_t>(policy.pages) << 16) | (static_cast<size_t>(policy.placement) << 8) | policy.node;
+}
+
+void * Allocator::map(size_t size, const AllocationPolicy & policy)
+{
+    void * addr = MAP_FAILED;
+    if (policy.pages == AllocationPolicy::Pages::ExplicitHuge) {
+        addr = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+    }
+
+    if (addr == MAP_FAILED) {
+        // over-allocate and trim, so that the mapping starts at a huge page boundary
+        size_t mappedSize = size + hugePageSize;
+        uint8_t * mapped = static_cast<uint8_t *>(
+                mmap(nullptr, mappedSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0));
+        if (unlikely(mapped == MAP_FAILED)) {
+            throw std::runtime_error("allocation failed");
+        }
+        uint8_t * aligned = reinterpret_cast<uint8_t *>(roundUp(reinterpret_cast<uintptr_t>(mapped), hugePageSize));
+        if (aligned > mapped) {
+            munmap(mapped, aligned - mapped);
+        }
+        munmap(aligned + size, (mapped + mappedSize) - (aligned + size));
+        addr = aligned;
+
+        if (policy.pages != AllocationPolicy::Pages::Regular) {
+            madvise(addr, size, MADV_HUGEPAGE);
+        }
+    }
+
+    if (unlikely((reinterpret_cast<uintptr_t>(addr) + size) >> addressBits != 0)) {
+        munmap(addr, size);
+        throw std::runtime_error("allocation outside of the tracked address space");
+    }
+
+    applyPlacement(addr, size, policy);
+    _mappedBytes += size;
+    return addr;
+}
+
+Allocator::FrameKind Allocator::getFrameKind(const void * ptr) const
+{
+    uintptr_t frame = reinterpret_cast<uintptr_t>(ptr) >> frameShift;
+    size_t leafIndex = frame >> frameLeafBits;
+    if (leafIndex >= frameLeafCount) {
+        return FrameKind::None; // map() never places mappings up there
+    }
+    const std::atomic<FrameKind> * leaf = _frameKinds[leafIndex].load(std::memory_order_acquire);
+    if (leaf == nullptr) {
+        return FrameKind::None;
+    }
+    return leaf[frame & (frameLeafSize - 1)].load(std::memory_order_acquire);
+}
+
+void Allocator::setFrameKind(const void * begin, FrameKind kind)
+{
+    uintptr_t frame = reinterpret_cast<uintptr_t>(begin) >> frameShift;
+    size_t leafIndex = frame >> frameLeafBits;
+    assert(leafIndex < frameLeafCount);
+    std::atomic<FrameKind> * leaf = _frameKinds[leafIndex].load(std::memory_order_relaxed);
+    if (leaf == nullptr) {
+        leaf = new std::atomic<FrameKind>[frameLeafSize]();
+        _frameKinds[leafIndex].store(leaf, std::memory_order_release);
+    }
+    leaf[frame & (frameLeafSize - 1)].store(kind, std::memory_order_release);
+}
+
+void * Allocator::allocate(size_t size, const AllocationPolicy & policy)
+{
+    if (policy.isRegular()) {
+        void * ptr = std::malloc(size);
+        if (unlikely(ptr == nullptr)) {
+            throw std::runtime_error("allocation failed");
+        }
+        return ptr;
+    }
+
+    std::lock_guard<std::mutex> lock(_mutex);
+    if (size >= hugePageSize) {
+        size_t mappedSize = roundUp(size, hugePageSize);
+        void * ptr = map(mappedSize, policy);
+        _mappings.emplace(ptr, mappedSize);
+        setFrameKind(ptr, FrameKind::Mapping);
+        return ptr;
+    }
+
+    size_t blockSize = getBlockSize(size);
+    size_t policyKey = getPolicyKey(policy);
+    Arena & arena = _arenas[policyKey];
+    auto freeBlocks = arena.freeBlocks.find(blockSize);
+    if (freeBlocks != arena.freeBlocks.end() && !freeBlocks->second.empty()) {
+        void * ptr = freeBlocks->second.back();
+        freeBlocks->second.pop_back();
+        return ptr;
+    }
+
+    // the rest of the current region is abandoned
+    if (static_cast<size_t>(arena.end - arena.current) < blockSize) {
+        arena.current = static_cast<uint8_t *>(map(hugePageSize, policy));
+        arena.end = arena.current + hugePageSize;
+        _regions.emplace(arena.current, Region{ hugePageSize, policyKey });
+        setFrameKind(arena.current, FrameKind::Region);
+    }
+    void * ptr = arena.current;
+    arena.current += blockSize;
+    return ptr;
+}
+
+void * Allocator::allocateZeroed(size_t size, const AllocationPolicy & policy)
+{
+    if (policy.isRegular()) {
+        void * ptr = std::calloc(size, 1);
+        if (unlikely(ptr == nullptr)) {
+            throw std::runtime_error("allocation failed");
+        }
+        return ptr;
+    }
+
+    // fresh mappings are zeroed by the kernel, recycled blocks are not
+    void * ptr = allocate(size, policy);
+    if (size < hugePageSize) {
+        std::memset(ptr, 0, size);
+    }
+    return ptr;
+}
+
+void Allocator::release(void * ptr, size_t size)
+{
+    if (ptr == nullptr) {
+        return;
+    }
+
+    // blocks outside of the frames of our mappings have been served by malloc, which needs no lock
+    FrameKind kind = getFrameKind(ptr);
+    if (kind == FrameKind::Mapping) {
+        std::lock_guard<std::mutex> lock(_mutex);
+        auto mapping = _mappings.find(ptr);
+        if (mapping != _mappings.end()) {
+            setFrameKind(ptr, FrameKind::None);
+            munmap(ptr, mapping->second);
+            _mappedBytes -= mapping->second;
+            _mappings.erase(mapping);
+            return;
+        }
+    } else if (kind == FrameKind::Region) {
+        // regions span exactly one frame
+        auto regionBegin = reinterpret_cast<const uint8_t *>(reinterpret_cast<uintptr_t>(ptr) & ~(hugePageSize - 1));
+        std::lock_guard<std::mutex> lock(_mutex);
+        auto region = _regions.find(regionBegin);
+        if (region != _regions.end()) {
+            _arenas[region->second.policyKey].freeBlocks[getBlockSize(size)].push_back(ptr);
+            return;
+        }
+    }
+
+    std::free(ptr);
+}
+
+void Allocator::setDefaultPolicy(const AllocationPolicy & policy)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    _defaultPolicy = policy;
+}
+
+AllocationPolicy Allocator::getDefaultPolicy()
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _defaultPolicy;
+}
+
+size_t Allocator::getMappedBytes()
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _mappedBytes;
+}
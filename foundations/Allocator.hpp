@@ -0,0 +1,127 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+//-----------------------------------------------------------------------------
+// AllocationPolicy
+
+/// Page size and NUMA placement of large allocations
+struct AllocationPolicy {
+    enum class Pages {
+        Regular,          ///< plain malloc, unless a NUMA placement is requested
+        TransparentHuge,  ///< 2 MB aligned mappings advised via madvise(MADV_HUGEPAGE)
+        ExplicitHuge      ///< mappings from the reserved huge page pool (MAP_HUGETLB), transparent ones as fallback
+    };
+
+    enum class Placement {
+        FirstTouch,   ///< the kernel default: pages reside on the node of the thread which touches them first
+        Interleaved,  ///< pages are distributed round-robin across all online nodes
+        Node          ///< pages preferably reside on the given node
+    };
+
+    Pages pages = Pages::Regular;
+    Placement placement = Placement::FirstTouch;
+    unsigned node = 0;
+
+    /// \brief Parses a comma separated list of a page size and a placement, e.g. "huge,interleave"
+    ///
+    /// Page sizes are "regular", "thp" and "huge", placements are "firsttouch", "interleave" and "node<N>".
+    /// Omitted parts keep their default.
+    static AllocationPolicy parse(const std::string & spec);
+
+    std::string toString() const;
+
+    /// \returns Whether allocations are served by malloc
+    bool isRegular() const { return pages == Pages::Regular && placement == Placement::FirstTouch; }
+
+    bool operator==(const AllocationPolicy & other) const {
+        return pages == other.pages && placement == other.placement && node == other.node;
+    }
+};
+
+//-----------------------------------------------------------------------------
+// Allocator
+
+/// Allocation layer for columns, bitmaps and query memory pools
+///
+/// Regular allocations are forwarded to malloc. All other policies are served by 2 MB aligned mappings
+/// to which the policy is applied before they are touched. Allocations of at least hugePageSize get
+/// a mapping of their own, smaller ones are carved out of shared per-policy regions, so that e.g. the
+/// chunks of many columns share huge pages. Released carved blocks are kept in per-size free lists.
+/// A map of the huge page frames at which the mappings begin tells release() without locking whether
+/// a block has been served by malloc.
+class Allocator {
+public:
+    static constexpr size_t hugePageSize = 2 << 20;
+
+    /// Carved blocks are aligned to cache lines
+    static constexpr size_t blockAlignment = 64;
+
+    static Allocator & instance();
+
+    void * allocate(size_t size, const AllocationPolicy & policy);
+
+    void * allocateZeroed(size_t size, const AllocationPolicy & policy);
+
+    /// \param size The size which has been passed to allocate()
+    void release(void * ptr, size_t size);
+
+    /// \brief Sets the policy of new tables and of the memory pools of queries
+    void setDefaultPolicy(const AllocationPolicy & policy);
+
+    AllocationPolicy getDefaultPolicy();
+
+    /// \returns The number of bytes mapped for non-regular policies
+    size_t getMappedBytes();
+
+private:
+    struct Arena {
+        uint8_t * current = nullptr;
+        uint8_t * end = nullptr;
+        std::unordered_map<size_t, std::vector<void *>> freeBlocks; // size -> blocks
+    };
+
+    struct Region {
+        size_t size;
+        size_t policyKey;
+    };
+
+    /// The kind of mapping which begins at a huge page frame
+    enum class FrameKind : uint8_t { None, Region, Mapping };
+
+    /// Mappings are placed below 2^addressBits, which is the user address space of x86-64 and AArch64
+    static constexpr unsigned addressBits = 48;
+    static constexpr unsigned frameShift = 21;
+    static constexpr unsigned frameLeafBits = 14;
+    static constexpr size_t frameLeafSize = static_cast<size_t>(1) << frameLeafBits;
+    static constexpr size_t frameLeafCount = static_cast<size_t>(1) << (addressBits - frameShift - frameLeafBits);
+    static_assert((static_cast<size_t>(1) << frameShift) == hugePageSize, "frames have to match the huge pages");
+
+    Allocator() = default;
+
+    /// \brief Maps size bytes (a multiple of hugePageSize) according to the policy
+    void * map(size_t size, const AllocationPolicy & policy);
+
+    static size_t getPolicyKey(const AllocationPolicy & policy);
+
+    /// \returns The kind of the mapping which begins at the frame of the given address; does not lock
+    FrameKind getFrameKind(const void * ptr) const;
+
+    /// \brief Records the kind of the mapping which begins at the given frame; requires the mutex
+    void setFrameKind(const void * begin, FrameKind kind);
+
+    std::mutex _mutex;
+    AllocationPolicy _defaultPolicy;
+    std::unordered_map<size_t, Arena> _arenas; // policy key -> arena
+    std::map<const uint8_t *, Region> _regions; // begin -> region, the source of all carved blocks
+    std::unordered_map<const void *, size_t> _mappings; // begin -> size of dedicated mappings
+    size_t _mappedBytes = 0;
+    std::atomic<std::atomic<FrameKind> *> _frameKinds[frameLeafCount] = {}; // frame -> kind, leaves are never freed
+};
@@ -0,0 +1,78 @@
+#include "foundations/Compactor.hpp"
+
+#include <iostream>
+#include <shared_mutex>
+
+#include "foundations/Database.hpp"
+#include "foundations/StringPool.hpp"
+
+constexpr std::chrono::milliseconds Compactor::defaultInterval;
+
+Compactor::Compactor(Database & db, size_t batchSize, std::chrono::milliseconds interval) :
+        _db(db),
+        _batchSize(batchSize),
+        _interval(interval)
+{
+    _thread = std::thread(&Compactor::run, this);
+}
+
+Compactor::~Compactor()
+{
+    {
+        std::lock_guard<std::mutex> guard(_mutex);
+        _stopping = true;
+    }
+    _stop.notify_all();
+    _thread.join();
+}
+
+size_t Compactor::step()
+{
+    std::unique_lock<std::shared_mutex> statementLock(_db.getStatementLock());
+
+    size_t reclaimed = 0;
+    for (Table * table : _db.getTables()) {
+        if (table->getDeadRowCount() > 0) {
+            reclaimed += table->compact(_batchSize);
+        }
+    }
+    size_t collected = _db.collectVersions();
+    // the statement lock is held exclusively, which the string collection requires
+    StringPool::instance().collectIfGrown();
+
+    std::lock_guard<std::mutex> guard(_mutex);
+    _reclaimedRows += reclaimed;
+    _collectedVersions += collected;
+    return reclaimed;
+}
+
+size_t Compactor::getReclaimedRowCount() const
+{
+    std::lock_guard<std::mutex> guard(_mutex);
+    return _reclaimedRows;
+}
+
+size_t Compactor::getCollectedVersionCount() const
+{
+    std::lock_guard<std::mutex> guard(_mutex);
+    return _collectedVersions;
+}
+
+void Compactor::run()
+{
+    std::unique_lock<std::mutex> lock(_mutex);
+    while (!_stopping) {
+        _stop.wait_for(lock, _interval);
+        if (_stopping) {
+            break;
+        }
+
+        lock.unlock();
+        try {
+            step();
+        } catch (const std::exception & e) {
+            std::cerr << "compactor: " << e.what() << std::endl;
+        }
+        lock.lock();
+    }
+}
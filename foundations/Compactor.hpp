@@ -0,0 +1,54 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <mutex>
+#include <thread>
+
+class Database;
+
+//-----------------------------------------------------------------------------
+// Compactor
+
+/// Background job which reclaims the tombstoned rows and the unobservable versions of a database
+///
+/// Each step takes the statement lock of the database exclusively, compacts at most batchSize rows
+/// per table and collects the version chains which have grown since the previous step. Hence,
+/// statements are only stalled for a bounded amount of time and chains stay short under a steady
+/// update load. Compaction moves rows and thereby changes their tids.
+class Compactor {
+public:
+    static constexpr size_t defaultBatchSize = 16384;
+    static constexpr std::chrono::milliseconds defaultInterval{100};
+
+    explicit Compactor(Database & db, size_t batchSize = defaultBatchSize,
+            std::chrono::milliseconds interval = defaultInterval);
+
+    ~Compactor();
+
+    /// \brief Compacts every table with tombstones once and collects versions
+    /// \returns The number of reclaimed rows
+    size_t step();
+
+    /// \returns The number of rows reclaimed since the job has been started
+    size_t getReclaimedRowCount() const;
+
+    /// \returns The number of versions freed since the job has been started
+    size_t getCollectedVersionCount() const;
+
+private:
+    void run();
+
+    Database & _db;
+    size_t _batchSize;
+    std::chrono::milliseconds _interval;
+
+    mutable std::mutex _mutex;
+    std::condition_variable _stop;
+    bool _stopping = false;
+    size_t _reclaimedRows = 0;
+    size_t _collectedVersions = 0;
+
+    std::thread _thread;
+};
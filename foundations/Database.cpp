@@ -2,141 +2,312 @@
 
 #include <cmath>
 #include <climits>
+#include <cstring>
 #include <algorithm>
+#include <atomic>
+#include <thread>
+#include <tuple>
 #include <vector>
 
 #include <llvm/IR/TypeBuilder.h>
 
 #include "foundations/exceptions.hpp"
+#include "foundations/Snapshot.hpp"
+#include "foundations/WriteAheadLog.hpp"
 #include "foundations/version_management.hpp"
+#include "native/sql/SqlTuple.hpp"
 
 //-----------------------------------------------------------------------------
 // NullIndicatorColumn
 
 BitmapTable::BitmapTable() :
-        BitmapTable(8) // FIXME once resize() is implemented this will no longer be necessary
+        _allocationPolicy(Allocator::instance().getDefaultPolicy())
 { }
 
-BitmapTable::BitmapTable(size_t columnCountHint)
-{
-    unsigned bytesPerTuple = static_cast<unsigned>(std::ceil(columnCountHint / 8.0));
-    _availableCount = bytesPerTuple*8;
-    _data = std::make_unique<Vector>(bytesPerTuple);
-}
-
 unsigned BitmapTable::addColumn()
 {
-    unsigned column = _columnCount;
-    _columnCount += 1;
-    if (_columnCount > _availableCount) {
-        resize(); // allocated one additional byte
+    unsigned column = getColumnCount();
+    size_t wordCount = (_rowCount + wordBits - 1) / wordBits;
+    auto words = std::make_unique<Vector>(sizeof(word_t), 0, wordChunkShift, _allocationPolicy);
+    for (size_t i = 0; i < wordCount; ++i) {
+        memset(words->reserve_back(), 0, sizeof(word_t));
     }
-
-    for (size_t tid = 0, limit = _data->size(); tid < limit; ++tid) {
-        set(tid, column, false);
-    }
-
+    _columns.push_back(std::move(words));
     return column;
 }
 
 unsigned BitmapTable::cloneColumn(unsigned original)
 {
-    unsigned column = _columnCount;
-    _columnCount += 1;
-    if (_columnCount > _availableCount) {
-        resize(); // allocated one additional byte
-    }
+    assert(original < getColumnCount());
 
-    for (size_t tid = 0, limit = _data->size(); tid < limit; ++tid) {
-        set(tid, column, isSet(tid, original));
+    unsigned column = getColumnCount();
+    const Vector & source = *_columns[original];
+    auto words = std::make_unique<Vector>(sizeof(word_t), 0, wordChunkShift, _allocationPolicy);
+    for (size_t i = 0, limit = source.size(); i < limit; ++i) {
+        words->reserve_back();
     }
+    // both columns share the same chunk layout
+    for (size_t chunk = 0, limit = source.getChunkCount(); chunk < limit; ++chunk) {
+        memcpy(words->getChunk(chunk), source.getChunk(chunk), source.getChunkSize(chunk)*sizeof(word_t));
+    }
+    _columns.push_back(std::move(words));
+    return column;
+}
 
+unsigned BitmapTable::forkColumn(unsigned original)
+{
+    assert(original < getColumnCount());
+
+    unsigned column = getColumnCount();
+    _columns.push_back(_columns[original]->fork());
     return column;
 }
 
+void BitmapTable::releaseColumn(unsigned column)
+{
+    assert(column < getColumnCount());
+    _columns[column].reset();
+}
 
-void BitmapTable::addRow()
+void BitmapTable::setAllocationPolicy(const AllocationPolicy & policy)
 {
-    void * row = _data->reserve_back();
-    unsigned byteCount = _availableCount/8;
-    memset(row, 0, byteCount);
+    _allocationPolicy = policy;
+    for (auto & words : _columns) {
+        if (words != nullptr) {
+            words->setAllocationPolicy(policy);
+        }
+    }
 }
 
-void BitmapTable::set(tid_t tid, unsigned column, bool value)
+void BitmapTable::addRow()
 {
-    assert(column < _columnCount);
+    if (_rowCount % wordBits == 0) {
+        for (auto & words : _columns) {
+            if (words != nullptr) {
+                memset(words->reserve_back(), 0, sizeof(word_t));
+            }
+        }
+    }
+    _rowCount += 1;
+}
 
-    uint8_t * tuple = static_cast<uint8_t *>(_data->at(tid));
+void BitmapTable::removeRow()
+{
+    assert(_rowCount > 0);
+
+    // addRow() relies on the bits beyond the last row being cleared
+    tid_t last = _rowCount - 1;
+    for (unsigned column = 0, limit = getColumnCount(); column < limit; ++column) {
+        // clear bits only, so that chunks shared with forked columns are not copied needlessly
+        if (!isReleased(column) && isSet(last, column)) {
+            set(last, column, false);
+        }
+    }
+    _rowCount -= 1;
+    if (_rowCount % wordBits == 0) {
+        for (auto & words : _columns) {
+            if (words != nullptr) {
+                words->pop_back();
+            }
+        }
+    }
+}
 
-    static_assert(CHAR_BIT == 8, "not supported");
-    size_t byte = column >> 3; // column / 8
-    unsigned sectionIndex = column & 7; // column % 8
+void BitmapTable::set(tid_t tid, unsigned column, bool value)
+{
+    assert(column < getColumnCount());
+    assert(tid < _rowCount);
 
-    // calculate section
-    uint8_t * sectionPtr = tuple + byte;
-    uint8_t section = *sectionPtr;
-    section ^= (-value ^ section) & (1 << sectionIndex); // set null indicator bit
-    *sectionPtr = section;
+    word_t * word = static_cast<word_t *>(_columns[column]->at(tid / wordBits));
+    word_t mask = static_cast<word_t>(1) << (tid % wordBits);
+    *word ^= (-static_cast<word_t>(value) ^ *word) & mask;
 }
 
 bool BitmapTable::isSet(tid_t tid, unsigned column) const
 {
-    assert(column < _columnCount);
+    assert(column < getColumnCount());
+    assert(tid < _rowCount);
 
-    uint8_t * tuple = static_cast<uint8_t *>(_data->at(tid));
+    const word_t * word = static_cast<const word_t *>(_columns[column]->at(tid / wordBits));
+    return static_cast<bool>((*word >> (tid % wordBits)) & 1);
+}
 
-    static_assert(CHAR_BIT == 8, "not supported");
-    size_t byte = column >> 3; // column / 8
-    unsigned sectionIndex = column & 7; // column % 8
+bool BitmapTable::isRowClear(tid_t tid) const
+{
+    assert(tid < _rowCount);
 
-    // calculate section
-    uint8_t * sectionPtr = tuple + byte;
-    uint8_t section = *sectionPtr;
-    return static_cast<bool>((section >> sectionIndex) & 1); // test null indicator bit
+    for (auto & words : _columns) {
+        if (words == nullptr) {
+            continue;
+        }
+        const word_t * word = static_cast<const word_t *>(words->at(tid / wordBits));
+        if ((*word >> (tid % wordBits)) & 1) {
+            return false;
+        }
+    }
+    return true;
 }
 
-void BitmapTable::resize()
+void BitmapTable::copyRow(tid_t from, tid_t to)
 {
-    throw NotImplementedException("BitmapTable::resize()");
+    for (unsigned column = 0, limit = getColumnCount(); column < limit; ++column) {
+        if (isReleased(column)) {
+            continue;
+        }
+        bool value = isSet(from, column);
+        if (isSet(to, column) != value) {
+            set(to, column, value);
+        }
+    }
 }
 
-static cg_bool_t isSet_gen(BitmapTable & table, cg_tid_t tid, cg_unsigned_t column)
+cg_u64_t genBitmapWordLoad(BitmapTable & table, cg_size_t wordIndex, unsigned column)
 {
     auto & codeGen = getThreadLocalCodeGen();
 
-    cg_ptr8_t tablePtr = cg_ptr8_t::fromRawPointer(table.data());
+    cg_voidptr_t wordPtr = genVectorElementPtr(table.getColumn(column), wordIndex);
+    llvm::Value * typedPtr = codeGen->CreatePointerCast(wordPtr, cg_u64_t::getType()->getPointerTo());
+    return cg_u64_t( codeGen->CreateLoad(cg_u64_t::getType(), typedPtr) );
+}
 
-    // section index within the row
-    cg_size_t sectionIndex( codeGen->CreateLShr(column, 3) );
+static cg_bool_t isSet_gen(BitmapTable & table, cg_tid_t tid, unsigned column)
+{
+    auto & codeGen = getThreadLocalCodeGen();
 
-    cg_size_t bytesPerRow = table.getRowSize();
-    cg_size_t offset = tid * bytesPerRow;
+    static_assert(BitmapTable::wordBits == 64, "not supported");
 
-    llvm::Value * indicatorIndex = codeGen->CreateAnd(column, cg_unsigned_t(7));
-    cg_size_t byteIndex = sectionIndex + offset;
+    // load the word containing the bit of the given tid
+    cg_size_t wordIndex( codeGen->CreateLShr(tid, 6) ); // tid / 64
+    cg_u64_t word = genBitmapWordLoad(table, wordIndex, column);
 
-    // calculate section
-    cg_ptr8_t sectionPtr( tablePtr + byteIndex.llvmValue );
-    cg_u8_t section( codeGen->CreateLoad(cg_u8_t::getType(), sectionPtr) );
-    cg_u8_t shifted( codeGen->CreateLShr(section, indicatorIndex) );
+    // test the bit
+    llvm::Value * bitIndex = codeGen->CreateAnd(tid, cg_size_t(BitmapTable::wordBits - 1)); // tid % 64
+    llvm::Value * shifted = codeGen->CreateLShr(word, bitIndex);
     cg_bool_t result( codeGen->CreateTrunc(shifted, cg_bool_t::getType()) );
     return result;
 }
 
-cg_bool_t genNullIndicatorLoad(BitmapTable & table, cg_tid_t tid, cg_unsigned_t column)
+cg_bool_t genNullIndicatorLoad(BitmapTable & table, cg_tid_t tid, unsigned column)
 {
     return isSet_gen(table, tid, column);
 }
 
-cg_bool_t isVisibleInBranch(BitmapTable & branchBitmap, cg_tid_t tid, cg_branch_id_t branchId)
+cg_bool_t isVisibleInBranch(BitmapTable & branchBitmap, cg_tid_t tid, branch_id_t branchId)
 {
     return isSet_gen(branchBitmap, tid, branchId);
 }
 
+//-----------------------------------------------------------------------------
+// BranchSet
+
+BranchSet::BranchSet(const BranchSet & other) :
+        _inline(other._inline)
+{
+    if (other._overflow != nullptr) {
+        _overflow = new uint64_t[1 + other._overflow[0]];
+        std::copy(other._overflow, other._overflow + 1 + other._overflow[0], _overflow);
+    }
+}
+
+BranchSet::BranchSet(BranchSet && other) noexcept :
+        _inline(other._inline),
+        _overflow(other._overflow)
+{
+    other._inline = 0;
+    other._overflow = nullptr;
+}
+
+BranchSet & BranchSet::operator=(const BranchSet & other)
+{
+    if (this != &other) {
+        BranchSet copy(other);
+        *this = std::move(copy);
+    }
+    return *this;
+}
+
+BranchSet & BranchSet::operator=(BranchSet && other) noexcept
+{
+    std::swap(_inline, other._inline);
+    std::swap(_overflow, other._overflow);
+    return *this;
+}
+
+void BranchSet::setWord(size_t idx, uint64_t word)
+{
+    if (idx == 0) {
+        _inline = word;
+        return;
+    }
+    if (idx >= getWordCount()) {
+        if (word == 0) {
+            return;
+        }
+        // grow geometrically, new words are cleared
+        size_t wordCount = std::max(idx, 2*(getWordCount() - 1));
+        uint64_t * overflow = new uint64_t[1 + wordCount]();
+        if (_overflow != nullptr) {
+            std::copy(_overflow + 1, _overflow + 1 + _overflow[0], overflow + 1);
+            delete[] _overflow;
+        }
+        overflow[0] = wordCount;
+        _overflow = overflow;
+    }
+    _overflow[idx] = word;
+}
+
+uint64_t BranchSet::getWord(size_t idx) const
+{
+    if (idx == 0) {
+        return _inline;
+    }
+    return (idx < getWordCount()) ? _overflow[idx] : 0;
+}
+
+void BranchSet::set(branch_id_t branch)
+{
+    setWord(branch / inlineBits, getWord(branch / inlineBits) | (static_cast<uint64_t>(1) << (branch % inlineBits)));
+}
+
+void BranchSet::reset(branch_id_t branch)
+{
+    setWord(branch / inlineBits, getWord(branch / inlineBits) & ~(static_cast<uint64_t>(1) << (branch % inlineBits)));
+}
+
+bool BranchSet::test(branch_id_t branch) const
+{
+    return (getWord(branch / inlineBits) >> (branch % inlineBits)) & 1;
+}
+
+void BranchSet::clear()
+{
+    _inline = 0;
+    delete[] _overflow;
+    _overflow = nullptr;
+}
+
+bool BranchSet::intersectsOverflow(const BranchSet & other) const
+{
+    size_t wordCount = std::min(getWordCount(), other.getWordCount());
+    for (size_t idx = 1; idx < wordCount; ++idx) {
+        if ((_overflow[idx] & other._overflow[idx]) != 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
 //-----------------------------------------------------------------------------
 // Table
 
-Table::Table(Database & db) : _db(db) {
+static size_t roundUp(size_t size, size_t alignment)
+{
+    return (size + alignment - 1) & ~(alignment - 1);
+}
+
+Table::Table(Database & db, const std::string & name) :
+        _db(db), _name(name), _allocationPolicy(Allocator::instance().getDefaultPolicy())
+{
 
     //Create TID column information
     _tidColumn = std::make_unique<ColumnInformation>();
@@ -148,15 +319,15 @@ Table::Table(Database & db) : _db(db) {
 
 Table::~Table()
 {
-    for (auto & versionEntry : _version_mgmt_column) {
-        destroy_chain(versionEntry.get());
+    for (size_t i = 0; i < _version_mgmt_column.size(); ++i) {
+        destroy_chain(&_version_mgmt_column[i], *this);
     }
-    for (auto & versionEntry : _dangling_version_mgmt_column) {
-        destroy_chain(versionEntry.get());
+    for (size_t i = 0; i < _dangling_version_mgmt_column.size(); ++i) {
+        destroy_chain(&_dangling_version_mgmt_column[i], *this);
     }
 }
 
-void Table::addColumn(const std::string & columnName, Sql::SqlType type)
+void Table::addColumn(const std::string & columnName, Sql::SqlType type, ColumnInformation::Encoding encoding)
 {
 //    _columnNames.push_back(columnName);
     if (_columnsByName.count(columnName) > 0) {
@@ -171,11 +342,48 @@ void Table::addColumn(const std::string & columnName, Sql::SqlType type)
 #endif
 
     // set-up column
-    auto column = std::make_unique<Vector>(valueSize);
+    std::unique_ptr<StringDictionary> dictionary;
+    if (encoding == ColumnInformation::Encoding::Dictionary) {
+        if (type.nullable) {
+            throw InvalidOperationException("dictionary encoding requires a not nullable column");
+        }
+        dictionary = std::make_unique<StringDictionary>(type);
+        valueSize = sizeof(StringDictionary::code_t);
+    }
+
+    std::unique_ptr<Vector> column;
+    std::unique_ptr<PackedIntegerColumn> packed;
+    if (encoding == ColumnInformation::Encoding::BitPacked && _versioningEngine == VersioningEngine::Pages) {
+        throw InvalidOperationException("bit-packed columns cannot be versioned by pages");
+    } else if (encoding == ColumnInformation::Encoding::BitPacked) {
+        packed = std::make_unique<PackedIntegerColumn>(type);
+    } else {
+        column = std::make_unique<Vector>(valueSize, 0, Vector::defaultChunkShift, _allocationPolicy);
+    }
+
+    std::unique_ptr<ZoneMap> zoneMap;
+    if (ZoneMap::isSupported(type)) {
+        zoneMap = std::make_unique<ZoneMap>(type);
+    }
+
     auto ci = std::make_unique<ColumnInformation>();
     ci->column = column.get();
     ci->columnName = columnName;
     ci->type = type;
+    ci->encoding = encoding;
+    ci->dictionary = dictionary.get();
+    if (dictionary) {
+        dictionary->setAllocationPolicy(_allocationPolicy);
+        _dictionaries.push_back(std::move(dictionary));
+    }
+    ci->packed = packed.get();
+    if (packed) {
+        _packedColumns.push_back(std::move(packed));
+    }
+    ci->zoneMap = zoneMap.get();
+    if (zoneMap) {
+        _zoneMaps.push_back(std::move(zoneMap));
+    }
 
     if (type.nullable) {
 #ifndef USE_INTERNAL_NULL_INDICATOR
@@ -189,40 +397,384 @@ void Table::addColumn(const std::string & columnName, Sql::SqlType type)
 //    _columns.emplace(columnName, std::make_pair(std::move(ci), std::move(column)));
     _columnsByName.emplace(columnName, _columns.size());
     _columns.emplace_back(std::move(ci), std::move(column));
+    for (auto & [branch, pages] : _branchPages) {
+        auto & [masterCi, masterVec] = _columns.back();
+        pages->vectors.push_back(masterVec->fork());
+        pages->columns.push_back(std::make_unique<ColumnInformation>(*masterCi));
+        pages->columns.back()->column = pages->vectors.back().get();
+    }
+
+    llvm::Type * valueTy = Sql::toLLVMTy(type);
+    auto & dataLayout = getThreadLocalCodeGen().getDefaultDataLayout();
+    _versionValueLayouts.push_back({ dataLayout.getTypeAllocSize(valueTy), dataLayout.getABITypeAlignment(valueTy) });
+    if (type.typeID == Sql::SqlType::TypeID::TextID) {
+        _textColumns.push_back(_columns.size() - 1);
+    }
 }
 
 void Table::addRow(branch_id_t branchId)
 {
     for (auto & [ci, vec] : _columns) {
-        vec->reserve_back();
+        if (ci->packed != nullptr) {
+            ci->packed->push_back(0);
+        } else {
+            vec->reserve_back();
+        }
+        if (ci->zoneMap != nullptr) {
+            ci->zoneMap->addRow();
+        }
     }
-#if USE_DATA_VERSIONING
+    for (auto & [branch, pages] : _branchPages) {
+        for (auto & vec : pages->vectors) {
+            vec->reserve_back();
+        }
+    }
+    _rowCount += 1;
+    // unversioned tables only use the master branch, its bits distinguish live rows from tombstones
     _nullIndicatorTable.addRow();
     _branchBitmap.addRow();
-    _branchBitmap.set(_columns.front().second->size() - 1,branchId,1);
-#endif
+    _branchBitmap.set(_rowCount - 1,branchId,1);
 }
 
 void Table::removeRow(tid_t tid) {
-#if !USE_DATA_VERSIONING
-    for (auto & [ci, vec] : _columns) {
-        vec->remove_at(tid);
-    }
-#endif
+    removeRowForBranch(tid, master_branch_id);
 }
 
 void Table::removeRowForBranch(tid_t tid, branch_id_t branchId) {
+    if (!_branchBitmap.isSet(tid, branchId)) {
+        return;
+    }
     _branchBitmap.set(tid,branchId,0);
+    if (isDeadRow(tid)) {
+        _deadRows.insert(tid);
+    }
+}
+
+bool Table::isDeadRow(tid_t tid) const {
+#if USE_DATA_VERSIONING
+    return _branchBitmap.isRowClear(tid);
+#else
+    return !_branchBitmap.isSet(tid, master_branch_id);
+#endif
+}
+
+size_t Table::compact(size_t maxRows)
+{
+    size_t reclaimed = 0;
+    while (!_deadRows.empty() && reclaimed < maxRows) {
+        tid_t last = _rowCount - 1;
+        auto lastDead = std::prev(_deadRows.end());
+        if (*lastDead == last) {
+            _deadRows.erase(lastDead);
+        } else {
+            auto hole = _deadRows.begin();
+            moveRow(last, *hole);
+            _deadRows.erase(hole);
+        }
+        removeLastRow();
+        reclaimed += 1;
+    }
+
+    if (reclaimed > 0) {
+        // the moved rows have received new tids
+        invalidateMaterializedBranches();
+        if (auto log = _db.getWriteAheadLog()) {
+            // the tids of the following records refer to the compacted table
+            log->commit(log->logCompact(*this, reclaimed));
+        }
+    }
+    return reclaimed;
+}
+
+void Table::scheduleVersionCollection(tid_t tid)
+{
+    if (_uncollectedTids.insert(tid).second) {
+        _db._uncollectedChainCount.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+size_t Table::collectVersions(const branch_children_t & children)
+{
+    size_t freed = 0;
+    for (tid_t tid : _uncollectedTids) {
+        freed += collect_chain(get_version_entry(tid, *this), children, *this);
+    }
+    _uncollectedTids.clear();
+    return freed;
+}
+
+void Table::moveRow(tid_t from, tid_t to)
+{
+    for (auto & [ci, vec] : _columns) {
+        if (ci->packed != nullptr) {
+            ci->packed->set(to, ci->packed->get(from));
+        } else {
+            // only the target chunk is made private, the source is read through the const accessor
+            void * target = vec->at(to);
+            std::memcpy(target, static_cast<const Vector &>(*vec).at(from), vec->getElementSize());
+        }
+    }
+    for (auto & [branch, pages] : _branchPages) {
+        for (auto & vec : pages->vectors) {
+            void * target = vec->at(to);
+            std::memcpy(target, static_cast<const Vector &>(*vec).at(from), vec->getElementSize());
+        }
+    }
+    _nullIndicatorTable.copyRow(from, to);
+    _branchBitmap.copyRow(from, to);
+    // zones are only widened, the zone of the last row keeps its bounds
+    includeInZoneMaps(to);
+
+    if (_version_mgmt_column.size() == _rowCount) {
+        destroy_chain(&_version_mgmt_column[to], *this);
+        move_version_entry(_version_mgmt_column[from], _version_mgmt_column[to]);
+    }
+    _uncollectedTids.erase(to);
+    if (_uncollectedTids.erase(from) > 0) {
+        _uncollectedTids.insert(to);
+    }
+    for (TidSet * modified : getDistinctModifiedTids()) {
+        modified->erase(to);
+        if (modified->erase(from)) {
+            modified->insert(to);
+        }
+    }
+}
+
+void Table::removeLastRow()
+{
+    for (auto & [ci, vec] : _columns) {
+        if (ci->packed != nullptr) {
+            ci->packed->pop_back();
+        } else {
+            vec->pop_back();
+        }
+        if (ci->zoneMap != nullptr) {
+            ci->zoneMap->removeRow();
+        }
+    }
+    for (auto & [branch, pages] : _branchPages) {
+        for (auto & vec : pages->vectors) {
+            vec->pop_back();
+        }
+    }
+    _nullIndicatorTable.removeRow();
+    _branchBitmap.removeRow();
+
+    if (_version_mgmt_column.size() == _rowCount) {
+        // moved entries have left an empty chain behind
+        destroy_chain(&_version_mgmt_column.back(), *this);
+        _version_mgmt_column.pop_back();
+    }
+    _uncollectedTids.erase(_rowCount - 1);
+    for (auto & modified : _modifiedTids) {
+        if (modified != nullptr) {
+            modified->erase(_rowCount - 1);
+        }
+    }
+    _rowCount -= 1;
 }
 
 void Table::createBranch(branch_id_t parent)
 {
+    branch_id_t branch = _branchBitmap.getColumnCount();
     if (parent == invalid_branch_id) {
         _branchBitmap.addColumn();
     } else {
-        _branchBitmap.cloneColumn(parent);
+        // the branch sees the tuples of its parent until either one inserts or deletes within a chunk
+        _branchBitmap.forkColumn(parent);
+    }
+
+    if (_versioningEngine == VersioningEngine::Pages && branch != master_branch_id) {
+        forkBranchPages(branch, parent);
+    }
+
+    if (branch == master_branch_id) {
+        _modifiedTids.push_back(nullptr);
+    } else if (parent != invalid_branch_id && _modifiedTids[parent] != nullptr) {
+        // shared until either branch records a version of its own
+        _modifiedTids.push_back(_modifiedTids[parent]);
+    } else {
+        _modifiedTids.push_back(std::make_shared<TidSet>());
+    }
+}
+
+size_t Table::dropBranch(branch_id_t branch, branch_id_t parent)
+{
+    assert(branch != master_branch_id && !_branchBitmap.isReleased(branch));
+    const Vector & branchWords = _branchBitmap.getColumn(branch);
+    const Vector & parentWords = _branchBitmap.getColumn(parent);
+    const TidSet * modified = _modifiedTids[branch].get();
+    size_t wordCount = (_rowCount + BitmapTable::wordBits - 1) / BitmapTable::wordBits;
+
+    // only tuples which the branch has inserted or modified may hold versions of it
+    size_t freed = 0;
+    std::vector<tid_t> inserted;
+    const size_t batchWords = 256;
+    std::vector<uint64_t> modifiedWords(batchWords, 0);
+    for (size_t firstWord = 0; firstWord < wordCount; firstWord += batchWords) {
+        size_t batchCount = std::min(batchWords, wordCount - firstWord);
+        bool anyModified = (_versioningEngine == VersioningEngine::Chains && modified != nullptr &&
+                modified->getWords(firstWord, batchCount, modifiedWords.data()));
+        for (size_t i = 0; i < batchCount; ++i) {
+            size_t wordIndex = firstWord + i;
+            uint64_t branchWord = *static_cast<const uint64_t *>(branchWords.at(wordIndex));
+            uint64_t parentWord = *static_cast<const uint64_t *>(parentWords.at(wordIndex));
+            uint64_t insertedWord = branchWord & ~parentWord;
+            uint64_t candidates = insertedWord | (anyModified ? modifiedWords[i] : 0);
+            for (; candidates != 0; candidates &= candidates - 1) {
+                unsigned bit = static_cast<unsigned>(__builtin_ctzll(candidates));
+                tid_t tid = wordIndex*BitmapTable::wordBits + bit;
+                if ((insertedWord >> bit) & 1) {
+                    inserted.push_back(tid);
+                }
+                if (_versioningEngine == VersioningEngine::Chains && tid < _version_mgmt_column.size()) {
+                    freed += drop_branch_versions(&_version_mgmt_column[tid], branch, *this);
+                }
+            }
+        }
+    }
+
+    // tuples of the branch which have been loaded from an older snapshot
+    for (size_t i = 0; i < _dangling_version_mgmt_column.size(); ++i) {
+        VersionEntry & versionEntry = _dangling_version_mgmt_column[i];
+        if (versionEntry.branch_id == branch) {
+            destroy_chain(&versionEntry, *this);
+            versionEntry.branch_visibility.clear();
+        } else if (versionEntry.branch_visibility.test(branch)) {
+            freed += drop_branch_versions(&versionEntry, branch, *this);
+        }
+    }
+
+    _branchPages.erase(branch);
+    _modifiedTids[branch].reset();
+    {
+        std::lock_guard<std::mutex> guard(_materializationMutex);
+        _materializedBranches.erase(branch);
+        _materializedBranchCount = _materializedBranches.size();
+    }
+    _branchBitmap.releaseColumn(branch);
+
+    for (tid_t tid : inserted) {
+        if (isDeadRow(tid)) {
+            _deadRows.insert(tid);
+        }
+    }
+    return freed;
+}
+
+std::vector<tid_t> Table::getMergeCandidates(branch_id_t source, branch_id_t destination) const
+{
+    const Vector & sourceWords = _branchBitmap.getColumn(source);
+    const Vector & destinationWords = _branchBitmap.getColumn(destination);
+    const TidSet * modified = _modifiedTids[source].get();
+    size_t wordCount = (_rowCount + BitmapTable::wordBits - 1) / BitmapTable::wordBits;
+
+    std::vector<tid_t> candidates;
+    const size_t batchWords = 256;
+    std::vector<uint64_t> modifiedWords(batchWords, 0);
+    for (size_t firstWord = 0; firstWord < wordCount; firstWord += batchWords) {
+        size_t batchCount = std::min(batchWords, wordCount - firstWord);
+        bool anyModified = (modified != nullptr && modified->getWords(firstWord, batchCount, modifiedWords.data()));
+        for (size_t i = 0; i < batchCount; ++i) {
+            size_t wordIndex = firstWord + i;
+            uint64_t sourceWord = *static_cast<const uint64_t *>(sourceWords.at(wordIndex));
+            uint64_t destinationWord = *static_cast<const uint64_t *>(destinationWords.at(wordIndex));
+            uint64_t words = (sourceWord & ~destinationWord) | (anyModified ? modifiedWords[i] : 0);
+            for (; words != 0; words &= words - 1) {
+                tid_t tid = wordIndex*BitmapTable::wordBits + static_cast<unsigned>(__builtin_ctzll(words));
+                if (tid < _version_mgmt_column.size()) {
+                    candidates.push_back(tid);
+                }
+            }
+        }
     }
+    return candidates;
+}
 
+void Table::markModified(tid_t tid, branch_id_t branch)
+{
+    if (branch != master_branch_id) {
+        auto & modified = _modifiedTids[branch];
+        if (modified.use_count() > 1) {
+            if (modified->contains(tid)) {
+                return;
+            }
+            modified = std::make_shared<TidSet>(*modified);
+        }
+        modified->insert(tid);
+        return;
+    }
+    // the version is recorded for all branches, hence shared sets stay shared
+    for (auto & modified : _modifiedTids) {
+        if (modified != nullptr) {
+            modified->insert(tid);
+        }
+    }
+}
+
+std::vector<TidSet *> Table::getDistinctModifiedTids()
+{
+    std::vector<TidSet *> sets;
+    std::unordered_set<TidSet *> visited;
+    for (auto & modified : _modifiedTids) {
+        if (modified != nullptr && visited.insert(modified.get()).second) {
+            sets.push_back(modified.get());
+        }
+    }
+    return sets;
+}
+
+const TidSet * Table::getModifiedTids(branch_id_t branch) const
+{
+    return (branch < _modifiedTids.size()) ? _modifiedTids[branch].get() : nullptr;
+}
+
+void Table::forkBranchPages(branch_id_t branch, branch_id_t parent)
+{
+    auto pages = std::make_unique<BranchPages>();
+    auto parentPages = _branchPages.find(parent);
+    for (size_t idx = 0; idx < _columns.size(); ++idx) {
+        auto & [ci, vec] = _columns[idx];
+        if (parentPages != _branchPages.end()) {
+            pages->vectors.push_back(parentPages->second->vectors[idx]->fork());
+        } else {
+            pages->vectors.push_back(vec->fork());
+        }
+        pages->columns.push_back(std::make_unique<ColumnInformation>(*ci));
+        pages->columns.back()->column = pages->vectors.back().get();
+    }
+    _branchPages[branch] = std::move(pages);
+}
+
+void Table::setVersioningEngine(VersioningEngine engine)
+{
+    if (_rowCount > 0) {
+        throw InvalidOperationException("the versioning engine can only be chosen for empty tables");
+    }
+    if (engine == _versioningEngine) {
+        return;
+    }
+    for (auto & [ci, vec] : _columns) {
+        if (engine == VersioningEngine::Pages && ci->packed != nullptr) {
+            throw InvalidOperationException("bit-packed columns cannot be versioned by pages");
+        }
+    }
+
+    _versioningEngine = engine;
+    _branchPages.clear();
+    if (engine == VersioningEngine::Pages) {
+        // the table is empty in every branch
+        for (branch_id_t branch = master_branch_id + 1; branch < _branchBitmap.getColumnCount(); ++branch) {
+            forkBranchPages(branch, master_branch_id);
+        }
+    }
+}
+
+const std::vector<std::unique_ptr<ColumnInformation>> * Table::getBranchColumns(branch_id_t branch) const
+{
+    auto pages = _branchPages.find(branch);
+    return (pages != _branchPages.end()) ? &pages->second->columns : nullptr;
 }
 
 ci_p_t Table::getCI(const std::string & columnName) const
@@ -233,16 +785,23 @@ ci_p_t Table::getCI(const std::string & columnName) const
     return ci.get();
 }
 
+ci_p_t Table::getCI(size_t idx) const
+{
+    return _columns.at(idx).first.get();
+}
+
 const Vector & Table::getColumn(size_t idx) const {
-    return *_columns.at(idx).second;
+    auto & [ci, vec] = _columns.at(idx);
+    if (ci->packed != nullptr) {
+        throw InvalidOperationException("bit-packed column '" + ci->columnName + "' has no plain storage");
+    }
+    return *vec;
 }
 
 const Vector & Table::getColumn(const std::string & columnName) const
 {
 //    return *_columns.at(columnName).second;
-    auto idx = _columnsByName.at(columnName);
-    auto & [ci, vec] = _columns[idx];
-    return *vec;
+    return getColumn(_columnsByName.at(columnName));
 }
 
 size_t Table::getColumnCount() const
@@ -285,12 +844,251 @@ std::vector<Sql::SqlType> Table::getTupleType() const {
 
 size_t Table::size() const
 {
-    if (_columns.empty()) {
-        return 0;
+    return _rowCount;
+}
+
+void Table::setAllocationPolicy(const AllocationPolicy & policy)
+{
+    _allocationPolicy = policy;
+    for (auto & [ci, vec] : _columns) {
+        if (vec) {
+            vec->setAllocationPolicy(policy);
+        }
+    }
+    for (auto & dictionary : _dictionaries) {
+        dictionary->setAllocationPolicy(policy);
+    }
+    _nullIndicatorTable.setAllocationPolicy(policy);
+    _branchBitmap.setAllocationPolicy(policy);
+    for (auto & [sizeClass, allocator] : _versionAllocators) {
+        allocator->setAllocationPolicy(policy);
+    }
+}
+
+void * Table::allocateVersion(size_t size, branch_id_t branchId)
+{
+    size_t sizeClass = roundUp(size, versionSizeClass);
+    auto & allocator = _versionAllocators[sizeClass];
+    if (!allocator) {
+        allocator = std::make_unique<SlabAllocator>(sizeClass, _allocationPolicy);
+    }
+    return allocator->allocate(size, branchId);
+}
+
+void Table::releaseVersion(void * ptr, size_t size)
+{
+    auto allocator = _versionAllocators.find(roundUp(size, versionSizeClass));
+    assert(allocator != _versionAllocators.end());
+    allocator->second->release(ptr);
+}
+
+SlabAllocator::Stats Table::getVersionAllocatorStats() const
+{
+    SlabAllocator::Stats stats = SlabAllocator::Stats();
+    for (auto & [sizeClass, allocator] : _versionAllocators) {
+        auto classStats = allocator->getStats();
+        stats.elementSize = std::max(stats.elementSize, classStats.elementSize);
+        stats.slabCount += classStats.slabCount;
+        stats.reservedBytes += classStats.reservedBytes;
+        stats.liveElements += classStats.liveElements;
+        stats.oversizedElements += classStats.oversizedElements;
+        stats.allocations += classStats.allocations;
+        stats.releases += classStats.releases;
+    }
+    return stats;
+}
+
+size_t Table::getVersionRecordSize(uint64_t columnMask) const
+{
+    return getVersionValueOffset(columnMask, _versionValueLayouts.size());
+}
+
+size_t Table::getVersionValueOffset(uint64_t columnMask, size_t columnIdx) const
+{
+    size_t offset = 0;
+    auto append = [&](size_t idx) {
+        offset = roundUp(offset, _versionValueLayouts[idx].alignment) + _versionValueLayouts[idx].size;
+    };
+
+    // only the set bits of the mask are visited, narrow records of wide tables are resolved quickly
+    uint64_t preceding = (columnIdx >= 64) ? columnMask : columnMask & ((static_cast<uint64_t>(1) << columnIdx) - 1);
+    while (preceding != 0) {
+        append(__builtin_ctzll(preceding));
+        preceding &= preceding - 1;
+    }
+    for (size_t idx = 64; idx < columnIdx; ++idx) {
+        append(idx);
+    }
+
+    if (columnIdx == _versionValueLayouts.size()) {
+        return offset;
+    }
+    return roundUp(offset, _versionValueLayouts[columnIdx].alignment);
+}
+
+cg_size_t Table::genVersionValueOffset(cg_u64_t columnMask, size_t columnIdx) const
+{
+    auto & codeGen = getThreadLocalCodeGen();
+    auto alignUp = [](cg_size_t value, size_t alignment) {
+        return (value + cg_size_t(alignment - 1)) & cg_size_t(~(alignment - 1));
+    };
+
+    // the layouts are known at compile time, hence each preceding column merely adds a select
+    cg_size_t offset(0ul);
+    for (size_t idx = 0; idx < columnIdx; ++idx) {
+        const VersionValueLayout & layout = _versionValueLayouts[idx];
+        cg_size_t appended = alignUp(offset, layout.alignment) + cg_size_t(layout.size);
+        if (idx >= 64) {
+            offset = appended;
+            continue;
+        }
+        cg_u64_t bit = (columnMask >> cg_u64_t(static_cast<uint64_t>(idx))) & cg_u64_t(1ul);
+        offset = cg_size_t( codeGen->CreateSelect(bit != cg_u64_t(0ul), appended, offset) );
+    }
+
+    if (columnIdx == _versionValueLayouts.size()) {
+        return offset;
+    }
+    return alignUp(offset, _versionValueLayouts[columnIdx].alignment);
+}
+
+void Table::materializeBranch(branch_id_t branch)
+{
+    if (_versioningEngine == VersioningEngine::Pages) {
+        // the branch is stored in columns already
+        return;
+    }
+    std::lock_guard<std::mutex> guard(_materializationMutex);
+    _materializedBranches[branch] = build_materialized_branch(*this, branch);
+    _materializedBranchCount = _materializedBranches.size();
+}
+
+std::shared_ptr<const MaterializedBranch> Table::getMaterializedBranch(branch_id_t branch)
+{
+    if (_materializedBranchCount == 0) {
+        return nullptr;
+    }
+
+    // writers wait for the rebuild, so that it does not miss their invalidation
+    std::lock_guard<std::mutex> guard(_materializationMutex);
+    auto it = _materializedBranches.find(branch);
+    if (it == _materializedBranches.end()) {
+        return nullptr;
+    }
+    if (it->second->stale) {
+        it->second = build_materialized_branch(*this, branch);
+    }
+    return it->second;
+}
+
+void Table::updateMaterializedBranches(branch_id_t modifiedBranch, tid_t tid)
+{
+    if (_materializedBranchCount == 0) {
+        return;
+    }
+
+    std::lock_guard<std::mutex> guard(_materializationMutex);
+    for (auto & [branch, materialized] : _materializedBranches) {
+        if ((modifiedBranch == branch || modifiedBranch == master_branch_id) && !materialized->stale) {
+            update_materialized_tuple(*this, *materialized, tid);
+        }
+    }
+}
+
+void Table::invalidateMaterializedBranches()
+{
+    if (_materializedBranchCount == 0) {
+        return;
+    }
+
+    std::lock_guard<std::mutex> guard(_materializationMutex);
+    for (auto & [branch, materialized] : _materializedBranches) {
+        materialized->stale = true;
+    }
+}
+
+void Table::markStrings(StringPool::Marker & marker) const
+{
+    for (auto & [ci, vec] : _columns) {
+        if (ci->type.typeID != Sql::SqlType::TypeID::TextID) {
+            continue;
+        }
+        // dictionary-encoded columns only store codes
+        const Vector & values = (ci->dictionary != nullptr) ? ci->dictionary->getValues() : *vec;
+        for (size_t i = 0; i < values.size(); ++i) {
+            marker.markText(values.at(i));
+        }
+    }
+    for (auto & [branch, pages] : _branchPages) {
+        for (auto & ci : pages->columns) {
+            if (ci->type.typeID != Sql::SqlType::TypeID::TextID || ci->dictionary != nullptr) {
+                continue;
+            }
+            const Vector & values = *ci->column;
+            for (size_t i = 0; i < values.size(); ++i) {
+                marker.markText(values.at(i));
+            }
+        }
+    }
+
+    if (_textColumns.empty()) {
+        return;
+    }
+    auto markChain = [&](const VersionEntry & versionEntry) {
+        const void * next = versionEntry.first;
+        while (next != nullptr) {
+            if (next == &versionEntry) {
+                next = versionEntry.next;
+                continue;
+            }
+            const auto storage = static_cast<const VersionedTupleStorage *>(next);
+            for (size_t columnIdx : _textColumns) {
+                if (has_column_value(storage->column_mask, columnIdx)) {
+                    marker.markText(storage->data + getVersionValueOffset(storage->column_mask, columnIdx));
+                }
+            }
+            next = storage->next;
+        }
+    };
+    for (size_t i = 0; i < _version_mgmt_column.size(); ++i) {
+        markChain(_version_mgmt_column[i]);
+    }
+    for (size_t i = 0; i < _dangling_version_mgmt_column.size(); ++i) {
+        markChain(_dangling_version_mgmt_column[i]);
+    }
+}
+
+void Table::refreshZoneMaps(size_t fromRow)
+{
+    for (auto & [ci, vec] : _columns) {
+        ZoneMap * zoneMap = ci->zoneMap;
+        if (zoneMap == nullptr) {
+            continue;
+        }
+        for (size_t row = fromRow; row < _rowCount; ++row) {
+            includeInZoneMap(*ci, row);
+        }
+    }
+}
+
+void Table::includeInZoneMaps(size_t row)
+{
+    for (auto & [ci, vec] : _columns) {
+        if (ci->zoneMap != nullptr) {
+            includeInZoneMap(*ci, row);
+        }
+    }
+}
+
+void Table::includeInZoneMap(const ColumnInformation & ci, size_t row)
+{
+    if (ci.type.nullable && row < _nullIndicatorTable.getRowCount() &&
+            _nullIndicatorTable.isSet(row, ci.nullColumnIndex)) {
+        ci.zoneMap->includeNull(row);
+    } else if (ci.packed != nullptr) {
+        ci.zoneMap->include(row, ci.packed->get(row));
     } else {
-        return _columns.begin()->second->size();
-//        return _columns.begin()->second.second->size();
-        return _version_mgmt_column.size();
+        ci.zoneMap->include(row, ci.zoneMap->toKey(ci.column->at(row)));
     }
 }
 
@@ -318,17 +1116,44 @@ Database::Database() :
 {
     auto branch = createBranch("master", invalid_branch_id);
     assert(branch == master_branch_id);
+
+    StringPool::instance().addRoot(this, [this](StringPool::Marker & marker) {
+        for (auto & [name, table] : _tables) {
+            table->markStrings(marker);
+        }
+    });
+}
+
+Database::~Database()
+{
+    // the strings which are referenced by nothing but this database can be freed
+    StringPool::instance().removeRoot(this);
+    StringPool::instance().collect();
 }
 
 Table & Database::createTable(const std::string & name) {
-    auto [it, ok] = _tables.emplace(name, std::make_unique<Table>(*this));
+    auto [it, ok] = _tables.emplace(name, std::make_unique<Table>(*this, name));
     assert(ok);
-    for (int i=0; i<_branches.size() - 1; i++) {
+    it->second->setVersioningEngine(_defaultVersioningEngine);
+    // the bitmap columns are indexed by branch id, including those of dropped branches
+    for (branch_id_t branch = master_branch_id + 1; branch < _next_branch_id; ++branch) {
         it->second->createBranch(invalid_branch_id);
+        if (_branches.count(branch) == 0) {
+            it->second->dropBranch(branch, master_branch_id);
+        }
     }
     return *it->second;
 }
 
+std::vector<Table *> Database::getTables() const
+{
+    std::vector<Table *> tables;
+    for (auto & [name, table] : _tables) {
+        tables.push_back(table.get());
+    }
+    return tables;
+}
+
 Table* Database::getTable(const std::string & tableName)
 {
     // TODO search case insensitive
@@ -340,10 +1165,50 @@ Table* Database::getTable(const std::string & tableName)
     }
 }
 
+void Database::setWriteAheadLog(std::unique_ptr<WriteAheadLog> log) {
+    _writeAheadLog = std::move(log);
+}
+
 branch_id_t Database::getLargestBranchId() const {
     return _next_branch_id - 1;
 }
 
+size_t Database::collectVersions() {
+    branch_children_t children;
+    for (auto & [id, branch] : _branches) {
+        if (branch->parent_id != invalid_branch_id) {
+            children[branch->parent_id].push_back(id);
+        }
+    }
+    for (auto & [parent, ids] : children) {
+        std::sort(ids.begin(), ids.end());
+    }
+
+    size_t freed = 0;
+    for (auto & [name, table] : _tables) {
+        freed += table->collectVersions(children);
+    }
+    _uncollectedChainCount.store(0, std::memory_order_relaxed);
+    // the freed versions might have held the last references to some strings
+    if (freed > 0) {
+        StringPool::instance().collectIfGrown();
+    }
+    return freed;
+}
+
+void Database::collectIfDue() {
+    bool versionsDue = (_uncollectedChainCount.load(std::memory_order_relaxed) >= versionCollectionThreshold);
+    if (!versionsDue && !StringPool::instance().isCollectionDue()) {
+        return;
+    }
+    // the collection walks the columns and chains of all tables, which other statements might modify
+    std::unique_lock<std::shared_mutex> statementLock(_statementLock);
+    if (versionsDue) {
+        collectVersions();
+    }
+    StringPool::instance().collectIfGrown();
+}
+
 branch_id_t Database::createBranch(const std::string & name, branch_id_t parent) {
     for (auto &[tablename,table] : _tables) {
         table->createBranch(parent);
@@ -355,28 +1220,174 @@ branch_id_t Database::createBranch(const std::string & name, branch_id_t parent)
     branch->parent_id = parent;
     _branches.insert({branch_id, std::move(branch)});
     _branchMapping[name] = branch_id;
+
+    if (_writeAheadLog != nullptr) {
+        _writeAheadLog->commit(_writeAheadLog->logCreateBranch(name, parent));
+    }
     return branch_id;
 }
 
 void Database::constructBranchLineage(branch_id_t branch, ExecutionContext & dstCtx) {
     assert(branch != invalid_branch_id);
 
-    if (dstCtx.branch_lineages.find(branch) == dstCtx.branch_lineages.end()) {
-        dstCtx.branch_lineages[branch] = std::unordered_map<branch_id_t, branch_id_t>();
-    }
-    dstCtx.branch_lineage.clear();
-    dstCtx.branch_lineage_bitset.clear();
-    dstCtx.branch_lineage_bitset.resize(_next_branch_id);
+    BranchLineage & lineage = dstCtx.branch_lineages[branch];
+    lineage.branch = branch;
+    lineage.cutoffs.assign(_next_branch_id, 0);
+    lineage.branches.clear();
+    lineage.ancestors.clear();
 
+    // all versions of the branch itself are visible
+    lineage.cutoffs[branch] = invalid_branch_id;
     branch_id_t current = branch;
     for (;;) {
-        dstCtx.branch_lineage_bitset.set(current);
+        lineage.branches.set(current);
+        lineage.ancestors.push_back(current);
         auto & branch_obj = _branches[current];
         if (branch_obj->parent_id == invalid_branch_id) {
             break;
         }
-        dstCtx.branch_lineages[branch].insert({branch_obj->parent_id, current});
-        dstCtx.branch_lineage.insert({branch_obj->parent_id, current});
+        lineage.cutoffs[branch_obj->parent_id] = current;
         current = branch_obj->parent_id;
     }
+    // the lineages live in a node-based map, hence the pointer stays valid while further ones are added
+    dstCtx.branch_lineage = &lineage;
+}
+
+BranchMergeResult Database::mergeBranch(branch_id_t source, branch_id_t destination) {
+#if USE_DATA_VERSIONING
+    auto branch = _branches.find(source);
+    if (branch == _branches.end() || branch->second->parent_id != destination) {
+        throw InvalidOperationException("branches can only be merged into their parent");
+    }
+    for (auto & [name, table] : _tables) {
+        if (table->getVersioningEngine() == Table::VersioningEngine::Pages) {
+            throw NotImplementedException("tables which are versioned by pages cannot be merged");
+        }
+    }
+
+    // the lineages are only read by the workers
+    QueryContext srcCtx(*this);
+    srcCtx.executionContext.branchId = source;
+    constructBranchLineage(source, srcCtx.executionContext);
+    QueryContext dstCtx(*this);
+    dstCtx.executionContext.branchId = destination;
+    constructBranchLineage(destination, dstCtx.executionContext);
+
+    struct Candidate {
+        Table * table;
+        tid_t tid;
+        std::vector<Native::Sql::value_op_t> values;
+    };
+    struct WorkerResult {
+        std::vector<Candidate> mergeable;
+        std::vector<std::pair<Table *, tid_t>> conflicts;
+    };
+
+    // only the tuples which the source branch has written are checked, handed out in chunks of candidates
+    const size_t chunkSize = 1024;
+    std::vector<std::pair<Table *, std::vector<tid_t>>> candidates;
+    std::vector<std::tuple<Table *, const tid_t *, size_t>> chunks;
+    for (auto & [name, table] : _tables) {
+        candidates.emplace_back(table.get(), table->getMergeCandidates(source, destination));
+    }
+    for (auto & [table, tids] : candidates) {
+        for (size_t i = 0; i < tids.size(); i += chunkSize) {
+            chunks.emplace_back(table, tids.data() + i, std::min(chunkSize, tids.size() - i));
+        }
+    }
+    std::atomic<size_t> nextChunk(0);
+
+    auto check = [&](WorkerResult & result) {
+        for (size_t chunk = nextChunk++; chunk < chunks.size(); chunk = nextChunk++) {
+            auto [tablePtr, tids, tidCount] = chunks[chunk];
+            Table & table = *tablePtr;
+            for (const tid_t * tid = tids; tid != tids + tidCount; ++tid) {
+                const void * element = nullptr;
+                switch (check_merge(*tid, table, srcCtx, dstCtx, &element)) {
+                    case merge_status_t::untouched:
+                        break;
+                    case merge_status_t::mergeable:
+                        result.mergeable.push_back({ &table, *tid, get_version_values(*tid, element, table) });
+                        break;
+                    case merge_status_t::conflict:
+                        result.conflicts.emplace_back(&table, *tid);
+                        break;
+                }
+            }
+        }
+    };
+
+    size_t workerCount = std::max<size_t>(1, std::min<size_t>(std::thread::hardware_concurrency(), chunks.size()));
+    std::vector<WorkerResult> results(workerCount);
+    std::vector<std::thread> workers;
+    for (size_t i = 1; i < workerCount; ++i) {
+        workers.emplace_back(check, std::ref(results[i]));
+    }
+    check(results[0]);
+    for (auto & worker : workers) {
+        worker.join();
+    }
+
+    // string encoding and the version collection schedule do not allow concurrent writers
+    BranchMergeResult mergeResult;
+    for (auto & result : results) {
+        for (auto & candidate : result.mergeable) {
+            Native::Sql::SqlTuple tuple(std::move(candidate.values));
+            merge_tuple(candidate.tid, destination, tuple, *candidate.table, dstCtx);
+            mergeResult.mergedCount += 1;
+        }
+        mergeResult.conflicts.insert(mergeResult.conflicts.end(), result.conflicts.begin(), result.conflicts.end());
+    }
+
+    if (_writeAheadLog != nullptr) {
+        _writeAheadLog->commit(_writeAheadLog->logMergeBranch(source, destination));
+    }
+    return mergeResult;
+#else
+    throw NotImplementedException("branches can only be merged with data versioning");
+#endif
+}
+
+void Database::materializeBranch(branch_id_t branch) {
+#if USE_DATA_VERSIONING
+    if (_branches.count(branch) == 0 || branch == master_branch_id) {
+        throw InvalidOperationException("only existing branches other than master can be materialized");
+    }
+    for (auto & [name, table] : _tables) {
+        table->materializeBranch(branch);
+    }
+#else
+    throw NotImplementedException("branches can only be materialized with data versioning");
+#endif
+}
+
+size_t Database::dropBranch(branch_id_t branch) {
+#if USE_DATA_VERSIONING
+    auto it = _branches.find(branch);
+    if (it == _branches.end() || branch == master_branch_id) {
+        throw InvalidOperationException("only existing branches other than master can be dropped");
+    }
+    for (auto & [id, other] : _branches) {
+        if (other->parent_id == branch) {
+            throw InvalidOperationException("branches with children cannot be dropped");
+        }
+    }
+
+    branch_id_t parent = it->second->parent_id;
+    size_t freed = 0;
+    for (auto & [name, table] : _tables) {
+        freed += table->dropBranch(branch, parent);
+    }
+    // the id is not reused, since ids also serve as creation timestamps of the versions
+    // the strings which only the freed versions referenced are left to collectIfDue()
+    _branchMapping.erase(it->second->name);
+    _branches.erase(it);
+
+    if (_writeAheadLog != nullptr) {
+        _writeAheadLog->commit(_writeAheadLog->logDropBranch(branch));
+    }
+    return freed;
+#else
+    throw NotImplementedException("branches can only be dropped with data versioning");
+#endif
 }
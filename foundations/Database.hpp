@@ -4,10 +4,21 @@
 #include <map>
 #include <unordered_map>
 #include <set>
+#include <unordered_set>
+#include <shared_mutex>
+#include <mutex>
+#include <atomic>
 #include <limits>
+#include <memory>
 
 #include "sql/SqlType.hpp"
 #include "Vector.hpp"
+#include "StringDictionary.hpp"
+#include "StringPool.hpp"
+#include "PackedIntegerColumn.hpp"
+#include "SlabAllocator.hpp"
+#include "TidSet.hpp"
+#include "ZoneMap.hpp"
 
 //#include "foundations/version_management.hpp"
 
@@ -16,6 +27,9 @@ using cg_branch_id_t = TypeWrappers::UInt32;
 constexpr branch_id_t master_branch_id = 0;
 constexpr branch_id_t invalid_branch_id = std::numeric_limits<branch_id_t>::max();
 
+/// parent -> ascending ids of its child branches
+using branch_children_t = std::unordered_map<branch_id_t, std::vector<branch_id_t>>;
+
 using tid_t = size_t;
 using cg_tid_t = cg_size_t;
 constexpr tid_t invalid_tid = std::numeric_limits<tid_t>::max();
@@ -31,6 +45,15 @@ struct ColumnInformation {
 
     enum class NullIndicatorType { Embedded, Column } nullIndicatorType;
     unsigned nullColumnIndex;
+
+    /// Dictionary-encoded columns store StringDictionary::code_t values,
+    /// bit-packed columns are stored by a PackedIntegerColumn instead of the Vector
+    enum class Encoding { Plain, Dictionary, BitPacked } encoding = Encoding::Plain;
+    StringDictionary * dictionary = nullptr;
+    PackedIntegerColumn * packed = nullptr;
+
+    /// Per-block bounds of integer-like columns; nullptr for all other types
+    ZoneMap * zoneMap = nullptr;
 };
 
 using ci_p_t = const ColumnInformation *;
@@ -38,72 +61,309 @@ using ci_p_t = const ColumnInformation *;
 //-----------------------------------------------------------------------------
 // NullIndicatorColumn
 
+/// Column-major bitmap: every column is a separate bitvector of 64-bit words.
+/// Columns can be added at any time without touching the existing ones.
 class BitmapTable {
 public:
-    BitmapTable();
+    using word_t = uint64_t;
 
-    BitmapTable(size_t columnCountHint);
+    static constexpr unsigned wordBits = 64;
+
+    /// log2 of the number of words per chunk of a column (8KB chunks)
+    static constexpr unsigned wordChunkShift = 10;
+
+    BitmapTable();
 
     unsigned addColumn();
 
     unsigned cloneColumn(unsigned original);
 
-    void removeColumn(unsigned column);
+    /// \brief Adds a column with the bits of the given one, whose chunks are shared copy-on-write
+    unsigned forkColumn(unsigned original);
+
+    /// \brief Frees the words of the given column, which must not be accessed anymore; the index is not reused
+    void releaseColumn(unsigned column);
 
-    unsigned getColumnCount() const { return _columnCount; }
+    bool isReleased(unsigned column) const { return _columns[column] == nullptr; }
+
+    unsigned getColumnCount() const { return static_cast<unsigned>(_columns.size()); }
 
     void addRow();
 
+    /// \brief Removes the last row
     void removeRow();
 
-    /// \returns Bytes per row
-    size_t getRowSize() const { return _data->getElementSize(); }
+    size_t getRowCount() const { return _rowCount; }
 
     void set(tid_t tid, unsigned column, bool value);
 
     bool isSet(tid_t tid, unsigned column) const;
 
-    void * data() const { return _data->front(); }
+    /// \returns Whether no bit of the given row is set
+    bool isRowClear(tid_t tid) const;
+
+    /// \brief Copies all bits of one row to another
+    void copyRow(tid_t from, tid_t to);
+
+    /// \returns The words of the given column; bit (tid % 64) of word (tid / 64) belongs to tid
+    const Vector & getColumn(unsigned column) const { return *_columns[column]; }
+
+    /// \brief Sets the policy of the words which are allocated from now on, including those of new columns
+    void setAllocationPolicy(const AllocationPolicy & policy);
 
 private:
-    void resize();
+    friend class Snapshot;
 
-    unsigned _availableCount = 0;
-    unsigned _columnCount = 0;
-    std::unique_ptr<Vector> _data;
+    size_t _rowCount = 0;
+    std::vector<std::unique_ptr<Vector>> _columns;
+    AllocationPolicy _allocationPolicy;
 };
 
-/// \param columnAddr The raw address obtained through NullIndicatorColumn::data()
-cg_bool_t genNullIndicatorLoad(BitmapTable & table, cg_tid_t tid, cg_unsigned_t column);
+/// \brief Loads the word of the given column which holds the bits of the tids [wordIndex*64, wordIndex*64 + 64)
+cg_u64_t genBitmapWordLoad(BitmapTable & table, cg_size_t wordIndex, unsigned column);
+
+cg_bool_t genNullIndicatorLoad(BitmapTable & table, cg_tid_t tid, unsigned column);
+
+cg_bool_t isVisibleInBranch(BitmapTable & branchBitmap, cg_tid_t tid, branch_id_t branchId);
+
+//-----------------------------------------------------------------------------
+// BranchSet
+
+/// Set of branch ids; the first inlineBits branches are stored inline, all further ones in an overflow array
+class BranchSet {
+public:
+    static constexpr unsigned inlineBits = 64;
+
+    BranchSet() = default;
+    BranchSet(const BranchSet & other);
+    BranchSet(BranchSet && other) noexcept;
+
+    ~BranchSet() { delete[] _overflow; }
+
+    BranchSet & operator=(const BranchSet & other);
+    BranchSet & operator=(BranchSet && other) noexcept;
+
+    void set(branch_id_t branch);
+    void reset(branch_id_t branch);
+    bool test(branch_id_t branch) const;
+
+    bool intersects(const BranchSet & other) const {
+        if ((_inline & other._inline) != 0) {
+            return true;
+        }
+        return (_overflow != nullptr && other._overflow != nullptr && intersectsOverflow(other));
+    }
+
+    void clear();
+
+    /// \returns The number of 64 bit words, including the inline one
+    size_t getWordCount() const { return 1 + ((_overflow == nullptr) ? 0 : _overflow[0]); }
+
+    /// \returns The word which holds the bits of the branches [idx*64, idx*64 + 64)
+    uint64_t getWord(size_t idx) const;
+    void setWord(size_t idx, uint64_t word);
+
+private:
+    bool intersectsOverflow(const BranchSet & other) const;
+
+    uint64_t _inline = 0;
+    uint64_t * _overflow = nullptr; // the count of the following words, the words of the branches beyond inlineBits
+};
 
-cg_bool_t isVisibleInBranch(BitmapTable & branchBitmap, cg_tid_t tid, cg_branch_id_t branchId);
+//-----------------------------------------------------------------------------
+// VersionEntryColumn
+
+struct VersionEntry;
+
+/// Dense, tid-indexed storage of the version entries of a table
+///
+/// The entries are placed in chunks, so that their addresses are stable: chain elements refer to them.
+/// The element access is defined along with VersionEntry in version_management.hpp.
+class VersionEntryColumn {
+public:
+    static constexpr unsigned chunkShift = 12;
+    static constexpr size_t chunkSize = static_cast<size_t>(1) << chunkShift;
+
+    VersionEntryColumn() = default;
+    VersionEntryColumn(const VersionEntryColumn &) = delete;
+    VersionEntryColumn & operator=(const VersionEntryColumn &) = delete;
+
+    ~VersionEntryColumn();
+
+    /// \brief Appends an entry with an empty chain
+    VersionEntry & emplace_back();
+
+    void pop_back();
+
+    inline VersionEntry & operator[](size_t idx) const;
+
+    VersionEntry & back() const { return (*this)[_size - 1]; }
+
+    size_t size() const { return _size; }
+
+    bool empty() const { return _size == 0; }
+
+    /// \returns The location of the chunk directory, which is read by generated code
+    VersionEntry * const * const * getDirectoryAddress() const { return &_directory; }
+
+    /// \brief Replaces the (empty) content by chunks of constructed entries which are owned by someone else
+    ///
+    /// Like Vector::adoptChunks(), appending continues within the last borrowed chunk.
+    void adoptChunks(VersionEntry * const * chunks, size_t chunkCount, size_t size);
+
+private:
+    std::vector<VersionEntry *> _chunks;
+    VersionEntry ** _directory = nullptr; // the current array of _chunks
+    size_t _size = 0;
+    size_t _borrowedChunkCount = 0;
+};
+
+//-----------------------------------------------------------------------------
+// BranchLineage
+
+/// The ancestry of a branch, flattened once per query so that checking the visibility of a version is a single lookup
+struct BranchLineage {
+    branch_id_t branch = invalid_branch_id;
+
+    /// Indexed by branch id: the versions of an ancestor are visible if they have been created before the cutoff,
+    /// which is the child through which the lineage descends. The branch itself maps to invalid_branch_id, every
+    /// other branch to zero.
+    std::vector<branch_id_t> cutoffs;
+
+    BranchSet branches; // the branch and all of its ancestors
+
+    std::vector<branch_id_t> ancestors; // the branch followed by its ancestors, from the parent up to master
+
+    bool isVisible(branch_id_t versionBranch, branch_id_t creationTs) const {
+        // branches which have been created after the lineage are no ancestors
+        return versionBranch < cutoffs.size() && creationTs < cutoffs[versionBranch];
+    }
+};
+
+//-----------------------------------------------------------------------------
+// MaterializedBranch
+
+/// Columnar copy of the latest state of a branch, which scans of the branch read like the master columns
+///
+/// Chunks in which the branch has not changed the column share the chunk of the master column, only the
+/// other ones are copied. Writes to the branch and to master patch the written tuple within the copy; a
+/// shared chunk is copied once one of its rows differs from master. Compaction marks the copy as stale, it
+/// is rebuilt by the next scan which needs it.
+struct MaterializedBranch {
+    MaterializedBranch() = default;
+    MaterializedBranch(const MaterializedBranch &) = delete;
+    MaterializedBranch & operator=(const MaterializedBranch &) = delete;
+
+    /// \brief Releases the copied chunks
+    ~MaterializedBranch();
+
+    branch_id_t branch;
+    BranchLineage lineage; // as of the build, branches created later do not affect the copy
+    size_t rowCount = 0;
+    std::atomic<bool> stale { false };
+
+    /// Per column: the master column information pointing to the copy; bit-packed columns are copied unpacked.
+    /// Dictionaries and zone maps are shared, the zone maps also cover the values of branch versions.
+    std::vector<std::unique_ptr<ColumnInformation>> columns;
+    std::vector<std::unique_ptr<Vector>> vectors; // borrow the shared and the copied chunks, own appended ones
+    std::vector<std::pair<void *, size_t>> copiedChunks; // (chunk, size)
+};
 
 //-----------------------------------------------------------------------------
 // Table
 
 class Database;
-struct VersionEntry;
 
 /// AbstractTable is a base class which provides an interface to lookup columns at runtime
 class Table {
 public:
-    Table(Database & db);
+    /// How the branches of the table are versioned
+    enum class VersioningEngine {
+        Chains, ///< the master columns and per-tuple version chains hold the values of all branches
+        Pages   ///< every branch has copy-on-write forks of the columns of its parent
+    };
+
+    Table(Database & db, const std::string & name);
 
     ~Table();
 
-    void addColumn(const std::string & columnName, Sql::SqlType type);
+    void addColumn(const std::string & columnName, Sql::SqlType type,
+            ColumnInformation::Encoding encoding = ColumnInformation::Encoding::Plain);
 
     void addRow(branch_id_t branchId);
 
+    /// \brief Deletes the row from the master branch
     void removeRow(tid_t tid);
 
+    /// \brief Hides the row from the given branch
+    ///
+    /// Rows which thereby become invisible in every branch (in the master branch in unversioned builds)
+    /// are left behind as tombstones until compact() reclaims their storage.
     void removeRowForBranch(tid_t tid, branch_id_t branchId);
 
+    /// \returns The number of tombstones
+    size_t getDeadRowCount() const { return _deadRows.size(); }
+
+    /// \brief Reclaims the storage of up to maxRows tombstones
+    ///
+    /// The holes are filled with the last rows of the table, which thereby receive a new tid; afterwards
+    /// the table is truncated. Since every reclaimed row costs a constant amount of work, the compaction
+    /// can proceed incrementally between statements.
+    /// \returns The number of reclaimed rows
+    size_t compact(size_t maxRows = std::numeric_limits<size_t>::max());
+
+    /// \brief Adds a branch, which shares the visibility words and the modified tuples of its parent copy-on-write
+    ///
+    /// The cost does not depend on the number of rows: a chunk of visibility words is only copied once either
+    /// branch inserts or deletes within it.
     void createBranch(branch_id_t parent);
 
-//    const std::string & getName() const;
+    /// \brief Frees the versions and the visibility words of a branch without children
+    ///
+    /// The tuples which have been inserted by the branch become tombstones, which are reclaimed by compact().
+    /// \returns The number of freed versions
+    size_t dropBranch(branch_id_t branch, branch_id_t parent);
+
+    /// \returns The tuples which might hold a version of the source branch that is not part of the destination
+    ///
+    /// Like dropBranch(), only the tuples which the source branch has modified or sees in contrast to the
+    /// destination are considered, hence the cost depends on the branch's writes rather than on the table size.
+    std::vector<tid_t> getMergeCandidates(branch_id_t source, branch_id_t destination) const;
+
+    /// \brief Selects how the branches of the table are versioned; only possible as long as the table is empty
+    ///
+    /// The page engine forks the chunks of all columns when a branch is created and copies a chunk when a
+    /// branch writes it first, so that scans of any branch read plain columns. Bit-packed columns and
+    /// merges are not supported.
+    void setVersioningEngine(VersioningEngine engine);
+
+    VersioningEngine getVersioningEngine() const { return _versioningEngine; }
+
+    /// \returns The columns of the given branch of a table which uses the page engine; nullptr for the master
+    ///          branch and for tables which use version chains
+    const std::vector<std::unique_ptr<ColumnInformation>> * getBranchColumns(branch_id_t branch) const;
+
+    /// \brief Records that a version of the tuple has been added within the given branch
+    ///
+    /// Scans of a branch resolve the version chains of its recorded tuples only, all other tuples are read from
+    /// the master row. A new branch inherits the tuples of its parent. A version of master is recorded for all
+    /// branches, since it moves the master row which they have forked off from into the chain.
+    void markModified(tid_t tid, branch_id_t branch);
+
+    /// \returns The tuples whose version chains scans of the given branch have to resolve; nullptr for master
+    const TidSet * getModifiedTids(branch_id_t branch) const;
+
+    /// \brief Schedules the version chain of the given tuple for the next collection
+    void scheduleVersionCollection(tid_t tid);
+
+    /// \brief Frees the unobservable versions of all chains which have grown since the previous collection
+    /// \returns The number of freed versions
+    size_t collectVersions(const branch_children_t & children);
+
+    const std::string & getName() const { return _name; }
 
     ci_p_t getCI(const std::string & columnName) const;
+    ci_p_t getCI(size_t idx) const;
 
     std::unique_ptr<ColumnInformation> &getTIDColumnInformation() { return _tidColumn; }
 
@@ -125,22 +385,140 @@ public:
 
     size_t size() const;
 
+    /// \brief Widens the zone maps by the values of all rows starting at the given row
+    ///
+    /// Has to be called after the column storage has been written directly, e.g. by the loader.
+    void refreshZoneMaps(size_t fromRow = 0);
+
+    /// \brief Marks all out-of-line Text values of the columns, dictionaries and version chains
+    void markStrings(StringPool::Marker & marker) const;
+
+    /// \brief Sets the placement of all column, dictionary and bitmap storage which is allocated from now on
+    ///
+    /// New tables start with the default policy of the Allocator.
+    void setAllocationPolicy(const AllocationPolicy & policy);
+
+    const AllocationPolicy & getAllocationPolicy() const { return _allocationPolicy; }
+
+    /// \brief Allocates a version chain element; the elements of a branch are placed next to each other
+    ///
+    /// Elements are rounded up to size classes, each of which is served by a slab allocator of its own.
+    void * allocateVersion(size_t size, branch_id_t branchId);
+
+    /// \param size The size which has been passed to allocateVersion()
+    void releaseVersion(void * ptr, size_t size);
+
+    /// \returns The summed statistics of all size classes, whereas the element size is the one of the largest class;
+    ///          all zero if no version has been created yet
+    SlabAllocator::Stats getVersionAllocatorStats() const;
+
+    /// \returns The size of the values of a version record which holds the columns of the given mask
+    size_t getVersionRecordSize(uint64_t columnMask) const;
+
+    /// \returns The offset of a column's value within a version record which holds the columns of the given mask
+    ///
+    /// The values are stored in column order, each one aligned like within the tuple of all columns.
+    size_t getVersionValueOffset(uint64_t columnMask, size_t columnIdx) const;
+
+    /// \brief Generates getVersionValueOffset() for a column mask which is only known at runtime
+    cg_size_t genVersionValueOffset(cg_u64_t columnMask, size_t columnIdx) const;
+
+    /// \brief Builds a columnar copy of the given branch, which is kept up to date from now on
+    void materializeBranch(branch_id_t branch);
+
+    /// \returns The copy of the given branch, which is rebuilt first if it has become stale;
+    ///          nullptr if the branch has not been materialized
+    std::shared_ptr<const MaterializedBranch> getMaterializedBranch(branch_id_t branch);
+
+    /// \brief Applies a write of the given tuple to the copies which it affects
+    ///
+    /// These are the copy of the modified branch and, for master writes, every copy: master rows are overwritten
+    /// in place within chunks which the copies may share. Writes to other ancestors only add versions which
+    /// are not visible within the copied branch.
+    void updateMaterializedBranches(branch_id_t modifiedBranch, tid_t tid);
+
+    /// \brief Marks all copies as stale, e.g. after rows have been moved
+    void invalidateMaterializedBranches();
+
 private:
+    friend class Snapshot;
+
+    /// \brief Widens the zone maps by the values of the given row
+    void includeInZoneMaps(size_t row);
+
+    void includeInZoneMap(const ColumnInformation & ci, size_t row);
+
+    bool isDeadRow(tid_t tid) const;
+
+    /// \brief Overwrites a row (including its version chain) by another one
+    void moveRow(tid_t from, tid_t to);
+
+    void removeLastRow();
+
+    /// \returns The modified tuple sets of all branches, each shared set once, e.g. for remapping a tid
+    std::vector<TidSet *> getDistinctModifiedTids();
+
+    /// The copy-on-write columns of a branch of a table which uses the page engine
+    struct BranchPages {
+        std::vector<std::unique_ptr<Vector>> vectors;
+        /// copies of the master column information which refer to the forked vectors
+        std::vector<std::unique_ptr<ColumnInformation>> columns;
+    };
+
+    /// \brief Forks the columns of the parent (of master if the parent is invalid) for a new branch
+    void forkBranchPages(branch_id_t branch, branch_id_t parent);
+
+
     Database & _db;
+    std::string _name;
 
     std::unordered_map<std::string, size_t> _columnsByName; // name -> column index
     std::vector<
         std::pair<std::unique_ptr<ColumnInformation>, std::unique_ptr<Vector>>
         > _columns;
 
+    std::vector<std::unique_ptr<StringDictionary>> _dictionaries;
+    std::vector<std::unique_ptr<PackedIntegerColumn>> _packedColumns;
+    std::vector<std::unique_ptr<ZoneMap>> _zoneMaps;
+
+    size_t _rowCount = 0;
+
     BitmapTable _nullIndicatorTable;
     BitmapTable _branchBitmap;
 
     std::unique_ptr<ColumnInformation> _tidColumn;
 
+    std::set<tid_t> _deadRows;
+    std::unordered_set<tid_t> _uncollectedTids; // tuples with versions added since the previous collection
+    /// indexed by branch id, see markModified(); null for master. A branch shares the set of its parent until either
+    /// one records a version of its own.
+    std::vector<std::shared_ptr<TidSet>> _modifiedTids;
+
+    static constexpr size_t versionSizeClass = 16;
+
+    struct VersionValueLayout {
+        size_t size;
+        size_t alignment;
+    };
+
+    std::vector<VersionValueLayout> _versionValueLayouts; // the value of each column within version records
+    std::vector<size_t> _textColumns; // indices of the Text columns
+
+    AllocationPolicy _allocationPolicy;
+
+    std::map<size_t, std::unique_ptr<SlabAllocator>> _versionAllocators; // size class -> allocator
+
+    VersioningEngine _versioningEngine = VersioningEngine::Chains;
+    std::unordered_map<branch_id_t, std::unique_ptr<BranchPages>> _branchPages; // all branches except master
+
+    // scans may still read a copy which has been replaced by a rebuild
+    std::unordered_map<branch_id_t, std::shared_ptr<MaterializedBranch>> _materializedBranches;
+    std::atomic<size_t> _materializedBranchCount { 0 }; // writers skip the mutex while there is no copy
+    std::mutex _materializationMutex;
+
 public:
-    std::vector<std::unique_ptr<VersionEntry>> _version_mgmt_column;
-    std::vector<std::unique_ptr<VersionEntry>> _dangling_version_mgmt_column;
+    VersionEntryColumn _version_mgmt_column;
+    VersionEntryColumn _dangling_version_mgmt_column;
 };
 
 void genTableAddRowCall(cg_voidptr_t table);
@@ -177,11 +555,22 @@ struct Branch {
 // Database
 
 struct ExecutionContext;
+class Snapshot;
+class WriteAheadLog;
+
+/// The outcome of Database::mergeBranch()
+struct BranchMergeResult {
+    size_t mergedCount = 0;
+    /// The tuples which have been modified in both branches; their destination versions are kept
+    std::vector<std::pair<Table *, tid_t>> conflicts;
+};
 
 class Database {
 public:
     Database();
 
+    ~Database();
+
     Table & createTable(const std::string & name);
 
     Table * getTable(const std::string & tableName);
@@ -190,16 +579,68 @@ public:
         return getTable(tableName) != nullptr;
     }
 
+    size_t getTableCount() const { return _tables.size(); }
+
+    /// \brief Sets the versioning engine of the tables which are created from now on
+    void setDefaultVersioningEngine(Table::VersioningEngine engine) { _defaultVersioningEngine = engine; }
+
+    std::vector<Table *> getTables() const;
+
+    /// \brief Statements hold this lock shared, maintenance jobs like the Compactor exclusively
+    std::shared_mutex & getStatementLock() { return _statementLock; }
+
+    /// \brief Attaches a write-ahead log; all following modifications are logged
+    void setWriteAheadLog(std::unique_ptr<WriteAheadLog> log);
+
+    WriteAheadLog * getWriteAheadLog() const { return _writeAheadLog.get(); }
+
     branch_id_t getLargestBranchId() const;
 
+    /// \brief Frees all versions which no branch can observe anymore, see collect_chain()
+    ///
+    /// Must not run concurrently with statements.
+    /// \returns The number of freed versions
+    size_t collectVersions();
+
+    /// \brief Runs the collections which are due while holding the statement lock exclusively
+    ///
+    /// Versions are collected once versionCollectionThreshold chains have grown, strings once the StringPool
+    /// has doubled. Called after each statement; the caller must not hold the statement lock.
+    void collectIfDue();
+
+    /// The number of grown version chains at which collectIfDue() collects the versions
+    static constexpr size_t versionCollectionThreshold = static_cast<size_t>(1) << 16;
+
 private:
+    friend class Snapshot;
+    friend class Table;
+
+    // mapped snapshots have to outlive the tables which borrow their storage
+    std::vector<std::unique_ptr<Snapshot>> _snapshots;
     std::unordered_map<std::string, std::unique_ptr<Table>> _tables;
     std::unordered_map<std::string, std::unique_ptr<Index>> _indexes;
+    std::unique_ptr<WriteAheadLog> _writeAheadLog;
+    std::shared_mutex _statementLock;
+    std::atomic<size_t> _uncollectedChainCount{0}; // the chains scheduled since the previous version collection
+    Table::VersioningEngine _defaultVersioningEngine = Table::VersioningEngine::Chains;
 
 public:
     branch_id_t createBranch(const std::string & name, branch_id_t parent);
     void constructBranchLineage(branch_id_t branch, ExecutionContext & dstCtx);
 
+    /// \brief Installs the latest versions of all tuples which have been modified in the source branch into its parent
+    ///
+    /// The chains are checked in parallel, the mergeable versions are installed afterwards. Tuples which have been
+    /// modified in the destination as well are left untouched and reported as conflicts.
+    BranchMergeResult mergeBranch(branch_id_t source, branch_id_t destination);
+
+    /// \brief Keeps a columnar copy of the branch within all current tables, see Table::materializeBranch()
+    void materializeBranch(branch_id_t branch);
+
+    /// \brief Removes a branch without children and frees its versions within all tables, see Table::dropBranch()
+    /// \returns The number of freed versions
+    size_t dropBranch(branch_id_t branch);
+
     std::unordered_map<branch_id_t, std::unique_ptr<Branch>> _branches;
     std::unordered_map<std::string, branch_id_t> _branchMapping;
     branch_id_t _next_branch_id;
@@ -23,7 +23,7 @@ Hashtable::Hashtable(size_t sizeHint)
     _moduloMask = _tableSize - 1;
     _uniqueCountThreshold = static_cast<size_t>(_loadFactorThreshold*_tableSize);
 
-    _table = new Node *[_tableSize](); // initialised to zero
+    _table = allocateTable(_tableSize);
 }
 
 Hashtable::Hashtable(Hashtable::Node * first, size_t len)
@@ -35,7 +35,7 @@ Hashtable::Hashtable(Hashtable::Node * first, size_t len)
     _moduloMask = _tableSize - 1;
     _uniqueCountThreshold = static_cast<size_t>(_loadFactorThreshold*_tableSize);
 
-    _table = new Node *[_tableSize](); // initialised to zero
+    _table = allocateTable(_tableSize);
 
     build(first);
 }
@@ -43,7 +43,14 @@ Hashtable::Hashtable(Hashtable::Node * first, size_t len)
 Hashtable::~Hashtable()
 {
 //    printf("Hashtable dtor %p\n", this);
-    delete[] _table;
+    Allocator::instance().release(_table, _tableSize*sizeof(Node *));
+}
+
+Hashtable::Node ** Hashtable::allocateTable(size_t tableSize)
+{
+    // initialised to zero
+    auto policy = Allocator::instance().getDefaultPolicy();
+    return static_cast<Node **>(Allocator::instance().allocateZeroed(tableSize*sizeof(Node *), policy));
 }
 
 Hashtable::Node * Hashtable::first()
@@ -171,7 +178,7 @@ void Hashtable::rehash()
 
     // create a new table
     Node ** oldTable = _table;
-    _table = new Node *[_tableSize]();
+    _table = allocateTable(_tableSize);
     _uniqueCount = 0;
 
     // rebuild the hash table
@@ -184,7 +191,7 @@ void Hashtable::rehash()
         }
     }
 
-    delete[] oldTable;
+    Allocator::instance().release(oldTable, oldTableSize*sizeof(Node *));
 }
 
 // wrapper functions
@@ -58,6 +58,8 @@ private:
 
     void rehash();
 
+    static Node ** allocateTable(size_t tableSize);
+
     size_t hash(hash_code_t h) { return h & _moduloMask; }
 
     Node ** _table;
@@ -20,7 +20,8 @@ MemoryPool::MemoryPool() :
 { }
 
 MemoryPool::MemoryPool(size_t sizeHint) :
-        nextBlockSize(0)
+        nextBlockSize(0),
+        allocationPolicy(Allocator::instance().getDefaultPolicy())
 {
 //    printf("MemoryPool ctor\n");
     // allocating one empty block before any call to malloc() actually saves one performance critical branch
@@ -33,7 +34,7 @@ MemoryPool::~MemoryPool()
 //    printf("MemoryPool dtor %p\n", this);
 
     for (auto & block : blocks) {
-        std::free(block.startAddr);
+        Allocator::instance().release(block.startAddr, block.size);
     }
 }
 
@@ -63,10 +64,7 @@ void MemoryPool::createNewBlock(size_t minimum)
 
     // we don't need continuous memory addresses
     // http://www.iso-9899.info/wiki/Why_not_realloc
-    void * mem = std::calloc(blockSize, 1);
-    if (unlikely(mem == nullptr)) {
-        throw std::runtime_error("allocation failed");
-    }
+    void * mem = Allocator::instance().allocateZeroed(blockSize, allocationPolicy);
 
     blocks.emplace_back(mem, mem, blockSize);
     nextBlockSize = nextBlockSize << 1;
@@ -7,6 +7,7 @@
 #include <llvm/IR/Value.h>
 
 #include "codegen/CodeGen.hpp"
+#include "foundations/Allocator.hpp"
 
 //-----------------------------------------------------------------------------
 // MemoryPool
@@ -40,6 +41,8 @@ private:
 
     size_t nextBlockSize;
 
+    AllocationPolicy allocationPolicy;
+
     std::vector<block_t> blocks;
 };
 
@@ -0,0 +1,400 @@
+#include "foundations/PackedIntegerColumn.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cstring>
+#include <utility>
+
+#include <llvm/IR/TypeBuilder.h>
+
+#include "foundations/exceptions.hpp"
+#include "utils/general.hpp"
+
+using namespace Sql;
+
+//-----------------------------------------------------------------------------
+// bit-packing kernels
+
+/// \returns The number of words required to store count values with the given bit width
+static size_t getWordCount(unsigned bitWidth, size_t count)
+{
+    // one additional word allows to read the successor of the last word unconditionally
+    return (bitWidth*count + PackedIntegerColumn::wordBits - 1)/PackedIntegerColumn::wordBits + 1;
+}
+
+static inline PackedIntegerColumn::word_t getMask(unsigned bitWidth)
+{
+    return (bitWidth >= PackedIntegerColumn::wordBits) ? ~PackedIntegerColumn::word_t(0) :
+            (PackedIntegerColumn::word_t(1) << bitWidth) - 1;
+}
+
+static inline PackedIntegerColumn::word_t extract(const PackedIntegerColumn::word_t * words, unsigned bitWidth, size_t index)
+{
+    if (bitWidth == 0) {
+        return 0;
+    }
+    size_t bit = index*bitWidth;
+    size_t wordIndex = bit / PackedIntegerColumn::wordBits;
+    unsigned shift = bit % PackedIntegerColumn::wordBits;
+    PackedIntegerColumn::word_t value = words[wordIndex] >> shift;
+    if (shift + bitWidth > PackedIntegerColumn::wordBits) {
+        value |= words[wordIndex + 1] << (PackedIntegerColumn::wordBits - shift);
+    }
+    return value & getMask(bitWidth);
+}
+
+static inline void insert(PackedIntegerColumn::word_t * words, unsigned bitWidth, size_t index, PackedIntegerColumn::word_t value)
+{
+    if (bitWidth == 0) {
+        return;
+    }
+    PackedIntegerColumn::word_t mask = getMask(bitWidth);
+    size_t bit = index*bitWidth;
+    size_t wordIndex = bit / PackedIntegerColumn::wordBits;
+    unsigned shift = bit % PackedIntegerColumn::wordBits;
+    words[wordIndex] = (words[wordIndex] & ~(mask << shift)) | (value << shift);
+    if (shift + bitWidth > PackedIntegerColumn::wordBits) {
+        unsigned spilled = PackedIntegerColumn::wordBits - shift;
+        words[wordIndex + 1] = (words[wordIndex + 1] & ~(mask >> spilled)) | (value >> spilled);
+    }
+}
+
+/// Unpacks count values of a fixed bit width
+///
+/// Every group of 64 values occupies exactly bitWidth words, so the shift amounts within a group
+/// are compile-time constants. This allows the compiler to fully unroll and vectorize the inner loop.
+template<unsigned bitWidth, typename T>
+static void unpackKernel(const PackedIntegerColumn::word_t * words, int64_t reference, size_t count, T * dest)
+{
+    using word_t = PackedIntegerColumn::word_t;
+    constexpr unsigned wordBits = PackedIntegerColumn::wordBits;
+
+    if constexpr (bitWidth == 0) {
+        std::fill(dest, dest + count, static_cast<T>(reference));
+    } else {
+        constexpr word_t mask = (bitWidth == wordBits) ? ~word_t(0) : (word_t(1) << (bitWidth % wordBits)) - 1;
+
+        size_t groupCount = count / wordBits;
+        for (size_t group = 0; group < groupCount; ++group) {
+            const word_t * in = words + group*bitWidth;
+            T * out = dest + group*wordBits;
+            for (unsigned i = 0; i < wordBits; ++i) {
+                const unsigned bit = i*bitWidth;
+                const unsigned shift = bit % wordBits;
+                word_t value = in[bit / wordBits] >> shift;
+                if (shift + bitWidth > wordBits) {
+                    value |= in[bit / wordBits + 1] << (wordBits - shift);
+                }
+                out[i] = static_cast<T>(static_cast<word_t>(reference) + (value & mask));
+            }
+        }
+
+        for (size_t i = groupCount*wordBits; i < count; ++i) {
+            dest[i] = static_cast<T>(static_cast<word_t>(reference) + extract(words, bitWidth, i));
+        }
+    }
+}
+
+template<typename T>
+using unpack_kernel_t = void (*)(const PackedIntegerColumn::word_t *, int64_t, size_t, T *);
+
+template<typename T, size_t... widths>
+static constexpr std::array<unpack_kernel_t<T>, sizeof...(widths)> makeUnpackKernels(std::index_sequence<widths...>)
+{
+    return { &unpackKernel<widths, T>... };
+}
+
+/// one specialized kernel for each bit width
+template<typename T>
+static const auto unpackKernels = makeUnpackKernels<T>(std::make_index_sequence<PackedIntegerColumn::wordBits + 1>());
+
+//-----------------------------------------------------------------------------
+// PackedIntegerColumn
+
+PackedIntegerColumn::PackedIntegerColumn(SqlType type) :
+        _type(type)
+{
+    if (type.nullable ||
+            (type.typeID != SqlType::TypeID::IntegerID && type.typeID != SqlType::TypeID::LongIntegerID)) {
+        throw InvalidOperationException("bit-packing requires a not nullable Integer or LongInteger column");
+    }
+    _valueSize = Sql::getValueSize(type);
+    assert(_valueSize == sizeof(int32_t) || _valueSize == sizeof(int64_t));
+}
+
+void PackedIntegerColumn::push_back(int64_t value)
+{
+    if ((_size & (blockCapacity - 1)) == 0) {
+        // the previous block is complete
+        if (!_blocks.empty()) {
+            size_t first = _size - blockCapacity;
+            std::vector<int64_t> values(blockCapacity);
+            for (size_t i = 0; i < blockCapacity; ++i) {
+                values[i] = get(first + i);
+            }
+            pack(_blocks.back(), values.data(), blockCapacity);
+        }
+
+        Block block;
+        block.words.reset(new word_t[getWordCount(wordBits, blockCapacity)]());
+        _blocks.push_back(std::move(block));
+    }
+
+    _size += 1;
+    set(_size - 1, value);
+}
+
+void PackedIntegerColumn::pop_back()
+{
+    assert(_size > 0);
+    _size -= 1;
+    if ((_size & (blockCapacity - 1)) == 0) {
+        _blocks.pop_back();
+    }
+}
+
+void PackedIntegerColumn::remove_at(size_t row)
+{
+    assert(row < _size);
+    for (size_t i = row + 1; i < _size; ++i) {
+        set(i - 1, get(i));
+    }
+    pop_back();
+}
+
+int64_t PackedIntegerColumn::get(size_t row) const
+{
+    assert(row < _size);
+    const Block & block = _blocks[row >> blockShift];
+    word_t delta = extract(block.words.get(), block.bitWidth, row & (blockCapacity - 1));
+    return static_cast<int64_t>(static_cast<word_t>(block.reference) + delta);
+}
+
+void PackedIntegerColumn::set(size_t row, int64_t value)
+{
+    assert(row < _size);
+    size_t blockIndex = row >> blockShift;
+    size_t index = row & (blockCapacity - 1);
+    Block & block = _blocks[blockIndex];
+
+    // full width blocks represent any value (modulo 2^64)
+    word_t delta = static_cast<word_t>(value) - static_cast<word_t>(block.reference);
+    if (block.bitWidth == wordBits || (value >= block.reference && delta <= getMask(block.bitWidth))) {
+        insert(block.words.get(), block.bitWidth, index, delta);
+        return;
+    }
+
+    // the value is out of the block's range
+    size_t count = getBlockSize(blockIndex);
+    std::vector<int64_t> values(count);
+    for (size_t i = 0; i < count; ++i) {
+        values[i] = static_cast<int64_t>(static_cast<word_t>(block.reference) + extract(block.words.get(), block.bitWidth, i));
+    }
+    values[index] = value;
+
+    if (blockIndex + 1 == _blocks.size()) {
+        // keep the last block at full width, so that appending values does not require repacking
+        block.words.reset(new word_t[getWordCount(wordBits, blockCapacity)]());
+        block.reference = 0;
+        block.bitWidth = wordBits;
+        for (size_t i = 0; i < count; ++i) {
+            insert(block.words.get(), block.bitWidth, i, static_cast<word_t>(values[i]));
+        }
+    } else {
+        pack(block, values.data(), count);
+    }
+}
+
+size_t PackedIntegerColumn::getBlockSize(size_t blockIndex) const
+{
+    if (blockIndex + 1 < _blocks.size()) {
+        return blockCapacity;
+    }
+    return _size - (blockIndex << blockShift);
+}
+
+void PackedIntegerColumn::unpack(size_t blockIndex, void * dest) const
+{
+    const Block & block = _blocks[blockIndex];
+    size_t count = getBlockSize(blockIndex);
+    if (_valueSize == sizeof(int32_t)) {
+        unpackKernels<int32_t>[block.bitWidth](block.words.get(), block.reference, count, static_cast<int32_t *>(dest));
+    } else {
+        unpackKernels<int64_t>[block.bitWidth](block.words.get(), block.reference, count, static_cast<int64_t *>(dest));
+    }
+}
+
+void PackedIntegerColumn::describeBlock(size_t blockIndex, BlockDescriptor & descriptor) const
+{
+    const Block & block = _blocks[blockIndex];
+    descriptor.words = block.words.get();
+    descriptor.reference = block.reference;
+    descriptor.bitWidth = block.bitWidth;
+}
+
+size_t PackedIntegerColumn::getBlockWordCount(unsigned bitWidth)
+{
+    return getWordCount(bitWidth, blockCapacity);
+}
+
+size_t PackedIntegerColumn::getMemoryUsage() const
+{
+    size_t bytes = 0;
+    for (auto & block : _blocks) {
+        bytes += sizeof(Block) + getWordCount(block.bitWidth, blockCapacity)*sizeof(word_t);
+    }
+    return bytes;
+}
+
+void PackedIntegerColumn::pack(Block & block, const int64_t * values, size_t count)
+{
+    int64_t min = 0, max = 0;
+    if (count > 0) {
+        auto [minIt, maxIt] = std::minmax_element(values, values + count);
+        min = *minIt;
+        max = *maxIt;
+    }
+
+    word_t range = static_cast<word_t>(max) - static_cast<word_t>(min);
+    unsigned bitWidth = 0;
+    while (bitWidth < wordBits && (range >> bitWidth) != 0) {
+        bitWidth += 1;
+    }
+
+    block.reference = min;
+    block.bitWidth = bitWidth;
+    block.words.reset(new word_t[getWordCount(bitWidth, blockCapacity)]());
+    for (size_t i = 0; i < count; ++i) {
+        insert(block.words.get(), bitWidth, i, static_cast<word_t>(values[i]) - static_cast<word_t>(min));
+    }
+}
+
+// wrapper functions
+void packedIntegerColumnDescribeBlock(PackedIntegerColumn * column, size_t blockIndex, PackedIntegerColumn::BlockDescriptor * descriptor)
+{
+    column->describeBlock(blockIndex, *descriptor);
+}
+
+int64_t packedIntegerColumnGet(PackedIntegerColumn * column, size_t row)
+{
+    return column->get(row);
+}
+
+void packedIntegerColumnSet(PackedIntegerColumn * column, size_t row, int64_t value)
+{
+    column->set(row, value);
+}
+
+void packedIntegerColumnSetBack(PackedIntegerColumn * column, int64_t value)
+{
+    column->set(column->size() - 1, value);
+}
+
+// generator functions
+/// \returns The delta of the value with the given index within a block of the given bit width
+static cg_u64_t genExtract(llvm::Value * words, unsigned bitWidth, cg_size_t index)
+{
+    auto & codeGen = getThreadLocalCodeGen();
+    constexpr unsigned wordBits = PackedIntegerColumn::wordBits;
+
+    if (bitWidth == 0) {
+        return cg_u64_t(0ul);
+    }
+    if (bitWidth == wordBits) {
+        llvm::Value * wordAddr = codeGen->CreateGEP(cg_u64_t::getType(), words, index.getValue());
+        return cg_u64_t( codeGen->CreateLoad(cg_u64_t::getType(), wordAddr) );
+    }
+
+    cg_size_t bit = index * cg_size_t(bitWidth);
+    cg_size_t wordIndex = bit >> cg_size_t(6);
+    cg_u64_t shift = bit & cg_size_t(wordBits - 1);
+    llvm::Value * wordAddr = codeGen->CreateGEP(cg_u64_t::getType(), words, wordIndex.getValue());
+    llvm::Value * nextAddr = codeGen->CreateGEP(cg_u64_t::getType(), wordAddr, codeGen->getInt64(1));
+    cg_u64_t word( codeGen->CreateLoad(cg_u64_t::getType(), wordAddr) );
+    cg_u64_t next( codeGen->CreateLoad(cg_u64_t::getType(), nextAddr) );
+
+    // the successor of the last word is allocated as well, shifting it twice avoids a shift by the word size
+    cg_u64_t spilled = (next << cg_u64_t(1ul)) << (cg_u64_t(wordBits - 1) - shift);
+    return ((word >> shift) | spilled) & cg_u64_t(getMask(bitWidth));
+}
+
+void genPackedIntegerColumnUnpack(PackedIntegerColumn & column, PackedIntegerColumn::BlockDescriptor & descriptor,
+        cg_size_t blockIndex, cg_size_t count, cg_voidptr_t dest)
+{
+    auto & codeGen = getThreadLocalCodeGen();
+    auto & context = codeGen.getLLVMContext();
+    auto & funcGen = codeGen.getCurrentFunctionGen();
+    constexpr unsigned wordBits = PackedIntegerColumn::wordBits;
+
+    llvm::FunctionType * funcTy = llvm::TypeBuilder<void (void *, size_t, void *), false>::get(context);
+    codeGen.CreateCall(&packedIntegerColumnDescribeBlock, funcTy,
+            {cg_voidptr_t::fromRawPointer(&column), blockIndex, cg_voidptr_t::fromRawPointer(&descriptor)});
+
+    llvm::Type * wordPtrTy = llvm::PointerType::getUnqual(cg_u64_t::getType());
+    llvm::Value * words = codeGen->CreateLoad(wordPtrTy, createPointerValue(&descriptor.words, wordPtrTy));
+    cg_u64_t reference( codeGen->CreateLoad(cg_u64_t::getType(),
+            createPointerValue(&descriptor.reference, cg_u64_t::getType())) );
+    cg_u64_t bitWidth( codeGen->CreateLoad(cg_u64_t::getType(),
+            createPointerValue(&descriptor.bitWidth, cg_u64_t::getType())) );
+
+    llvm::Type * valueTy = (column.getValueSize() == sizeof(int32_t)) ? cg_i32_t::getType() : cg_i64_t::getType();
+    llvm::Value * values = codeGen->CreatePointerCast(dest, llvm::PointerType::getUnqual(valueTy));
+
+    llvm::Function * function = funcGen.getFunction();
+    llvm::BasicBlock * unpackedBB = llvm::BasicBlock::Create(context, "unpacked");
+    llvm::SwitchInst * widthSwitch = codeGen->CreateSwitch(bitWidth.getValue(), unpackedBB, wordBits + 1);
+    for (unsigned width = 0; width <= wordBits; ++width) {
+        llvm::BasicBlock * widthBB = llvm::BasicBlock::Create(context, "unpack_width", function);
+        widthSwitch->addCase(codeGen->getInt64(width), widthBB);
+        codeGen->SetInsertPoint(widthBB);
+
+        LoopGen unpackLoop(funcGen, count != cg_size_t(0ul), {{"index", cg_size_t(0ul)}});
+        cg_size_t index(unpackLoop.getLoopVar(0));
+        {
+            LoopBodyGen bodyGen(unpackLoop);
+
+            cg_u64_t value = reference + genExtract(words, width, index);
+            llvm::Value * valueAddr = codeGen->CreateGEP(valueTy, values, index.getValue());
+            codeGen->CreateStore(codeGen->CreateTrunc(value, valueTy), valueAddr);
+        }
+        cg_size_t nextIndex = index + 1ul;
+        unpackLoop.loopDone(nextIndex < count, {nextIndex});
+        codeGen->CreateBr(unpackedBB);
+    }
+
+    function->getBasicBlockList().push_back(unpackedBB);
+    codeGen->SetInsertPoint(unpackedBB);
+}
+
+cg_i64_t genPackedIntegerColumnGetCall(PackedIntegerColumn & column, cg_size_t row)
+{
+    auto & codeGen = getThreadLocalCodeGen();
+    auto & context = codeGen.getLLVMContext();
+
+    llvm::FunctionType * funcTy = llvm::TypeBuilder<int64_t (void *, size_t), false>::get(context);
+    llvm::CallInst * result = codeGen.CreateCall(&packedIntegerColumnGet, funcTy,
+            {cg_voidptr_t::fromRawPointer(&column), row});
+
+    return cg_i64_t( llvm::cast<llvm::Value>(result) );
+}
+
+void genPackedIntegerColumnSetCall(PackedIntegerColumn & column, cg_size_t row, const Sql::Value & value)
+{
+    auto & codeGen = getThreadLocalCodeGen();
+    auto & context = codeGen.getLLVMContext();
+
+    llvm::Value * widened = codeGen->CreateSExt(value.getLLVMValue(), cg_i64_t::getType());
+    llvm::FunctionType * funcTy = llvm::TypeBuilder<void (void *, size_t, int64_t), false>::get(context);
+    codeGen.CreateCall(&packedIntegerColumnSet, funcTy, {cg_voidptr_t::fromRawPointer(&column), row, widened});
+}
+
+void genPackedIntegerColumnSetBackCall(PackedIntegerColumn & column, const Sql::Value & value)
+{
+    auto & codeGen = getThreadLocalCodeGen();
+    auto & context = codeGen.getLLVMContext();
+
+    llvm::Value * widened = codeGen->CreateSExt(value.getLLVMValue(), cg_i64_t::getType());
+    llvm::FunctionType * funcTy = llvm::TypeBuilder<void (void *, int64_t), false>::get(context);
+    codeGen.CreateCall(&packedIntegerColumnSetBack, funcTy, {cg_voidptr_t::fromRawPointer(&column), widened});
+}
@@ -0,0 +1,119 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "codegen/CodeGen.hpp"
+#include "foundations/Vector.hpp"
+#include "sql/SqlType.hpp"
+#include "sql/SqlValues.hpp"
+
+//-----------------------------------------------------------------------------
+// PackedIntegerColumn
+
+/// Integer column compressed by frame-of-reference and bit-packing
+///
+/// The rows are split into blocks which cover exactly one scan chunk. Each block stores the
+/// difference of its values to the block minimum (the reference) using the smallest bit width
+/// which fits the block's range. The last block receives appended values at full width and is
+/// packed as soon as the next block is started.
+class PackedIntegerColumn {
+public:
+    using word_t = uint64_t;
+
+    static constexpr unsigned wordBits = 64;
+
+    /// log2 of the number of values per block
+    static constexpr unsigned blockShift = Vector::defaultChunkShift;
+    static constexpr size_t blockCapacity = static_cast<size_t>(1) << blockShift;
+
+    struct Block {
+        int64_t reference = 0;
+        unsigned bitWidth = wordBits;
+        std::unique_ptr<word_t[]> words;
+    };
+
+    /// Location and encoding of a block, which generated code reads to unpack the block
+    struct BlockDescriptor {
+        const word_t * words = nullptr;
+        int64_t reference = 0;
+        uint64_t bitWidth = wordBits;
+    };
+
+    /// \param type Either an Integer or a LongInteger type
+    PackedIntegerColumn(Sql::SqlType type);
+
+    Sql::SqlType getType() const { return _type; }
+
+    /// \returns The size of a single unpacked value
+    size_t getValueSize() const { return _valueSize; }
+
+    void push_back(int64_t value);
+
+    void pop_back();
+
+    void remove_at(size_t row);
+
+    int64_t get(size_t row) const;
+
+    void set(size_t row, int64_t value);
+
+    size_t size() const { return _size; }
+
+    size_t getBlockCount() const { return _blocks.size(); }
+
+    const Block & getBlock(size_t blockIndex) const { return _blocks[blockIndex]; }
+
+    /// \returns The number of values within the given block
+    size_t getBlockSize(size_t blockIndex) const;
+
+    /// \brief Writes the values of the given block at full width (getValueSize()) to dest
+    void unpack(size_t blockIndex, void * dest) const;
+
+    void describeBlock(size_t blockIndex, BlockDescriptor & descriptor) const;
+
+    /// \returns The number of bytes occupied by the packed values
+    size_t getMemoryUsage() const;
+
+    /// \returns The number of words allocated for a block with the given bit width
+    static size_t getBlockWordCount(unsigned bitWidth);
+
+private:
+    friend class Snapshot;
+
+    /// \brief Packs the given values with the smallest possible bit width
+    void pack(Block & block, const int64_t * values, size_t count);
+
+    Sql::SqlType _type;
+    size_t _valueSize;
+    size_t _size = 0;
+    std::vector<Block> _blocks;
+};
+
+// wrapper functions
+extern "C" {
+void packedIntegerColumnDescribeBlock(PackedIntegerColumn * column, size_t blockIndex, PackedIntegerColumn::BlockDescriptor * descriptor);
+int64_t packedIntegerColumnGet(PackedIntegerColumn * column, size_t row);
+void packedIntegerColumnSet(PackedIntegerColumn * column, size_t row, int64_t value);
+void packedIntegerColumnSetBack(PackedIntegerColumn * column, int64_t value);
+}
+
+// generator functions
+
+/// \brief Unpacks the first count values of the block with the given index into dest at full width
+///
+/// The block is described into the given descriptor, which has to outlive the generated code. Its bit width is only
+/// known at runtime, hence a loop with constant shift amounts is generated for each width like the unpack kernels.
+void genPackedIntegerColumnUnpack(PackedIntegerColumn & column, PackedIntegerColumn::BlockDescriptor & descriptor,
+        cg_size_t blockIndex, cg_size_t count, cg_voidptr_t dest);
+
+/// \returns The value of the given row widened to 64 bit
+cg_i64_t genPackedIntegerColumnGetCall(PackedIntegerColumn & column, cg_size_t row);
+
+/// \brief Overwrites the value of the given row
+void genPackedIntegerColumnSetCall(PackedIntegerColumn & column, cg_size_t row, const Sql::Value & value);
+
+/// \brief Overwrites the value of the last row
+void genPackedIntegerColumnSetBackCall(PackedIntegerColumn & column, const Sql::Value & value);
@@ -0,0 +1,138 @@
+#include "foundations/SlabAllocator.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+#include <stdexcept>
+
+#include "utils/general.hpp"
+
+constexpr size_t SlabAllocator::slabSize;
+
+SlabAllocator::SlabAllocator(size_t elementSize, const AllocationPolicy & policy) :
+        _policy(policy)
+{
+    // released elements hold the link of the free list
+    _elementSize = std::max(elementSize, sizeof(void *));
+    _elementSize = (_elementSize + alignof(std::max_align_t) - 1) & ~(alignof(std::max_align_t) - 1);
+    _slabCapacity = static_cast<uint32_t>(std::max<size_t>(1, slabSize/_elementSize));
+}
+
+SlabAllocator::~SlabAllocator()
+{
+    for (auto & [begin, slab] : _slabs) {
+        Allocator::instance().release(slab.data, _slabCapacity*_elementSize);
+    }
+}
+
+SlabAllocator::Slab * SlabAllocator::allocateSlab(uint32_t bin)
+{
+    Slab slab;
+    slab.data = static_cast<uint8_t *>(Allocator::instance().allocate(_slabCapacity*_elementSize, _policy));
+    slab.bin = bin;
+    return &_slabs.emplace(slab.data, slab).first->second;
+}
+
+void SlabAllocator::releaseSlab(Slab * slab)
+{
+    Allocator::instance().release(slab->data, _slabCapacity*_elementSize);
+    _slabs.erase(slab->data);
+}
+
+void * SlabAllocator::allocate(size_t size, uint32_t bin)
+{
+    if (unlikely(size > _elementSize)) {
+        void * ptr = std::malloc(size);
+        if (ptr == nullptr) {
+            throw std::runtime_error("allocation failed");
+        }
+        std::lock_guard<std::mutex> lock(_mutex);
+        _oversizedElements += 1;
+        _allocations += 1;
+        return ptr;
+    }
+
+    std::lock_guard<std::mutex> lock(_mutex);
+    Bin & binState = _bins[bin];
+    Slab * slab = binState.current;
+    if (slab == nullptr || (slab->freeList == nullptr && slab->bumped == _slabCapacity)) {
+        // continue with a slab of the same bin which has room again before allocating a fresh one
+        if (!binState.partial.empty()) {
+            slab = binState.partial.back();
+            binState.partial.pop_back();
+            slab->partial = false;
+        } else {
+            slab = allocateSlab(bin);
+        }
+        binState.current = slab;
+    }
+
+    void * ptr;
+    if (slab->freeList != nullptr) {
+        ptr = slab->freeList;
+        slab->freeList = *static_cast<void **>(ptr);
+    } else {
+        ptr = slab->data + static_cast<size_t>(slab->bumped)*_elementSize;
+        slab->bumped += 1;
+    }
+    slab->live += 1;
+    _liveElements += 1;
+    _allocations += 1;
+    return ptr;
+}
+
+void SlabAllocator::release(void * ptr)
+{
+    if (ptr == nullptr) {
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(_mutex);
+    _releases += 1;
+    const uint8_t * element = static_cast<const uint8_t *>(ptr);
+    auto it = _slabs.upper_bound(element);
+    if (it == _slabs.begin() || element >= std::prev(it)->first + _slabCapacity*_elementSize) {
+        _oversizedElements -= 1;
+        std::free(ptr);
+        return;
+    }
+
+    Slab & slab = std::prev(it)->second;
+    *static_cast<void **>(ptr) = slab.freeList;
+    slab.freeList = ptr;
+    slab.live -= 1;
+    _liveElements -= 1;
+
+    Bin & bin = _bins[slab.bin];
+    if (&slab == bin.current) {
+        return;
+    }
+    if (slab.live == 0) {
+        if (slab.partial) {
+            bin.partial.erase(std::find(bin.partial.begin(), bin.partial.end(), &slab));
+        }
+        releaseSlab(&slab);
+    } else if (!slab.partial) {
+        slab.partial = true;
+        bin.partial.push_back(&slab);
+    }
+}
+
+void SlabAllocator::setAllocationPolicy(const AllocationPolicy & policy)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    _policy = policy;
+}
+
+SlabAllocator::Stats SlabAllocator::getStats() const
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    Stats stats;
+    stats.elementSize = _elementSize;
+    stats.slabCount = _slabs.size();
+    stats.reservedBytes = _slabs.size()*_slabCapacity*_elementSize;
+    stats.liveElements = _liveElements;
+    stats.oversizedElements = _oversizedElements;
+    stats.allocations = _allocations;
+    stats.releases = _releases;
+    return stats;
+}
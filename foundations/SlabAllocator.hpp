@@ -0,0 +1,80 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#include "foundations/Allocator.hpp"
+
+//-----------------------------------------------------------------------------
+// SlabAllocator
+
+/// Allocator of equally sized elements, e.g. the version chain elements of a table
+///
+/// Elements are carved out of slabs of slabSize bytes. Every allocation names a bin (e.g. the branch
+/// of a version), each bin allocates from slabs of its own, so that the elements of a bin are placed
+/// next to each other. Released elements are reused by their slab; slabs without any element left
+/// are returned to the Allocator. Allocations exceeding the element size are forwarded to malloc.
+class SlabAllocator {
+public:
+    static constexpr size_t slabSize = 64 << 10;
+
+    struct Stats {
+        size_t elementSize;
+        size_t slabCount;
+        size_t reservedBytes;     ///< the bytes of all slabs
+        size_t liveElements;      ///< carved elements which have not been released yet
+        size_t oversizedElements; ///< live elements which have been served by malloc
+        uint64_t allocations;
+        uint64_t releases;
+    };
+
+    SlabAllocator(size_t elementSize, const AllocationPolicy & policy);
+
+    ~SlabAllocator();
+
+    void * allocate(size_t size, uint32_t bin);
+
+    void release(void * ptr);
+
+    /// \brief Sets the policy of all slabs which are allocated from now on
+    void setAllocationPolicy(const AllocationPolicy & policy);
+
+    size_t getElementSize() const { return _elementSize; }
+
+    Stats getStats() const;
+
+private:
+    struct Slab {
+        uint8_t * data;
+        uint32_t bin;
+        uint32_t bumped = 0;  // the count of elements handed out by bump allocation
+        uint32_t live = 0;
+        bool partial = false; // whether the slab is listed as partial slab of its bin
+        void * freeList = nullptr;
+    };
+
+    struct Bin {
+        Slab * current = nullptr;
+        std::vector<Slab *> partial; // slabs with released elements
+    };
+
+    Slab * allocateSlab(uint32_t bin);
+
+    void releaseSlab(Slab * slab);
+
+    size_t _elementSize;
+    uint32_t _slabCapacity;
+    AllocationPolicy _policy;
+
+    mutable std::mutex _mutex;
+    std::map<const uint8_t *, Slab> _slabs; // begin -> slab
+    std::unordered_map<uint32_t, Bin> _bins;
+    size_t _liveElements = 0;
+    size_t _oversizedElements = 0;
+    uint64_t _allocations = 0;
+    uint64_t _releases = 0;
+};
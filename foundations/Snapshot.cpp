@@ -0,0 +1,829 @@
+#include "foundations/Snapshot.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#ifndef MAP_FIXED_NOREPLACE
+#define MAP_FIXED_NOREPLACE 0x100000
+#endif
+
+#include "codegen/CodeGen.hpp"
+#include "foundations/Database.hpp"
+#include "foundations/StringPool.hpp"
+#include "foundations/version_management.hpp"
+#include "native/sql/SqlValues.hpp"
+
+namespace {
+
+constexpr char snapshotMagic[8] = { 'T', 'A', 'R', 'D', 'I', 'S', 'S', 'N' };
+constexpr uint32_t snapshotFormatVersion = 5;
+
+/// Data blocks start at page boundaries, so that copy-on-write never spans two chunks
+constexpr uint64_t dataAlignment = 4096;
+
+/// The address at which snapshots are mapped unless the range is taken;
+/// far below the region in which Linux places mappings by default
+constexpr uint64_t preferredSnapshotBase = static_cast<uint64_t>(1) << 45;
+
+struct SnapshotHeader {
+    char magic[8];
+    uint32_t formatVersion;
+    uint32_t reserved;
+    uint64_t metadataOffset;
+    uint64_t metadataSize;
+    uint64_t preferredBase; // the stored pointers are valid if the file is mapped at this address
+};
+
+/// Out-of-line Text values: { begin pointer tagged by the leftmost bit, end pointer }
+constexpr uintptr_t textTag = static_cast<uintptr_t>(1) << (8*sizeof(uintptr_t) - 1);
+
+/// Chain pointers are stored as 0 (nullptr), 1 (the version entry) or 2 + storage index
+constexpr uint32_t nullReference = 0;
+constexpr uint32_t versionEntryReference = 1;
+constexpr uint32_t firstStorageReference = 2;
+
+/// \returns The offsets of the Text values within a version record which holds the columns of the given mask
+std::vector<size_t> getVersionTextOffsets(const Table & table, uint64_t columnMask)
+{
+    std::vector<size_t> offsets;
+    auto tupleType = table.getTupleType();
+    for (size_t i = 0; i < tupleType.size(); ++i) {
+        if (tupleType[i].typeID == Sql::SqlType::TypeID::TextID && has_column_value(columnMask, i)) {
+            offsets.push_back(table.getVersionValueOffset(columnMask, i));
+        }
+    }
+    return offsets;
+}
+
+bool hasTextValues(ci_p_t ci)
+{
+    return ci->type.typeID == Sql::SqlType::TypeID::TextID && ci->encoding == ColumnInformation::Encoding::Plain;
+}
+
+/// \returns Whether the version entry holds nothing but the fields of a freshly inserted tuple
+bool hasEmptyChain(const VersionEntry & versionEntry)
+{
+    return versionEntry.first == &versionEntry && versionEntry.prev == nullptr && versionEntry.next == nullptr &&
+            versionEntry.next_in_branch == nullptr && versionEntry.branch_visibility.getWordCount() == 1;
+}
+
+} // end anonymous namespace
+
+//-----------------------------------------------------------------------------
+// Snapshot::Writer
+
+class Snapshot::Writer {
+public:
+    Writer(const std::string & path) :
+            _out(path, std::ios::binary | std::ios::trunc)
+    {
+        if (!_out) {
+            throw std::runtime_error("cannot create snapshot '" + path + "'");
+        }
+        // the header is written last
+        _offset = sizeof(SnapshotHeader);
+    }
+
+    template<typename T>
+    void put(const T & value)
+    {
+        static_assert(std::is_trivially_copyable<T>::value, "only trivial types can be serialized");
+        putBytes(&value, sizeof(T));
+    }
+
+    void putBytes(const void * data, size_t size)
+    {
+        _metadata.append(static_cast<const char *>(data), size);
+    }
+
+    void putString(const std::string & str)
+    {
+        put<uint64_t>(str.size());
+        putBytes(str.data(), str.size());
+    }
+
+    /// \returns The file offset of the next data block
+    uint64_t beginData()
+    {
+        _offset = (_offset + dataAlignment - 1) & ~(dataAlignment - 1);
+        _out.seekp(static_cast<std::streamoff>(_offset));
+        return _offset;
+    }
+
+    /// \returns The address which the given file offset has if the snapshot is mapped at its preferred base
+    uint64_t getAddress(uint64_t offset) const
+    {
+        return preferredSnapshotBase + offset;
+    }
+
+    void writeData(const void * data, size_t size)
+    {
+        _out.write(static_cast<const char *>(data), static_cast<std::streamsize>(size));
+        _offset += size;
+    }
+
+    /// \brief Appends a data block; the reserved space beyond size remains a hole
+    uint64_t appendData(const void * data, size_t size, size_t reservedSize)
+    {
+        assert(size <= reservedSize);
+        uint64_t offset = beginData();
+        writeData(data, size);
+        _offset = offset + reservedSize;
+        return offset;
+    }
+
+    /// \brief Writes all strings of the StringPool into one data block
+    void writeStrings(const StringPool & pool)
+    {
+        for (auto & [begin, size] : pool.getRanges()) {
+            _ranges.push_back({ begin, size, 0 });
+        }
+        std::sort(_ranges.begin(), _ranges.end(), [](const Range & lhs, const Range & rhs) {
+            return lhs.begin < rhs.begin;
+        });
+
+        uint64_t blobOffset = beginData();
+        uint64_t blobSize = 0;
+        _stringsOffset = blobOffset;
+        for (auto & range : _ranges) {
+            range.offset = blobSize;
+            writeData(range.begin, range.size);
+            blobSize += range.size;
+        }
+        put(blobOffset);
+        put(blobSize);
+    }
+
+    /// \brief Replaces the pointers of an out-of-line Text value by the ones into the mapped string block
+    void relocateText(void * value) const
+    {
+        Native::Sql::Text text(value);
+        if (text.isInplace()) {
+            return;
+        }
+
+        const uint8_t * begin = text.begin();
+        auto it = std::upper_bound(_ranges.begin(), _ranges.end(), begin, [](const uint8_t * ptr, const Range & range) {
+            return ptr < range.begin;
+        });
+        if (it == _ranges.begin() || begin > (it - 1)->begin + (it - 1)->size) {
+            throw std::runtime_error("text value outside of the StringPool");
+        }
+        --it;
+        uint64_t address = getAddress(_stringsOffset + it->offset + static_cast<uint64_t>(begin - it->begin));
+
+        uintptr_t * words = static_cast<uintptr_t *>(value);
+        words[0] = static_cast<uintptr_t>(address) | textTag;
+        words[1] = static_cast<uintptr_t>(address + text.length());
+    }
+
+    void finish()
+    {
+        SnapshotHeader header = {};
+        std::memcpy(header.magic, snapshotMagic, sizeof(snapshotMagic));
+        header.formatVersion = snapshotFormatVersion;
+        header.metadataOffset = beginData();
+        header.metadataSize = _metadata.size();
+        header.preferredBase = preferredSnapshotBase;
+        writeData(_metadata.data(), _metadata.size());
+
+        _out.seekp(0);
+        _out.write(reinterpret_cast<const char *>(&header), sizeof(header));
+        _out.flush();
+        if (!_out) {
+            throw std::runtime_error("writing the snapshot failed");
+        }
+    }
+
+private:
+    struct Range {
+        const uint8_t * begin;
+        size_t size;
+        uint64_t offset;
+    };
+
+    std::ofstream _out;
+    uint64_t _offset;
+    uint64_t _stringsOffset = 0;
+    std::string _metadata;
+    std::vector<Range> _ranges;
+};
+
+//-----------------------------------------------------------------------------
+// Snapshot::Reader
+
+class Snapshot::Reader {
+public:
+    Reader(uint8_t * base, size_t size, const SnapshotHeader & header) :
+            _base(base), _size(size), _delta(reinterpret_cast<uintptr_t>(base) - header.preferredBase)
+    {
+        uint64_t metadataOffset = header.metadataOffset;
+        uint64_t metadataSize = header.metadataSize;
+        _cursor = getData(metadataOffset, metadataSize);
+        _end = _cursor + metadataSize;
+    }
+
+    template<typename T>
+    T get()
+    {
+        static_assert(std::is_trivially_copyable<T>::value, "only trivial types can be deserialized");
+        T value;
+        getBytes(&value, sizeof(T));
+        return value;
+    }
+
+    void getBytes(void * dest, size_t size)
+    {
+        if (size > static_cast<size_t>(_end - _cursor)) {
+            throw std::runtime_error("truncated snapshot");
+        }
+        std::memcpy(dest, _cursor, size);
+        _cursor += size;
+    }
+
+    std::string getString()
+    {
+        auto size = get<uint64_t>();
+        if (size > static_cast<size_t>(_end - _cursor)) {
+            throw std::runtime_error("truncated snapshot");
+        }
+        std::string str(reinterpret_cast<const char *>(_cursor), size);
+        _cursor += size;
+        return str;
+    }
+
+    /// \returns The address of the given data block within the mapping
+    uint8_t * getData(uint64_t offset, uint64_t size)
+    {
+        if (offset > _size || size > _size - offset) {
+            throw std::runtime_error("truncated snapshot");
+        }
+        return _base + offset;
+    }
+
+    void setStrings(const uint8_t * begin, uint64_t size)
+    {
+        _strings = begin;
+        _stringsSize = size;
+    }
+
+    /// \returns Whether the snapshot could not be mapped at its preferred base, hence its pointers have to be adjusted
+    bool isRelocated() const
+    {
+        return _delta != 0;
+    }
+
+    /// \brief Adjusts the pointers of an out-of-line Text value to the actual location of the string block
+    void relocateText(void * value) const
+    {
+        uintptr_t * words = static_cast<uintptr_t *>(value);
+        if ((words[0] & textTag) == 0) {
+            return;
+        }
+        uintptr_t strings = reinterpret_cast<uintptr_t>(_strings) - _delta;
+        uintptr_t begin = words[0] ^ textTag;
+        uintptr_t end = words[1];
+        if (begin > end || begin < strings || end > strings + _stringsSize) {
+            throw std::runtime_error("corrupt text value within the snapshot");
+        }
+        words[0] = (begin + _delta) | textTag;
+        words[1] = end + _delta;
+    }
+
+private:
+    uint8_t * _base;
+    size_t _size;
+    uintptr_t _delta; // the actual minus the preferred base
+    const uint8_t * _cursor;
+    const uint8_t * _end;
+    const uint8_t * _strings = nullptr;
+    uint64_t _stringsSize = 0;
+};
+
+//-----------------------------------------------------------------------------
+// Snapshot
+
+Snapshot::Snapshot(uint8_t * base, size_t size) :
+        _base(base), _size(size)
+{ }
+
+Snapshot::~Snapshot()
+{
+    if (_stringArena != nullptr) {
+        StringPool::instance().removeArena(_stringArena);
+    }
+    munmap(_base, _size);
+}
+
+void Snapshot::save(Database & db, const std::string & path)
+{
+    for (auto & [name, table] : db._tables) {
+        if (table->getVersioningEngine() == Table::VersioningEngine::Pages) {
+            throw std::runtime_error("table '" + name + "' is versioned by pages, which snapshots do not support");
+        }
+    }
+
+    Writer writer(path);
+    writer.writeStrings(StringPool::instance());
+
+    saveBranches(writer, db);
+
+    writer.put<uint64_t>(db._tables.size());
+    for (auto & [name, table] : db._tables) {
+        writer.putString(name);
+        saveTable(writer, *table);
+    }
+
+    writer.finish();
+}
+
+void Snapshot::load(Database & db, const std::string & path)
+{
+    if (db.getTableCount() > 0) {
+        throw std::runtime_error("snapshots can only be loaded into an empty database");
+    }
+    if (db.getWriteAheadLog() != nullptr) {
+        // the log does not contain the snapshot's rows, which its records would address by tid after a replay
+        throw std::runtime_error("snapshots cannot be loaded while a write-ahead log is attached");
+    }
+
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        throw std::runtime_error("cannot open snapshot '" + path + "'");
+    }
+    struct stat fileStat;
+    if (fstat(fd, &fileStat) != 0 || static_cast<size_t>(fileStat.st_size) < sizeof(SnapshotHeader)) {
+        close(fd);
+        throw std::runtime_error("invalid snapshot '" + path + "'");
+    }
+    size_t size = static_cast<size_t>(fileStat.st_size);
+
+    SnapshotHeader header;
+    if (pread(fd, &header, sizeof(header), 0) != static_cast<ssize_t>(sizeof(header)) ||
+            std::memcmp(header.magic, snapshotMagic, sizeof(snapshotMagic)) != 0 ||
+            header.formatVersion != snapshotFormatVersion) {
+        close(fd);
+        throw std::runtime_error("invalid snapshot '" + path + "'");
+    }
+
+    // private mapping: modifications of the loaded tables never reach the file;
+    // at the preferred base, the stored pointers are used as they are
+    void * base = mmap(reinterpret_cast<void *>(header.preferredBase), size, PROT_READ | PROT_WRITE,
+            MAP_PRIVATE | MAP_FIXED_NOREPLACE, fd, 0);
+    if (base == MAP_FAILED) {
+        // the range is taken, e.g. by another snapshot
+        base = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+    }
+    close(fd);
+    if (base == MAP_FAILED) {
+        throw std::runtime_error("cannot map snapshot '" + path + "'");
+    }
+    std::unique_ptr<Snapshot> snapshot(new Snapshot(static_cast<uint8_t *>(base), size));
+
+    // kernels which do not know MAP_FIXED_NOREPLACE treat the address as a hint, which is covered by the relocation
+    Reader reader(snapshot->_base, size, header);
+
+    auto stringsOffset = reader.get<uint64_t>();
+    auto stringsSize = reader.get<uint64_t>();
+    const uint8_t * strings = reader.getData(stringsOffset, stringsSize);
+    reader.setStrings(strings, stringsSize);
+    StringPool::instance().addArena(strings, stringsSize);
+    snapshot->_stringArena = strings;
+
+    // the tables reference the mapping from now on
+    db._snapshots.push_back(std::move(snapshot));
+
+    loadBranches(reader, db);
+
+    auto tableCount = reader.get<uint64_t>();
+    for (uint64_t i = 0; i < tableCount; ++i) {
+        std::string name = reader.getString();
+        Table & table = db.createTable(name);
+        loadTable(reader, table);
+    }
+}
+
+void Snapshot::saveBranches(Writer & writer, Database & db)
+{
+    writer.put(db._next_branch_id);
+    writer.put<uint64_t>(db._branches.size());
+    for (auto & [id, branch] : db._branches) {
+        writer.put(branch->id);
+        writer.put(branch->parent_id);
+        writer.putString(branch->name);
+    }
+}
+
+void Snapshot::loadBranches(Reader & reader, Database & db)
+{
+    db._branches.clear();
+    db._branchMapping.clear();
+
+    db._next_branch_id = reader.get<branch_id_t>();
+    auto branchCount = reader.get<uint64_t>();
+    for (uint64_t i = 0; i < branchCount; ++i) {
+        auto branch = std::make_unique<Branch>();
+        branch->id = reader.get<branch_id_t>();
+        branch->parent_id = reader.get<branch_id_t>();
+        branch->name = reader.getString();
+        db._branchMapping[branch->name] = branch->id;
+        db._branches.insert({branch->id, std::move(branch)});
+    }
+}
+
+void Snapshot::saveTable(Writer & writer, Table & table)
+{
+    writer.put<uint64_t>(table._rowCount);
+    writer.put<uint64_t>(table._columns.size());
+    for (auto & [ci, vec] : table._columns) {
+        writer.putString(ci->columnName);
+        writer.put(ci->type);
+        writer.put(ci->encoding);
+
+        if (ci->packed != nullptr) {
+            PackedIntegerColumn & packed = *ci->packed;
+            writer.put<uint64_t>(packed._size);
+            writer.put<uint64_t>(packed._blocks.size());
+            for (auto & block : packed._blocks) {
+                writer.put(block.reference);
+                writer.put(block.bitWidth);
+                writer.putBytes(block.words.get(), PackedIntegerColumn::getBlockWordCount(block.bitWidth)*sizeof(PackedIntegerColumn::word_t));
+            }
+        } else {
+            saveVector(writer, *vec, hasTextValues(ci.get()));
+        }
+
+        if (ci->dictionary != nullptr) {
+            bool isText = ci->dictionary->getType().typeID == Sql::SqlType::TypeID::TextID;
+            saveVector(writer, ci->dictionary->_values, isText);
+        }
+
+        if (ci->zoneMap != nullptr) {
+            writer.put<uint64_t>(ci->zoneMap->_rowCount);
+            saveVector(writer, ci->zoneMap->_zones, false);
+        }
+    }
+
+    saveBitmapTable(writer, table._nullIndicatorTable);
+    saveBitmapTable(writer, table._branchBitmap);
+
+    saveVersionColumn(writer, table._version_mgmt_column, table);
+    saveVersionColumn(writer, table._dangling_version_mgmt_column, table);
+
+    writer.put<uint64_t>(table._deadRows.size());
+    for (tid_t tid : table._deadRows) {
+        writer.put<uint64_t>(tid);
+    }
+}
+
+void Snapshot::loadTable(Reader & reader, Table & table)
+{
+    auto rowCount = reader.get<uint64_t>();
+    auto columnCount = reader.get<uint64_t>();
+    for (uint64_t i = 0; i < columnCount; ++i) {
+        std::string columnName = reader.getString();
+        auto type = reader.get<Sql::SqlType>();
+        auto encoding = reader.get<ColumnInformation::Encoding>();
+        table.addColumn(columnName, type, encoding);
+        auto & [ci, vec] = table._columns.back();
+
+        if (ci->packed != nullptr) {
+            // packed blocks own their words, hence they are copied
+            PackedIntegerColumn & packed = *ci->packed;
+            packed._size = reader.get<uint64_t>();
+            auto blockCount = reader.get<uint64_t>();
+            packed._blocks.resize(blockCount);
+            for (auto & block : packed._blocks) {
+                block.reference = reader.get<int64_t>();
+                block.bitWidth = reader.get<unsigned>();
+                if (block.bitWidth > PackedIntegerColumn::wordBits) {
+                    throw std::runtime_error("corrupt packed block within the snapshot");
+                }
+                size_t wordCount = PackedIntegerColumn::getBlockWordCount(block.bitWidth);
+                block.words.reset(new PackedIntegerColumn::word_t[wordCount]);
+                reader.getBytes(block.words.get(), wordCount*sizeof(PackedIntegerColumn::word_t));
+            }
+        } else {
+            loadVector(reader, *vec, hasTextValues(ci.get()));
+        }
+
+        if (ci->dictionary != nullptr) {
+            StringDictionary & dictionary = *ci->dictionary;
+            bool isText = dictionary.getType().typeID == Sql::SqlType::TypeID::TextID;
+            loadVector(reader, dictionary._values, isText);
+            for (size_t code = 0; code < dictionary._values.size(); ++code) {
+                dictionary._codes.emplace(dictionary.toString(dictionary._values.at(code)),
+                        static_cast<StringDictionary::code_t>(code));
+            }
+        }
+
+        if (ci->zoneMap != nullptr) {
+            ci->zoneMap->_rowCount = reader.get<uint64_t>();
+            loadVector(reader, ci->zoneMap->_zones, false);
+        }
+    }
+    table._rowCount = rowCount;
+
+    loadBitmapTable(reader, table._nullIndicatorTable);
+    loadBitmapTable(reader, table._branchBitmap);
+
+    std::vector<tid_t> chainedTids = loadVersionColumn(reader, table._version_mgmt_column, table);
+    loadVersionColumn(reader, table._dangling_version_mgmt_column, table);
+
+    // the modified tuples are not part of the snapshot, hence branch scans resolve every tuple which has versions
+    while (table._modifiedTids.size() < table._branchBitmap.getColumnCount()) {
+        bool released = table._branchBitmap.isReleased(table._modifiedTids.size());
+        table._modifiedTids.push_back(released ? nullptr : std::make_shared<TidSet>());
+    }
+    for (tid_t tid : chainedTids) {
+        const VersionEntry & versionEntry = table._version_mgmt_column[tid];
+        if (versionEntry.first != &versionEntry || versionEntry.next != nullptr) {
+            table.markModified(tid, master_branch_id);
+        }
+    }
+
+    auto deadRowCount = reader.get<uint64_t>();
+    for (uint64_t i = 0; i < deadRowCount; ++i) {
+        table._deadRows.insert(table._deadRows.end(), reader.get<uint64_t>());
+    }
+}
+
+void Snapshot::saveVector(Writer & writer, const Vector & vector, bool hasText)
+{
+    size_t elementSize = vector.getElementSize();
+    size_t chunkCapacity = vector.getChunkCapacity();
+    size_t chunkBytes = elementSize*chunkCapacity;
+    size_t chunkCount = (vector.size() + chunkCapacity - 1) >> vector.getChunkShift();
+
+    writer.put<uint64_t>(elementSize);
+    writer.put<uint32_t>(vector.getChunkShift());
+    writer.put<uint64_t>(vector.size());
+    writer.put<uint64_t>(chunkCount);
+
+    // every chunk occupies its full capacity, so that the loaded vector can keep appending to the last one
+    std::vector<uint8_t> buffer;
+    for (size_t chunkIndex = 0; chunkIndex < chunkCount; ++chunkIndex) {
+        size_t usedBytes = vector.getChunkSize(chunkIndex)*elementSize;
+        const void * chunk = vector.getChunk(chunkIndex);
+        if (hasText) {
+            buffer.assign(static_cast<const uint8_t *>(chunk), static_cast<const uint8_t *>(chunk) + usedBytes);
+            for (size_t offset = 0; offset < usedBytes; offset += elementSize) {
+                writer.relocateText(buffer.data() + offset);
+            }
+            chunk = buffer.data();
+        }
+        writer.put(writer.appendData(chunk, usedBytes, chunkBytes));
+    }
+}
+
+void Snapshot::loadVector(Reader & reader, Vector & vector, bool hasText)
+{
+    auto elementSize = reader.get<uint64_t>();
+    auto chunkShift = reader.get<uint32_t>();
+    auto elementCount = reader.get<uint64_t>();
+    auto chunkCount = reader.get<uint64_t>();
+    if (elementSize != vector.getElementSize() || chunkShift != vector.getChunkShift() ||
+            elementCount > (chunkCount << chunkShift)) {
+        throw std::runtime_error("snapshot does not match the storage layout");
+    }
+
+    size_t chunkBytes = elementSize*vector.getChunkCapacity();
+    std::vector<uint8_t *> chunks(chunkCount);
+    for (uint64_t chunkIndex = 0; chunkIndex < chunkCount; ++chunkIndex) {
+        chunks[chunkIndex] = reader.getData(reader.get<uint64_t>(), chunkBytes);
+    }
+    vector.adoptChunks(chunks.data(), chunkCount, elementCount);
+
+    if (hasText && reader.isRelocated()) {
+        for (size_t i = 0; i < elementCount; ++i) {
+            reader.relocateText(vector.at(i));
+        }
+    }
+}
+
+void Snapshot::saveBitmapTable(Writer & writer, const BitmapTable & bitmap)
+{
+    writer.put<uint64_t>(bitmap._rowCount);
+    writer.put<uint64_t>(bitmap._columns.size());
+    for (auto & words : bitmap._columns) {
+        // the columns of dropped branches keep their index
+        writer.put<uint8_t>(words == nullptr);
+        if (words != nullptr) {
+            saveVector(writer, *words, false);
+        }
+    }
+}
+
+void Snapshot::loadBitmapTable(Reader & reader, BitmapTable & bitmap)
+{
+    bitmap._rowCount = reader.get<uint64_t>();
+    auto columnCount = reader.get<uint64_t>();
+    bitmap._columns.clear();
+    for (uint64_t i = 0; i < columnCount; ++i) {
+        if (reader.get<uint8_t>() != 0) {
+            bitmap._columns.push_back(nullptr);
+            continue;
+        }
+        auto words = std::make_unique<Vector>(sizeof(BitmapTable::word_t), 0, BitmapTable::wordChunkShift);
+        loadVector(reader, *words, false);
+        bitmap._columns.push_back(std::move(words));
+    }
+}
+
+void Snapshot::saveVersionColumn(Writer & writer, const VersionEntryColumn & column, Table & table)
+{
+    size_t chunkBytes = VersionEntryColumn::chunkSize*sizeof(VersionEntry);
+    size_t chunkCount = (column.size() + VersionEntryColumn::chunkSize - 1) >> VersionEntryColumn::chunkShift;
+    writer.put<uint64_t>(column.size());
+    writer.put<uint64_t>(chunkCount);
+
+    // the chunks hold the entries without their chains, which are valid as they are at the preferred base
+    std::unique_ptr<VersionEntry[]> image(new VersionEntry[VersionEntryColumn::chunkSize]);
+    std::vector<tid_t> chainedTids;
+    for (size_t chunkIndex = 0; chunkIndex < chunkCount; ++chunkIndex) {
+        tid_t begin = chunkIndex << VersionEntryColumn::chunkShift;
+        size_t count = std::min(VersionEntryColumn::chunkSize, column.size() - begin);
+        uint64_t offset = writer.beginData();
+        for (size_t i = 0; i < count; ++i) {
+            const VersionEntry & versionEntry = column[begin + i];
+            VersionEntry & entryImage = image[i];
+            entryImage.first = reinterpret_cast<void *>(writer.getAddress(offset + i*sizeof(VersionEntry)));
+            entryImage.branch_id = versionEntry.branch_id;
+            entryImage.creation_ts = versionEntry.creation_ts;
+            entryImage.branch_visibility.setWord(0, versionEntry.branch_visibility.getWord(0));
+            if (!hasEmptyChain(versionEntry)) {
+                chainedTids.push_back(begin + i);
+            }
+        }
+        writer.put(writer.appendData(image.get(), count*sizeof(VersionEntry), chunkBytes));
+    }
+
+    // the chains are restored into the mapped entries
+    writer.put<uint64_t>(chainedTids.size());
+    for (tid_t tid : chainedTids) {
+        writer.put<uint64_t>(tid);
+        saveVersionEntry(writer, column[tid], table);
+    }
+}
+
+std::vector<size_t> Snapshot::loadVersionColumn(Reader & reader, VersionEntryColumn & column, Table & table)
+{
+    auto size = reader.get<uint64_t>();
+    auto chunkCount = reader.get<uint64_t>();
+    if (size > (chunkCount << VersionEntryColumn::chunkShift)) {
+        throw std::runtime_error("snapshot does not match the storage layout");
+    }
+
+    size_t chunkBytes = VersionEntryColumn::chunkSize*sizeof(VersionEntry);
+    std::vector<VersionEntry *> chunks(chunkCount);
+    for (uint64_t chunkIndex = 0; chunkIndex < chunkCount; ++chunkIndex) {
+        chunks[chunkIndex] = reinterpret_cast<VersionEntry *>(reader.getData(reader.get<uint64_t>(), chunkBytes));
+    }
+    column.adoptChunks(chunks.data(), chunkCount, size);
+
+    if (reader.isRelocated()) {
+        for (tid_t tid = 0; tid < size; ++tid) {
+            column[tid].first = &column[tid];
+        }
+    }
+
+    auto chainedCount = reader.get<uint64_t>();
+    std::vector<tid_t> chainedTids(chainedCount);
+    for (tid_t & tid : chainedTids) {
+        tid = reader.get<uint64_t>();
+        if (tid >= size) {
+            throw std::runtime_error("corrupt version chain within the snapshot");
+        }
+        loadVersionEntry(reader, column[tid], table);
+    }
+    return chainedTids;
+}
+
+void Snapshot::saveVersionEntry(Writer & writer, const VersionEntry & versionEntry, Table & table)
+{
+    // number all chain elements which are reachable from the version entry
+    std::vector<const VersionedTupleStorage *> storages;
+    std::unordered_map<const void *, uint32_t> references;
+    auto reference = [&](const void * ptr) -> uint32_t {
+        if (ptr == nullptr) {
+            return nullReference;
+        } else if (ptr == &versionEntry) {
+            return versionEntryReference;
+        }
+        auto [it, inserted] = references.emplace(ptr, firstStorageReference + storages.size());
+        if (inserted) {
+            storages.push_back(static_cast<const VersionedTupleStorage *>(ptr));
+        }
+        return it->second;
+    };
+
+    writer.put(versionEntry.branch_id);
+    writer.put(versionEntry.creation_ts);
+    writer.put(reference(versionEntry.first));
+    writer.put(reference(versionEntry.prev));
+    writer.put(reference(versionEntry.next));
+    writer.put(reference(versionEntry.next_in_branch));
+
+    writer.put<uint64_t>(versionEntry.branch_visibility.getWordCount());
+    for (size_t i = 0; i < versionEntry.branch_visibility.getWordCount(); ++i) {
+        writer.put(versionEntry.branch_visibility.getWord(i));
+    }
+
+    // the storages vector grows while the chain is being traversed
+    std::vector<uint32_t> links;
+    for (size_t i = 0; i < storages.size(); ++i) {
+        links.push_back(reference(storages[i]->next));
+        links.push_back(reference(storages[i]->next_in_branch));
+    }
+
+    std::vector<uint8_t> record;
+    writer.put<uint64_t>(storages.size());
+    for (size_t i = 0; i < storages.size(); ++i) {
+        const VersionedTupleStorage * storage = storages[i];
+        writer.put(storage->branch_id);
+        writer.put(storage->creation_ts);
+        writer.put(links[2*i]);
+        writer.put(links[2*i + 1]);
+        writer.put(storage->column_mask);
+
+        size_t recordSize = table.getVersionRecordSize(storage->column_mask);
+        record.resize(recordSize);
+        std::memcpy(record.data(), storage->data, recordSize);
+        for (size_t offset : getVersionTextOffsets(table, storage->column_mask)) {
+            writer.relocateText(record.data() + offset);
+        }
+        writer.putBytes(record.data(), recordSize);
+    }
+}
+
+void Snapshot::loadVersionEntry(Reader & reader, VersionEntry & entry, Table & table)
+{
+    VersionEntry * versionEntry = &entry;
+    versionEntry->branch_id = reader.get<branch_id_t>();
+    versionEntry->creation_ts = reader.get<branch_id_t>();
+    uint32_t first = reader.get<uint32_t>();
+    uint32_t prev = reader.get<uint32_t>();
+    uint32_t next = reader.get<uint32_t>();
+    uint32_t nextInBranch = reader.get<uint32_t>();
+
+    auto wordCount = reader.get<uint64_t>();
+    for (uint64_t i = 0; i < wordCount; ++i) {
+        versionEntry->branch_visibility.setWord(i, reader.get<uint64_t>());
+    }
+
+    // chain elements are freed by destroy_chain(), hence they are allocated by the table
+    auto storageCount = reader.get<uint64_t>();
+    std::vector<VersionedTupleStorage *> storages(storageCount);
+    std::vector<uint32_t> links(2*storageCount);
+    for (uint64_t i = 0; i < storageCount; ++i) {
+        auto branchId = reader.get<branch_id_t>();
+        auto creationTs = reader.get<branch_id_t>();
+        links[2*i] = reader.get<uint32_t>();
+        links[2*i + 1] = reader.get<uint32_t>();
+        auto columnMask = reader.get<uint64_t>();
+
+        size_t recordSize = table.getVersionRecordSize(columnMask);
+        void * mem = table.allocateVersion(sizeof(VersionedTupleStorage) + recordSize, branchId);
+        VersionedTupleStorage * storage = new (mem) VersionedTupleStorage();
+        storages[i] = storage;
+        storage->branch_id = branchId;
+        storage->creation_ts = creationTs;
+        storage->column_mask = columnMask;
+        reader.getBytes(storage->data, recordSize);
+        for (size_t offset : getVersionTextOffsets(table, columnMask)) {
+            reader.relocateText(storage->data + offset);
+        }
+    }
+
+    auto resolve = [&](uint32_t reference) -> void * {
+        if (reference == nullReference) {
+            return nullptr;
+        } else if (reference == versionEntryReference) {
+            return versionEntry;
+        } else if (reference - firstStorageReference < storageCount) {
+            return storages[reference - firstStorageReference];
+        }
+        throw std::runtime_error("corrupt version chain within the snapshot");
+    };
+    versionEntry->first = resolve(first);
+    versionEntry->prev = resolve(prev);
+    versionEntry->next = resolve(next);
+    versionEntry->next_in_branch = static_cast<VersionedTupleStorage *>(resolve(nextInBranch));
+    for (uint64_t i = 0; i < storageCount; ++i) {
+        storages[i]->next = resolve(links[2*i]);
+        storages[i]->next_in_branch = resolve(links[2*i + 1]);
+    }
+    // the heads are not part of the snapshot
+    rebuild_branch_heads(versionEntry);
+}
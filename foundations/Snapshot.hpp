@@ -0,0 +1,72 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+class BitmapTable;
+class Database;
+class Table;
+class Vector;
+struct VersionEntry;
+class VersionEntryColumn;
+
+//-----------------------------------------------------------------------------
+// Snapshot
+
+/// Memory-mapped on-disk image of a whole database
+///
+/// Column chunks, bitmap words, zones, version entries and strings are stored page-aligned in the data section
+/// of the file, everything else (schema, branches, version chains, dictionaries and packed blocks)
+/// is serialized into the trailing metadata section. Loading maps the file privately (copy-on-write)
+/// and lets the restored vectors borrow their chunks from the mapping, hence only the metadata is
+/// deserialized. The stored pointers (out-of-line Text values, version entries) assume that the file is
+/// mapped at its preferred base; only if that range is taken, they are relocated in place.
+class Snapshot {
+public:
+    ~Snapshot();
+
+    Snapshot(const Snapshot &) = delete;
+    Snapshot & operator=(const Snapshot &) = delete;
+
+    /// \brief Writes all tables, branches and the StringPool of the given database to the file
+    static void save(Database & db, const std::string & path);
+
+    /// \brief Restores the snapshot into the given database, which must not contain any table
+    ///
+    /// The snapshot is not logged, hence the database must not have a write-ahead log attached.
+    static void load(Database & db, const std::string & path);
+
+    size_t getSize() const { return _size; }
+
+private:
+    class Writer;
+    class Reader;
+
+    Snapshot(uint8_t * base, size_t size);
+
+    static void saveBranches(Writer & writer, Database & db);
+    static void loadBranches(Reader & reader, Database & db);
+
+    static void saveTable(Writer & writer, Table & table);
+    static void loadTable(Reader & reader, Table & table);
+
+    static void saveVector(Writer & writer, const Vector & vector, bool hasText);
+    static void loadVector(Reader & reader, Vector & vector, bool hasText);
+
+    static void saveBitmapTable(Writer & writer, const BitmapTable & bitmap);
+    static void loadBitmapTable(Reader & reader, BitmapTable & bitmap);
+
+    static void saveVersionColumn(Writer & writer, const VersionEntryColumn & column, Table & table);
+    /// \returns The tids of the restored version chains
+    static std::vector<size_t> loadVersionColumn(Reader & reader, VersionEntryColumn & column, Table & table);
+
+    static void saveVersionEntry(Writer & writer, const VersionEntry & versionEntry, Table & table);
+    static void loadVersionEntry(Reader & reader, VersionEntry & versionEntry, Table & table);
+
+    uint8_t * _base;
+    size_t _size;
+    const uint8_t * _stringArena = nullptr;
+};
@@ -0,0 +1,185 @@
+#include "foundations/StringDictionary.hpp"
+
+#include <cassert>
+#include <cstring>
+#include <stdexcept>
+#include <vector>
+
+#include <llvm/IR/IRBuilder.h>
+#include <llvm/IR/TypeBuilder.h>
+
+#include "foundations/exceptions.hpp"
+#include "native/sql/SqlValues.hpp"
+#include "utils/general.hpp"
+
+using namespace Sql;
+
+//-----------------------------------------------------------------------------
+// StringDictionary
+
+StringDictionary::StringDictionary(SqlType type) :
+        _type(toNotNullableTy(type)),
+        _values(Sql::getValueSize(toNotNullableTy(type)))
+{
+    if (type.typeID != SqlType::TypeID::TextID && type.typeID != SqlType::TypeID::VarcharID) {
+        throw InvalidOperationException("dictionary encoding requires a Text or Varchar column");
+    }
+}
+
+StringDictionary::code_t StringDictionary::encode(const void * value)
+{
+    auto [it, inserted] = _codes.emplace(toString(value), static_cast<code_t>(_values.size()));
+    if (!inserted) {
+        return it->second;
+    }
+
+    if (unlikely(it->second == invalid_code)) {
+        _codes.erase(it);
+        throw std::runtime_error("dictionary is full");
+    }
+
+    // long Text values reference the StringPool, hence copying the representation is sufficient
+    std::memcpy(_values.reserve_back(), value, _values.getElementSize());
+    return it->second;
+}
+
+StringDictionary::code_t StringDictionary::encode(const std::string & str)
+{
+    auto it = _codes.find(str);
+    if (it != _codes.end()) {
+        return it->second;
+    }
+
+    // construct the regular storage layout of the string
+    std::vector<uint8_t> buffer(_values.getElementSize(), 0);
+    if (_type.typeID == SqlType::TypeID::TextID) {
+        auto text = Native::Sql::Text::castString(str);
+        text->store(buffer.data());
+    } else {
+        if (str.size() > _type.length) {
+            throw std::runtime_error("type mismatch");
+        }
+        size_t offset = (_type.length < 256) ? sizeof(uint8_t) : (_type.length < 65536) ? sizeof(uint16_t) : sizeof(uint32_t);
+        uint32_t length = static_cast<uint32_t>(str.size());
+        std::memcpy(buffer.data(), &length, offset); // little endian
+        std::memcpy(buffer.data() + offset, str.data(), str.size());
+    }
+    return encode(buffer.data());
+}
+
+StringDictionary::code_t StringDictionary::lookup(const std::string & str) const
+{
+    auto it = _codes.find(str);
+    if (it == _codes.end()) {
+        return invalid_code;
+    }
+    return it->second;
+}
+
+StringDictionary::code_t StringDictionary::lookup(const void * value) const
+{
+    return lookup(toString(value));
+}
+
+std::string StringDictionary::toString(const void * value) const
+{
+    if (_type.typeID == SqlType::TypeID::TextID) {
+        Native::Sql::Text text(value);
+        return std::string(text.getView());
+    }
+
+    // Varchar: { length indicator, char[capacity] }
+    const uint8_t * bytes = static_cast<const uint8_t *>(value);
+    size_t length;
+    size_t offset;
+    if (_type.length < 256) {
+        length = bytes[0];
+        offset = sizeof(uint8_t);
+    } else if (_type.length < 65536) {
+        uint16_t len16;
+        std::memcpy(&len16, bytes, sizeof(uint16_t));
+        length = len16;
+        offset = sizeof(uint16_t);
+    } else {
+        uint32_t len32;
+        std::memcpy(&len32, bytes, sizeof(uint32_t));
+        length = len32;
+        offset = sizeof(uint32_t);
+    }
+    assert(length <= _type.length);
+    return std::string(reinterpret_cast<const char *>(bytes + offset), length);
+}
+
+// wrapper functions
+uint32_t stringDictionaryEncode(StringDictionary * dictionary, const void * value)
+{
+    return dictionary->encode(value);
+}
+
+uint32_t stringDictionaryLookup(StringDictionary * dictionary, const void * value)
+{
+    return dictionary->lookup(value);
+}
+
+// generator functions
+StringDictionary::cg_code_t genStringDictionaryEncodeCall(StringDictionary & dictionary, cg_voidptr_t value)
+{
+    auto & codeGen = getThreadLocalCodeGen();
+    auto & context = codeGen.getLLVMContext();
+
+    llvm::FunctionType * funcTy = llvm::TypeBuilder<uint32_t (void *, void *), false>::get(context);
+    llvm::CallInst * result = codeGen.CreateCall(&stringDictionaryEncode, funcTy,
+            {cg_voidptr_t::fromRawPointer(&dictionary), value});
+
+    return StringDictionary::cg_code_t( llvm::cast<llvm::Value>(result) );
+}
+
+/// \returns The address of the given value in its regular storage layout
+static cg_voidptr_t genMaterializeValue(const StringDictionary & dictionary, const Sql::Value & value)
+{
+    auto & codeGen = getThreadLocalCodeGen();
+
+    // materialize the value within the entry block, so that repeated calls do not grow the stack
+    llvm::BasicBlock & entryBlock = codeGen.getCurrentFunctionGen().getFunction()->getEntryBlock();
+    llvm::IRBuilder<> entryBuilder(&entryBlock, entryBlock.begin());
+    llvm::Value * valuePtr = entryBuilder.CreateAlloca(toLLVMTy(dictionary.getType()));
+    value.store(valuePtr);
+
+    return cg_voidptr_t( codeGen->CreatePointerCast(valuePtr, cg_voidptr_t::getType()) );
+}
+
+StringDictionary::cg_code_t genStringDictionaryEncode(StringDictionary & dictionary, const Sql::Value & value)
+{
+    auto & str = static_cast<const BasicString &>(value);
+    if (str.getDictionary() == &dictionary) {
+        return StringDictionary::cg_code_t( str.getDictionaryCode() );
+    }
+
+    return genStringDictionaryEncodeCall(dictionary, genMaterializeValue(dictionary, value));
+}
+
+StringDictionary::cg_code_t genStringDictionaryLookup(StringDictionary & dictionary, const Sql::Value & value)
+{
+    auto & codeGen = getThreadLocalCodeGen();
+    auto & context = codeGen.getLLVMContext();
+
+    auto & str = static_cast<const BasicString &>(value);
+    if (str.getDictionary() == &dictionary) {
+        return StringDictionary::cg_code_t( str.getDictionaryCode() );
+    }
+
+    llvm::FunctionType * funcTy = llvm::TypeBuilder<uint32_t (void *, void *), false>::get(context);
+    llvm::CallInst * result = codeGen.CreateCall(&stringDictionaryLookup, funcTy,
+            {cg_voidptr_t::fromRawPointer(&dictionary), genMaterializeValue(dictionary, value)});
+
+    return StringDictionary::cg_code_t( llvm::cast<llvm::Value>(result) );
+}
+
+cg_voidptr_t genStringDictionaryDecode(const StringDictionary & dictionary, StringDictionary::cg_code_t code)
+{
+    auto & codeGen = getThreadLocalCodeGen();
+
+    // the values are chunked, so their addresses remain valid while the dictionary grows
+    cg_size_t index( codeGen->CreateZExt(code, cg_size_t::getType()) );
+    return genVectorElementPtr(dictionary.getValues(), index);
+}
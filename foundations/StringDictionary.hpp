@@ -0,0 +1,89 @@
+#pragma once
+
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <unordered_map>
+
+#include "codegen/CodeGen.hpp"
+#include "foundations/Vector.hpp"
+#include "sql/SqlType.hpp"
+#include "sql/SqlValues.hpp"
+
+//-----------------------------------------------------------------------------
+// StringDictionary
+
+/// Per-column dictionary for low- to medium-cardinality strings (Text and Varchar)
+///
+/// A dictionary-encoded column stores fixed-width codes instead of the values themselves.
+/// The distinct values are kept in their regular storage layout, so the address obtained
+/// by decoding a code can be loaded like any other column value.
+class StringDictionary {
+public:
+    using code_t = uint32_t;
+    using cg_code_t = cg_u32_t;
+
+    static constexpr code_t invalid_code = std::numeric_limits<code_t>::max();
+
+    StringDictionary(Sql::SqlType type);
+
+    /// \param value The value in its regular storage layout
+    /// \returns The code of the given value; unknown values are added to the dictionary
+    code_t encode(const void * value);
+
+    /// \brief Encodes the given string; unknown values are added to the dictionary
+    code_t encode(const std::string & str);
+
+    /// \returns The code of the given string or invalid_code if the dictionary does not contain it
+    code_t lookup(const std::string & str) const;
+
+    /// \param value The value in its regular storage layout
+    /// \returns The code of the given value or invalid_code if the dictionary does not contain it
+    code_t lookup(const void * value) const;
+
+    /// \returns The address of the value with the given code
+    const void * decode(code_t code) const { return _values.at(code); }
+
+    /// \returns The number of distinct values
+    size_t size() const { return _values.size(); }
+
+    Sql::SqlType getType() const { return _type; }
+
+    /// \returns The size of a single decoded value
+    size_t getValueSize() const { return _values.getElementSize(); }
+
+    const Vector & getValues() const { return _values; }
+
+    void setAllocationPolicy(const AllocationPolicy & policy) { _values.setAllocationPolicy(policy); }
+
+private:
+    friend class Snapshot;
+
+    std::string toString(const void * value) const;
+
+    Sql::SqlType _type;
+    Vector _values;
+    std::unordered_map<std::string, code_t> _codes;
+};
+
+// wrapper functions
+extern "C" {
+uint32_t stringDictionaryEncode(StringDictionary * dictionary, const void * value);
+uint32_t stringDictionaryLookup(StringDictionary * dictionary, const void * value);
+}
+
+// generator functions
+
+/// \brief Encodes the value at the given address at runtime
+StringDictionary::cg_code_t genStringDictionaryEncodeCall(StringDictionary & dictionary, cg_voidptr_t value);
+
+/// \returns The code of the given value; the attached code is used if the value has been loaded from this dictionary
+StringDictionary::cg_code_t genStringDictionaryEncode(StringDictionary & dictionary, const Sql::Value & value);
+
+/// \returns The code of the given value or invalid_code if the dictionary does not contain it
+///
+/// Unlike genStringDictionaryEncode(), this never adds values to the dictionary.
+StringDictionary::cg_code_t genStringDictionaryLookup(StringDictionary & dictionary, const Sql::Value & value);
+
+/// \brief Computes the address of the value with the given code
+cg_voidptr_t genStringDictionaryDecode(const StringDictionary & dictionary, StringDictionary::cg_code_t code);
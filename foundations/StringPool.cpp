@@ -1,21 +1,18 @@
 #include "foundations/StringPool.hpp"
 
+#include <algorithm>
 #include <cstring>
-#include "utils/hashing.hpp"
 
-using namespace HashUtils;
+/// Out-of-line Text values: { begin pointer tagged by the leftmost bit, end pointer }
+static constexpr uintptr_t textTag = static_cast<uintptr_t>(1) << (8*sizeof(uintptr_t) - 1);
 
-size_t SqlStringHash::operator()(const sql_string_t & str) const {
-    return hashByteArray(str.second.get(), str.first);
-}
-
-bool SqlStringEqual::operator()(const sql_string_t & str1, const sql_string_t & str2) const {
-    // compare length
-    if (str1.second != str2.second) {
-        return false;
+void StringPool::Marker::markText(const void * value) {
+    uintptr_t begin;
+    std::memcpy(&begin, value, sizeof(begin));
+    if ((begin & textTag) == 0) {
+        return;
     }
-
-    return (0 == std::memcmp(str1.second.get(), str2.second.get(), str1.first));
+    _pool.markAddress(reinterpret_cast<const uint8_t *>(begin ^ textTag));
 }
 
 StringPool & StringPool::instance() {
@@ -23,8 +20,165 @@ StringPool & StringPool::instance() {
     return pool;
 }
 
-const sql_string_t & StringPool::put(sql_string_t && str) {
-//    return *pool.insert(std::move(str)).first;
-    pool.push_back(std::move(str));
-    return pool.back();
+const uint8_t * StringPool::put(const uint8_t * bytes, size_t len) {
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    if (_interning) {
+        auto it = _interned.find(std::string_view(reinterpret_cast<const char *>(bytes), len));
+        if (it != _interned.end()) {
+            const uint8_t * str = reinterpret_cast<const uint8_t *>(it->data());
+            // the string is handed out once more, hence its page has to survive the next collection
+            auto page = std::prev(_pages.upper_bound(str));
+            page->second.epoch = _epoch;
+            return str;
+        }
+    }
+
+    uint8_t * str = allocate(len);
+    std::memcpy(str, bytes, len);
+    if (_interning) {
+        _interned.emplace(reinterpret_cast<const char *>(str), len);
+    }
+    return str;
+}
+
+uint8_t * StringPool::allocate(size_t len) {
+    // oversized strings get a dedicated page, the current page stays open
+    if (len > pageSize/4) {
+        Page page;
+        page.data.reset(new uint8_t[len]);
+        page.capacity = len;
+        page.used = len;
+        page.epoch = _epoch;
+        uint8_t * begin = page.data.get();
+        _pages.emplace(begin, std::move(page));
+        _allocatedBytes += len;
+        return begin;
+    }
+
+    if (_currentPage == nullptr || _currentPage->capacity - _currentPage->used < len) {
+        Page page;
+        page.data.reset(new uint8_t[pageSize]);
+        page.capacity = pageSize;
+        uint8_t * begin = page.data.get();
+        _currentPage = &_pages.emplace(begin, std::move(page)).first->second;
+        _allocatedBytes += pageSize;
+    }
+
+    uint8_t * str = _currentPage->data.get() + _currentPage->used;
+    _currentPage->used += len;
+    _currentPage->epoch = _epoch;
+    return str;
+}
+
+void StringPool::setInterning(bool enabled) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _interning = enabled;
+    if (!enabled) {
+        _interned.clear();
+    }
+}
+
+void StringPool::addArena(const uint8_t * begin, size_t size) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _arenas.emplace_back(begin, size);
+}
+
+void StringPool::removeArena(const uint8_t * begin) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _arenas.erase(std::remove_if(_arenas.begin(), _arenas.end(), [begin](const arena_t & arena) {
+        return arena.first == begin;
+    }), _arenas.end());
+}
+
+void StringPool::addRoot(const void * owner, root_t root) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _roots[owner] = std::move(root);
+}
+
+void StringPool::removeRoot(const void * owner) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _roots.erase(owner);
+}
+
+void StringPool::markAddress(const uint8_t * ptr) {
+    auto it = _pages.upper_bound(ptr);
+    if (it == _pages.begin()) {
+        return;
+    }
+    --it;
+    Page & page = it->second;
+    // pointers into arenas or somewhere else are ignored
+    if (ptr < it->first + page.used) {
+        page.marked = true;
+    }
+}
+
+size_t StringPool::collect() {
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    for (auto & [begin, page] : _pages) {
+        page.marked = false;
+    }
+    Marker marker(*this);
+    for (auto & [owner, root] : _roots) {
+        root(marker);
+    }
+
+    // pages which handed out a string during this epoch might be referenced by a running statement
+    auto isReclaimable = [this](const Page & page) {
+        return !page.marked && page.epoch != _epoch && &page != _currentPage;
+    };
+
+    for (auto str = _interned.begin(); str != _interned.end(); ) {
+        auto page = std::prev(_pages.upper_bound(reinterpret_cast<const uint8_t *>(str->data())));
+        if (isReclaimable(page->second)) {
+            str = _interned.erase(str);
+        } else {
+            ++str;
+        }
+    }
+
+    size_t freedBytes = 0;
+    for (auto it = _pages.begin(); it != _pages.end(); ) {
+        if (isReclaimable(it->second)) {
+            freedBytes += it->second.capacity;
+            it = _pages.erase(it);
+        } else {
+            ++it;
+        }
+    }
+    _allocatedBytes -= freedBytes;
+    _collectionThreshold = std::max(minCollectionThreshold, 2*_allocatedBytes);
+
+    _epoch += 1;
+    return freedBytes;
+}
+
+size_t StringPool::collectIfGrown() {
+    if (!isCollectionDue()) {
+        return 0;
+    }
+    return collect();
+}
+
+bool StringPool::isCollectionDue() const {
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _allocatedBytes >= _collectionThreshold;
+}
+
+std::vector<StringPool::arena_t> StringPool::getRanges() const {
+    std::lock_guard<std::mutex> lock(_mutex);
+    std::vector<arena_t> ranges = _arenas;
+    for (auto & [begin, page] : _pages) {
+        if (page.used > 0) {
+            ranges.emplace_back(begin, page.used);
+        }
+    }
+    return ranges;
+}
+
+size_t StringPool::getAllocatedBytes() const {
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _allocatedBytes;
 }
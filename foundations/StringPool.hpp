@@ -1,29 +1,113 @@
 #pragma once
 
 #include <cstdint>
-#include <tuple>
+#include <functional>
+#include <map>
 #include <memory>
+#include <mutex>
+#include <string_view>
+#include <tuple>
+#include <unordered_map>
 #include <unordered_set>
 #include <vector>
 
-using sql_string_t = std::pair<size_t, std::unique_ptr<uint8_t[]>>;
-
-struct SqlStringHash {
-	size_t operator()(const sql_string_t & str) const;
-};
-
-struct SqlStringEqual {
-	bool operator()(const sql_string_t & str1, const sql_string_t & str2) const;
-};
+//-----------------------------------------------------------------------------
+// StringPool
 
+/// Storage of all out-of-line Text values
+///
+/// Strings are bump-allocated from large pages, so that a string costs no more than its bytes.
+/// With interning enabled, equal strings are stored only once.
+///
+/// Pages are reclaimed by a mark & sweep collection: every registered root (usually a database)
+/// marks the Text values it still references, afterwards all pages without a marked string are freed.
+/// Each collection starts a new epoch; pages which have handed out a string during the current epoch
+/// survive the collection regardless, since the string might belong to a statement which has not
+/// stored it yet (e.g. a constant of a compiled query).
 class StringPool {
 public:
+    using arena_t = std::pair<const uint8_t *, size_t>;
+
+    /// Strings longer than a quarter of the page size get a page of their own
+    static constexpr size_t pageSize = 1 << 20;
+
+    /// collectIfGrown() does not collect below this amount of allocated pages
+    static constexpr size_t minCollectionThreshold = 16*pageSize;
+
+    class Marker {
+    public:
+        /// \param value A Text value in its storage layout; inplace values are ignored
+        void markText(const void * value);
+
+    private:
+        friend class StringPool;
+
+        Marker(StringPool & pool) : _pool(pool) { }
+
+        StringPool & _pool;
+    };
+
+    using root_t = std::function<void(Marker &)>;
+
     static StringPool & instance();
-    const sql_string_t & put(sql_string_t && str);
+
+    /// \returns The address of a copy of the given bytes which remains valid until no root references it anymore
+    const uint8_t * put(const uint8_t * bytes, size_t len);
+
+    /// \brief Enables or disables the deduplication of equal strings (enabled by default)
+    void setInterning(bool enabled);
+
+    /// \brief Registers a memory region holding strings which are owned by someone else, e.g. a mapped snapshot
+    void addArena(const uint8_t * begin, size_t size);
+    void removeArena(const uint8_t * begin);
+
+    /// \brief Registers a visitor which marks all Text values that are reachable from the given owner
+    void addRoot(const void * owner, root_t root);
+    void removeRoot(const void * owner);
+
+    /// \brief Frees all pages which do not hold any string referenced by a root
+    ///
+    /// Must not run concurrently with statements which store Text values.
+    /// \returns The number of freed bytes
+    size_t collect();
+
+    /// \brief Collects once the allocated pages have doubled since the previous collection
+    size_t collectIfGrown();
+
+    /// \returns Whether collectIfGrown() would collect
+    bool isCollectionDue() const;
+
+    /// \returns All memory regions which may contain strings: the used part of every page and all arenas
+    std::vector<arena_t> getRanges() const;
+
+    /// \returns The number of bytes allocated for pages
+    size_t getAllocatedBytes() const;
+
 private:
-/*
-    using pool_t = std::unordered_set<sql_string_t, SqlStringHash, SqlStringEqual>;
-    pool_t pool;
-*/
-    std::vector<sql_string_t> pool;
+    struct Page {
+        std::unique_ptr<uint8_t[]> data;
+        size_t capacity;
+        size_t used = 0;
+        uint64_t epoch = 0; // the latest epoch in which the page handed out a string
+        bool marked = false;
+    };
+
+    StringPool() = default;
+
+    uint8_t * allocate(size_t len);
+
+    void markAddress(const uint8_t * ptr);
+
+    mutable std::mutex _mutex;
+    std::map<const uint8_t *, Page> _pages; // begin -> page
+    Page * _currentPage = nullptr;
+    uint64_t _epoch = 0;
+    size_t _allocatedBytes = 0;
+    size_t _collectionThreshold = minCollectionThreshold;
+
+    bool _interning = true;
+    std::unordered_set<std::string_view> _interned;
+
+    std::vector<arena_t> _arenas;
+    std::unordered_map<const void *, root_t> _roots;
 };
@@ -0,0 +1,155 @@
+#include "foundations/TidSet.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+
+#include <llvm/IR/TypeBuilder.h>
+
+bool TidSet::insert(size_t tid)
+{
+    Container & container = _containers[tid >> containerShift];
+    uint16_t low = static_cast<uint16_t>(tid);
+    if (container.isBitmap()) {
+        uint64_t & word = container.bitmap[low / wordBits];
+        uint64_t bit = static_cast<uint64_t>(1) << (low % wordBits);
+        if ((word & bit) != 0) {
+            return false;
+        }
+        word |= bit;
+    } else {
+        auto it = std::lower_bound(container.array.begin(), container.array.end(), low);
+        if (it != container.array.end() && *it == low) {
+            return false;
+        }
+        if (container.array.size() < arrayLimit) {
+            container.array.insert(it, low);
+        } else {
+            // the array would occupy more space than the bitmap
+            container.bitmap.assign(containerWords, 0);
+            container.array.push_back(low);
+            for (uint16_t value : container.array) {
+                container.bitmap[value / wordBits] |= static_cast<uint64_t>(1) << (value % wordBits);
+            }
+            container.array.clear();
+            container.array.shrink_to_fit();
+        }
+    }
+    container.count += 1;
+    _size += 1;
+    return true;
+}
+
+bool TidSet::erase(size_t tid)
+{
+    auto containerIt = _containers.find(tid >> containerShift);
+    if (containerIt == _containers.end()) {
+        return false;
+    }
+    Container & container = containerIt->second;
+    uint16_t low = static_cast<uint16_t>(tid);
+    if (container.isBitmap()) {
+        uint64_t & word = container.bitmap[low / wordBits];
+        uint64_t bit = static_cast<uint64_t>(1) << (low % wordBits);
+        if ((word & bit) == 0) {
+            return false;
+        }
+        word &= ~bit;
+    } else {
+        auto it = std::lower_bound(container.array.begin(), container.array.end(), low);
+        if (it == container.array.end() || *it != low) {
+            return false;
+        }
+        container.array.erase(it);
+    }
+    container.count -= 1;
+    _size -= 1;
+
+    // bitmaps are kept until the container is empty, so that alternating updates do not convert it back and forth
+    if (container.count == 0) {
+        _containers.erase(containerIt);
+    }
+    return true;
+}
+
+bool TidSet::contains(size_t tid) const
+{
+    auto containerIt = _containers.find(tid >> containerShift);
+    if (containerIt == _containers.end()) {
+        return false;
+    }
+    const Container & container = containerIt->second;
+    uint16_t low = static_cast<uint16_t>(tid);
+    if (container.isBitmap()) {
+        return ((container.bitmap[low / wordBits] >> (low % wordBits)) & 1) != 0;
+    }
+    return std::binary_search(container.array.begin(), container.array.end(), low);
+}
+
+void TidSet::clear()
+{
+    _containers.clear();
+    _size = 0;
+}
+
+bool TidSet::getWords(size_t firstWord, size_t wordCount, uint64_t * words) const
+{
+    std::memset(words, 0, wordCount*sizeof(uint64_t));
+    size_t endWord = firstWord + wordCount;
+    bool any = false;
+
+    auto containerIt = _containers.lower_bound(firstWord / containerWords);
+    for (; containerIt != _containers.end(); ++containerIt) {
+        auto & [key, container] = *containerIt;
+        size_t containerBegin = key*containerWords; // the first word of the container
+        if (containerBegin >= endWord) {
+            break;
+        }
+        size_t begin = std::max(firstWord, containerBegin);
+        size_t end = std::min(endWord, containerBegin + containerWords);
+
+        if (container.isBitmap()) {
+            for (size_t word = begin; word < end; ++word) {
+                words[word - firstWord] = container.bitmap[word - containerBegin];
+                any |= (words[word - firstWord] != 0);
+            }
+            continue;
+        }
+
+        auto lowBegin = static_cast<uint16_t>((begin - containerBegin)*wordBits);
+        auto it = std::lower_bound(container.array.begin(), container.array.end(), lowBegin);
+        for (; it != container.array.end(); ++it) {
+            size_t word = containerBegin + *it / wordBits;
+            if (word >= end) {
+                break;
+            }
+            words[word - firstWord] |= static_cast<uint64_t>(1) << (*it % wordBits);
+            any = true;
+        }
+    }
+    return any;
+}
+
+size_t TidSet::getBitmapContainerCount() const
+{
+    return std::count_if(_containers.begin(), _containers.end(), [](auto & entry) {
+        return entry.second.isBitmap();
+    });
+}
+
+// wrapper functions
+void tidSetGetWords(const TidSet * set, size_t firstWord, size_t wordCount, uint64_t * words)
+{
+    set->getWords(firstWord, wordCount, words);
+}
+
+// generator functions
+void genTidSetGetWordsCall(const TidSet & set, cg_size_t firstWord, size_t wordCount, cg_voidptr_t words)
+{
+    auto & codeGen = getThreadLocalCodeGen();
+    auto & context = codeGen.getLLVMContext();
+
+    llvm::FunctionType * funcTy = llvm::TypeBuilder<void (void *, size_t, size_t, void *), false>::get(context);
+    codeGen.CreateCall(&tidSetGetWords, funcTy,
+            {cg_voidptr_t::fromRawPointer(&set), firstWord, cg_size_t(wordCount), words});
+}
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <vector>
+
+#include "codegen/CodeGen.hpp"
+
+//-----------------------------------------------------------------------------
+// TidSet
+
+/// Compressed set of tids, organized like a roaring bitmap
+///
+/// The tids are partitioned by their upper bits into containers of 2^16 tids each. A container holds the
+/// lower 16 bits of its tids as sorted array as long as it is sparse and switches to a bitmap once the array
+/// would exceed the size of the bitmap.
+class TidSet {
+public:
+    static constexpr unsigned containerShift = 16;
+    static constexpr size_t containerCapacity = static_cast<size_t>(1) << containerShift;
+    static constexpr unsigned wordBits = 64;
+    static constexpr size_t containerWords = containerCapacity / wordBits;
+
+    /// the largest array container; a bitmap container occupies the same space
+    static constexpr size_t arrayLimit = containerWords*sizeof(uint64_t)/sizeof(uint16_t);
+
+    /// \returns Whether the tid has not been contained before
+    bool insert(size_t tid);
+
+    /// \returns Whether the tid has been contained
+    bool erase(size_t tid);
+
+    bool contains(size_t tid) const;
+
+    size_t size() const { return _size; }
+
+    bool empty() const { return _size == 0; }
+
+    void clear();
+
+    /// \brief Writes the membership of the tids [firstWord*64, (firstWord + wordCount)*64) as bitmap words
+    /// \returns Whether any of these tids is contained
+    bool getWords(size_t firstWord, size_t wordCount, uint64_t * words) const;
+
+    /// \returns The number of bitmap containers, which are dense
+    size_t getBitmapContainerCount() const;
+
+private:
+    struct Container {
+        std::vector<uint16_t> array; // sorted; empty if the container is a bitmap
+        std::vector<uint64_t> bitmap;
+        size_t count = 0;
+
+        bool isBitmap() const { return !bitmap.empty(); }
+    };
+
+    std::map<size_t, Container> _containers; // upper bits -> container
+    size_t _size = 0;
+};
+
+// wrapper functions
+extern "C" {
+void tidSetGetWords(const TidSet * set, size_t firstWord, size_t wordCount, uint64_t * words);
+}
+
+// generator functions
+
+/// \brief Writes the membership of wordCount*64 tids into words, see TidSet::getWords()
+void genTidSetGetWordsCall(const TidSet & set, cg_size_t firstWord, size_t wordCount, cg_voidptr_t words);
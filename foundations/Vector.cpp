@@ -5,33 +5,195 @@
 #include <cstdlib>
 #include <cstring>
 #include <cmath>
+#include <algorithm>
+#include <atomic>
+#include <stdexcept>
 
 #include <llvm/IR/TypeBuilder.h>
 
 #include "codegen/CodeGen.hpp"
+#include "utils/general.hpp"
+
+/// Reference count of a chunk which is shared by forked vectors
+///
+/// Every vector which refers to the chunk holds one reference. Borrowed chunks hold an additional
+/// reference on behalf of their actual owner, so they are never freed.
+struct Vector::SharedChunk {
+    explicit SharedChunk(size_t references) : referenceCount(references) { }
+
+    std::atomic<size_t> referenceCount;
+};
 
 Vector::Vector(size_type elementSize) :
         Vector(elementSize, 0)
 { }
 
 Vector::Vector(size_type elementSize, size_type reserveCount) :
+        Vector(elementSize, reserveCount, defaultChunkShift)
+{ }
+
+Vector::Vector(size_type elementSize, size_type reserveCount, unsigned chunkShift) :
+        Vector(elementSize, reserveCount, chunkShift, Allocator::instance().getDefaultPolicy())
+{ }
+
+Vector::Vector(size_type elementSize, size_type reserveCount, unsigned chunkShift, const AllocationPolicy & policy) :
         _elementSize(elementSize),
-        _elementCount(reserveCount)
+        _elementCount(reserveCount),
+        _chunkShift(chunkShift),
+        _chunkMask((static_cast<size_type>(1) << chunkShift) - 1),
+        _allocationPolicy(policy)
 {
-    _capacity = defaultCount;
+    _directoryCapacity = defaultCount;
+    _directory = static_cast<uint8_t **>(std::malloc(_directoryCapacity*sizeof(uint8_t *)));
 
-    if (reserveCount > defaultCount) {
-        unsigned power = static_cast<unsigned>( std::ceil( std::log2(_capacity) ) );
-        _capacity = 1ul << power;
+    // the first chunk is always present
+    size_type requiredChunks = std::max<size_type>(1, (reserveCount + _chunkMask) >> _chunkShift);
+    while (_chunkCount < requiredChunks) {
+        addChunk();
     }
-
-    _arraySize = elementSize*_capacity; // size in bytes
-    _array = static_cast<uint8_t *>(std::malloc(_arraySize));
 }
 
 Vector::~Vector()
 {
-    std::free(_array);
+    for (size_type i = 0; i < _chunkCount; ++i) {
+        freeChunk(i);
+    }
+    std::free(_directory);
+}
+
+void Vector::addChunk()
+{
+    if (_chunkCount == _directoryCapacity) {
+        // only the directory is relocated, the chunks themselves stay in place
+        _directoryCapacity <<= 1;
+        _directory = static_cast<uint8_t **>(std::realloc(_directory, _directoryCapacity*sizeof(uint8_t *)));
+        assert(_directory);
+    }
+
+    uint8_t * chunk = static_cast<uint8_t *>(Allocator::instance().allocate(_elementSize*getChunkCapacity(), _allocationPolicy));
+    _directory[_chunkCount] = chunk;
+    _chunkCount += 1;
+    if (!_sharedChunks.empty()) {
+        _sharedChunks.push_back(nullptr);
+    }
+}
+
+void Vector::releaseChunk()
+{
+    assert(_chunkCount > 1);
+    _chunkCount -= 1;
+    freeChunk(_chunkCount);
+    if (!_sharedChunks.empty()) {
+        _sharedChunks.pop_back();
+    }
+    if (_chunkCount < _borrowedChunkCount) {
+        _borrowedChunkCount = _chunkCount;
+    }
+}
+
+void Vector::freeChunk(size_type chunkIndex)
+{
+    uint8_t * chunk = _directory[chunkIndex];
+    SharedChunk * shared = _sharedChunks.empty() ? nullptr : _sharedChunks[chunkIndex];
+    if (shared != nullptr) {
+        if (shared->referenceCount.fetch_sub(1, std::memory_order_acq_rel) > 1) {
+            return;
+        }
+        delete shared;
+    } else if (chunkIndex < _borrowedChunkCount) {
+        return;
+    }
+    Allocator::instance().release(chunk, _elementSize*getChunkCapacity());
+}
+
+std::unique_ptr<Vector> Vector::fork()
+{
+    auto forked = std::make_unique<Vector>(_elementSize, 0, _chunkShift, _allocationPolicy);
+    forked->freeChunk(0);
+    if (forked->_directoryCapacity < _chunkCount) {
+        forked->_directoryCapacity = _directoryCapacity;
+        forked->_directory = static_cast<uint8_t **>(std::realloc(forked->_directory, _directoryCapacity*sizeof(uint8_t *)));
+        assert(forked->_directory);
+    }
+
+    // each chunk has its own counter, so no lock is taken
+    if (_sharedChunks.empty()) {
+        _sharedChunks.assign(_chunkCount, nullptr);
+    }
+    for (size_type i = 0; i < _chunkCount; ++i) {
+        if (_sharedChunks[i] == nullptr) {
+            _sharedChunks[i] = new SharedChunk((i < _borrowedChunkCount) ? 2 : 1);
+        }
+        _sharedChunks[i]->referenceCount.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    std::memcpy(forked->_directory, _directory, _chunkCount*sizeof(uint8_t *));
+    forked->_chunkCount = _chunkCount;
+    forked->_elementCount = _elementCount;
+    forked->_sharedChunks = _sharedChunks;
+    return forked;
+}
+
+Vector::size_type Vector::getSharedChunkCount() const
+{
+    return _sharedChunks.size() - std::count(_sharedChunks.begin(), _sharedChunks.end(), nullptr);
+}
+
+void Vector::copySharedChunk(size_type chunkIndex)
+{
+    uint8_t * chunk = _directory[chunkIndex];
+    SharedChunk * shared = _sharedChunks[chunkIndex];
+    size_type chunkBytes = _elementSize*getChunkCapacity();
+
+    if (shared->referenceCount.load(std::memory_order_acquire) == 1) {
+        // all other vectors have dropped the chunk meanwhile
+        if (chunkIndex >= _borrowedChunkCount) {
+            delete shared;
+            _sharedChunks[chunkIndex] = nullptr;
+        }
+        return;
+    }
+
+    auto copy = static_cast<uint8_t *>(Allocator::instance().allocate(chunkBytes, _allocationPolicy));
+    std::memcpy(copy, chunk, chunkBytes);
+    _directory[chunkIndex] = copy;
+    // borrowed slots are only released through the reference counts
+    _sharedChunks[chunkIndex] = (chunkIndex < _borrowedChunkCount) ? new SharedChunk(1) : nullptr;
+    if (shared->referenceCount.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+        // the other vectors have dropped the chunk while it was copied
+        delete shared;
+        Allocator::instance().release(chunk, chunkBytes);
+    }
+}
+
+void Vector::adoptChunks(uint8_t * const * chunks, size_type chunkCount, size_type elementCount)
+{
+    assert(_elementCount == 0 && _borrowedChunkCount == 0 && _sharedChunks.empty());
+    assert(elementCount <= (chunkCount << _chunkShift));
+    if (chunkCount == 0) {
+        return;
+    }
+
+    for (size_type i = 0; i < _chunkCount; ++i) {
+        Allocator::instance().release(_directory[i], _elementSize*getChunkCapacity());
+    }
+    if (_directoryCapacity < chunkCount) {
+        while (_directoryCapacity < chunkCount) {
+            _directoryCapacity <<= 1;
+        }
+        _directory = static_cast<uint8_t **>(std::realloc(_directory, _directoryCapacity*sizeof(uint8_t *)));
+        assert(_directory);
+    }
+    std::memcpy(_directory, chunks, chunkCount*sizeof(uint8_t *));
+    _chunkCount = chunkCount;
+    _borrowedChunkCount = chunkCount;
+    _elementCount = elementCount;
+}
+
+void Vector::replaceBorrowedChunk(size_type chunkIndex, uint8_t * chunk)
+{
+    assert(chunkIndex < _borrowedChunkCount && _sharedChunks.empty());
+    _directory[chunkIndex] = chunk;
 }
 
 void Vector::push_back(void * ptr)
@@ -41,25 +203,38 @@ void Vector::push_back(void * ptr)
 }
 
 void Vector::remove_at(size_type index) {
-    if (index < size() - 1) {
-        void *elementPtr = at(index);
-        void *nextElementPtr = at(index + 1);
-        size_type restLength = (size() - index - 1) * _elementSize;
-        std::memcpy(elementPtr,nextElementPtr,restLength);
+    assert(index < _elementCount);
+
+    // shift the tail chunk by chunk
+    size_type chunkIndex = index >> _chunkShift;
+    size_type offset = index & _chunkMask;
+    size_type lastChunk = (_elementCount - 1) >> _chunkShift;
+    for (size_type i = chunkIndex; i <= lastChunk; ++i) {
+        makeChunkPrivate(i);
+    }
+    for (; chunkIndex <= lastChunk; ++chunkIndex) {
+        uint8_t * chunk = _directory[chunkIndex];
+        size_type chunkSize = getChunkSize(chunkIndex);
+        size_type restLength = (chunkSize - offset - 1) * _elementSize;
+        std::memmove(chunk + offset*_elementSize, chunk + (offset + 1)*_elementSize, restLength);
+        if (chunkIndex < lastChunk) {
+            // move the first element of the next chunk into the last slot of this one
+            std::memcpy(chunk + (getChunkCapacity() - 1)*_elementSize, _directory[chunkIndex + 1], _elementSize);
+        }
+        offset = 0;
     }
     pop_back();
 }
 
 void * Vector::reserve_back()
 {
-    if (_elementCount == _capacity) {
-        _capacity <<= 1;
-        _arraySize = _elementSize*_capacity; // size in bytes
-        _array = static_cast<uint8_t *>(std::realloc(_array, _arraySize));
-        assert(_array);
+    size_type chunkIndex = _elementCount >> _chunkShift;
+    if (chunkIndex == _chunkCount) {
+        addChunk();
     }
+    makeChunkPrivate(chunkIndex);
 
-    void * elemAddr = (_array + _elementSize*_elementCount);
+    void * elemAddr = (_directory[chunkIndex] + _elementSize*(_elementCount & _chunkMask));
     _elementCount += 1;
     return elemAddr;
 }
@@ -69,50 +244,49 @@ void Vector::pop_back()
     assert(_elementCount > 0);
 
     _elementCount -= 1;
-    // TODO hysteresis
 
-    if (_elementCount <= defaultCount) {
-        return;
-    } else if (_elementCount <= (_capacity >> 1)) {
-        _capacity >>= 1;
-        _arraySize = _elementSize*_capacity; // size in bytes
-        _array = static_cast<uint8_t *>(std::realloc(_array, _arraySize));
-        assert(_array);
+    // keep one spare chunk as hysteresis
+    size_type usedChunks = (_elementCount + _chunkMask) >> _chunkShift;
+    if (_chunkCount > usedChunks + 1) {
+        releaseChunk();
     }
 }
 
 void * Vector::operator[](size_type index)
 {
     assert(index < _elementCount);
-    return (_array + _elementSize*index);
+    makeChunkPrivate(index >> _chunkShift);
+    return (_directory[index >> _chunkShift] + _elementSize*(index & _chunkMask));
 }
 
 const void * Vector::operator[](size_type index) const
 {
     assert(index < _elementCount);
-    return (_array + _elementSize*index);
+    return (_directory[index >> _chunkShift] + _elementSize*(index & _chunkMask));
 }
 
 void * Vector::at(size_type index)
 {
     assert(index < _elementCount);
-    return (_array + _elementSize*index);
+    makeChunkPrivate(index >> _chunkShift);
+    return (_directory[index >> _chunkShift] + _elementSize*(index & _chunkMask));
 }
 
 const void * Vector::at(size_type index) const
 {
     assert(index < _elementCount);
-    return (_array + _elementSize*index);
+    return (_directory[index >> _chunkShift] + _elementSize*(index & _chunkMask));
 }
 
 void * Vector::front()
 {
-    return _array;
+    makeChunkPrivate(0);
+    return _directory[0];
 }
 
 const void * Vector::front() const
 {
-    return _array;
+    return _directory[0];
 }
 
 void * Vector::back()
@@ -125,16 +299,25 @@ const void * Vector::back() const
     return at(_elementCount - 1);
 }
 
-Vector::size_type Vector::size()
+Vector::size_type Vector::size() const
 {
     return _elementCount;
 }
 
-bool Vector::empty()
+bool Vector::empty() const
 {
     return (_elementCount == 0);
 }
 
+Vector::size_type Vector::getChunkSize(size_type chunkIndex) const
+{
+    size_type chunkBegin = chunkIndex << _chunkShift;
+    if (chunkBegin >= _elementCount) {
+        return 0;
+    }
+    return std::min(getChunkCapacity(), _elementCount - chunkBegin);
+}
+
 // wrapper functions
 static void * vectorReserveBack(Vector * vector)
 {
@@ -168,3 +351,27 @@ cg_voidptr_t genVectoBackCall(cg_voidptr_t vector)
 
     return cg_voidptr_t( llvm::cast<llvm::Value>(result) );
 }
+
+cg_voidptr_t genVectorChunkLoad(const Vector & vector, cg_size_t chunkIndex)
+{
+    auto & codeGen = getThreadLocalCodeGen();
+
+    llvm::Type * chunkPtrTy = cg_voidptr_t::getType();
+    llvm::Type * directoryTy = llvm::PointerType::getUnqual(chunkPtrTy);
+
+    // load the current directory address
+    llvm::Value * directoryAddr = createPointerValue(vector.getDirectoryAddress(), directoryTy);
+    llvm::Value * directory = codeGen->CreateLoad(directoryTy, directoryAddr);
+
+    llvm::Value * chunkAddr = codeGen->CreateGEP(chunkPtrTy, directory, chunkIndex.getValue());
+    return cg_voidptr_t( codeGen->CreateLoad(chunkPtrTy, chunkAddr) );
+}
+
+cg_voidptr_t genVectorElementPtr(const Vector & vector, cg_size_t index)
+{
+    cg_size_t chunkIndex = index >> cg_size_t(vector.getChunkShift());
+    cg_size_t offset = (index & cg_size_t(vector.getChunkCapacity() - 1)) * cg_size_t(vector.getElementSize());
+
+    cg_voidptr_t chunk = genVectorChunkLoad(vector, chunkIndex);
+    return chunk + offset.getValue();
+}
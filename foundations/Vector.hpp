@@ -1,24 +1,41 @@
-
 #pragma once
 
 #include <cstddef>
 #include <cstdint>
+#include <memory>
+#include <vector>
 
 #include "codegen/CodeGen.hpp"
+#include "foundations/Allocator.hpp"
 
 // vector without type information
+//
+// The elements are stored in fixed-size chunks which are referenced by a small directory.
+// Chunks are never relocated, hence element addresses stay valid while the vector grows.
+// Forked vectors share their chunks copy-on-write: the non-const accessors copy a shared chunk before
+// handing out an address within it, so that addresses obtained for writing are only stable until the next fork.
 class Vector {
 public:
     using size_type = size_t;
 
     static const size_type defaultCount = 2;
 
+    /// log2 of the default number of elements per chunk
+    static constexpr unsigned defaultChunkShift = 14;
+
     Vector(size_type elementSize);
 
     Vector(size_type elementSize, size_type reserveCount);
 
+    Vector(size_type elementSize, size_type reserveCount, unsigned chunkShift);
+
+    Vector(size_type elementSize, size_type reserveCount, unsigned chunkShift, const AllocationPolicy & policy);
+
     ~Vector();
 
+    Vector(const Vector &) = delete;
+    Vector & operator=(const Vector &) = delete;
+
     size_type getElementSize() const { return _elementSize; }
 
     void push_back(void * ptr);
@@ -35,25 +52,98 @@ public:
     void * at(size_type index);
     const void * at(size_type index) const;
 
+    /// \returns The address of the first chunk; only the first chunkCapacity elements are contiguous
     void * front();
     const void * front() const;
 
     void * back();
     const void * back() const;
 
-    size_type size();
+    size_type size() const;
+
+    bool empty() const;
+
+    unsigned getChunkShift() const { return _chunkShift; }
+
+    /// \returns The number of elements per chunk
+    size_type getChunkCapacity() const { return _chunkMask + 1; }
+
+    /// \returns The number of allocated chunks
+    size_type getChunkCount() const { return _chunkCount; }
+
+    void * getChunk(size_type chunkIndex) { makeChunkPrivate(chunkIndex); return _directory[chunkIndex]; }
+    const void * getChunk(size_type chunkIndex) const { return _directory[chunkIndex]; }
+
+    /// \returns The number of elements stored within the given chunk
+    size_type getChunkSize(size_type chunkIndex) const;
+
+    /// The directory itself may be reallocated, generated code therefore has to load it through this address
+    uint8_t * const * const * getDirectoryAddress() const { return &_directory; }
+
+    /// \brief Replaces the (empty) content by chunks which are owned by someone else, e.g. a mapped snapshot
+    ///
+    /// Each chunk has to provide room for getChunkCapacity() elements. Borrowed chunks are never freed,
+    /// appending continues within the last borrowed chunk.
+    void adoptChunks(uint8_t * const * chunks, size_type chunkCount, size_type elementCount);
 
-    bool empty();
+    /// \returns The number of leading chunks which are not owned by this vector
+    size_type getBorrowedChunkCount() const { return _borrowedChunkCount; }
+
+    /// \brief Replaces a borrowed chunk by another one which is not owned by this vector either
+    void replaceBorrowedChunk(size_type chunkIndex, uint8_t * chunk);
+
+    /// \brief Creates a vector with the same content which shares all chunks copy-on-write
+    ///
+    /// Only the directory is copied. Whichever vector writes to a shared chunk first copies it.
+    /// Each chunk carries its own reference count, hence forking takes one atomic increment per chunk.
+    std::unique_ptr<Vector> fork();
+
+    /// \returns The number of chunks which may still be shared with other vectors
+    size_type getSharedChunkCount() const;
+
+    /// \brief Sets the policy of all chunks which are allocated from now on
+    void setAllocationPolicy(const AllocationPolicy & policy) { _allocationPolicy = policy; }
+
+    const AllocationPolicy & getAllocationPolicy() const { return _allocationPolicy; }
 
 private:
+    struct SharedChunk;
+
+    void addChunk();
+
+    void releaseChunk();
+
+    /// \brief Releases the last chunk, or only drops its reference if it is shared
+    void freeChunk(size_type chunkIndex);
+
+    /// \brief Ensures that no other vector refers to the given chunk
+    void makeChunkPrivate(size_type chunkIndex) {
+        if (!_sharedChunks.empty() && _sharedChunks[chunkIndex] != nullptr) {
+            copySharedChunk(chunkIndex);
+        }
+    }
+
+    void copySharedChunk(size_type chunkIndex);
+
     size_type _elementSize;
     size_type _elementCount = 0;
-    size_type _capacity;
-    size_type _arraySize;
-    uint8_t * _array;
+    unsigned _chunkShift;
+    size_type _chunkMask;
+    size_type _chunkCount = 0;
+    size_type _borrowedChunkCount = 0;
+    size_type _directoryCapacity = 0;
+    uint8_t ** _directory = nullptr;
+    AllocationPolicy _allocationPolicy;
+    std::vector<SharedChunk *> _sharedChunks; // per chunk its reference count if it may be shared; empty unless forked
 };
 
 // generator functions
 cg_voidptr_t genVectorReserveBackCall(cg_voidptr_t vector);
 
 cg_voidptr_t genVectoBackCall(cg_voidptr_t vector);
+
+/// \brief Loads the start address of the given chunk
+cg_voidptr_t genVectorChunkLoad(const Vector & vector, cg_size_t chunkIndex);
+
+/// \brief Computes the address of the element at the given index
+cg_voidptr_t genVectorElementPtr(const Vector & vector, cg_size_t index);
@@ -0,0 +1,577 @@
+#include "foundations/WriteAheadLog.hpp"
+
+#include <cassert>
+#include <cerrno>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <stdexcept>
+#include <type_traits>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <boost/crc.hpp>
+#include <llvm/IR/TypeBuilder.h>
+
+#include "foundations/exceptions.hpp"
+#include "foundations/version_management.hpp"
+#include "native/sql/SqlValues.hpp"
+#include "utils/general.hpp"
+
+using namespace Native::Sql;
+
+namespace {
+
+enum class RecordType : uint8_t { CreateTable, CreateBranch, Insert, Update, Delete, Compact, MergeBranch, DropBranch };
+
+/// Each record is framed by its payload size and a checksum, which allows to detect a torn tail
+struct RecordHeader {
+    uint32_t size;
+    uint32_t checksum;
+};
+
+uint32_t computeChecksum(const char * data, size_t size)
+{
+    boost::crc_32_type crc;
+    crc.process_bytes(data, size);
+    return crc.checksum();
+}
+
+template<typename T>
+void put(std::string & record, const T & value)
+{
+    static_assert(std::is_trivially_copyable<T>::value, "only trivial types can be logged");
+    record.append(reinterpret_cast<const char *>(&value), sizeof(T));
+}
+
+void putBytes(std::string & record, const void * data, size_t size)
+{
+    put<uint32_t>(record, static_cast<uint32_t>(size));
+    record.append(static_cast<const char *>(data), size);
+}
+
+void putValue(std::string & record, const Value & value)
+{
+    put(record, value.type);
+
+#ifndef USE_INTERNAL_NULL_INDICATOR
+    if (value.type.nullable) {
+        // null values keep their placeholder, which has the type of the column
+        auto & nullable = static_cast<const NullableValue &>(value);
+        put<uint8_t>(record, nullable.isNull());
+        putValue(record, nullable.getValue());
+        return;
+    }
+#endif
+
+    if (value.type.typeID == Sql::SqlType::TypeID::TextID) {
+        // the stored representation of Text values consists of pointers
+        auto view = static_cast<const Text &>(value).getView();
+        putBytes(record, view.data(), view.size());
+        return;
+    }
+
+    std::string buffer(value.getSize(), '\0');
+    value.store(&buffer[0]);
+    putBytes(record, buffer.data(), buffer.size());
+}
+
+void putTuple(std::string & record, SqlTuple & tuple)
+{
+    put<uint32_t>(record, static_cast<uint32_t>(tuple.values.size()));
+    for (auto & value : tuple.values) {
+        putValue(record, *value);
+    }
+}
+
+class RecordReader {
+public:
+    RecordReader(const char * data, size_t size) :
+            _cursor(data), _end(data + size)
+    { }
+
+    template<typename T>
+    T get()
+    {
+        static_assert(std::is_trivially_copyable<T>::value, "only trivial types can be logged");
+        T value;
+        std::memcpy(&value, take(sizeof(T)), sizeof(T));
+        return value;
+    }
+
+    std::string getBytes()
+    {
+        auto size = get<uint32_t>();
+        return std::string(take(size), size);
+    }
+
+    value_op_t getValue()
+    {
+        auto type = get<Sql::SqlType>();
+
+#ifndef USE_INTERNAL_NULL_INDICATOR
+        if (type.nullable) {
+            bool isNull = get<uint8_t>() != 0;
+            return NullableValue::create(getValue(), isNull);
+        }
+#endif
+
+        std::string bytes = getBytes();
+        if (type.typeID == Sql::SqlType::TypeID::TextID) {
+            return Text::castString(bytes);
+        }
+        return Value::load(bytes.data(), type);
+    }
+
+    std::unique_ptr<SqlTuple> getTuple()
+    {
+        auto count = get<uint32_t>();
+        std::vector<value_op_t> values;
+        for (uint32_t i = 0; i < count; ++i) {
+            values.push_back(getValue());
+        }
+        return std::make_unique<SqlTuple>(std::move(values));
+    }
+
+    Table & getTable(Database & db)
+    {
+        std::string name = getBytes();
+        Table * table = db.getTable(name);
+        if (table == nullptr) {
+            throw std::runtime_error("write-ahead log references the unknown table '" + name + "'");
+        }
+        return *table;
+    }
+
+private:
+    const char * take(size_t size)
+    {
+        if (size > static_cast<size_t>(_end - _cursor)) {
+            throw std::runtime_error("corrupt write-ahead log record");
+        }
+        const char * data = _cursor;
+        _cursor += size;
+        return data;
+    }
+
+    const char * _cursor;
+    const char * _end;
+};
+
+void applyRecord(Database & db, QueryContext & ctx, RecordReader & reader)
+{
+    auto type = reader.get<RecordType>();
+    switch (type) {
+        case RecordType::CreateTable: {
+            std::string name = reader.getBytes();
+            Table & table = db.createTable(name);
+            table.setVersioningEngine(reader.get<Table::VersioningEngine>());
+            auto columnCount = reader.get<uint32_t>();
+            for (uint32_t i = 0; i < columnCount; ++i) {
+                std::string columnName = reader.getBytes();
+                auto columnType = reader.get<Sql::SqlType>();
+                auto encoding = reader.get<ColumnInformation::Encoding>();
+                table.addColumn(columnName, columnType, encoding);
+            }
+            break;
+        }
+        case RecordType::CreateBranch: {
+            std::string name = reader.getBytes();
+            auto parent = reader.get<branch_id_t>();
+            db.createBranch(name, parent);
+            break;
+        }
+        case RecordType::Insert: {
+            Table & table = reader.getTable(db);
+            auto branchId = reader.get<branch_id_t>();
+            auto tuple = reader.getTuple();
+#if USE_DATA_VERSIONING
+            insert_tuple_with_branchId(*tuple, table, ctx, branchId);
+#else
+            table.addRow(branchId);
+            tid_t tid = table.size() - 1;
+            for (size_t i = 0; i < tuple->values.size(); ++i) {
+                store_master_value(tid, i, *tuple->values[i], table);
+            }
+#endif
+            break;
+        }
+        case RecordType::Update: {
+            Table & table = reader.getTable(db);
+            auto branchId = reader.get<branch_id_t>();
+            auto tid = reader.get<tid_t>();
+            auto tuple = reader.getTuple();
+#if USE_DATA_VERSIONING
+            db.constructBranchLineage(branchId, ctx.executionContext);
+            update_tuple_with_branchId(tid, branchId, *tuple, table, ctx);
+#else
+            for (size_t i = 0; i < tuple->values.size(); ++i) {
+                store_master_value(tid, i, *tuple->values[i], table);
+            }
+#endif
+            break;
+        }
+        case RecordType::Delete: {
+            Table & table = reader.getTable(db);
+            auto branchId = reader.get<branch_id_t>();
+            auto tid = reader.get<tid_t>();
+#if USE_DATA_VERSIONING
+            db.constructBranchLineage(branchId, ctx.executionContext);
+            delete_tuple_with_branchId(tid, branchId, table, ctx);
+#else
+            table.removeRow(tid);
+#endif
+            break;
+        }
+        case RecordType::Compact: {
+            Table & table = reader.getTable(db);
+            auto rowCount = reader.get<uint64_t>();
+            // the tombstones are the same as before, hence the same rows are moved
+            if (table.compact(rowCount) != rowCount) {
+                throw std::runtime_error("write-ahead log does not match the table '" + table.getName() + "'");
+            }
+            break;
+        }
+        case RecordType::MergeBranch: {
+            auto source = reader.get<branch_id_t>();
+            auto destination = reader.get<branch_id_t>();
+            db.mergeBranch(source, destination);
+            break;
+        }
+        case RecordType::DropBranch: {
+            db.dropBranch(reader.get<branch_id_t>());
+            break;
+        }
+        default:
+            throw std::runtime_error("unknown write-ahead log record");
+    }
+}
+
+} // end anonymous namespace
+
+//-----------------------------------------------------------------------------
+// WriteAheadLog
+
+constexpr std::chrono::milliseconds WriteAheadLog::asyncFlushInterval;
+
+WriteAheadLog::WriteAheadLog(const std::string & path, Durability durability) :
+        _durability(durability)
+{
+    _fd = open(path.c_str(), O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+    if (_fd < 0) {
+        throw std::runtime_error("cannot open write-ahead log '" + path + "': " + std::strerror(errno));
+    }
+    if (_durability == Durability::Async) {
+        _flusher = std::thread(&WriteAheadLog::runFlusher, this);
+    }
+}
+
+WriteAheadLog::~WriteAheadLog()
+{
+    if (_flusher.joinable()) {
+        {
+            std::lock_guard<std::mutex> guard(_mutex);
+            _stopping = true;
+        }
+        _stop.notify_all();
+        _flusher.join();
+    }
+
+    try {
+        flush();
+    } catch (const std::exception & e) {
+        std::cerr << "write-ahead log: " << e.what() << std::endl;
+    }
+    close(_fd);
+}
+
+WriteAheadLog::Durability WriteAheadLog::parseDurability(const std::string & name)
+{
+    if (name == "sync") {
+        return Durability::Sync;
+    } else if (name == "group") {
+        return Durability::Group;
+    } else if (name == "async") {
+        return Durability::Async;
+    }
+    throw InvalidOperationException("unknown durability mode '" + name + "'");
+}
+
+const char * WriteAheadLog::getDurabilityName(Durability durability)
+{
+    switch (durability) {
+        case Durability::Sync:
+            return "sync";
+        case Durability::Group:
+            return "group";
+        case Durability::Async:
+            return "async";
+        default:
+            unreachable();
+    }
+}
+
+WriteAheadLog::lsn_t WriteAheadLog::logCreateTable(const Table & table)
+{
+    std::string payload;
+    put(payload, RecordType::CreateTable);
+    putBytes(payload, table.getName().data(), table.getName().size());
+    // the default engine of the replaying database might differ
+    put(payload, table.getVersioningEngine());
+    put<uint32_t>(payload, static_cast<uint32_t>(table.getColumnCount()));
+    for (size_t i = 0; i < table.getColumnCount(); ++i) {
+        ci_p_t ci = table.getCI(i);
+        putBytes(payload, ci->columnName.data(), ci->columnName.size());
+        put(payload, ci->type);
+        put(payload, ci->encoding);
+    }
+    return append(payload);
+}
+
+WriteAheadLog::lsn_t WriteAheadLog::logCreateBranch(const std::string & name, branch_id_t parent)
+{
+    std::string payload;
+    put(payload, RecordType::CreateBranch);
+    putBytes(payload, name.data(), name.size());
+    put(payload, parent);
+    return append(payload);
+}
+
+WriteAheadLog::lsn_t WriteAheadLog::logInsert(const Table & table, branch_id_t branchId, SqlTuple & tuple)
+{
+    std::string payload;
+    put(payload, RecordType::Insert);
+    putBytes(payload, table.getName().data(), table.getName().size());
+    put(payload, branchId);
+    putTuple(payload, tuple);
+    return append(payload);
+}
+
+WriteAheadLog::lsn_t WriteAheadLog::logUpdate(const Table & table, branch_id_t branchId, tid_t tid, SqlTuple & tuple)
+{
+    std::string payload;
+    put(payload, RecordType::Update);
+    putBytes(payload, table.getName().data(), table.getName().size());
+    put(payload, branchId);
+    put(payload, tid);
+    putTuple(payload, tuple);
+    return append(payload);
+}
+
+WriteAheadLog::lsn_t WriteAheadLog::logDelete(const Table & table, branch_id_t branchId, tid_t tid)
+{
+    std::string payload;
+    put(payload, RecordType::Delete);
+    putBytes(payload, table.getName().data(), table.getName().size());
+    put(payload, branchId);
+    put(payload, tid);
+    return append(payload);
+}
+
+WriteAheadLog::lsn_t WriteAheadLog::logCompact(const Table & table, size_t rowCount)
+{
+    std::string payload;
+    put(payload, RecordType::Compact);
+    putBytes(payload, table.getName().data(), table.getName().size());
+    put<uint64_t>(payload, rowCount);
+    return append(payload);
+}
+
+WriteAheadLog::lsn_t WriteAheadLog::logMergeBranch(branch_id_t source, branch_id_t destination)
+{
+    std::string payload;
+    put(payload, RecordType::MergeBranch);
+    put(payload, source);
+    put(payload, destination);
+    return append(payload);
+}
+
+WriteAheadLog::lsn_t WriteAheadLog::logDropBranch(branch_id_t branch)
+{
+    std::string payload;
+    put(payload, RecordType::DropBranch);
+    put(payload, branch);
+    return append(payload);
+}
+
+WriteAheadLog::lsn_t WriteAheadLog::append(const std::string & payload)
+{
+    RecordHeader header;
+    header.size = static_cast<uint32_t>(payload.size());
+    header.checksum = computeChecksum(payload.data(), payload.size());
+
+    std::lock_guard<std::mutex> guard(_mutex);
+    _buffer.append(reinterpret_cast<const char *>(&header), sizeof(header));
+    _buffer.append(payload);
+    _lastLsn += 1;
+    return _lastLsn;
+}
+
+void WriteAheadLog::commit(lsn_t lsn)
+{
+    if (lsn == 0 || _durability == Durability::Async) {
+        return;
+    }
+
+    std::unique_lock<std::mutex> lock(_mutex);
+    if (_durability == Durability::Sync) {
+        // the lock is held during the sync, hence no other statement can join it
+        if (_durableLsn < lsn) {
+            writeAndSync(_buffer);
+            _buffer.clear();
+            _durableLsn = _lastLsn;
+            _syncCount += 1;
+        }
+        return;
+    }
+
+    // group commit: the first waiting statement becomes the leader and syncs the records of all others
+    while (_durableLsn < lsn) {
+        if (_flushing) {
+            _flushed.wait(lock);
+        } else {
+            flushBuffer(lock);
+        }
+    }
+}
+
+void WriteAheadLog::flush()
+{
+    std::unique_lock<std::mutex> lock(_mutex);
+    while (_flushing) {
+        _flushed.wait(lock);
+    }
+    if (!_buffer.empty()) {
+        flushBuffer(lock);
+    }
+}
+
+uint64_t WriteAheadLog::getSyncCount()
+{
+    std::lock_guard<std::mutex> guard(_mutex);
+    return _syncCount;
+}
+
+void WriteAheadLog::flushBuffer(std::unique_lock<std::mutex> & lock)
+{
+    assert(!_flushing);
+    _flushing = true;
+    std::string batch;
+    batch.swap(_buffer);
+    lsn_t batchLsn = _lastLsn;
+    lock.unlock();
+
+    try {
+        writeAndSync(batch);
+    } catch (...) {
+        lock.lock();
+        _flushing = false;
+        _flushed.notify_all();
+        throw;
+    }
+
+    lock.lock();
+    _flushing = false;
+    _durableLsn = batchLsn;
+    _syncCount += 1;
+    _flushed.notify_all();
+}
+
+void WriteAheadLog::writeAndSync(const std::string & data)
+{
+    const char * cursor = data.data();
+    size_t remaining = data.size();
+    while (remaining > 0) {
+        ssize_t written = write(_fd, cursor, remaining);
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            throw std::runtime_error(std::string("writing the write-ahead log failed: ") + std::strerror(errno));
+        }
+        cursor += written;
+        remaining -= static_cast<size_t>(written);
+    }
+
+#ifdef __APPLE__
+    int result = fsync(_fd);
+#else
+    int result = fdatasync(_fd);
+#endif
+    if (result != 0) {
+        throw std::runtime_error(std::string("syncing the write-ahead log failed: ") + std::strerror(errno));
+    }
+}
+
+void WriteAheadLog::runFlusher()
+{
+    std::unique_lock<std::mutex> lock(_mutex);
+    while (!_stopping) {
+        _stop.wait_for(lock, asyncFlushInterval);
+        if (_buffer.empty() || _flushing) {
+            continue;
+        }
+        try {
+            flushBuffer(lock);
+        } catch (const std::exception & e) {
+            std::cerr << "write-ahead log: " << e.what() << std::endl;
+        }
+    }
+}
+
+size_t WriteAheadLog::replay(Database & db, const std::string & path)
+{
+    std::ifstream in(path, std::ios::binary);
+    if (!in) {
+        // nothing has been logged yet
+        return 0;
+    }
+    std::string log((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    in.close();
+
+    QueryContext ctx(db);
+    size_t offset = 0;
+    size_t count = 0;
+    while (log.size() - offset >= sizeof(RecordHeader)) {
+        RecordHeader header;
+        std::memcpy(&header, log.data() + offset, sizeof(header));
+        const char * payload = log.data() + offset + sizeof(header);
+        if (header.size > log.size() - offset - sizeof(header) ||
+                computeChecksum(payload, header.size) != header.checksum) {
+            break;
+        }
+
+        RecordReader reader(payload, header.size);
+        applyRecord(db, ctx, reader);
+        offset += sizeof(header) + header.size;
+        count += 1;
+    }
+
+    if (offset < log.size()) {
+        // records appended behind a torn tail would never be replayed
+        if (truncate(path.c_str(), static_cast<off_t>(offset)) != 0) {
+            throw std::runtime_error("cannot truncate write-ahead log '" + path + "': " + std::strerror(errno));
+        }
+    }
+    return count;
+}
+
+// wrapper functions
+void writeAheadLogUpdate(WriteAheadLog * log, Table * table, tid_t tid, QueryContext * ctx)
+{
+    auto tuple = get_current_master(tid, *table);
+    ctx->executionContext.commitLsn = log->logUpdate(*table, master_branch_id, tid, *tuple);
+}
+
+// generator functions
+void genWriteAheadLogUpdateCall(WriteAheadLog & log, Table & table, cg_tid_t tid, llvm::Value * queryContext)
+{
+    auto & codeGen = getThreadLocalCodeGen();
+    auto & context = codeGen.getLLVMContext();
+
+    llvm::FunctionType * funcTy = llvm::TypeBuilder<void (void *, void *, size_t, void *), false>::get(context);
+    codeGen.CreateCall(&writeAheadLogUpdate, funcTy,
+            {cg_voidptr_t::fromRawPointer(&log), cg_voidptr_t::fromRawPointer(&table), tid, queryContext});
+}
@@ -0,0 +1,119 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#include "codegen/CodeGen.hpp"
+#include "foundations/Database.hpp"
+#include "native/sql/SqlTuple.hpp"
+
+struct QueryContext;
+
+//-----------------------------------------------------------------------------
+// WriteAheadLog
+
+/// Logical redo log of all modifications of a database
+///
+/// Each record describes one operation (table creation, branch creation, insert, update, delete, compaction, branch merge or branch drop)
+/// by its arguments. Replaying the records in order against an empty database therefore reproduces
+/// the same tids and version chains. Records are buffered in memory and become durable when the
+/// statement which wrote them commits. Bulk loads (loadTable()) are logged as inserts, whereas snapshots
+/// cannot be loaded while a log is attached.
+class WriteAheadLog {
+public:
+    using lsn_t = uint64_t;
+
+    enum class Durability {
+        Sync,   ///< every commit writes and syncs the log while holding it exclusively
+        Group,  ///< commits which arrive while a sync is in progress share the next fdatasync
+        Async   ///< commits return immediately, a background thread syncs periodically
+    };
+
+    static constexpr std::chrono::milliseconds asyncFlushInterval{10};
+
+    WriteAheadLog(const std::string & path, Durability durability);
+
+    ~WriteAheadLog();
+
+    WriteAheadLog(const WriteAheadLog &) = delete;
+    WriteAheadLog & operator=(const WriteAheadLog &) = delete;
+
+    /// \param name Either "sync", "group" or "async"
+    static Durability parseDurability(const std::string & name);
+
+    static const char * getDurabilityName(Durability durability);
+
+    lsn_t logCreateTable(const Table & table);
+
+    lsn_t logCreateBranch(const std::string & name, branch_id_t parent);
+
+    lsn_t logInsert(const Table & table, branch_id_t branchId, Native::Sql::SqlTuple & tuple);
+
+    lsn_t logUpdate(const Table & table, branch_id_t branchId, tid_t tid, Native::Sql::SqlTuple & tuple);
+
+    lsn_t logDelete(const Table & table, branch_id_t branchId, tid_t tid);
+
+    /// \brief Logs that the given number of tombstones has been reclaimed, which changes the tids of moved rows
+    lsn_t logCompact(const Table & table, size_t rowCount);
+
+    /// \brief Logs the merge of a branch as a whole, since replaying it installs the same versions again
+    lsn_t logMergeBranch(branch_id_t source, branch_id_t destination);
+
+    lsn_t logDropBranch(branch_id_t branch);
+
+    /// \brief Blocks until all records up to the given one are durable; returns immediately in Async mode
+    void commit(lsn_t lsn);
+
+    /// \brief Writes and syncs all buffered records
+    void flush();
+
+    Durability getDurability() const { return _durability; }
+
+    /// \returns The number of fdatasync calls issued so far
+    uint64_t getSyncCount();
+
+    /// \brief Applies all complete records of the given log to the database and cuts off a torn tail
+    ///
+    /// Has to be called before the log is attached to the database, otherwise the records would be logged again.
+    /// \returns The number of replayed records
+    static size_t replay(Database & db, const std::string & path);
+
+private:
+    lsn_t append(const std::string & payload);
+
+    /// \brief Writes and syncs the buffer without holding the lock; other commits wait for the result
+    void flushBuffer(std::unique_lock<std::mutex> & lock);
+
+    void writeAndSync(const std::string & data);
+
+    void runFlusher();
+
+    int _fd;
+    Durability _durability;
+
+    std::mutex _mutex;
+    std::condition_variable _flushed;
+    std::condition_variable _stop;
+    std::string _buffer;
+    lsn_t _lastLsn = 0;     // the latest appended record
+    lsn_t _durableLsn = 0;  // the latest synced record
+    bool _flushing = false;
+    bool _stopping = false;
+    uint64_t _syncCount = 0;
+
+    std::thread _flusher;
+};
+
+// wrapper functions
+extern "C" {
+void writeAheadLogUpdate(WriteAheadLog * log, Table * table, tid_t tid, QueryContext * ctx);
+}
+
+// generator functions
+
+/// \brief Logs the current content of the given row as an update of the master branch
+void genWriteAheadLogUpdateCall(WriteAheadLog & log, Table & table, cg_tid_t tid, llvm::Value * queryContext);
@@ -0,0 +1,196 @@
+#include "foundations/ZoneMap.hpp"
+
+#include <cassert>
+#include <cstring>
+#include <limits>
+
+#include <llvm/IR/Constants.h>
+#include <llvm/IR/TypeBuilder.h>
+
+#include "foundations/exceptions.hpp"
+#include "utils/general.hpp"
+
+using namespace Sql;
+
+//-----------------------------------------------------------------------------
+// ZoneMap
+
+static constexpr int64_t emptyMin = std::numeric_limits<int64_t>::max();
+static constexpr int64_t emptyMax = std::numeric_limits<int64_t>::min();
+
+ZoneMap::ZoneMap(SqlType type) :
+        _type(toNotNullableTy(type)),
+        _valueSize(getValueSize(toNotNullableTy(type))),
+        _zones(sizeof(Zone))
+{
+    if (!isSupported(type)) {
+        throw InvalidOperationException("zone maps require an integer-like column");
+    }
+    assert(_valueSize == sizeof(int32_t) || _valueSize == sizeof(int64_t));
+}
+
+bool ZoneMap::isSupported(SqlType type)
+{
+    switch (type.typeID) {
+        case SqlType::TypeID::IntegerID:
+        case SqlType::TypeID::LongIntegerID:
+        case SqlType::TypeID::NumericID:
+        case SqlType::TypeID::DateID:
+        case SqlType::TypeID::TimestampID:
+            return true;
+        default:
+            return false;
+    }
+}
+
+int64_t ZoneMap::toKey(const void * value) const
+{
+    if (_valueSize == sizeof(int32_t)) {
+        int32_t narrowValue;
+        std::memcpy(&narrowValue, value, sizeof(int32_t));
+        return narrowValue;
+    }
+    int64_t wideValue;
+    std::memcpy(&wideValue, value, sizeof(int64_t));
+    return wideValue;
+}
+
+bool ZoneMap::getConstantKey(const Sql::Value & value, int64_t & key)
+{
+    if (value.type.nullable || !isSupported(value.type)) {
+        return false;
+    }
+    auto constant = llvm::dyn_cast<llvm::ConstantInt>(value.getLLVMValue());
+    if (constant == nullptr) {
+        return false;
+    }
+    key = constant->getSExtValue();
+    return true;
+}
+
+void ZoneMap::addRow()
+{
+    if ((_rowCount & (zoneCapacity - 1)) == 0) {
+        Zone zone = { emptyMin, emptyMax, 0, 0 };
+        _zones.push_back(&zone);
+    }
+    getZoneOfRow(_rowCount).rowCount += 1;
+    _rowCount += 1;
+}
+
+void ZoneMap::removeRow()
+{
+    assert(_rowCount > 0);
+    _rowCount -= 1;
+    Zone & zone = getZoneOfRow(_rowCount);
+    zone.rowCount -= 1;
+    if (zone.rowCount == 0) {
+        _zones.pop_back();
+    }
+}
+
+void ZoneMap::include(size_t row, int64_t key)
+{
+    assert(row < _rowCount);
+    Zone & zone = getZoneOfRow(row);
+    if (key < zone.min) { zone.min = key; }
+    if (key > zone.max) { zone.max = key; }
+}
+
+void ZoneMap::include(size_t row, const Native::Sql::Value & value)
+{
+#ifndef USE_INTERNAL_NULL_INDICATOR
+    if (value.type.nullable) {
+        auto & nullable = static_cast<const Native::Sql::NullableValue &>(value);
+        if (nullable.isNull()) {
+            includeNull(row);
+            return;
+        }
+        include(row, nullable.getValue());
+        return;
+    }
+#endif
+
+    int64_t buffer = 0;
+    value.store(&buffer);
+    include(row, toKey(&buffer));
+}
+
+void ZoneMap::includeNull(size_t row)
+{
+    assert(row < _rowCount);
+    getZoneOfRow(row).nullCount += 1;
+}
+
+void ZoneMap::reset(size_t zoneIndex)
+{
+    Zone & zone = *static_cast<Zone *>(_zones.at(zoneIndex));
+    zone.min = emptyMin;
+    zone.max = emptyMax;
+    zone.nullCount = 0;
+}
+
+bool ZoneMap::mayMatch(const Zone & zone, ComparisonMode mode, int64_t constant)
+{
+    switch (mode) {
+        case ComparisonMode::less:
+            return zone.min < constant;
+        case ComparisonMode::leq:
+            return zone.min <= constant;
+        case ComparisonMode::eq:
+            return zone.min <= constant && constant <= zone.max;
+        case ComparisonMode::geq:
+            return zone.max >= constant;
+        case ComparisonMode::gtr:
+            return zone.max > constant;
+        default:
+            unreachable();
+    }
+}
+
+// wrapper functions
+void zoneMapInclude(ZoneMap * zoneMap, size_t row, int64_t key)
+{
+    zoneMap->include(row, key);
+}
+
+// generator functions
+void genZoneMapIncludeCall(ZoneMap & zoneMap, cg_size_t row, const Sql::Value & value)
+{
+    auto & codeGen = getThreadLocalCodeGen();
+    auto & context = codeGen.getLLVMContext();
+
+    assert(!value.type.nullable);
+    llvm::Value * key = codeGen->CreateSExt(value.getLLVMValue(), cg_i64_t::getType());
+
+    llvm::FunctionType * funcTy = llvm::TypeBuilder<void (void *, size_t, int64_t), false>::get(context);
+    codeGen.CreateCall(&zoneMapInclude, funcTy, {cg_voidptr_t::fromRawPointer(&zoneMap), row, key});
+}
+
+cg_bool_t genZoneMayMatch(const ZoneMap & zoneMap, cg_size_t zoneIndex, ComparisonMode mode, int64_t constant)
+{
+    auto & codeGen = getThreadLocalCodeGen();
+
+    // Zone: { int64_t min, int64_t max, ... }
+    cg_voidptr_t zonePtr = genVectorElementPtr(zoneMap.getZones(), zoneIndex);
+    llvm::Type * keyTy = cg_i64_t::getType();
+    llvm::Value * boundsPtr = codeGen->CreatePointerCast(zonePtr, keyTy->getPointerTo());
+    cg_i64_t min( codeGen->CreateLoad(keyTy, boundsPtr) );
+    cg_i64_t max( codeGen->CreateLoad(keyTy, codeGen->CreateConstGEP1_32(keyTy, boundsPtr, 1)) );
+
+    cg_i64_t key(constant);
+    switch (mode) {
+        case ComparisonMode::less:
+            return min < key;
+        case ComparisonMode::leq:
+            return min <= key;
+        case ComparisonMode::eq:
+            return cg_bool_t( codeGen->CreateAnd(min <= key, key <= max) );
+        case ComparisonMode::geq:
+            return max >= key;
+        case ComparisonMode::gtr:
+            return max > key;
+        default:
+            unreachable();
+    }
+}
@@ -0,0 +1,96 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include "codegen/CodeGen.hpp"
+#include "foundations/Vector.hpp"
+#include "native/sql/SqlValues.hpp"
+#include "sql/SqlType.hpp"
+#include "sql/SqlValues.hpp"
+
+//-----------------------------------------------------------------------------
+// ZoneMap
+
+/// Per-block summary (min, max, null count, row count) of an integer-like column
+///
+/// Each zone covers exactly one scan chunk. The bounds enclose every value which has ever been
+/// written to one of the zone's rows: zones are only widened, hence they stay conservative while
+/// values are overwritten or older versions of a tuple remain visible within other branches.
+/// Values are compared as sign-extended 64-bit keys, which matches the SQL comparison operators.
+class ZoneMap {
+public:
+    /// log2 of the number of rows per zone
+    static constexpr unsigned zoneShift = Vector::defaultChunkShift;
+    static constexpr size_t zoneCapacity = static_cast<size_t>(1) << zoneShift;
+
+    struct Zone {
+        int64_t min;
+        int64_t max;
+        uint64_t nullCount;
+        uint64_t rowCount;
+    };
+
+    /// \param type Integer, LongInteger, Numeric, Date or Timestamp
+    ZoneMap(Sql::SqlType type);
+
+    static bool isSupported(Sql::SqlType type);
+
+    /// \returns The key of the value at the given address
+    int64_t toKey(const void * value) const;
+
+    /// \brief Converts a constant of the column type into its key
+    /// \returns false if the value is not a compile time constant
+    static bool getConstantKey(const Sql::Value & value, int64_t & key);
+
+    Sql::SqlType getType() const { return _type; }
+
+    /// \brief Appends an empty row
+    void addRow();
+
+    /// \brief Removes the last row; the bounds of its zone are kept
+    void removeRow();
+
+    void include(size_t row, int64_t key);
+
+    void include(size_t row, const Native::Sql::Value & value);
+
+    void includeNull(size_t row);
+
+    /// \brief Clears the bounds and the null count of the given zone
+    void reset(size_t zoneIndex);
+
+    size_t size() const { return _rowCount; }
+
+    size_t getZoneCount() const { return _zones.size(); }
+
+    const Zone & getZone(size_t zoneIndex) const { return *static_cast<const Zone *>(_zones.at(zoneIndex)); }
+
+    const Vector & getZones() const { return _zones; }
+
+    /// \returns false if no value of the zone satisfies "value mode constant"
+    static bool mayMatch(const Zone & zone, Sql::ComparisonMode mode, int64_t constant);
+
+private:
+    friend class Snapshot;
+
+    Zone & getZoneOfRow(size_t row) { return *static_cast<Zone *>(_zones.at(row >> zoneShift)); }
+
+    Sql::SqlType _type;
+    size_t _valueSize;
+    size_t _rowCount = 0;
+    Vector _zones;
+};
+
+// wrapper functions
+extern "C" {
+void zoneMapInclude(ZoneMap * zoneMap, size_t row, int64_t key);
+}
+
+// generator functions
+
+/// \brief Widens the zone of the given row by the given value at runtime
+void genZoneMapIncludeCall(ZoneMap & zoneMap, cg_size_t row, const Sql::Value & value);
+
+/// \returns Whether the zone with the given index may contain a value satisfying "value mode constant"
+cg_bool_t genZoneMayMatch(const ZoneMap & zoneMap, cg_size_t zoneIndex, Sql::ComparisonMode mode, int64_t constant);
@@ -6,14 +6,16 @@
 #include "codegen/CodeGen.hpp"
 #include "foundations/Database.hpp"
 #include "foundations/version_management.hpp"
+#include "foundations/WriteAheadLog.hpp"
 #include "sql/SqlType.hpp"
 #include "sql/SqlValues.hpp"
 #include "utils/general.hpp"
 
 using namespace Sql;
 
-void genLoadValue(cg_ptr8_t str, cg_size_t length, SqlType type, Vector & column)
+void genLoadValue(cg_ptr8_t str, cg_size_t length, ci_p_t ci)
 {
+    SqlType type = ci->type;
     auto & codeGen = getThreadLocalCodeGen();
 
     // this is fine for both types of null indicators
@@ -23,7 +25,21 @@ void genLoadValue(cg_ptr8_t str, cg_size_t length, SqlType type, Vector & column
 
     // parse value
     value_op_t value = Value::castString(str, length, notNullableType);
-    cg_voidptr_t destPtr = genVectoBackCall(cg_voidptr_t::fromRawPointer(&column));
+    if (ci->packed != nullptr) {
+        genPackedIntegerColumnSetBackCall(*ci->packed, *value);
+        return;
+    }
+
+    cg_voidptr_t destPtr = genVectoBackCall(cg_voidptr_t::fromRawPointer(ci->column));
+
+    if (ci->dictionary != nullptr) {
+        // store the code of the value
+        StringDictionary::cg_code_t code = genStringDictionaryEncode(*ci->dictionary, *value);
+        llvm::Value * codePtr = codeGen->CreatePointerCast(destPtr.getValue(),
+                llvm::PointerType::getUnqual(StringDictionary::cg_code_t::getType()));
+        codeGen->CreateStore(code, codePtr);
+        return;
+    }
 
     // cast destination pointer
     llvm::Type * sqlValuePtrTy = llvm::PointerType::getUnqual(toLLVMTy(notNullableType));
@@ -94,7 +110,7 @@ llvm::Function * genLoadRowFunction(Table & table)
         llvm::Value * length = codeGen->CreateLoad(lengthPtr);
         llvm::Value * str = codeGen->CreateLoad(strPtr);
 
-        genLoadValue(cg_ptr8_t(str), cg_size_t(length), ci->type, *ci->column);
+        genLoadValue(cg_ptr8_t(str), cg_size_t(length), ci);
 
         i += 1;
     }
@@ -119,6 +135,7 @@ void loadTable(std::istream & stream, Table & table, char delimiter)
     FunPtr f = reinterpret_cast<FunPtr>(ee->getPointerToFunction(loadFun));
 
     // load each row
+    size_t firstRow = table.size();
     std::string rowStr;
     std::vector<RowItem> row(table.getColumnCount());
     while (std::getline(stream, rowStr)) {
@@ -138,6 +155,18 @@ void loadTable(std::istream & stream, Table & table, char delimiter)
         // load row
         f(row.data());
     }
+
+    // the generated code writes to the columns directly
+    table.refreshZoneMaps(firstRow);
+
+    // later records address the loaded rows by their tids, hence they are logged like inserted ones
+    if (auto log = table.getDatabase().getWriteAheadLog()) {
+        WriteAheadLog::lsn_t lsn = 0;
+        for (tid_t tid = firstRow; tid < table.size(); ++tid) {
+            lsn = log->logInsert(table, master_branch_id, *get_current_master(tid, table));
+        }
+        log->commit(lsn);
+    }
 }
 
 std::unique_ptr<Database> loadUniDb()
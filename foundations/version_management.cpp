@@ -1,82 +1,190 @@
 #include "foundations/version_management.hpp"
 
+#include <algorithm>
+#include <cassert>
 #include <iostream>
+#include <new>
+#include <unordered_set>
 
+#include <llvm/IR/TypeBuilder.h>
+
+#include "foundations/WriteAheadLog.hpp"
 #include "foundations/exceptions.hpp"
 #include "utils/general.hpp"
 
-template<typename T>
-static bool is_visible(const T & elem, QueryContext & ctx) {
-    branch_id_t current_branch = ctx.executionContext.branchId;
-    if (elem.branch_id == current_branch) {
-        return true;
-    }
-    const auto & branch_lineage = ctx.executionContext.branch_lineage;
-    auto it = branch_lineage.find(elem.branch_id);
-    if (it != branch_lineage.end() && elem.creation_ts < it->second) {
-        return true;
+/// \brief Lets the context operate on the given branch, whose lineage has been constructed before unless it is not read
+static void use_branch(QueryContext & ctx, branch_id_t branch) {
+    auto & executionContext = ctx.executionContext;
+    executionContext.branchId = branch;
+    if (executionContext.branch_lineage == nullptr || executionContext.branch_lineage->branch != branch) {
+        auto lineage = executionContext.branch_lineages.find(branch);
+        if (lineage != executionContext.branch_lineages.end()) {
+            executionContext.branch_lineage = &lineage->second;
+        }
     }
-    return false;
 }
 
-static VersionedTupleStorage * create_chain_element(Table & table, size_t tuple_size) {
-    size_t size = sizeof(VersionedTupleStorage) + tuple_size;
-    void * mem = std::malloc(size);
+static size_t get_element_size(uint64_t column_mask, Table & table) {
+    return sizeof(VersionedTupleStorage) + table.getVersionRecordSize(column_mask);
+}
+
+static VersionedTupleStorage * create_chain_element(Table & table, branch_id_t branch, uint64_t column_mask) {
+    void * mem = table.allocateVersion(get_element_size(column_mask, table), branch);
     VersionedTupleStorage * storage = new (mem) VersionedTupleStorage();
+    storage->column_mask = column_mask;
     return storage;
 }
 
-inline void * get_tuple_ptr(VersionedTupleStorage * storage) {
-    return storage->data;
+static void release_chain_element(VersionedTupleStorage * storage, Table & table) {
+    table.releaseVersion(storage, get_element_size(storage->column_mask, table));
+}
+
+/// \brief Stores the values of the columns within the element's column mask
+static void store_version_values(VersionedTupleStorage * storage, Native::Sql::SqlTuple & tuple, Table & table) {
+    for (size_t column_idx = 0; column_idx < tuple.values.size(); ++column_idx) {
+        if (has_column_value(storage->column_mask, column_idx)) {
+            tuple.values[column_idx]->store(storage->data + table.getVersionValueOffset(storage->column_mask, column_idx));
+        }
+    }
+}
+
+static Native::Sql::value_op_t load_version_value(tid_t tid, const void * element, size_t column_idx, Table & table) {
+    const void * ptr = get_version_value(tid, element, column_idx, table);
+    if (ptr == nullptr) {
+        return load_master_value(tid, column_idx, table);
+    }
+    return Native::Sql::Value::load(ptr, table.getCI(column_idx)->type);
+}
+
+/// \returns The tuple version which is represented by the given chain element
+static std::unique_ptr<Native::Sql::SqlTuple> load_version(tid_t tid, const void * element, Table & table) {
+    return std::make_unique<Native::Sql::SqlTuple>(get_version_values(tid, element, table));
+}
+
+static void store_column_value(tid_t tid, const ColumnInformation & ci, const Native::Sql::Value & value) {
+    if (ci.zoneMap != nullptr) {
+        ci.zoneMap->include(tid, value);
+    }
+    if (ci.packed != nullptr) {
+        int64_t buffer = 0;
+        value.store(&buffer);
+        int64_t packedValue = (ci.packed->getValueSize() == sizeof(int32_t)) ?
+                static_cast<int64_t>(*reinterpret_cast<int32_t *>(&buffer)) : buffer;
+        ci.packed->set(tid, packedValue);
+        return;
+    }
+
+    // copies the chunk first if it is shared with another branch
+    void * ptr = ci.column->at(tid);
+    StringDictionary * dictionary = ci.dictionary;
+    if (dictionary == nullptr) {
+        value.store(ptr);
+        return;
+    }
+
+    std::vector<uint8_t> buffer(dictionary->getValueSize());
+    value.store(buffer.data());
+    *static_cast<StringDictionary::code_t *>(ptr) = dictionary->encode(buffer.data());
+}
+
+static Native::Sql::value_op_t load_column_value(tid_t tid, const ColumnInformation & ci) {
+    if (ci.packed != nullptr) {
+        int64_t value = ci.packed->get(tid);
+        int32_t narrowValue = static_cast<int32_t>(value);
+        const void * ptr = (ci.packed->getValueSize() == sizeof(int32_t)) ?
+                static_cast<const void *>(&narrowValue) : static_cast<const void *>(&value);
+        return Native::Sql::Value::load(ptr, ci.type);
+    }
+
+    const void * ptr = static_cast<const Vector *>(ci.column)->at(tid);
+    if (ci.dictionary != nullptr) {
+        ptr = ci.dictionary->decode(*static_cast<const StringDictionary::code_t *>(ptr));
+    }
+    return Native::Sql::Value::load(ptr, ci.type);
 }
 
-inline const void * get_tuple_ptr(const VersionedTupleStorage * storage) {
-    return storage->data;
+static bool uses_pages(Table & table) {
+    return table.getVersioningEngine() == Table::VersioningEngine::Pages;
+}
+
+/// \returns The column which holds the values of the branch in a table which is versioned by pages
+static const ColumnInformation & get_branch_column(branch_id_t branch, size_t column_idx, Table & table) {
+    auto columns = table.getBranchColumns(branch);
+    return (columns != nullptr) ? *(*columns)[column_idx] : *table.getCI(column_idx);
+}
+
+/// \brief Overwrites the values of the tuple within the columns of the branch
+static void store_branch_tuple(tid_t tid, branch_id_t branch, Native::Sql::SqlTuple & tuple, Table & table) {
+    for (size_t column_idx = 0; column_idx < tuple.values.size(); ++column_idx) {
+        store_column_value(tid, get_branch_column(branch, column_idx, table), *tuple.values[column_idx]);
+    }
+}
+
+static std::unique_ptr<Native::Sql::SqlTuple> load_branch_tuple(tid_t tid, branch_id_t branch, Table & table) {
+    std::vector<Native::Sql::value_op_t> values;
+    for (size_t column_idx = 0; column_idx < table.getColumnCount(); ++column_idx) {
+        values.push_back(load_column_value(tid, get_branch_column(branch, column_idx, table)));
+    }
+    return std::make_unique<Native::Sql::SqlTuple>(std::move(values));
 }
 
 tid_t insert_tuple(Native::Sql::SqlTuple & tuple, Table & table, QueryContext & ctx) {
     tid_t tid;
     branch_id_t branch = ctx.executionContext.branchId;
     Database & db = table.getDatabase();
-    size_t branch_cnt = 1 + db.getLargestBranchId();
 
-    tid = table._version_mgmt_column.size();
+    if (uses_pages(table)) {
+        // there are no version chains, only the columns of the branch hold the tuple
+        table.addRow(branch);
+        tid = table.size() - 1;
+        store_branch_tuple(tid, branch, tuple, table);
+    } else {
+        tid = table._version_mgmt_column.size();
 
-    table._version_mgmt_column.push_back(std::make_unique<VersionEntry>());
-    VersionEntry * version_entry = table._version_mgmt_column.back().get();
-    version_entry->first = version_entry;
-    version_entry->next = nullptr;
-    version_entry->next_in_branch = nullptr;
+        VersionEntry & version_entry = table._version_mgmt_column.emplace_back();
 
-    // branch visibility
-    version_entry->branch_id = branch;
-    version_entry->branch_visibility.resize(branch_cnt, false);
-    version_entry->branch_visibility.set(branch);
-    version_entry->creation_ts = db.getLargestBranchId();
+        // branch visibility
+        version_entry.branch_id = branch;
+        version_entry.branch_visibility.set(branch);
+        version_entry.creation_ts = db.getLargestBranchId();
 
-    // store tuple
-    table.addRow(branch);
-    size_t column_idx = 0;
-    for (auto & value : tuple.values) {
-        void * ptr = const_cast<void *>(table.getColumn(column_idx).back());
-        value->store(ptr);
-        column_idx += 1;
+        // store tuple
+        table.addRow(branch);
+        tid_t row = table.size() - 1;
+        size_t column_idx = 0;
+        for (auto & value : tuple.values) {
+            store_master_value(row, column_idx, *value, table);
+            column_idx += 1;
+        }
+    }
+    table.updateMaterializedBranches(branch, tid);
+
+    if (auto log = db.getWriteAheadLog()) {
+        ctx.executionContext.commitLsn = log->logInsert(table, branch, tuple);
     }
 
     return tid;
 }
 
 tid_t insert_tuple_with_branchId(Native::Sql::SqlTuple & tuple, Table & table, QueryContext & ctx, branch_id_t branchId) {
-    ctx.executionContext.branchId = branchId;
+    use_branch(ctx, branchId);
     return insert_tuple(tuple,table,ctx);
 }
 
+void store_master_value(tid_t tid, size_t column_idx, const Native::Sql::Value & value, Table & table) {
+    store_column_value(tid, *table.getCI(column_idx), value);
+}
+
+Native::Sql::value_op_t load_master_value(tid_t tid, size_t column_idx, Table & table) {
+    return load_column_value(tid, *table.getCI(column_idx));
+}
+
 VersionEntry * get_version_entry(tid_t tid, Table & table) {
     if (is_marked_as_dangling_tid(tid)) {
         tid_t unmarked = unmark_dangling_tid(tid);
-        return table._dangling_version_mgmt_column[unmarked].get();
+        return &table._dangling_version_mgmt_column[unmarked];
     } else {
-        return table._version_mgmt_column[tid].get();
+        return &table._version_mgmt_column[tid];
     }
 }
 
@@ -84,8 +192,7 @@ std::unique_ptr<Native::Sql::SqlTuple> get_current_master(tid_t tid, Table & tab
     std::vector<Native::Sql::value_op_t> values;
     auto tuple_type = table.getTupleType();
     for (size_t i = 0; i < tuple_type.size(); ++i) {
-        const void * ptr = table.getColumn(i).at(tid);
-        values.push_back(Native::Sql::Value::load(ptr, tuple_type[i]));
+        values.push_back(load_master_value(tid, i, table));
     }
     return std::make_unique<Native::Sql::SqlTuple>(std::move(values));
 }
@@ -93,118 +200,276 @@ std::unique_ptr<Native::Sql::SqlTuple> get_current_master(tid_t tid, Table & tab
 static void update_master(tid_t tid, Native::Sql::SqlTuple & tuple, Table & table) {
     size_t column_idx = 0;
     for (auto & value : tuple.values) {
-        void * ptr = const_cast<void *>(table.getColumn(column_idx).at(tid));
-        value->store(ptr);
+        store_master_value(tid, column_idx, *value, table);
         column_idx += 1;
     }
 }
 
-void update_tuple(tid_t tid, Native::Sql::SqlTuple & tuple, Table & table, QueryContext & ctx) {
-    branch_id_t branch = ctx.executionContext.branchId;
-
-    if (is_marked_as_dangling_tid(tid) && branch == master_branch_id) {
-        throw std::runtime_error("no such tuple in the given branch");
-    }
-
+/// \brief Moves the current master row into a chain element and overwrites it by the given tuple
+static void add_master_version(tid_t tid, Native::Sql::SqlTuple & tuple, Table & table) {
     Database & db = table.getDatabase();
     auto version_entry = get_version_entry(tid, table);
-    if (branch == master_branch_id) {
-        auto old_tuple = get_current_master(tid, table);
+    auto old_tuple = get_current_master(tid, table);
 
-        auto storage = create_chain_element(table, old_tuple->getSize());
+    // the copy of the old master row only holds the columns which differ from its predecessor, the previous copy;
+    // values which it inherits from a copy freed by the version collection are retained by release_chain_elements()
+    const void * predecessor = version_entry->next_in_branch;
+    uint64_t column_mask = (predecessor == nullptr) ? all_columns_mask : 0;
+    for (size_t column_idx = 0; column_idx < old_tuple->values.size() && predecessor != nullptr; ++column_idx) {
+        if (column_idx >= 64) {
+            break; // held by every record
+        }
+        auto old_value = load_version_value(tid, predecessor, column_idx, table);
+        if (!old_tuple->values[column_idx]->equals(*old_value)) {
+            column_mask |= static_cast<uint64_t>(1) << column_idx;
+        }
+    }
+    auto storage = create_chain_element(table, version_entry->branch_id, column_mask);
 
-        // branch visibility
-        storage->branch_id = version_entry->branch_id;
-        storage->creation_ts = version_entry->creation_ts;
+    // branch visibility
+    storage->branch_id = version_entry->branch_id;
+    storage->creation_ts = version_entry->creation_ts;
 
-        // Hand over next and next_in_branch values from version_entry to storage
-        storage->next = version_entry->next;
-        storage->next_in_branch = version_entry->next_in_branch;
-        // If the head of the chain does not equal the version_entry,
-        // adjust the next pointer of the previous storage element to the created one
-        if (version_entry->first != version_entry) {
-            ((VersionedTupleStorage*)version_entry->prev)->next = storage;
-        }
+    // Hand over next and next_in_branch values from version_entry to storage
+    storage->next = version_entry->next;
+    storage->next_in_branch = version_entry->next_in_branch;
+    // If the head of the chain does not equal the version_entry,
+    // adjust the next pointer of the previous storage element to the created one
+    if (version_entry->first != version_entry) {
+        ((VersionedTupleStorage*)version_entry->prev)->next = storage;
+    }
 
-        old_tuple->store(get_tuple_ptr(storage));
+    store_version_values(storage, *old_tuple, table);
 
-        // version entry update
-        if (version_entry->first != version_entry) {            // next should point to the old head of the chain
-            version_entry->next = version_entry->first;
-        } else {
-            version_entry->next = storage;
+    // versions of other branches which have been derived from the old master row now refer to its copy
+    for (const void * next = version_entry->first; next != nullptr; ) {
+        if (next == version_entry) {
+            next = version_entry->next;
+            continue;
+        }
+        auto element = static_cast<VersionedTupleStorage *>(const_cast<void *>(next));
+        if (element->next_in_branch == version_entry) {
+            element->next_in_branch = storage;
         }
-        version_entry->next_in_branch = storage;                // next_in_branch points to the inserted storage entry
-        version_entry->first = version_entry;                   // the head now points again to the version_entry
-        version_entry->branch_id = branch;
-        version_entry->creation_ts = db.getLargestBranchId();
+        next = element->next;
+    }
+
+    // the copy is the latest element of a branch which has inserted the tuple
+    if (version_entry->branch_id != master_branch_id && version_entry->heads.get(version_entry->branch_id) == nullptr) {
+        version_entry->heads.set(version_entry->branch_id, storage);
+    }
 
-        // new master
-        update_master(tid, tuple, table);
+    // version entry update
+    if (version_entry->first != version_entry) {            // next should point to the old head of the chain
+        version_entry->next = version_entry->first;
     } else {
-        auto predecessor = get_latest_chain_element(version_entry, table, ctx);
-        if (predecessor == nullptr) {
-            throw std::runtime_error("no such tuple in the given branch");
+        version_entry->next = storage;
+    }
+    version_entry->next_in_branch = storage;                // next_in_branch points to the inserted storage entry
+    version_entry->first = version_entry;                   // the head now points again to the version_entry
+    version_entry->branch_id = master_branch_id;
+    version_entry->creation_ts = db.getLargestBranchId();
+
+    // the master row which the branches have forked off from is part of the chain now
+    if (!is_marked_as_dangling_tid(tid)) {
+        table.markModified(tid, master_branch_id);
+    }
+
+    // new master
+    update_master(tid, tuple, table);
+}
+
+/// \brief Prepends a version of the given branch to the chain
+/// \param predecessor The element which has been visible in the branch so far; the new version holds all columns if null
+static void add_branch_version(tid_t tid, branch_id_t branch, const void * predecessor, Native::Sql::SqlTuple & tuple, Table & table) {
+    Database & db = table.getDatabase();
+    auto version_entry = get_version_entry(tid, table);
+
+    // only the columns which differ from the predecessor are stored
+    uint64_t column_mask = (predecessor == nullptr) ? all_columns_mask : 0;
+    for (size_t column_idx = 0; column_idx < tuple.values.size() && predecessor != nullptr; ++column_idx) {
+        if (column_idx >= 64) {
+            break; // held by every record
+        }
+        auto old_value = load_version_value(tid, predecessor, column_idx, table);
+        if (!tuple.values[column_idx]->equals(*old_value)) {
+            column_mask |= static_cast<uint64_t>(1) << column_idx;
         }
+    }
+    // a superseded version of the same branch may be freed by the next collection, hence its values are retained
+    if (predecessor != nullptr && predecessor != version_entry) {
+        auto superseded = static_cast<const VersionedTupleStorage *>(predecessor);
+        if (superseded->branch_id == branch) {
+            column_mask |= superseded->column_mask;
+        }
+    }
 
-        auto storage = create_chain_element(table, tuple.getSize());
+    auto storage = create_chain_element(table, branch, column_mask);
 
-        // branch visibility
-        storage->branch_id = branch;
-        storage->creation_ts = db.getLargestBranchId();
-        size_t branch_cnt = 1 + db.getLargestBranchId();
-        if (version_entry->branch_visibility.size() < branch_cnt) {
-            version_entry->branch_visibility.resize(branch_cnt, false);
+    // branch visibility
+    storage->branch_id = branch;
+    storage->creation_ts = db.getLargestBranchId();
+    version_entry->branch_visibility.set(branch);
+    version_entry->heads.set(branch, storage);
+
+    store_version_values(storage, tuple, table);
+
+    // scans of this branch read the new version at the master row of the tuple
+    if (!is_marked_as_dangling_tid(tid)) {
+        table.markModified(tid, branch);
+        for (size_t column_idx = 0; column_idx < tuple.values.size(); ++column_idx) {
+            ci_p_t ci = table.getCI(column_idx);
+            if (ci->zoneMap != nullptr && has_column_value(column_mask, column_idx)) {
+                ci->zoneMap->include(tid, *tuple.values[column_idx]);
+            }
         }
-        version_entry->branch_visibility.set(branch);
+    }
+
+    storage->next = version_entry->first;
+    storage->next_in_branch = predecessor;
+
+    // If the head equals the version_entry set the prev pointer of the version_entry to the address of the
+    // created storage entry
+    if (version_entry->first == version_entry) version_entry->prev = storage;
+    version_entry->first = storage;
+}
 
-        tuple.store(get_tuple_ptr(storage));
+void update_tuple(tid_t tid, Native::Sql::SqlTuple & tuple, Table & table, QueryContext & ctx) {
+    branch_id_t branch = ctx.executionContext.branchId;
+
+    if (is_marked_as_dangling_tid(tid) && branch == master_branch_id) {
+        throw std::runtime_error("no such tuple in the given branch");
+    }
+
+    if (uses_pages(table)) {
+        // the columns of the branch are overwritten in place, shared chunks are copied first
+        if (!table.getBranchBitmap().isSet(tid, branch)) {
+            throw std::runtime_error("no such tuple in the given branch");
+        }
+        store_branch_tuple(tid, branch, tuple, table);
+    } else {
+        if (branch == master_branch_id) {
+            add_master_version(tid, tuple, table);
+        } else {
+            auto predecessor = get_latest_chain_element(get_version_entry(tid, table), table, ctx);
+            if (predecessor == nullptr) {
+                throw std::runtime_error("no such tuple in the given branch");
+            }
+            add_branch_version(tid, branch, predecessor, tuple, table);
+        }
 
-        storage->next = version_entry->first;
-        storage->next_in_branch = predecessor;
+        // the new version might supersede an older one of the same branch
+        table.scheduleVersionCollection(tid);
+    }
+    table.updateMaterializedBranches(branch, tid);
 
-        // If the head equals the version_entry set the prev pointer of the version_entry to the address of the
-        // created storage entry
-        if (version_entry->first == version_entry) version_entry->prev = storage;
-        version_entry->first = storage;
+    if (auto log = table.getDatabase().getWriteAheadLog()) {
+        ctx.executionContext.commitLsn = log->logUpdate(table, branch, tid, tuple);
     }
 }
 
 void update_tuple_with_branchId(tid_t tid, branch_id_t branchId, Native::Sql::SqlTuple & tuple, Table & table, QueryContext & ctx) {
-    ctx.executionContext.branchId = branchId;
+    use_branch(ctx, branchId);
     return update_tuple(tid,tuple,table,ctx);
 }
 
 void delete_tuple(tid_t tid, Table & table, QueryContext & ctx) {
     branch_id_t branch = ctx.executionContext.branchId;
 
+    // scans of materialized branches read the branch bitmap, hence their copies are not affected
     table.removeRowForBranch(tid,branch);
+
+    if (auto log = table.getDatabase().getWriteAheadLog()) {
+        ctx.executionContext.commitLsn = log->logDelete(table, branch, tid);
+    }
 }
 
 void delete_tuple_with_branchId(tid_t tid, branch_id_t branchId, Table & table, QueryContext & ctx) {
-    ctx.executionContext.branchId = branchId;
+    use_branch(ctx, branchId);
 
     delete_tuple(tid,table,ctx);
 }
 
-const void * get_latest_chain_element(const VersionEntry * version_entry, Table & table, QueryContext & ctx) {
-    branch_id_t branch = ctx.executionContext.branchId;
+/// \returns Whether both chain elements hold the same values
+static bool has_equal_values(tid_t tid, const void * lhs, const void * rhs, Table & table) {
+    for (size_t i = 0; i < table.getColumnCount(); ++i) {
+        if (!load_version_value(tid, lhs, i, table)->equals(*load_version_value(tid, rhs, i, table))) {
+            return false;
+        }
+    }
+    return true;
+}
 
-    if (branch == master_branch_id) {
-        return version_entry;
+merge_status_t check_merge(tid_t tid, Table & table, QueryContext & src_ctx, QueryContext & dst_ctx, const void ** src_element) {
+    branch_id_t src_branch = src_ctx.executionContext.branchId;
+    branch_id_t dst_branch = dst_ctx.executionContext.branchId;
+    const BitmapTable & branch_bitmap = table.getBranchBitmap();
+    const auto version_entry = get_version_entry(tid, table);
+    auto get_branch = [version_entry](const void * element) {
+        return (element == version_entry) ? version_entry->branch_id
+                : static_cast<const VersionedTupleStorage *>(element)->branch_id;
+    };
+
+    // deletions within the source branch are not merged
+    if (!version_entry->branch_visibility.test(src_branch) || !branch_bitmap.isSet(tid, src_branch)) {
+        return merge_status_t::untouched;
+    }
+    const void * latest = get_latest_chain_element(version_entry, table, src_ctx);
+    if (latest == nullptr || get_branch(latest) != src_branch) {
+        return merge_status_t::untouched;
     }
+    *src_element = latest;
 
-    const void * next = version_entry->first;
+    if (!branch_bitmap.isSet(tid, dst_branch)) {
+        // the tuple has either been inserted into the source branch or deleted from the destination
+        return (version_entry->branch_id == src_branch) ? merge_status_t::mergeable : merge_status_t::conflict;
+    }
+    const void * current = get_latest_chain_element(version_entry, table, dst_ctx);
+    if (current == nullptr) {
+        return merge_status_t::conflict;
+    }
+    branch_id_t creation_ts = (current == version_entry) ? version_entry->creation_ts
+            : static_cast<const VersionedTupleStorage *>(current)->creation_ts;
+    // versions which have been created after the source branch are unknown to it,
+    // unless they stem from merging the source's latest version before
+    if (get_branch(current) == dst_branch && creation_ts >= src_branch) {
+        return has_equal_values(tid, current, latest, table) ? merge_status_t::untouched : merge_status_t::conflict;
+    }
+    return merge_status_t::mergeable;
+}
+
+void merge_tuple(tid_t tid, branch_id_t dst_branch, Native::Sql::SqlTuple & tuple, Table & table, QueryContext & ctx) {
+    BitmapTable & branch_bitmap = table.getBranchBitmap();
+    auto version_entry = get_version_entry(tid, table);
+    bool visible = branch_bitmap.isSet(tid, dst_branch);
+
+    if (dst_branch == master_branch_id) {
+        add_master_version(tid, tuple, table);
+    } else {
+        const void * predecessor = visible ? get_latest_chain_element(version_entry, table, ctx) : nullptr;
+        add_branch_version(tid, dst_branch, predecessor, tuple, table);
+    }
+
+    if (!visible) {
+        branch_bitmap.set(tid, dst_branch, true);
+        version_entry->branch_visibility.set(dst_branch);
+    }
+    table.scheduleVersionCollection(tid);
+    table.updateMaterializedBranches(dst_branch, tid);
+}
+
+/// \returns The first element, starting at 'next', which is visible within the lineage
+static const void * find_visible_element(const VersionEntry * version_entry, const void * next, const BranchLineage & lineage) {
     while (next != nullptr) {
         if (next == version_entry) {
             // this is the current master branch
-            if (is_visible(*version_entry, ctx)) {
+            if (lineage.isVisible(version_entry->branch_id, version_entry->creation_ts)) {
                 return version_entry;
             }
             next = version_entry->next;
         } else {
             const auto storage = static_cast<const VersionedTupleStorage *>(next);
-            if (is_visible(*storage, ctx)) {
+            if (lineage.isVisible(storage->branch_id, storage->creation_ts)) {
                 return storage;
             }
             next = storage->next;
@@ -213,6 +478,52 @@ const void * get_latest_chain_element(const VersionEntry * version_entry, Table
     return nullptr;
 }
 
+const void * get_latest_chain_element(const VersionEntry * version_entry, Table & table, QueryContext & ctx) {
+    branch_id_t branch = ctx.executionContext.branchId;
+
+    if (branch == master_branch_id) {
+        return version_entry;
+    }
+    return get_latest_lineage_element(version_entry, ctx.executionContext.branch_lineage);
+}
+
+const void * get_latest_lineage_element(const VersionEntry * version_entry, const BranchLineage * branch_lineage) {
+    // the visible elements of a branch are newer than the ones of its ancestors, which have been created before
+    // the branch forked off; hence the lineage is searched upwards, each branch from its latest element on
+    const BranchLineage & lineage = *branch_lineage;
+    for (branch_id_t member : lineage.ancestors) {
+        const void * element = version_entry->heads.get(member);
+        if (element == nullptr && version_entry->branch_id == member) {
+            element = version_entry;
+        }
+
+        const void * last = nullptr;
+        while (element != nullptr) {
+            bool is_entry = (element == version_entry);
+            auto storage = static_cast<const VersionedTupleStorage *>(element);
+            branch_id_t element_branch = is_entry ? version_entry->branch_id : storage->branch_id;
+            if (element_branch != member) {
+                break; // an element of an ancestor, which is visited along with its own branch
+            }
+            branch_id_t creation_ts = is_entry ? version_entry->creation_ts : storage->creation_ts;
+            if (lineage.isVisible(member, creation_ts)) {
+                return element;
+            }
+            last = element;
+            element = is_entry ? version_entry->next_in_branch : storage->next_in_branch;
+        }
+
+        if (element == nullptr && last != nullptr) {
+            // the older elements of the branch are not linked to the newer ones (e.g. after a merge has re-inserted
+            // the tuple), but all of them follow within the chain
+            const void * next = (last == version_entry) ? version_entry->next
+                    : static_cast<const VersionedTupleStorage *>(last)->next;
+            return find_visible_element(version_entry, next, lineage);
+        }
+    }
+    return nullptr;
+}
+
 const void * get_earliest_chain_element(const VersionEntry * version_entry, Table & table, QueryContext & ctx) {
     const void * latest = get_latest_chain_element(version_entry, table, ctx);
 
@@ -253,6 +564,12 @@ std::unique_ptr<Native::Sql::SqlTuple> get_latest_tuple(tid_t tid, Table & table
     if (branch == master_branch_id) {
         return get_current_master(tid, table);
     }
+    if (uses_pages(table)) {
+        if (!table.getBranchBitmap().isSet(tid, branch)) {
+            throw std::runtime_error("no such tuple in the given branch");
+        }
+        return load_branch_tuple(tid, branch, table);
+    }
 
     const auto version_entry = get_version_entry(tid, table);
     const void * element = get_latest_chain_element(version_entry, table, ctx);
@@ -261,16 +578,12 @@ std::unique_ptr<Native::Sql::SqlTuple> get_latest_tuple(tid_t tid, Table & table
     } else if (element == version_entry) {
         return get_current_master(tid, table);
     } else {
-        const auto storage = static_cast<const VersionedTupleStorage *>(element);
-        const void * tuple_ptr = get_tuple_ptr(storage);
-        auto tuple_type = table.getTupleType();
-        return Native::Sql::SqlTuple::load(tuple_ptr, tuple_type);
+        return load_version(tid, element, table);
     }
 }
 
 const void *get_latest_entry(tid_t tid, Table & table, branch_id_t branchId, QueryContext & ctx) {
-    ctx.executionContext.branchId = branchId;
-    ctx.executionContext.branch_lineage = ctx.executionContext.branch_lineages[branchId];
+    use_branch(ctx, branchId);
 
     if (branchId == master_branch_id) {
         return nullptr;
@@ -283,9 +596,28 @@ const void *get_latest_entry(tid_t tid, Table & table, branch_id_t branchId, Que
     } else if (element == version_entry) {
         return nullptr;
     } else {
+        return element;
+    }
+}
+
+std::vector<Native::Sql::value_op_t> get_version_values(tid_t tid, const void * element, Table & table) {
+    std::vector<Native::Sql::value_op_t> values;
+    for (size_t i = 0; i < table.getColumnCount(); ++i) {
+        values.push_back(load_version_value(tid, element, i, table));
+    }
+    return values;
+}
+
+const void * get_version_value(tid_t tid, const void * element, size_t column_idx, Table & table) {
+    const VersionEntry * version_entry = get_version_entry(tid, table);
+    while (element != nullptr && element != version_entry) {
         const auto storage = static_cast<const VersionedTupleStorage *>(element);
-        return get_tuple_ptr(storage);
+        if (has_column_value(storage->column_mask, column_idx)) {
+            return storage->data + table.getVersionValueOffset(storage->column_mask, column_idx);
+        }
+        element = storage->next_in_branch;
     }
+    return nullptr;
 }
 
 std::unique_ptr<Native::Sql::SqlTuple> get_tuple(tid_t tid, unsigned revision_offset, Table & table, QueryContext & ctx) {
@@ -296,10 +628,7 @@ std::unique_ptr<Native::Sql::SqlTuple> get_tuple(tid_t tid, unsigned revision_of
     } else if (element == version_entry) {
         return get_current_master(tid, table);
     } else {
-        const auto storage = static_cast<const VersionedTupleStorage *>(element);
-        const void * tuple_ptr = get_tuple_ptr(storage);
-        auto tuple_type = table.getTupleType();
-        return Native::Sql::SqlTuple::load(tuple_ptr, tuple_type);
+        return load_version(tid, element, table);
     }
 }
 
@@ -307,12 +636,15 @@ bool is_visible(tid_t tid, Table & table, QueryContext & ctx) {
     if (is_marked_as_dangling_tid(tid) && ctx.executionContext.branchId == master_branch_id) {
         return false;
     }
+    if (uses_pages(table)) {
+        return table.getBranchBitmap().isSet(tid, ctx.executionContext.branchId);
+    }
     const auto version_entry = get_version_entry(tid, table);
     const void * element = get_latest_chain_element(version_entry, table, ctx);
     return (element != nullptr);
 }
 
-void destroy_chain(VersionEntry * version_entry) {
+void destroy_chain(VersionEntry * version_entry, Table & table) {
     const void * next = version_entry->first;
     while (next != nullptr) {
         if (next == version_entry) {
@@ -320,10 +652,880 @@ void destroy_chain(VersionEntry * version_entry) {
         } else {
             const auto storage = static_cast<const VersionedTupleStorage *>(next);
             next = storage->next;
-            std::free(const_cast<VersionedTupleStorage *>(storage));
+            release_chain_element(const_cast<VersionedTupleStorage *>(storage), table);
         }
     }
     version_entry->first = version_entry;
     version_entry->next = nullptr;
     version_entry->next_in_branch = nullptr;
+    version_entry->heads.clear();
+}
+
+void move_version_entry(VersionEntry & from, VersionEntry & to) {
+    // chain elements refer to the entry by its address
+    const void * next = from.first;
+    while (next != nullptr) {
+        if (next == &from) {
+            next = from.next;
+            continue;
+        }
+        auto storage = static_cast<VersionedTupleStorage *>(const_cast<void *>(next));
+        next = storage->next;
+        if (storage->next == &from) {
+            storage->next = &to;
+        }
+        if (storage->next_in_branch == &from) {
+            storage->next_in_branch = &to;
+        }
+    }
+
+    to.first = (from.first == &from) ? &to : from.first;
+    to.prev = from.prev;
+    to.next = from.next;
+    to.next_in_branch = from.next_in_branch;
+    to.branch_id = from.branch_id;
+    to.creation_ts = from.creation_ts;
+    to.branch_visibility = std::move(from.branch_visibility);
+    to.heads.moveFrom(from.heads);
+
+    from.first = &from;
+    from.prev = nullptr;
+    from.next = nullptr;
+    from.next_in_branch = nullptr;
+    from.branch_visibility.clear();
+}
+
+void rebuild_branch_heads(VersionEntry * version_entry) {
+    // the chain is ordered from the newest to the oldest element
+    // the entry itself is the head of its branch unless the branch has newer elements
+    version_entry->heads.clear();
+    std::unordered_set<branch_id_t> visited;
+    for (const void * next = version_entry->first; next != nullptr; ) {
+        if (next == version_entry) {
+            visited.insert(version_entry->branch_id);
+            next = version_entry->next;
+            continue;
+        }
+        const auto storage = static_cast<const VersionedTupleStorage *>(next);
+        if (visited.insert(storage->branch_id).second) {
+            version_entry->heads.set(storage->branch_id, storage);
+        }
+        next = storage->next;
+    }
+}
+
+/// \returns Whether a child of the given branch has been created after an element with creation timestamp 'from'
+///          and not after an element with creation timestamp 'to'
+static bool has_child_between(const branch_children_t & children, branch_id_t parent, branch_id_t from, branch_id_t to) {
+    auto it = children.find(parent);
+    if (it == children.end()) {
+        return false;
+    }
+    auto child = std::upper_bound(it->second.begin(), it->second.end(), from);
+    return (child != it->second.end() && *child <= to);
+}
+
+/// \returns A copy of the element which additionally holds the values it inherits from the given predecessors;
+///          nullptr if it inherits none of them
+static VersionedTupleStorage * copy_with_inherited_values(const VersionedTupleStorage * element,
+        const std::unordered_set<const void *> & garbage, Table & table) {
+    uint64_t inherited = 0;
+    for (const void * predecessor = element->next_in_branch; predecessor != nullptr && garbage.count(predecessor) > 0; ) {
+        const auto storage = static_cast<const VersionedTupleStorage *>(predecessor);
+        inherited |= storage->column_mask;
+        predecessor = storage->next_in_branch;
+    }
+    inherited &= ~element->column_mask;
+    if (inherited == 0) {
+        return nullptr;
+    }
+
+    auto copy = create_chain_element(table, element->branch_id, element->column_mask | inherited);
+    copy->next = element->next;
+    copy->next_in_branch = element->next_in_branch;
+    copy->branch_id = element->branch_id;
+    copy->creation_ts = element->creation_ts;
+    for (size_t column_idx = 0; column_idx < table.getColumnCount(); ++column_idx) {
+        if (!has_column_value(copy->column_mask, column_idx)) {
+            continue;
+        }
+        // either the element itself or one of the freed predecessors holds the value
+        auto source = element;
+        while (!has_column_value(source->column_mask, column_idx)) {
+            source = static_cast<const VersionedTupleStorage *>(source->next_in_branch);
+        }
+        auto value = Native::Sql::Value::load(source->data + table.getVersionValueOffset(source->column_mask, column_idx),
+                table.getCI(column_idx)->type);
+        value->store(copy->data + table.getVersionValueOffset(copy->column_mask, column_idx));
+    }
+    return copy;
+}
+
+/// \brief Replaces the elements of the chain which inherit values from the given ones by copies holding these values
+/// \returns Whether any element has been replaced
+static bool retain_inherited_values(VersionEntry * version_entry, const std::unordered_set<const void *> & garbage, Table & table) {
+    std::unordered_map<const void *, const void *> replacements;
+    for (const void * next = version_entry->first; next != nullptr; ) {
+        if (next == version_entry) {
+            next = version_entry->next;
+            continue;
+        }
+        const auto storage = static_cast<const VersionedTupleStorage *>(next);
+        if (garbage.count(storage) == 0 && garbage.count(storage->next_in_branch) > 0) {
+            auto copy = copy_with_inherited_values(storage, garbage, table);
+            if (copy != nullptr) {
+                replacements[storage] = copy;
+            }
+        }
+        next = storage->next;
+    }
+    if (replacements.empty()) {
+        return false;
+    }
+
+    auto replace = [&replacements](const void * element) {
+        auto it = replacements.find(element);
+        return const_cast<void *>((it == replacements.end()) ? element : it->second);
+    };
+    version_entry->first = replace(version_entry->first);
+    version_entry->prev = replace(version_entry->prev);
+    version_entry->next = replace(version_entry->next);
+    version_entry->next_in_branch = static_cast<VersionedTupleStorage *>(replace(version_entry->next_in_branch));
+    for (const void * next = version_entry->first; next != nullptr; ) {
+        if (next == version_entry) {
+            next = version_entry->next;
+            continue;
+        }
+        auto storage = static_cast<VersionedTupleStorage *>(const_cast<void *>(next));
+        storage->next = replace(storage->next);
+        storage->next_in_branch = replace(storage->next_in_branch);
+        next = storage->next;
+    }
+    for (auto & [element, copy] : replacements) {
+        release_chain_element(static_cast<VersionedTupleStorage *>(const_cast<void *>(element)), table);
+    }
+    return true;
+}
+
+/// \brief Unlinks and frees the given elements of the chain
+///
+/// The values which remaining elements inherit from freed ones are retained, like a superseded version of a branch
+/// passes its values on to the next version.
+static void release_chain_elements(VersionEntry * version_entry, const std::unordered_set<const void *> & garbage, Table & table) {
+    bool replaced = retain_inherited_values(version_entry, garbage, table);
+
+    // revision walks continue with the predecessor of a freed element; all of them are older, hence not yet freed
+    auto skip_garbage = [&garbage](const void * element) {
+        while (element != nullptr && garbage.count(element) > 0) {
+            element = static_cast<const VersionedTupleStorage *>(element)->next_in_branch;
+        }
+        return element;
+    };
+
+    const void * prev = nullptr;
+    const void * next = version_entry->first;
+    while (next != nullptr) {
+        if (next == version_entry) {
+            version_entry->next_in_branch = static_cast<VersionedTupleStorage *>(
+                    const_cast<void *>(skip_garbage(version_entry->next_in_branch)));
+            prev = version_entry;
+            next = version_entry->next;
+            continue;
+        }
+
+        auto storage = static_cast<VersionedTupleStorage *>(const_cast<void *>(next));
+        next = storage->next;
+        if (garbage.count(storage) == 0) {
+            storage->next_in_branch = skip_garbage(storage->next_in_branch);
+            prev = storage;
+            continue;
+        }
+
+        if (prev == nullptr) {
+            version_entry->first = const_cast<void *>(next);
+        } else if (prev == version_entry) {
+            version_entry->next = const_cast<void *>(next);
+        } else {
+            static_cast<VersionedTupleStorage *>(const_cast<void *>(prev))->next = next;
+        }
+        if (next == version_entry) {
+            version_entry->prev = const_cast<void *>(prev);
+        }
+        release_chain_element(storage, table);
+    }
+
+    // the heads may refer to replaced elements
+    if (replaced) {
+        rebuild_branch_heads(version_entry);
+    }
+}
+
+size_t collect_chain(VersionEntry * version_entry, const branch_children_t & children, Table & table) {
+    // the chain is ordered from the newest to the oldest element
+    std::unordered_map<branch_id_t, branch_id_t> newer_creation_ts; // branch -> creation_ts of its last visited element
+    std::unordered_set<const void *> garbage;
+    const void * next = version_entry->first;
+    while (next != nullptr) {
+        if (next == version_entry) {
+            newer_creation_ts[version_entry->branch_id] = version_entry->creation_ts;
+            next = version_entry->next;
+            continue;
+        }
+
+        const auto storage = static_cast<const VersionedTupleStorage *>(next);
+        auto newer = newer_creation_ts.find(storage->branch_id);
+        if (newer != newer_creation_ts.end() &&
+                !has_child_between(children, storage->branch_id, storage->creation_ts, newer->second)) {
+            garbage.insert(storage);
+        }
+        newer_creation_ts[storage->branch_id] = storage->creation_ts;
+        next = storage->next;
+    }
+    if (garbage.empty()) {
+        return 0;
+    }
+    release_chain_elements(version_entry, garbage, table);
+    return garbage.size();
+}
+
+size_t drop_branch_versions(VersionEntry * version_entry, branch_id_t branch, Table & table) {
+    std::unordered_set<const void *> garbage;
+    for (const void * next = version_entry->first; next != nullptr; ) {
+        if (next == version_entry) {
+            next = version_entry->next;
+            continue;
+        }
+        const auto storage = static_cast<const VersionedTupleStorage *>(next);
+        if (storage->branch_id == branch) {
+            garbage.insert(storage);
+        }
+        next = storage->next;
+    }
+    version_entry->branch_visibility.reset(branch);
+    if (garbage.empty()) {
+        return 0;
+    }
+    release_chain_elements(version_entry, garbage, table);
+    rebuild_branch_heads(version_entry);
+    return garbage.size();
+}
+
+//-----------------------------------------------------------------------------
+// MaterializedBranch
+
+MaterializedBranch::~MaterializedBranch() {
+    // the vectors only borrow the chunks
+    vectors.clear();
+    for (auto & [chunk, size] : copiedChunks) {
+        Allocator::instance().release(chunk, size);
+    }
+}
+
+std::shared_ptr<MaterializedBranch> build_materialized_branch(Table & table, branch_id_t branch) {
+    Database & db = table.getDatabase();
+    QueryContext ctx(db);
+    ctx.executionContext.branchId = branch;
+    db.constructBranchLineage(branch, ctx.executionContext);
+
+    auto materialized = std::make_shared<MaterializedBranch>();
+    materialized->branch = branch;
+    materialized->lineage = *ctx.executionContext.branch_lineage;
+    size_t rowCount = table.size();
+    materialized->rowCount = rowCount;
+
+    const unsigned chunkShift = Vector::defaultChunkShift;
+    const size_t chunkCapacity = static_cast<size_t>(1) << chunkShift;
+    size_t chunkCount = std::max<size_t>(1, (rowCount + chunkCapacity - 1) >> chunkShift);
+
+    // the tuples of each chunk whose latest element within the branch is a version
+    std::vector<std::vector<std::pair<tid_t, const void *>>> versions(chunkCount);
+    BitmapTable & branch_bitmap = table.getBranchBitmap();
+    for (tid_t tid = 0; tid < rowCount; ++tid) {
+        if (!branch_bitmap.isSet(tid, branch)) {
+            continue;
+        }
+        const VersionEntry * version_entry = get_version_entry(tid, table);
+        const void * element = get_latest_chain_element(version_entry, table, ctx);
+        if (element != nullptr && element != version_entry) {
+            versions[tid >> chunkShift].emplace_back(tid, element);
+        }
+    }
+
+    AllocationPolicy policy = table.getAllocationPolicy();
+    for (size_t column_idx = 0; column_idx < table.getColumnCount(); ++column_idx) {
+        ci_p_t ci = table.getCI(column_idx);
+        const Vector * masterColumn = ci->column;
+        size_t valueSize;
+        if (ci->dictionary != nullptr) {
+            valueSize = sizeof(StringDictionary::code_t);
+        } else if (ci->packed != nullptr) {
+            valueSize = ci->packed->getValueSize();
+        } else {
+            valueSize = masterColumn->getElementSize();
+        }
+
+        std::vector<uint8_t *> directory(chunkCount);
+        for (size_t chunkIndex = 0; chunkIndex < chunkCount; ++chunkIndex) {
+            auto & chunkVersions = versions[chunkIndex];
+            bool changed = std::any_of(chunkVersions.begin(), chunkVersions.end(), [&](auto & version) {
+                return get_version_value(version.first, version.second, column_idx, table) != nullptr;
+            });
+            if (ci->packed == nullptr && !changed) {
+                // scans read the master chunk, whose address is stable
+                directory[chunkIndex] = static_cast<uint8_t *>(const_cast<void *>(masterColumn->getChunk(chunkIndex)));
+                continue;
+            }
+
+            size_t chunkBytes = chunkCapacity*valueSize;
+            auto chunk = static_cast<uint8_t *>(Allocator::instance().allocate(chunkBytes, policy));
+            materialized->copiedChunks.emplace_back(chunk, chunkBytes);
+            directory[chunkIndex] = chunk;
+
+            tid_t chunkBegin = chunkIndex << chunkShift;
+            size_t chunkRows = std::min(chunkCapacity, rowCount - std::min(rowCount, chunkBegin));
+            if (ci->packed != nullptr && chunkRows > 0) {
+                static_assert(PackedIntegerColumn::blockShift == Vector::defaultChunkShift,
+                        "packed blocks have to match the chunks");
+                ci->packed->unpack(chunkIndex, chunk);
+            } else if (ci->packed == nullptr) {
+                std::memcpy(chunk, masterColumn->getChunk(chunkIndex), chunkRows*valueSize);
+            }
+
+            for (auto & [tid, element] : chunkVersions) {
+                const void * value = get_version_value(tid, element, column_idx, table);
+                if (value == nullptr) {
+                    continue;
+                }
+                uint8_t * dest = chunk + (tid & (chunkCapacity - 1))*valueSize;
+                if (ci->dictionary != nullptr) {
+                    *reinterpret_cast<StringDictionary::code_t *>(dest) = ci->dictionary->encode(value);
+                } else {
+                    std::memcpy(dest, value, valueSize);
+                }
+            }
+        }
+
+        auto vector = std::make_unique<Vector>(valueSize, 0, chunkShift, policy);
+        vector->adoptChunks(directory.data(), chunkCount, rowCount);
+
+        auto column = std::make_unique<ColumnInformation>(*ci);
+        column->column = vector.get();
+        column->encoding = (ci->dictionary != nullptr) ? ColumnInformation::Encoding::Dictionary : ColumnInformation::Encoding::Plain;
+        column->packed = nullptr;
+        materialized->vectors.push_back(std::move(vector));
+        materialized->columns.push_back(std::move(column));
+    }
+
+    return materialized;
+}
+
+void update_materialized_tuple(Table & table, MaterializedBranch & materialized, tid_t tid) {
+    // scans of the copy read the live branch bitmap, hence deleted and invisible tuples need no update
+    if (!table.getBranchBitmap().isSet(tid, materialized.branch)) {
+        return;
+    }
+
+    // tuples which have been inserted after the build extend the copy, further chunks are owned by its vectors
+    for (auto & vector : materialized.vectors) {
+        while (vector->size() <= tid) {
+            vector->reserve_back();
+        }
+    }
+    materialized.rowCount = std::max<size_t>(materialized.rowCount, tid + 1);
+
+    const VersionEntry * version_entry = get_version_entry(tid, table);
+    const void * element = get_latest_lineage_element(version_entry, &materialized.lineage);
+    bool is_version = (element != nullptr && element != version_entry);
+    size_t chunkIndex = tid >> Vector::defaultChunkShift;
+
+    for (size_t column_idx = 0; column_idx < table.getColumnCount(); ++column_idx) {
+        ci_p_t ci = table.getCI(column_idx);
+        const Vector * masterColumn = ci->column;
+        Vector & vector = *materialized.vectors[column_idx];
+        size_t valueSize = vector.getElementSize();
+
+        // the value within the branch, represented like within the copy
+        const void * value = is_version ? get_version_value(tid, element, column_idx, table) : nullptr;
+        StringDictionary::code_t code;
+        int64_t packedValue;
+        int32_t narrowPackedValue;
+        if (value != nullptr && ci->dictionary != nullptr) {
+            code = ci->dictionary->encode(value);
+            value = &code;
+        } else if (value == nullptr && ci->packed != nullptr) {
+            packedValue = ci->packed->get(tid);
+            narrowPackedValue = static_cast<int32_t>(packedValue);
+            value = (valueSize == sizeof(int32_t)) ? static_cast<const void *>(&narrowPackedValue) : &packedValue;
+        } else if (value == nullptr) {
+            value = masterColumn->at(tid);
+        }
+
+        const Vector & copy = vector;
+        if (std::memcmp(copy.at(tid), value, valueSize) == 0) {
+            continue;
+        }
+        if (ci->packed == nullptr && chunkIndex < copy.getBorrowedChunkCount() &&
+                copy.getChunk(chunkIndex) == masterColumn->getChunk(chunkIndex)) {
+            // the master chunk has just been overwritten, its other rows still hold the values of the branch
+            size_t chunkBytes = copy.getChunkCapacity()*valueSize;
+            auto chunk = static_cast<uint8_t *>(Allocator::instance().allocate(chunkBytes, table.getAllocationPolicy()));
+            std::memcpy(chunk, copy.getChunk(chunkIndex), chunkBytes);
+            materialized.copiedChunks.emplace_back(chunk, chunkBytes);
+            vector.replaceBorrowedChunk(chunkIndex, chunk);
+        }
+        std::memcpy(vector.at(tid), value, valueSize);
+    }
+}
+
+static bool equal_tuples(const Native::Sql::SqlTuple & lhs, const Native::Sql::SqlTuple & rhs) {
+    for (size_t column_idx = 0; column_idx < lhs.values.size(); ++column_idx) {
+        if (!lhs.values[column_idx]->equals(*rhs.values[column_idx])) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/// \returns Per chunk of the default size: whether the columns of the two branches refer to different chunks
+static std::vector<bool> get_differing_chunks(Table & table, branch_id_t base, branch_id_t branch) {
+    const size_t chunkCapacity = static_cast<size_t>(1) << Vector::defaultChunkShift;
+    size_t chunkCount = (table.size() + chunkCapacity - 1) >> Vector::defaultChunkShift;
+    std::vector<bool> differing(chunkCount, false);
+    for (size_t column_idx = 0; column_idx < table.getColumnCount(); ++column_idx) {
+        const Vector & base_column = *get_branch_column(base, column_idx, table).column;
+        const Vector & branch_column = *get_branch_column(branch, column_idx, table).column;
+        for (size_t chunkIndex = 0; chunkIndex < chunkCount; ++chunkIndex) {
+            differing[chunkIndex] = differing[chunkIndex] ||
+                    chunkIndex >= base_column.getChunkCount() || chunkIndex >= branch_column.getChunkCount() ||
+                    base_column.getChunk(chunkIndex) != branch_column.getChunk(chunkIndex);
+        }
+    }
+    return differing;
+}
+
+std::vector<tid_t> diff_branches(Table & table, branch_id_t base, branch_id_t branch) {
+    Database & db = table.getDatabase();
+    QueryContext base_ctx(db);
+    base_ctx.executionContext.branchId = base;
+    db.constructBranchLineage(base, base_ctx.executionContext);
+    QueryContext branch_ctx(db);
+    branch_ctx.executionContext.branchId = branch;
+    db.constructBranchLineage(branch, branch_ctx.executionContext);
+
+    const bool pages = uses_pages(table);
+    std::vector<bool> differing_chunks;
+    if (pages) {
+        differing_chunks = get_differing_chunks(table, base, branch);
+    }
+    const TidSet * base_modified = table.getModifiedTids(base);
+    const TidSet * branch_modified = table.getModifiedTids(branch);
+
+    // whether the tuple, which is visible in both branches, holds the same values in both
+    auto same_version = [&](tid_t tid) {
+        if (pages) {
+            return equal_tuples(*load_branch_tuple(tid, base, table), *load_branch_tuple(tid, branch, table));
+        }
+        const VersionEntry * version_entry = get_version_entry(tid, table);
+        const void * base_element = get_latest_chain_element(version_entry, table, base_ctx);
+        const void * branch_element = get_latest_chain_element(version_entry, table, branch_ctx);
+        if (base_element == branch_element) {
+            return true;
+        } else if (base_element == nullptr || branch_element == nullptr) {
+            return false;
+        }
+        return equal_tuples(Native::Sql::SqlTuple(get_version_values(tid, base_element, table)),
+                Native::Sql::SqlTuple(get_version_values(tid, branch_element, table)));
+    };
+
+    const BitmapTable & branch_bitmap = table.getBranchBitmap();
+    const Vector & base_words = branch_bitmap.getColumn(base);
+    const Vector & branch_words = branch_bitmap.getColumn(branch);
+    size_t rowCount = table.size();
+    size_t wordCount = (rowCount + BitmapTable::wordBits - 1) / BitmapTable::wordBits;
+
+    // the modified tuples are fetched in batches of bitmap words
+    const size_t batchWords = 256;
+    std::vector<uint64_t> modified(batchWords);
+    std::vector<uint64_t> scratch(batchWords);
+    std::vector<tid_t> tids;
+    for (size_t firstWord = 0; firstWord < wordCount; firstWord += batchWords) {
+        size_t batchCount = std::min(batchWords, wordCount - firstWord);
+        if (pages) {
+            for (size_t i = 0; i < batchCount; ++i) {
+                tid_t wordTid = (firstWord + i)*BitmapTable::wordBits;
+                modified[i] = differing_chunks[wordTid >> Vector::defaultChunkShift] ? ~static_cast<uint64_t>(0) : 0;
+            }
+        } else {
+            std::fill(modified.begin(), modified.end(), 0);
+            for (const TidSet * set : { base_modified, branch_modified }) {
+                if (set != nullptr && set->getWords(firstWord, batchCount, scratch.data())) {
+                    for (size_t i = 0; i < batchCount; ++i) {
+                        modified[i] |= scratch[i];
+                    }
+                }
+            }
+        }
+
+        for (size_t i = 0; i < batchCount; ++i) {
+            size_t wordIndex = firstWord + i;
+            uint64_t base_word = *static_cast<const uint64_t *>(base_words.at(wordIndex));
+            uint64_t branch_word = *static_cast<const uint64_t *>(branch_words.at(wordIndex));
+            // tuples which are invisible in the branch are never part of the result
+            uint64_t candidates = branch_word & ((base_word ^ branch_word) | modified[i]);
+            for (; candidates != 0; candidates &= candidates - 1) {
+                unsigned bit = static_cast<unsigned>(__builtin_ctzll(candidates));
+                tid_t tid = wordIndex*BitmapTable::wordBits + bit;
+                if (tid >= rowCount) {
+                    break;
+                }
+                if (((base_word >> bit) & 1) == 0 || !same_version(tid)) {
+                    tids.push_back(tid);
+                }
+            }
+        }
+    }
+    return tids;
+}
+
+//-----------------------------------------------------------------------------
+// BranchHeads
+
+BranchHeads::BranchHeads() {
+    clear();
+}
+
+void BranchHeads::set(branch_id_t branch, const void * element) {
+    assert(branch != invalid_branch_id);
+    unsigned slot = inlineCount;
+    for (unsigned i = 0; i < inlineCount; ++i) {
+        if (_branches[i] == branch) {
+            _elements[i] = element;
+            return;
+        } else if (_branches[i] == invalid_branch_id && slot == inlineCount) {
+            slot = i;
+        }
+    }
+
+    if (_overflow != nullptr) {
+        auto it = _overflow->find(branch);
+        if (it != _overflow->end()) {
+            it->second = element;
+            return;
+        }
+    }
+    if (slot < inlineCount) {
+        _branches[slot] = branch;
+        _elements[slot] = element;
+        return;
+    }
+    if (_overflow == nullptr) {
+        _overflow = new std::unordered_map<branch_id_t, const void *>();
+    }
+    (*_overflow)[branch] = element;
+}
+
+void BranchHeads::moveFrom(BranchHeads & other) {
+    clear();
+    std::copy(std::begin(other._branches), std::end(other._branches), std::begin(_branches));
+    std::copy(std::begin(other._elements), std::end(other._elements), std::begin(_elements));
+    _overflow = other._overflow;
+    other._overflow = nullptr;
+    other.clear();
+}
+
+void BranchHeads::clear() {
+    std::fill(std::begin(_branches), std::end(_branches), invalid_branch_id);
+    std::fill(std::begin(_elements), std::end(_elements), nullptr);
+    delete _overflow;
+    _overflow = nullptr;
+}
+
+size_t BranchHeads::getBranchesOffset() {
+    return offsetof(BranchHeads, _branches);
+}
+
+size_t BranchHeads::getElementsOffset() {
+    return offsetof(BranchHeads, _elements);
+}
+
+size_t BranchHeads::getOverflowOffset() {
+    return offsetof(BranchHeads, _overflow);
+}
+
+const void * BranchHeads::getOverflow(branch_id_t branch) const {
+    auto it = _overflow->find(branch);
+    return (it == _overflow->end()) ? nullptr : it->second;
+}
+
+//-----------------------------------------------------------------------------
+// VersionEntryColumn
+
+VersionEntryColumn::~VersionEntryColumn() {
+    while (_size > 0) {
+        pop_back();
+    }
+    for (size_t i = _borrowedChunkCount; i < _chunks.size(); ++i) {
+        ::operator delete(_chunks[i], std::align_val_t(alignof(VersionEntry)));
+    }
+}
+
+VersionEntry & VersionEntryColumn::emplace_back() {
+    if ((_size >> chunkShift) == _chunks.size()) {
+        void * chunk = ::operator new(chunkSize*sizeof(VersionEntry), std::align_val_t(alignof(VersionEntry)));
+        _chunks.push_back(static_cast<VersionEntry *>(chunk));
+        _directory = _chunks.data();
+    }
+    VersionEntry * entry = new (&(*this)[_size]) VersionEntry();
+    _size += 1;
+    return *entry;
+}
+
+void VersionEntryColumn::adoptChunks(VersionEntry * const * chunks, size_t chunkCount, size_t size) {
+    assert(_size == 0 && _chunks.empty());
+    assert(size <= (chunkCount << chunkShift));
+    _chunks.assign(chunks, chunks + chunkCount);
+    _directory = _chunks.data();
+    _borrowedChunkCount = chunkCount;
+    _size = size;
+}
+
+void VersionEntryColumn::pop_back() {
+    assert(_size > 0);
+    _size -= 1;
+    (*this)[_size].~VersionEntry();
+}
+
+//-----------------------------------------------------------------------------
+// Code generation
+
+cg_voidptr_t genVersionEntryPtr(Table & table, cg_tid_t tid) {
+    auto & codeGen = getThreadLocalCodeGen();
+    const VersionEntryColumn & entries = table._version_mgmt_column;
+
+    llvm::Type * chunkPtrTy = cg_voidptr_t::getType();
+    llvm::Type * directoryTy = llvm::PointerType::getUnqual(chunkPtrTy);
+
+    // the directory is relocated whenever a chunk is added
+    llvm::Value * directoryAddr = createPointerValue(entries.getDirectoryAddress(), directoryTy);
+    llvm::Value * directory = codeGen->CreateLoad(directoryTy, directoryAddr);
+
+    cg_size_t chunkIndex = tid >> cg_size_t(VersionEntryColumn::chunkShift);
+    llvm::Value * chunkAddr = codeGen->CreateGEP(chunkPtrTy, directory, chunkIndex.getValue());
+    cg_voidptr_t chunk( codeGen->CreateLoad(chunkPtrTy, chunkAddr) );
+
+    cg_size_t offset = (tid & cg_size_t(VersionEntryColumn::chunkSize - 1)) * cg_size_t(sizeof(VersionEntry));
+    return chunk + offset.getValue();
+}
+
+/// \returns The field of a version entry or chain element which is located at the given byte offset
+static llvm::Value * genFieldLoad(llvm::Value * element, llvm::Value * offset, llvm::Type * fieldTy) {
+    auto & codeGen = getThreadLocalCodeGen();
+    llvm::Value * fieldAddr = codeGen->CreateGEP(codeGen->getInt8Ty(), element, offset);
+    llvm::Value * typedAddr = codeGen->CreatePointerCast(fieldAddr, llvm::PointerType::getUnqual(fieldTy));
+    return codeGen->CreateLoad(fieldTy, typedAddr);
+}
+
+/// \returns Whether a version of the given branch and creation timestamp is visible, see BranchLineage::isVisible()
+static cg_bool_t genIsVisible(llvm::Value * cutoffs, uint32_t cutoffCount, llvm::Value * versionBranch,
+        llvm::Value * creationTs) {
+    auto & codeGen = getThreadLocalCodeGen();
+    // branches which have been created after the lineage map to the trailing zero
+    llvm::Value * known = codeGen->CreateICmpULT(versionBranch, cg_u32_t(cutoffCount));
+    llvm::Value * index = codeGen->CreateSelect(known, versionBranch, cg_u32_t(cutoffCount));
+    llvm::Value * cutoff = codeGen->CreateLoad(cg_u32_t::getType(),
+            codeGen->CreateGEP(cg_u32_t::getType(), cutoffs, index));
+    return cg_bool_t( codeGen->CreateICmpULT(creationTs, cutoff) );
+}
+
+/// \returns The latest element of the branch among the inline heads (see BranchHeads::get()); null if there is none
+static llvm::Value * genInlineBranchHeadLoad(llvm::Value * heads, branch_id_t branch) {
+    auto & codeGen = getThreadLocalCodeGen();
+    llvm::Type * ptrTy = cg_voidptr_t::getType();
+    llvm::Type * branchTy = cg_u32_t::getType();
+
+    // unused slots hold invalid_branch_id, hence at most one slot matches
+    llvm::Value * head = llvm::ConstantPointerNull::get(llvm::cast<llvm::PointerType>(ptrTy));
+    for (unsigned i = 0; i < BranchHeads::inlineCount; ++i) {
+        llvm::Value * slotBranch = genFieldLoad(heads,
+                cg_size_t(BranchHeads::getBranchesOffset() + i*sizeof(branch_id_t)), branchTy);
+        llvm::Value * slotElement = genFieldLoad(heads,
+                cg_size_t(BranchHeads::getElementsOffset() + i*sizeof(const void *)), ptrTy);
+        llvm::Value * matches = codeGen->CreateICmpEQ(slotBranch, cg_u32_t(static_cast<uint32_t>(branch)));
+        head = codeGen->CreateSelect(matches, slotElement, head);
+    }
+    return head;
+}
+
+cg_voidptr_t genLatestChainElementLookup(Table & table, cg_tid_t tid, const BranchLineage & lineage) {
+    static_assert(sizeof(branch_id_t) == sizeof(uint32_t), "the generated code loads branch ids as i32");
+
+    auto & codeGen = getThreadLocalCodeGen();
+    auto & funcGen = codeGen.getCurrentFunctionGen();
+    auto & context = codeGen.getLLVMContext();
+    llvm::Module & module = codeGen.getCurrentModule();
+    llvm::Type * ptrTy = cg_voidptr_t::getType();
+    llvm::Type * branchTy = cg_u32_t::getType();
+
+    // the lineage of the query is embedded as constant array
+    std::vector<uint32_t> cutoffValues(lineage.cutoffs.begin(), lineage.cutoffs.end());
+    cutoffValues.push_back(0);
+    llvm::Constant * cutoffArray = llvm::ConstantDataArray::get(context, cutoffValues);
+    auto cutoffGlobal = new llvm::GlobalVariable(module, cutoffArray->getType(), true,
+            llvm::GlobalValue::PrivateLinkage, cutoffArray, "branch_lineage");
+    llvm::Value * cutoffs = codeGen->CreateConstInBoundsGEP2_32(cutoffArray->getType(), cutoffGlobal, 0, 0);
+    uint32_t cutoffCount = static_cast<uint32_t>(lineage.cutoffs.size());
+
+    cg_voidptr_t entry = genVersionEntryPtr(table, tid);
+    llvm::Value * first = genFieldLoad(entry, cg_size_t(offsetof(VersionEntry, first)), ptrTy);
+    llvm::Value * entryBranch = genFieldLoad(entry, cg_size_t(offsetof(VersionEntry, branch_id)), branchTy);
+    llvm::Value * entryTs = genFieldLoad(entry, cg_size_t(offsetof(VersionEntry, creation_ts)), branchTy);
+    llvm::Value * isHead = codeGen->CreateICmpEQ(first, entry.getValue());
+
+    // tuples which have not been modified since their master row has become visible are read from the master row
+    cg_voidptr_t nullElement( llvm::ConstantPointerNull::get(llvm::cast<llvm::PointerType>(ptrTy)) );
+    cg_bool_t masterOnly( codeGen->CreateAnd(isHead, genIsVisible(cutoffs, cutoffCount, entryBranch, entryTs)) );
+    IfGen shortcut(funcGen, masterOnly, {{"element", nullElement}});
+    {
+        shortcut.setVar(0, nullElement);
+    }
+    shortcut.Else();
+    {
+        llvm::Function * prefetch = llvm::Intrinsic::getDeclaration(&module, llvm::Intrinsic::prefetch);
+        llvm::Value * heads = codeGen->CreateGEP(codeGen->getInt8Ty(), entry.getValue(),
+                cg_size_t(offsetof(VersionEntry, heads)).getValue());
+        llvm::Value * overflow = genFieldLoad(heads, cg_size_t(BranchHeads::getOverflowOffset()), ptrTy);
+        llvm::Value * hasOverflow = codeGen->CreateICmpNE(overflow, nullElement.getValue());
+
+        // just like get_latest_lineage_element(), the ancestors are searched upwards, each one from its head on;
+        // the elements of unrelated branches are never visited
+        llvm::Value * element = nullElement;
+        llvm::Value * resolved = codeGen->getFalse();
+        llvm::Value * fallback = codeGen->getFalse();
+        for (branch_id_t member : lineage.ancestors) {
+            cg_u32_t memberValue(static_cast<uint32_t>(member));
+            IfGen step(funcGen, codeGen->CreateNot(resolved),
+                    {{"element", element}, {"resolved", resolved}, {"fallback", fallback}});
+            {
+                llvm::Value * head = genInlineBranchHeadLoad(heads, member);
+                llvm::Value * entryIsHead = codeGen->CreateAnd(codeGen->CreateICmpEQ(head, nullElement.getValue()),
+                        codeGen->CreateICmpEQ(entryBranch, memberValue.getValue()));
+                head = codeGen->CreateSelect(entryIsHead, entry.getValue(), head);
+
+                // heads which have spilled into the overflow map are left to the runtime lookup
+                IfGen walkBranch(funcGen, codeGen->CreateICmpNE(head, nullElement.getValue()),
+                        {{"element", nullElement}, {"resolved", hasOverflow}, {"fallback", hasOverflow}});
+                {
+                    LoopGen walk(funcGen, {{"current", head}});
+                    llvm::Value * current = walk.getLoopVar(0);
+                    llvm::Value * older;
+                    llvm::Value * ownElement;
+                    llvm::Value * visible;
+                    {
+                        LoopBodyGen walkBody(walk);
+
+                        // the version entry and the chain elements place their fields differently
+                        llvm::Value * isEntry = codeGen->CreateICmpEQ(current, entry.getValue());
+                        auto fieldOffset = [&](size_t entryOffset, size_t storageOffset) {
+                            return codeGen->CreateSelect(isEntry, cg_size_t(entryOffset), cg_size_t(storageOffset));
+                        };
+                        older = genFieldLoad(current, fieldOffset(offsetof(VersionEntry, next_in_branch),
+                                offsetof(VersionedTupleStorage, next_in_branch)), ptrTy);
+                        // the element is needed if the current one is not visible; prefetching null does not fault
+                        codeGen->CreateCall(prefetch, {older, cg_u32_t(0u), cg_u32_t(3u), cg_u32_t(1u)});
+
+                        llvm::Value * branch = genFieldLoad(current, fieldOffset(offsetof(VersionEntry, branch_id),
+                                offsetof(VersionedTupleStorage, branch_id)), branchTy);
+                        llvm::Value * creationTs = genFieldLoad(current, fieldOffset(offsetof(VersionEntry, creation_ts),
+                                offsetof(VersionedTupleStorage, creation_ts)), branchTy);
+                        // an element of an ancestor is visited along with its own branch
+                        ownElement = codeGen->CreateICmpEQ(branch, memberValue.getValue());
+                        visible = codeGen->CreateAnd(ownElement, genIsVisible(cutoffs, cutoffCount, branch, creationTs));
+                    }
+                    llvm::Value * invisible = codeGen->CreateAnd(ownElement, codeGen->CreateNot(visible));
+                    llvm::Value * hasOlder = codeGen->CreateICmpNE(older, nullElement.getValue());
+                    walk.loopDone(codeGen->CreateAnd(invisible, hasOlder), {older});
+
+                    // the older elements of the branch are not linked to the newer ones (e.g. after a merge has
+                    // re-inserted the tuple); those are found by the runtime lookup
+                    // the master row is represented by null, just like an invisible tuple
+                    llvm::Value * isElement = codeGen->CreateAnd(visible,
+                            codeGen->CreateICmpNE(current, entry.getValue()));
+                    walkBranch.setVar(0, codeGen->CreateSelect(isElement, current, nullElement.getValue()));
+                    walkBranch.setVar(1, codeGen->CreateOr(visible, invisible));
+                    walkBranch.setVar(2, invisible);
+                }
+                walkBranch.EndIf();
+                llvm::Value * branchElement = walkBranch.getResult(0);
+                llvm::Value * branchResolved = walkBranch.getResult(1);
+                llvm::Value * branchFallback = walkBranch.getResult(2);
+                step.setVar(0, branchElement);
+                step.setVar(1, branchResolved);
+                step.setVar(2, branchFallback);
+            }
+            step.EndIf();
+            element = step.getResult(0);
+            resolved = step.getResult(1);
+            fallback = step.getResult(2);
+        }
+
+        llvm::FunctionType * funcTy = llvm::TypeBuilder<void * (void *, void *), false>::get(context);
+        IfGen runtimeLookup(funcGen, fallback, {{"element", element}});
+        {
+            llvm::Value * latest = codeGen.CreateCall(&get_latest_lineage_element, funcTy,
+                    {entry.getValue(), cg_voidptr_t::fromRawPointer(&lineage).getValue()});
+            llvm::Value * isEntry = codeGen->CreateICmpEQ(latest, entry.getValue());
+            runtimeLookup.setVar(0, codeGen->CreateSelect(isEntry, nullElement.getValue(), latest));
+        }
+        runtimeLookup.EndIf();
+        shortcut.setVar(0, runtimeLookup.getResult(0));
+    }
+    shortcut.EndIf();
+    return cg_voidptr_t( shortcut.getResult(0) );
+}
+
+cg_voidptr_t genVersionValueLookup(Table & table, cg_tid_t tid, cg_voidptr_t element, size_t columnIdx) {
+    auto & codeGen = getThreadLocalCodeGen();
+    auto & funcGen = codeGen.getCurrentFunctionGen();
+    llvm::Type * ptrTy = cg_voidptr_t::getType();
+    cg_voidptr_t nullElement( llvm::ConstantPointerNull::get(llvm::cast<llvm::PointerType>(ptrTy)) );
+
+    // the versions of a branch only hold the columns which they have changed, the walk stops at the master row
+    cg_voidptr_t entry = genVersionEntryPtr(table, tid);
+    auto isVersion = [&](llvm::Value * ptr) {
+        return codeGen->CreateAnd(codeGen->CreateICmpNE(ptr, nullElement.getValue()),
+                codeGen->CreateICmpNE(ptr, entry.getValue()));
+    };
+
+    IfGen resolve(funcGen, isVersion(element.getValue()), {{"valuePtr", nullElement}});
+    {
+        LoopGen walk(funcGen, {{"current", element.getValue()}});
+        llvm::Value * current = walk.getLoopVar(0);
+        llvm::Value * columnMask;
+        llvm::Value * hasValue;
+        llvm::Value * older;
+        {
+            LoopBodyGen walkBody(walk);
+            columnMask = genFieldLoad(current, cg_size_t(offsetof(VersionedTupleStorage, column_mask)),
+                    cg_u64_t::getType());
+            if (columnIdx >= 64) {
+                hasValue = codeGen->getTrue();
+            } else {
+                cg_u64_t bit = (cg_u64_t(columnMask) >> cg_u64_t(static_cast<uint64_t>(columnIdx))) & cg_u64_t(1ul);
+                hasValue = bit != cg_u64_t(0ul);
+            }
+            older = genFieldLoad(current, cg_size_t(offsetof(VersionedTupleStorage, next_in_branch)), ptrTy);
+        }
+        walk.loopDone(codeGen->CreateAnd(codeGen->CreateNot(hasValue), isVersion(older)), {older});
+
+        IfGen found(funcGen, hasValue, {{"valuePtr", nullElement}});
+        {
+            cg_size_t offset = cg_size_t(offsetof(VersionedTupleStorage, data)) +
+                    table.genVersionValueOffset(cg_u64_t(columnMask), columnIdx);
+            found.setVar(0, codeGen->CreateGEP(codeGen->getInt8Ty(), current, offset.getValue()));
+        }
+        found.EndIf();
+        resolve.setVar(0, found.getResult(0));
+    }
+    resolve.EndIf();
+    return cg_voidptr_t( resolve.getResult(0) );
 }
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <tuple>
+#include <unordered_map>
 
 #include "foundations/Database.hpp"
 #include "queryCompiler/QueryContext.hpp"
@@ -9,30 +10,94 @@
 #include "native/sql/SqlTuple.hpp"
 #include "utils/optimistic_lock.hpp"
 
-#include <boost/dynamic_bitset.hpp>
-
 class Table;
 
+/// Column mask of version records which hold the values of all columns
+constexpr uint64_t all_columns_mask = ~static_cast<uint64_t>(0);
+
+/// \returns Whether a version record with the given column mask holds a value of the column
+///
+/// Only the first 64 columns are covered by the mask, all further columns are held by every record.
+inline bool has_column_value(uint64_t column_mask, size_t column_idx) {
+    return (column_idx >= 64 || ((column_mask >> column_idx) & 1) != 0);
+}
+
+/// A version record holds the values of the columns within its column mask (see Table::getVersionValueOffset());
+/// the values of all other columns equal the ones of the record's predecessor (next_in_branch)
 struct VersionedTupleStorage {
     const void * next = nullptr;
     const void * next_in_branch = nullptr;
     branch_id_t branch_id;
     branch_id_t creation_ts; // latest branch id during the time of creation
+    uint64_t column_mask = all_columns_mask;
     uint8_t data[0];
 };
 
+/// Per-tuple map from a branch to its latest chain element
+///
+/// Few branches write to a single tuple, hence their heads are held inline; further ones spill into an overflow map.
+/// The branch of the version entry itself has no head unless the branch has newer elements.
+class BranchHeads {
+public:
+    static constexpr unsigned inlineCount = 4;
+
+    BranchHeads();
+    BranchHeads(const BranchHeads &) = delete;
+    BranchHeads & operator=(const BranchHeads &) = delete;
+
+    ~BranchHeads() { delete _overflow; }
+
+    /// \returns The latest chain element of the branch; nullptr if there is none
+    const void * get(branch_id_t branch) const {
+        for (unsigned i = 0; i < inlineCount; ++i) {
+            if (_branches[i] == branch) {
+                return _elements[i];
+            }
+        }
+        return (_overflow == nullptr) ? nullptr : getOverflow(branch);
+    }
+
+    void set(branch_id_t branch, const void * element);
+
+    /// \brief Takes over the heads of the other map, which is left empty
+    void moveFrom(BranchHeads & other);
+
+    void clear();
+
+    /// \returns The byte offsets of the inline slots and of the overflow map, which generated lookups read
+    static size_t getBranchesOffset();
+    static size_t getElementsOffset();
+    static size_t getOverflowOffset();
+
+private:
+    const void * getOverflow(branch_id_t branch) const;
+
+    branch_id_t _branches[inlineCount]; // invalid_branch_id marks unused slots
+    const void * _elements[inlineCount];
+    std::unordered_map<branch_id_t, const void *> * _overflow = nullptr;
+};
+
 // similar to VersionedTupleStorage; used by the current 'master' branch entry
-struct VersionEntry {
-    void * first = nullptr;
+// the fields of chain walks share the first cache line, the branch heads of point reads occupy the second one;
+// the chain of a new entry is empty
+struct alignas(64) VersionEntry {
+    void * first = this;
     void * prev = nullptr;
     void * next = nullptr;
     VersionedTupleStorage * next_in_branch = nullptr;
-    branch_id_t branch_id;
-    branch_id_t creation_ts; // latest branch id during the time of creation (same as the length of the branch bitvector)
-    opt_lock::lock_t lock;
-    boost::dynamic_bitset<> branch_visibility;
+    branch_id_t branch_id = master_branch_id;
+    branch_id_t creation_ts = 0; // latest branch id during the time of creation (same as the length of the branch bitvector)
+    opt_lock::lock_t lock{0};
+    BranchSet branch_visibility; // the branches which have a version of this tuple
+    alignas(64) BranchHeads heads;
 };
 
+static_assert(sizeof(VersionEntry) == 128, "version entries should fit into two cache lines");
+
+inline VersionEntry & VersionEntryColumn::operator[](size_t idx) const {
+    return _chunks[idx >> chunkShift][idx & (chunkSize - 1)];
+}
+
 inline tid_t mark_as_dangling_tid(tid_t tid) {
     return (tid | static_cast<decltype(tid)>(1) << (8*sizeof(decltype(tid))-1));
 }
@@ -46,13 +111,27 @@ inline bool is_marked_as_dangling_tid(tid_t tid) {
 }
 
 inline bool has_lineage_intersection(QueryContext & ctx, VersionEntry * version_entry) {
-    return (ctx.executionContext.branch_lineage_bitset.intersects(version_entry->branch_visibility));
+    return (ctx.executionContext.branch_lineage->branches.intersects(version_entry->branch_visibility));
 }
 
 VersionEntry * get_version_entry(tid_t tid, Table & table);
 
+/// \brief Overwrites the master value of the given column; dictionary-encoded columns store the value's code
+void store_master_value(tid_t tid, size_t column_idx, const Native::Sql::Value & value, Table & table);
+
+/// \returns The master value of the given column; encoded columns are decoded
+Native::Sql::value_op_t load_master_value(tid_t tid, size_t column_idx, Table & table);
+
+/// \returns The latest chain element which is visible in the branch of the context; nullptr if there is none
+///
+/// Starts at the heads of the lineage's branches, hence the versions of unrelated branches are not visited.
 const void * get_latest_chain_element(const VersionEntry * version_entry, Table & table, QueryContext & ctx);
 
+/// \returns The latest chain element which is visible within the lineage (of a branch other than master)
+///
+/// Called by the generated lookups for the chains which they cannot resolve from the inline branch heads.
+const void * get_latest_lineage_element(const VersionEntry * version_entry, const BranchLineage * lineage);
+
 const void * get_earliest_chain_element(const VersionEntry * version_entry, Table & table, QueryContext & ctx);
 
 const void * get_chain_element(const VersionEntry * version_entry, unsigned revision_offset, Table & table, QueryContext & ctx);
@@ -71,26 +150,103 @@ void update_tuple_with_branchId(tid_t tid, branch_id_t branchId, Native::Sql::Sq
 void delete_tuple(tid_t tid, Table & table, QueryContext & ctx);
 void delete_tuple_with_branchId(tid_t tid, branch_id_t branchId, Table & table, QueryContext & ctx);
 
-tid_t merge_tuple(branch_id_t src_branch, branch_id_t dst_branch, tid_t tid, QueryContext ctx);
+enum class merge_status_t {
+    untouched,  ///< the source branch has no version of its own, or the destination holds its values already
+    mergeable,  ///< the latest version of the source branch can be installed into the destination
+    conflict    ///< the destination has changed or deleted the tuple as well since the source forked off
+};
+
+/// \brief Determines whether the latest version of the tuple within the source branch can be merged into the destination
+///
+/// Only reads the version chain, hence several tuples may be checked concurrently.
+/// \param src_ctx, dst_ctx Hold the lineages of the source and of the destination branch
+/// \param src_element Receives the latest chain element of the source branch unless the tuple is untouched
+merge_status_t check_merge(tid_t tid, Table & table, QueryContext & src_ctx, QueryContext & dst_ctx, const void ** src_element);
+
+/// \brief Installs the given tuple as the latest version of the destination branch, which thereby sees the tuple
+///
+/// Unlike update_tuple(), the modification is not logged; Database::mergeBranch() logs the merge as a whole.
+void merge_tuple(tid_t tid, branch_id_t dst_branch, Native::Sql::SqlTuple & tuple, Table & table, QueryContext & ctx);
 
 std::unique_ptr<Native::Sql::SqlTuple> get_latest_tuple(tid_t tid, Table & table, QueryContext & ctx);
+
+/// \returns The latest chain element which is visible in the given branch; nullptr if it is the master row
 const void *get_latest_entry(tid_t tid, Table & table, branch_id_t branchId, QueryContext & ctx);
 
+/// \returns The values of the tuple version which is represented by the given chain element
+std::vector<Native::Sql::value_op_t> get_version_values(tid_t tid, const void * element, Table & table);
+
+/// \brief Resolves a column of the tuple version which is represented by the given chain element
+/// \returns The address of the value within the version records; nullptr if the value is the one of the master row
+const void * get_version_value(tid_t tid, const void * element, size_t column_idx, Table & table);
+
 bool is_visible(tid_t tid, Table & table, QueryContext & ctx);
 
-void destroy_chain(VersionEntry * version_entry);
+void destroy_chain(VersionEntry * version_entry, Table & table);
+
+/// \brief Moves the entry including its chain to another (empty) entry; the source is left with an empty chain
+void move_version_entry(VersionEntry & from, VersionEntry & to);
+
+/// \brief Derives the branch heads of the entry from its chain, e.g. after the chain has been restored
+void rebuild_branch_heads(VersionEntry * version_entry);
+
+/// \brief Unlinks and frees the chain elements which no branch can observe anymore
+///
+/// A branch and its descendants see the latest element of the branch which has been created before the
+/// descendants forked off. Hence, an element is unobservable once a newer element of the same branch exists
+/// and no child of the branch has been created in between. The master entry itself is never freed.
+/// Revision walks (next_in_branch) skip the freed elements.
+/// \returns The number of freed elements
+size_t collect_chain(VersionEntry * version_entry, const branch_children_t & children, Table & table);
+
+/// \brief Unlinks and frees the chain elements of a branch which is dropped
+///
+/// The branch must not have any children, hence no element of another branch has been derived from its elements.
+/// \returns The number of freed elements
+size_t drop_branch_versions(VersionEntry * version_entry, branch_id_t branch, Table & table);
 
 std::unique_ptr<Native::Sql::SqlTuple> get_current_master(tid_t tid, Table & table);
 
+/// \brief Copies the latest state of the branch into columns; chunks which the branch has not changed are shared
+std::shared_ptr<MaterializedBranch> build_materialized_branch(Table & table, branch_id_t branch);
+
+/// \brief Writes the latest state of the tuple within the copied branch into the copy, which grows if necessary
+void update_materialized_tuple(Table & table, MaterializedBranch & materialized, tid_t tid);
+
+/// \brief Determines the tuples of the branch whose visible version differs from the one visible in the base branch
+///
+/// Only the tuples which are visible in just one of the branches or which have been modified within either
+/// lineage are compared (in tables which are versioned by pages: the tuples of the chunks which either branch
+/// has copied), all other ones read the same master row.
+/// \returns The ascending tids of the tuples which are visible in the branch and are either missing from the base
+///          branch or hold other values there
+std::vector<tid_t> diff_branches(Table & table, branch_id_t base, branch_id_t branch);
+
+// generator functions
+
+/// \returns The address of the tuple's version entry
+cg_voidptr_t genVersionEntryPtr(Table & table, cg_tid_t tid);
+
+/// \brief Generates the lookup of get_latest_entry() inline, with the given lineage embedded as constant array
+///
+/// Tuples which consist of nothing but a visible master row skip the chain walk, which otherwise starts at the
+/// heads of the lineage's branches and prefetches the older element of a branch while checking the current one.
+/// \returns The latest chain element which is visible within the lineage; null if it is the master row
+cg_voidptr_t genLatestChainElementLookup(Table & table, cg_tid_t tid, const BranchLineage & lineage);
+
+/// \brief Generates get_version_value() inline for a chain element which is not the master row
+/// \returns The address of the value within the version records; null if the value is the one of the master row
+cg_voidptr_t genVersionValueLookup(Table & table, cg_tid_t tid, cg_voidptr_t element, size_t columnIdx);
+
 template<typename RegisterType>
 struct ScanItem {
     const Vector & column;
-    size_t offset;
+    size_t column_idx;
     RegisterType reg;
 
-    ScanItem(const Vector & column, size_t offset)
+    ScanItem(const Vector & column, size_t column_idx)
         : column(column)
-        , offset(offset)
+        , column_idx(column_idx)
     { }
 
     ScanItem(const ScanItem &) = delete;
@@ -98,7 +254,7 @@ struct ScanItem {
     // https://stackoverflow.com/a/15730993
     ScanItem(ScanItem && other) noexcept
         : column(other.column)
-        , offset(other.offset)
+        , column_idx(other.column_idx)
         , reg() // FIXME preserve value
     { }
 };
@@ -112,10 +268,14 @@ inline void produce_current_master(tid_t tid, Consumer consumer, std::tuple<Ts..
 }
 
 template<typename Consumer, typename... Ts>
-inline void produce(const VersionedTupleStorage * storage, Consumer consumer, std::tuple<Ts...> & scan_items) {
-    const uint8_t * tuple_ptr = storage->data;
-    std::apply([tuple_ptr] (auto &... item) {
-        (item.reg.load_from(tuple_ptr + item.offset), ...);
+inline void produce(tid_t tid, const VersionedTupleStorage * storage, Table & table, Consumer consumer, std::tuple<Ts...> & scan_items) {
+    // columns which the versions have not changed are read from the master row
+    auto resolve = [&] (const auto & item) {
+        const void * ptr = get_version_value(tid, storage, item.column_idx, table);
+        return (ptr != nullptr) ? ptr : item.column.at(tid);
+    };
+    std::apply([&] (auto &... item) {
+        (item.reg.load_from(resolve(item)), ...);
     }, scan_items);
     consumer(scan_items);
 }
@@ -140,7 +300,7 @@ void produce_latest_tuple(QueryContext & ctx, tid_t tid, Table & table, Consumer
         produce_current_master(tid, consumer, scan_items);
     } else {
         auto storage = static_cast<const VersionedTupleStorage *>(element);
-        produce(storage, consumer, scan_items);
+        produce(tid, storage, table, consumer, scan_items);
     }
 }
 
@@ -159,7 +319,7 @@ void produce_earliest_tuple(QueryContext & ctx, tid_t tid, Table & table, Consum
         produce_current_master(tid, consumer, scan_items);
     } else {
         auto storage = static_cast<const VersionedTupleStorage *>(element);
-        produce(storage, consumer, scan_items);
+        produce(tid, storage, table, consumer, scan_items);
     }
 }
 
@@ -181,7 +341,7 @@ void produce_tuple(QueryContext & ctx, tid_t tid, unsigned revision_offset, Tabl
         produce_current_master(tid, consumer, scan_items);
     } else {
         auto storage = static_cast<const VersionedTupleStorage *>(element);
-        produce(storage, consumer, scan_items);
+        produce(tid, storage, table, consumer, scan_items);
     }
 }
 
@@ -7,7 +7,6 @@
 
 #include <vector>
 #include "foundations/Database.hpp"
-#include <boost/dynamic_bitset.hpp>
 
 
 struct ExecutionResource {
@@ -20,9 +19,10 @@ struct ExecutionContext {
 
     bool overflowFlag = false;
     branch_id_t branchId = 0;
-    std::unordered_map<branch_id_t, branch_id_t> branch_lineage; // mapping: parent -> offspring
-    std::unordered_map<branch_id_t,std::unordered_map<branch_id_t, branch_id_t>> branch_lineages;
-    boost::dynamic_bitset<> branch_lineage_bitset;
+    const BranchLineage * branch_lineage = nullptr; // the lineage of branchId, one of branch_lineages
+    std::unordered_map<branch_id_t, BranchLineage> branch_lineages;
+
+    uint64_t commitLsn = 0; // the latest write-ahead log record of the statement
 };
 
 #endif //PROTODB_EXECUTIONCONTEXT_HPP
@@ -16,11 +16,14 @@ namespace semanticalAnalysis {
         size_t length;
         size_t precision;
         bool nullable;
+        bool dictionaryEncoded;
+        bool bitPacked;
     };
     struct Relation {
         std::string name;
         std::string alias;
         std::string version;
+        std::string diffVersion; // the branch which a diff scan compares the version to; empty for plain scans
     };
     struct Column {
         std::string name;
@@ -61,13 +64,27 @@ namespace semanticalAnalysis {
         std::string format;
         bool directionFrom;
     };
+    struct SnapshotStatement {
+        std::string filePath;
+        bool load;
+    };
+    struct MergeBranchStatement {
+        std::string sourceBranchName;
+        std::string destinationBranchName;
+    };
+    struct MaterializeBranchStatement {
+        std::string branchName;
+    };
+    struct DropBranchStatement {
+        std::string branchName;
+    };
 
     using BindingAttribute = std::pair<std::string, std::string>; // bindingName and attribute
 
     struct SQLParserResult {
 
         enum OpType : unsigned int {
-            Unknown, Select, Insert, Update, Delete, CreateTable, CreateBranch, Branch, Copy
+            Unknown, Select, Insert, Update, Delete, CreateTable, CreateBranch, Branch, Copy, Snapshot, MergeBranch, MaterializeBranch, DropBranch
         } opType = Unknown;
 
         CreateTableStatement *createTableStmt;
@@ -77,6 +94,10 @@ namespace semanticalAnalysis {
         UpdateStatement *updateStmt;
         DeleteStatement *deleteStmt;
         CopyStatement *copyStmt;
+        SnapshotStatement *snapshotStmt;
+        MergeBranchStatement *mergeBranchStmt;
+        MaterializeBranchStatement *materializeBranchStmt;
+        DropBranchStatement *dropBranchStmt;
 
         SQLParserResult() {}
         ~SQLParserResult() {
@@ -104,6 +125,18 @@ namespace semanticalAnalysis {
                 case Copy:
                     delete copyStmt;
                     break;
+                case Snapshot:
+                    delete snapshotStmt;
+                    break;
+                case MergeBranch:
+                    delete mergeBranchStmt;
+                    break;
+                case MaterializeBranch:
+                    delete materializeBranchStmt;
+                    break;
+                case DropBranch:
+                    delete dropBranchStmt;
+                    break;
                 case Unknown:
                     break;
             }
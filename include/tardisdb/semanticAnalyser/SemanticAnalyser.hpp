@@ -107,6 +107,34 @@ namespace semanticalAnalysis {
         static void dumpCallbackCSV(Native::Sql::SqlTuple *tuple);
         static void dumpCallbackTBL(Native::Sql::SqlTuple *tuple);
     };
+
+    class SnapshotAnalyser : public SemanticAnalyser {
+    public:
+        SnapshotAnalyser(AnalyzingContext &context) : SemanticAnalyser(context) {}
+        void verify() override;
+        void constructTree() override;
+    };
+
+    class MergeBranchAnalyser : public SemanticAnalyser {
+    public:
+        MergeBranchAnalyser(AnalyzingContext &context) : SemanticAnalyser(context) {}
+        void verify() override;
+        void constructTree() override;
+    };
+
+    class MaterializeBranchAnalyser : public SemanticAnalyser {
+    public:
+        MaterializeBranchAnalyser(AnalyzingContext &context) : SemanticAnalyser(context) {}
+        void verify() override;
+        void constructTree() override;
+    };
+
+    class DropBranchAnalyser : public SemanticAnalyser {
+    public:
+        DropBranchAnalyser(AnalyzingContext &context) : SemanticAnalyser(context) {}
+        void verify() override;
+        void constructTree() override;
+    };
 }
 
 
@@ -21,6 +21,8 @@ namespace tardisParser {
         SelectFromRelationName,
         SelectFromVersion,
         SelectFromTag,
+        SelectFromDiff,
+        SelectFromDiffBase,
         SelectFromBindingName,
         SelectFromSeparator,
         SelectWhere,
@@ -84,6 +86,7 @@ namespace tardisParser {
         CreateTableTypeDetailPrecision,
         CreateTableTypeNot,
         CreateTableTypeNotNull,
+        CreateTableTypeEncoding,
         CreateTableColumnSeperator,
         CreateBranch,
         CreateBranchTag,
@@ -102,6 +105,24 @@ namespace tardisParser {
         CopyFormat,
         CopyType,
 
+        Snapshot,
+        SnapshotKeyword,
+        SnapshotPath,
+
+        Merge,
+        MergeBranch,
+        MergeSource,
+        MergeInto,
+        MergeDestination,
+
+        Materialize,
+        MaterializeBranch,
+        MaterializeName,
+
+        Drop,
+        DropBranch,
+        DropName,
+
         Done
     } state_t;
 
@@ -111,11 +132,14 @@ namespace tardisParser {
         size_t length;
         size_t precision;
         bool nullable;
+        bool dictionaryEncoded;
+        bool bitPacked;
     };
     struct Table {
         std::string name;
         std::string alias;
         std::string version;
+        std::string diffVersion; // the branch which a diff scan compares the version to; empty for plain scans
     };
     struct Column {
         std::string name;
@@ -156,6 +180,20 @@ namespace tardisParser {
         std::string format;
         bool directionFrom;
     };
+    struct SnapshotStatement {
+        std::string filePath;
+        bool load;
+    };
+    struct MergeBranchStatement {
+        std::string sourceBranchName;
+        std::string destinationBranchName;
+    };
+    struct MaterializeBranchStatement {
+        std::string branchName;
+    };
+    struct DropBranchStatement {
+        std::string branchName;
+    };
 
     using BindingAttribute = std::pair<std::string, std::string>; // bindingName and attribute
 
@@ -164,7 +202,7 @@ namespace tardisParser {
         State state;
 
         enum OpType : unsigned int {
-            Unkown, Select, Insert, Update, Delete, CreateTable, CreateBranch, Branch, Copy
+            Unkown, Select, Insert, Update, Delete, CreateTable, CreateBranch, Branch, Copy, Snapshot, MergeBranch, MaterializeBranch, DropBranch
         } opType;
 
         CreateTableStatement *createTableStmt;
@@ -174,6 +212,10 @@ namespace tardisParser {
         UpdateStatement *updateStmt;
         DeleteStatement *deleteStmt;
         CopyStatement *copyStmt;
+        SnapshotStatement *snapshotStmt;
+        MergeBranchStatement *mergeBranchStmt;
+        MaterializeBranchStatement *materializeBranchStmt;
+        DropBranchStatement *dropBranchStmt;
 
         ParsingContext() {
             opType = Unkown;
@@ -205,6 +247,18 @@ namespace tardisParser {
                 case Copy:
                     delete copyStmt;
                     break;
+                case Snapshot:
+                    delete snapshotStmt;
+                    break;
+                case MergeBranch:
+                    delete mergeBranchStmt;
+                    break;
+                case MaterializeBranch:
+                    delete materializeBranchStmt;
+                    break;
+                case DropBranch:
+                    delete dropBranchStmt;
+                    break;
             }
         }
 
@@ -223,7 +277,11 @@ namespace tardisParser {
                                             State::CreateTableColumnsEnd,
                                             State::CreateBranchParent,
                                             State::Branch,
-                                            State::CopyType };
+                                            State::CopyType,
+                                            State::SnapshotPath,
+                                            State::MergeDestination,
+                                            State::MaterializeName,
+                                            State::DropName };
 
             return finalStates.count(state);
         }
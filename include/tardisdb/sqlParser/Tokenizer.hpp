@@ -14,6 +14,7 @@ namespace tardisParser {
     // Define all SQL keywords
     namespace Keyword {
         const std::string Version = "version";
+        const std::string Diff = "diff";
 
         const std::string Select = "select";
         const std::string From = "from";
@@ -33,6 +34,8 @@ namespace tardisParser {
         const std::string Table = "table";
         const std::string Not = "not";
         const std::string Null = "null";
+        const std::string Dictionary = "dictionary";
+        const std::string Packed = "packed";
 
         const std::string Branch = "branch";
 
@@ -44,8 +47,17 @@ namespace tardisParser {
 
         const std::string To = "to";
 
-        static std::set<std::string> keywordset = {Version, Select, From, Where, And, Insert, Into, Values, Update, Set, Delete, Create,
-                                            Table, Not, Null, Branch, Copy, With, Format, CSV, TBL, To};
+        const std::string Save = "save";
+        const std::string Load = "load";
+        const std::string Snapshot = "snapshot";
+
+        const std::string Merge = "merge";
+        const std::string Materialize = "materialize";
+        const std::string Drop = "drop";
+
+        static std::set<std::string> keywordset = {Version, Diff, Select, From, Where, And, Insert, Into, Values, Update, Set, Delete, Create,
+                                            Table, Not, Null, Dictionary, Packed, Branch, Copy, With, Format, CSV, TBL, To,
+                                            Save, Load, Snapshot, Merge, Materialize, Drop};
     }
 
     // Define all control symbols
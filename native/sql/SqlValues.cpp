@@ -863,11 +863,8 @@ value_op_t Text::castString(const std::string & str)
     const uint8_t * bytes = reinterpret_cast<const uint8_t *>(str.c_str());
     size_t len = str.size();
     if (len > 15) {
-        std::unique_ptr<uint8_t[]> data(new uint8_t[len]);
-        std::memcpy(data.get(), bytes, len);
-        auto & storedStr = StringPool::instance().put(sql_string_t(len, std::move(data)));
-        uint8_t * beginPtr = storedStr.second.get();
-        uint8_t * endPtr = beginPtr+len;
+        const uint8_t * beginPtr = StringPool::instance().put(bytes, len);
+        const uint8_t * endPtr = beginPtr+len;
         value_op_t sqlValue( new Text(beginPtr, endPtr) );
         return sqlValue;
     } else {
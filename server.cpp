@@ -7,6 +7,9 @@
 #include <llvm/Support/TargetSelect.h>
 
 #include "foundations/Database.hpp"
+#include "foundations/Allocator.hpp"
+#include "foundations/Compactor.hpp"
+#include "foundations/WriteAheadLog.hpp"
 #include "queryCompiler/queryCompiler.hpp"
 #include "utils/general.hpp"
 
@@ -167,12 +170,28 @@ public:
 
 int main(int argc, char **argv) {
   unsigned port = 5000;
+  std::string logPath;
+  auto durability = WriteAheadLog::Durability::Group;
+  bool compaction = false;
   int opt;
-  while ((opt = getopt(argc, argv, "p:")) != -1) {
+  while ((opt = getopt(argc, argv, "p:l:d:a:c")) != -1) {
     switch (opt) {
     case 'p':
       port = atoi(optarg);
       break;
+    case 'l':
+      logPath = optarg;
+      break;
+    case 'd':
+      durability = WriteAheadLog::parseDurability(optarg);
+      break;
+    case 'a':
+      // e.g. "thp,interleave"; applies to all tables and query memory
+      Allocator::instance().setDefaultPolicy(AllocationPolicy::parse(optarg));
+      break;
+    case 'c':
+      compaction = true;
+      break;
     default:
       break;
     }
@@ -183,6 +202,22 @@ int main(int argc, char **argv) {
   llvm::InitializeNativeTargetAsmParser();
   dbs.emplace(0,std::make_unique<Database>()); // add a default db
 
+  // the default db is recovered from and logged to the write-ahead log
+  if (!logPath.empty()) {
+    {
+      ModuleGen moduleGen("ReplayModule");
+      size_t count = WriteAheadLog::replay(*dbs[0], logPath);
+      fprintf(stderr, "replayed %zu log records\n", count);
+    }
+    dbs[0]->setWriteAheadLog(std::make_unique<WriteAheadLog>(logPath, durability));
+  }
+
+  // reclaims the rows deleted from the default db in the background
+  std::unique_ptr<Compactor> compactor;
+  if (compaction) {
+    compactor = std::make_unique<Compactor>(*dbs[0]);
+  }
+
   Pistache::Address addr(Pistache::Ipv4::any(), Pistache::Port(port));
   auto opts = Pistache::Http::Endpoint::options().threads(1).maxRequestSize(1024 * 1024);
   Http::Endpoint server(addr);
@@ -624,6 +624,24 @@ std::vector<llvm::Value *> BasicString::getRawValues() const
     return { _llvmValue, _length };
 }
 
+void BasicString::setDictionaryCode(const StringDictionary * dictionary, llvm::Value * code)
+{
+    _dictionary = dictionary;
+    _dictionaryCode = code;
+}
+
+bool BasicString::equalCodes(const BasicString & str1, const BasicString & str2, cg_bool_t & result)
+{
+    if (str1._dictionary == nullptr || str1._dictionary != str2._dictionary) {
+        return false;
+    }
+
+    // equal strings share the same code
+    auto & codeGen = getThreadLocalCodeGen();
+    result = cg_bool_t( codeGen->CreateICmpEQ(str1._dictionaryCode, str2._dictionaryCode) );
+    return true;
+}
+
 static inline unsigned lengthIndicatorSize(size_t length)
 {
     return (length < 256) ? 8 : (length < 65536) ? 16 : 32;
@@ -854,7 +872,9 @@ cg_bool_t Char::compare(const Value & other, ComparisonMode mode) const
 
     value_op_t Text::clone() const
     {
-        return value_op_t( new Text(type, _llvmValue) );
+        auto text = new Text(type, _llvmValue);
+        text->setDictionaryCode(_dictionary, _dictionaryCode);
+        return value_op_t(text);
     }
 
     void storeText(char *dest, uint8_t * beginPtr, size_t len) {
@@ -875,11 +895,8 @@ cg_bool_t Char::compare(const Value & other, ComparisonMode mode) const
 
     void storeTextGen(char *dest, const uint8_t * bytes, size_t len) {
         if (len > 15) {
-            std::unique_ptr<uint8_t[]> data(new uint8_t[len]);
-            std::memcpy(data.get(), bytes, len);
-            auto & storedStr = StringPool::instance().put(sql_string_t(len, std::move(data)));
-            uint8_t * beginPtr = storedStr.second.get();
-            uint8_t * endPtr = beginPtr+len;
+            const uint8_t * beginPtr = StringPool::instance().put(bytes, len);
+            const uint8_t * endPtr = beginPtr+len;
 
             uintptr_t first_value = reinterpret_cast<uintptr_t>(beginPtr);
             first_value ^= static_cast<uintptr_t>(1) << (8*sizeof(uintptr_t)-1);
@@ -923,16 +940,14 @@ cg_bool_t Char::compare(const Value & other, ComparisonMode mode) const
 
 
         size_t len = str.size();
-        uint8_t* data = new uint8_t[len];
-        std::memcpy(data, str.c_str(), len);
+        const uint8_t * bytes = reinterpret_cast<const uint8_t *>(str.c_str());
 
         uint8_t * beginPtr;
         if (len > 15) {
-            std::unique_ptr<uint8_t[]> dataPtr(data);
-            auto & storedStr = StringPool::instance().put(sql_string_t(len, std::move(dataPtr)));
-            beginPtr = storedStr.second.get();
+            beginPtr = const_cast<uint8_t *>(StringPool::instance().put(bytes, len));
         } else {
-            beginPtr = data;
+            beginPtr = new uint8_t[len];
+            std::memcpy(beginPtr, bytes, len);
         }
 
         llvm::FunctionType * funcTy = llvm::TypeBuilder<void (void *, void *, size_t), false>::get(codeGen.getLLVMContext());
@@ -1042,6 +1057,11 @@ cg_bool_t Char::compare(const Value & other, ComparisonMode mode) const
             return other.equals(*this);
         }
 
+        cg_bool_t codesEqual(false);
+        if (equalCodes(*this, static_cast<const BasicString &>(other), codesEqual)) {
+            return codesEqual;
+        }
+
         llvm::FunctionType * funcTy = llvm::TypeBuilder<int (void *), false>::get(codeGen.getLLVMContext());
         llvm::Function * func = llvm::cast<llvm::Function>( getThreadLocalCodeGen().getCurrentModuleGen().getModule().getOrInsertFunction("getLengthText", funcTy) );
         getThreadLocalCodeGen().getCurrentModuleGen().addFunctionMapping(func,(void *)&getLengthText);
@@ -1076,6 +1096,9 @@ cg_bool_t Char::compare(const Value & other, ComparisonMode mode) const
 
     cg_bool_t Text::compare(const Value & other, ComparisonMode mode) const
     {
+        if (mode == ComparisonMode::eq) {
+            return equals(other);
+        }
         throw NotImplementedException("Text::compare");
     }
 
@@ -1090,7 +1113,9 @@ Varchar::Varchar(SqlType type, llvm::Value * value, llvm::Value * length) :
 
 value_op_t Varchar::clone() const
 {
-    return value_op_t( new Varchar(type, _llvmValue, _length) );
+    auto varchar = new Varchar(type, _llvmValue, _length);
+    varchar->setDictionaryCode(_dictionary, _dictionaryCode);
+    return value_op_t(varchar);
 }
 
 value_op_t Varchar::castString(const std::string & str, SqlType type)
@@ -1189,11 +1214,19 @@ cg_bool_t Varchar::equals(const Value & other) const
         return other.equals(*this);
     }
 
+    cg_bool_t codesEqual(false);
+    if (equalCodes(*this, static_cast<const BasicString &>(other), codesEqual)) {
+        return codesEqual;
+    }
+
     return equalBuffers(*this, static_cast<const BasicString &>(other));
 }
 
 cg_bool_t Varchar::compare(const Value & other, ComparisonMode mode) const
 {
+    if (mode == ComparisonMode::eq) {
+        return equals(other);
+    }
     throw NotImplementedException("Varchar::compare");
 }
 
@@ -6,6 +6,8 @@
 #include "codegen/CodeGen.hpp"
 #include "sql/SqlType.hpp"
 
+class StringDictionary;
+
 namespace Sql {
 
 class Value;
@@ -209,9 +211,26 @@ public:
         return _length;
     }
 
+    /// \brief Attaches the code of this string within the given dictionary
+    void setDictionaryCode(const StringDictionary * dictionary, llvm::Value * code);
+
+    /// \returns The dictionary the attached code belongs to or nullptr if there is none
+    const StringDictionary * getDictionary() const
+    {
+        return _dictionary;
+    }
+
+    llvm::Value * getDictionaryCode() const
+    {
+        return _dictionaryCode;
+    }
+
 protected:
     BasicString(SqlType type, llvm::Value * value, llvm::Value * length);
 
+    /// \brief Compares the attached codes, provided that both strings are encoded by the same dictionary
+    static bool equalCodes(const BasicString & str1, const BasicString & str2, cg_bool_t & result);
+
     static llvm::Value * loadStringLength(llvm::Value * ptr, SqlType type);
 
     static cg_bool_t equalBuffers(const BasicString & str1, const BasicString & str2);
@@ -219,6 +238,9 @@ protected:
     static cg_int_t compareBuffers(const BasicString & str1, const BasicString & str2);
 
     llvm::Value * _length = nullptr;
+
+    const StringDictionary * _dictionary = nullptr;
+    llvm::Value * _dictionaryCode = nullptr;
 };
 
 //-----------------------------------------------------------------------------
@@ -1,11 +1,19 @@
 #include <llvm/IR/TypeBuilder.h>
 
+#include <algorithm>
+#include <cstdio>
+#include <limits>
+
 #include "codegen/CodeGen.hpp"
 #include "foundations/loader.hpp"
+#include "foundations/Snapshot.hpp"
+#include "foundations/version_management.hpp"
+#include "foundations/ZoneMap.hpp"
 #include "include/tardisdb/semanticAnalyser/SemanticAnalyser.hpp"
 #include "algebra/translation.hpp"
 #include "queryExecutor/queryExecutor.hpp"
 #include "queryCompiler/queryCompiler.hpp"
+#include "queryCompiler/QueryContext.hpp"
 #include <gtest/gtest.h>
 
 namespace {
@@ -47,6 +55,40 @@ namespace {
             }
         }
 
+        static void collectIntegersCallbackHandler(Native::Sql::SqlTuple *tuple) {
+            for (auto &value : tuple->values) {
+                collectedIntegers.push_back(static_cast<const Native::Sql::Integer &>(*value).value);
+            }
+        }
+
+        /// \returns The sorted values of the integer columns which the query produces
+        std::vector<int32_t> selectIntegers(const std::string &query) {
+            collectedIntegers.clear();
+            QueryCompiler::compileAndExecute(query, *db, (void*) &collectIntegersCallbackHandler);
+            std::sort(collectedIntegers.begin(), collectedIntegers.end());
+            return collectedIntegers;
+        }
+
+        /// \brief Inserts the rows makeRow(0) to makeRow(count - 1) into master, which is faster than INSERT statements
+        template<typename RowFunc>
+        void insertRows(const std::string &tableName, int32_t count, RowFunc makeRow) {
+            ModuleGen moduleGen("QueryTestModule");
+            Table &table = *db->getTable(tableName);
+            QueryContext ctx(*db);
+            for (int32_t i = 0; i < count; ++i) {
+                Native::Sql::SqlTuple tuple(makeRow(i));
+                insert_tuple(tuple, table, ctx);
+            }
+        }
+
+        static std::vector<Native::Sql::value_op_t> integerRow(int32_t value) {
+            std::vector<Native::Sql::value_op_t> values;
+            values.push_back(std::make_unique<Native::Sql::Integer>(value));
+            return values;
+        }
+
+        static inline std::vector<int32_t> collectedIntegers;
+
         std::unique_ptr<Database> db;
     };
 
@@ -199,5 +241,316 @@ namespace {
         QueryCompiler::compileAndExecute("select id, rang from professoren version hello;",*db, (void*) &stateProfessor2CallbackHandler);
         QueryCompiler::compileAndExecute("select id, rang from professoren;",*db, (void*) &stateKemperProfessor2CallbackHandler);
     }
-}
 
+#if !USE_HYRISE
+    TEST_F(QueryTest, ScanSkipsDeletedRowsWordwise) {
+        // more than one chunk, the last word of the table is partial
+        const int32_t rowCount = (1 << Vector::defaultChunkShift) + 70;
+        QueryCompiler::compileAndExecute("create table t ( id INTEGER NOT NULL );",*db);
+        insertRows("t", rowCount, integerRow);
+
+        // deleted rows at both sides of word boundaries, of the chunk boundary and at the end of the table
+        std::vector<int32_t> deleted = { 0, 63, 64, 127, 128, 129, (1 << Vector::defaultChunkShift) - 1,
+                                         1 << Vector::defaultChunkShift, rowCount - 1 };
+        QueryCompiler::compileAndExecute("create branch b from master;",*db);
+        for (int32_t id : deleted) {
+            QueryCompiler::compileAndExecute("DELETE FROM t WHERE id = " + std::to_string(id) + " ;",*db);
+        }
+
+        std::vector<int32_t> expected;
+        for (int32_t id = 0; id < rowCount; ++id) {
+            if (std::find(deleted.begin(), deleted.end(), id) == deleted.end()) {
+                expected.push_back(id);
+            }
+        }
+        EXPECT_EQ(selectIntegers("select id from t;"), expected);
+
+        // the branch forked off before the deletes
+        std::vector<int32_t> all(rowCount);
+        for (int32_t id = 0; id < rowCount; ++id) {
+            all[id] = id;
+        }
+        EXPECT_EQ(selectIntegers("select id from t version b;"), all);
+    }
+
+    TEST_F(QueryTest, ScanPartialWord) {
+        QueryCompiler::compileAndExecute("create table t ( id INTEGER NOT NULL );",*db);
+        insertRows("t", 3, integerRow);
+        EXPECT_EQ(selectIntegers("select id from t;"), std::vector<int32_t>({ 0, 1, 2 }));
+
+        insertRows("t", 64, [](int32_t i) { return integerRow(100 + i); });
+        EXPECT_EQ(selectIntegers("select id from t;").size(), 67ul);
+    }
+
+    TEST_F(QueryTest, DictionaryColumnsInPredicatesAndJoins) {
+        QueryCompiler::compileAndExecute("create table t ( id INTEGER NOT NULL, name VARCHAR ( 10 ) NOT NULL DICTIONARY );",*db);
+        QueryCompiler::compileAndExecute("create table u ( uid INTEGER NOT NULL, name VARCHAR ( 10 ) NOT NULL );",*db);
+        QueryCompiler::compileAndExecute("INSERT INTO t ( id, name ) VALUES ( 1, 'alice' );",*db);
+        QueryCompiler::compileAndExecute("INSERT INTO t ( id, name ) VALUES ( 2, 'bob' );",*db);
+        QueryCompiler::compileAndExecute("INSERT INTO t ( id, name ) VALUES ( 3, 'alice' );",*db);
+        QueryCompiler::compileAndExecute("INSERT INTO t ( id, name ) VALUES ( 4, 'carol' );",*db);
+        QueryCompiler::compileAndExecute("INSERT INTO u ( uid, name ) VALUES ( 7, 'alice' );",*db);
+
+        EXPECT_EQ(selectIntegers("select id from t where name = 'alice';"), std::vector<int32_t>({ 1, 3 }));
+        // the constant is not part of the dictionary yet and must not be added by the lookup
+        const StringDictionary & dictionary = *db->getTable("t")->getCI("name")->dictionary;
+        EXPECT_TRUE(selectIntegers("select id from t where name = 'dave';").empty());
+        EXPECT_TRUE(selectIntegers("select x.id from t x , u y where x.name = y.name and y.name = 'dave';").empty());
+        EXPECT_EQ(dictionary.size(), 3ul);
+        QueryCompiler::compileAndExecute("INSERT INTO t ( id, name ) VALUES ( 5, 'dave' );",*db);
+        EXPECT_EQ(selectIntegers("select id from t where name = 'dave';"), std::vector<int32_t>({ 5 }));
+
+        // both sides share the dictionary, respectively the build side is a plain column
+        EXPECT_EQ(selectIntegers("select x.id from t x , t y where x.name = y.name and y.id = 3;"),
+                std::vector<int32_t>({ 1, 3 }));
+        EXPECT_EQ(selectIntegers("select x.id from t x , u y where x.name = y.name and y.uid = 7;"),
+                std::vector<int32_t>({ 1, 3 }));
+
+        // the values of version chains carry no codes
+        QueryCompiler::compileAndExecute("create branch b from master;",*db);
+        QueryCompiler::compileAndExecute("UPDATE t VERSION b SET name = 'bob' WHERE id = 1 ;",*db);
+        QueryCompiler::compileAndExecute("UPDATE t SET name = 'bob' WHERE id = 4 ;",*db);
+        EXPECT_EQ(selectIntegers("select id from t version b where name = 'bob';"), std::vector<int32_t>({ 1, 2 }));
+        EXPECT_EQ(selectIntegers("select id from t where name = 'bob';"), std::vector<int32_t>({ 2, 4 }));
+        EXPECT_EQ(selectIntegers("select x.id from t version b x , t version b y where x.name = y.name and y.id = 2;"),
+                std::vector<int32_t>({ 1, 2 }));
+        EXPECT_EQ(selectIntegers("select x.id from t x , t version b y where x.name = y.name and y.id = 1;"),
+                std::vector<int32_t>({ 2, 4 }));
+    }
+
+    TEST_F(QueryTest, ScanPackedColumns) {
+        const int32_t chunkSize = 1 << Vector::defaultChunkShift;
+        const int32_t rowCount = 2*chunkSize + 10;
+        QueryCompiler::compileAndExecute("create table t ( id INTEGER NOT NULL, v INTEGER NOT NULL PACKED, c INTEGER NOT NULL PACKED );",*db);
+
+        // the first block needs 15 bits, the second one the full width, the last one is not packed yet;
+        // the blocks of c need no bits at all
+        auto makeValue = [&](int32_t id) {
+            if (id == chunkSize) {
+                return std::numeric_limits<int32_t>::min();
+            } else if (id == chunkSize + 1) {
+                return std::numeric_limits<int32_t>::max();
+            }
+            return 1000 + id;
+        };
+        insertRows("t", rowCount, [&](int32_t id) {
+            std::vector<Native::Sql::value_op_t> values;
+            values.push_back(std::make_unique<Native::Sql::Integer>(id));
+            values.push_back(std::make_unique<Native::Sql::Integer>(makeValue(id)));
+            values.push_back(std::make_unique<Native::Sql::Integer>(7));
+            return values;
+        });
+
+        std::vector<int32_t> expected;
+        for (int32_t id = 0; id < rowCount; ++id) {
+            expected.push_back(makeValue(id));
+        }
+        std::sort(expected.begin(), expected.end());
+        EXPECT_EQ(selectIntegers("select v from t;"), expected);
+        EXPECT_EQ(selectIntegers("select id from t where v = 1005;"), std::vector<int32_t>({ 5 }));
+        EXPECT_EQ(selectIntegers("select id from t where v = 2147483647;"), std::vector<int32_t>({ chunkSize + 1 }));
+        EXPECT_EQ(selectIntegers("select c from t where id = " + std::to_string(chunkSize + 3) + ";"),
+                std::vector<int32_t>({ 7 }));
+
+        // the new value leaves the range of the first block, which is repacked
+        QueryCompiler::compileAndExecute("create branch b from master;",*db);
+        QueryCompiler::compileAndExecute("UPDATE t SET v = -7 WHERE id = 5 ;",*db);
+        QueryCompiler::compileAndExecute("UPDATE t VERSION b SET v = 123456789 WHERE id = 6 ;",*db);
+        EXPECT_EQ(selectIntegers("select id from t where v = -7;"), std::vector<int32_t>({ 5 }));
+        EXPECT_EQ(selectIntegers("select v from t where id = 4;"), std::vector<int32_t>({ 1004 }));
+        EXPECT_EQ(selectIntegers("select v from t where id = 6;"), std::vector<int32_t>({ 1006 }));
+        EXPECT_EQ(selectIntegers("select v from t version b where id = 5;"), std::vector<int32_t>({ 1005 }));
+        EXPECT_EQ(selectIntegers("select v from t version b where id = 6;"), std::vector<int32_t>({ 123456789 }));
+        EXPECT_EQ(selectIntegers("select v from t where id = " + std::to_string(rowCount - 1) + ";"),
+                std::vector<int32_t>({ 1000 + rowCount - 1 }));
+    }
+
+    TEST_F(QueryTest, ZoneMapsSkipOnlyExcludedBlocks) {
+        const int32_t chunkSize = 1 << Vector::defaultChunkShift;
+        const int32_t rowCount = 3*chunkSize;
+        QueryCompiler::compileAndExecute("create table t ( id INTEGER NOT NULL, v INTEGER NOT NULL );",*db);
+        insertRows("t", rowCount, [](int32_t id) {
+            std::vector<Native::Sql::value_op_t> values;
+            values.push_back(std::make_unique<Native::Sql::Integer>(id));
+            values.push_back(std::make_unique<Native::Sql::Integer>(id));
+            return values;
+        });
+        const ZoneMap & zoneMap = *db->getTable("t")->getCI("v")->zoneMap;
+        ASSERT_EQ(zoneMap.getZoneCount(), 3ul);
+
+        // every block but one is excluded
+        EXPECT_EQ(selectIntegers("select id from t where v = 5;"), std::vector<int32_t>({ 5 }));
+        EXPECT_EQ(selectIntegers("select id from t where v = " + std::to_string(chunkSize) + ";"),
+                std::vector<int32_t>({ chunkSize }));
+        EXPECT_EQ(selectIntegers("select id from t where v = " + std::to_string(rowCount - 1) + ";"),
+                std::vector<int32_t>({ rowCount - 1 }));
+        EXPECT_TRUE(selectIntegers("select id from t where v = " + std::to_string(rowCount) + ";").empty());
+
+        // the master update widens the first block, which may no longer be skipped for the value
+        const int32_t moved = 2*chunkSize + 1;
+        QueryCompiler::compileAndExecute("create branch b from master;",*db);
+        QueryCompiler::compileAndExecute("UPDATE t SET v = " + std::to_string(moved) + " WHERE id = 3 ;",*db);
+        EXPECT_TRUE(ZoneMap::mayMatch(zoneMap.getZone(0), Sql::ComparisonMode::eq, moved));
+        EXPECT_FALSE(ZoneMap::mayMatch(zoneMap.getZone(1), Sql::ComparisonMode::eq, moved));
+        EXPECT_EQ(selectIntegers("select id from t where v = " + std::to_string(moved) + ";"),
+                std::vector<int32_t>({ 3, moved }));
+        EXPECT_EQ(selectIntegers("select id from t version b where v = " + std::to_string(moved) + ";"),
+                std::vector<int32_t>({ moved }));
+        EXPECT_EQ(selectIntegers("select id from t version b where v = 3;"), std::vector<int32_t>({ 3 }));
+
+        // the blocks cover the versions of branch updates and branch inserts as well
+        QueryCompiler::compileAndExecute("UPDATE t VERSION b SET v = 999999 WHERE id = " +
+                std::to_string(chunkSize + 7) + " ;",*db);
+        QueryCompiler::compileAndExecute("INSERT INTO t VERSION b ( id, v ) VALUES ( 1000000, -5 );",*db);
+        EXPECT_EQ(selectIntegers("select id from t version b where v = 999999;"),
+                std::vector<int32_t>({ chunkSize + 7 }));
+        EXPECT_EQ(selectIntegers("select id from t version b where v = -5;"), std::vector<int32_t>({ 1000000 }));
+        EXPECT_TRUE(selectIntegers("select id from t where v = 999999;").empty());
+        EXPECT_TRUE(selectIntegers("select id from t where v = -5;").empty());
+    }
+
+    TEST_F(QueryTest, BranchScanResolvesLatestVersions) {
+        QueryCompiler::compileAndExecute("create table t ( id INTEGER NOT NULL, v INTEGER NOT NULL );",*db);
+        for (int32_t id = 1; id <= 4; ++id) {
+            QueryCompiler::compileAndExecute("INSERT INTO t ( id, v ) VALUES ( " + std::to_string(id) + ", " +
+                    std::to_string(10*id) + " );",*db);
+        }
+        QueryCompiler::compileAndExecute("create branch b from master;",*db);
+
+        // tuple 1 stays unmodified, tuple 2 is updated twice in the branch, tuple 3 only in master after the fork
+        QueryCompiler::compileAndExecute("UPDATE t VERSION b SET v = 21 WHERE id = 2 ;",*db);
+        QueryCompiler::compileAndExecute("UPDATE t VERSION b SET v = 22 WHERE id = 2 ;",*db);
+        QueryCompiler::compileAndExecute("UPDATE t SET v = 31 WHERE id = 3 ;",*db);
+        QueryCompiler::compileAndExecute("create branch c from b;",*db);
+        QueryCompiler::compileAndExecute("UPDATE t VERSION c SET v = 41 WHERE id = 4 ;",*db);
+
+        EXPECT_EQ(selectIntegers("select v from t;"), std::vector<int32_t>({ 10, 20, 31, 40 }));
+        EXPECT_EQ(selectIntegers("select v from t version b;"), std::vector<int32_t>({ 10, 22, 30, 40 }));
+        EXPECT_EQ(selectIntegers("select v from t version c;"), std::vector<int32_t>({ 10, 22, 30, 41 }));
+
+        // further branches writing tuple 1 spill its heads into the overflow map
+        for (int i = 0; i < 6; ++i) {
+            std::string name = "x" + std::to_string(i);
+            QueryCompiler::compileAndExecute("create branch " + name + " from master;",*db);
+            QueryCompiler::compileAndExecute("UPDATE t VERSION " + name + " SET v = " + std::to_string(100 + i) +
+                    " WHERE id = 1 ;",*db);
+        }
+        EXPECT_EQ(selectIntegers("select v from t version c;"), std::vector<int32_t>({ 10, 22, 30, 41 }));
+        EXPECT_EQ(selectIntegers("select v from t version x5;"), std::vector<int32_t>({ 20, 31, 40, 105 }));
+    }
+
+    TEST_F(QueryTest, ChildKeepsVersionsOfParentAtFork) {
+        QueryCompiler::compileAndExecute("create table t ( id INTEGER NOT NULL, v INTEGER NOT NULL );",*db);
+        QueryCompiler::compileAndExecute("INSERT INTO t ( id, v ) VALUES ( 1, 10 );",*db);
+        QueryCompiler::compileAndExecute("INSERT INTO t ( id, v ) VALUES ( 2, 20 );",*db);
+        QueryCompiler::compileAndExecute("create branch p from master;",*db);
+        QueryCompiler::compileAndExecute("UPDATE t VERSION p SET v = 11 WHERE id = 1 ;",*db);
+        QueryCompiler::compileAndExecute("create branch c from p;",*db);
+
+        // the child shares the modified tuples of its parent until the parent records further ones
+        QueryCompiler::compileAndExecute("UPDATE t VERSION p SET v = 12 WHERE id = 1 ;",*db);
+        QueryCompiler::compileAndExecute("UPDATE t VERSION p SET v = 21 WHERE id = 2 ;",*db);
+        QueryCompiler::compileAndExecute("UPDATE t SET v = 22 WHERE id = 2 ;",*db);
+
+        EXPECT_EQ(selectIntegers("select v from t version c;"), std::vector<int32_t>({ 11, 20 }));
+        EXPECT_EQ(selectIntegers("select v from t version p;"), std::vector<int32_t>({ 12, 21 }));
+        EXPECT_EQ(selectIntegers("select v from t;"), std::vector<int32_t>({ 10, 22 }));
+    }
+
+    TEST_F(QueryTest, DiffSiblingBranches) {
+        QueryCompiler::compileAndExecute("create table t ( id INTEGER NOT NULL, v INTEGER NOT NULL );",*db);
+        for (int32_t id = 1; id <= 4; ++id) {
+            QueryCompiler::compileAndExecute("INSERT INTO t ( id, v ) VALUES ( " + std::to_string(id) + ", " +
+                    std::to_string(10*id) + " );",*db);
+        }
+        QueryCompiler::compileAndExecute("create branch a from master;",*db);
+        QueryCompiler::compileAndExecute("create branch b from master;",*db);
+
+        QueryCompiler::compileAndExecute("UPDATE t VERSION a SET v = 21 WHERE id = 2 ;",*db);
+        QueryCompiler::compileAndExecute("UPDATE t VERSION b SET v = 31 WHERE id = 3 ;",*db);
+        QueryCompiler::compileAndExecute("DELETE FROM t VERSION b WHERE id = 4 ;",*db);
+        QueryCompiler::compileAndExecute("INSERT INTO t VERSION b ( id, v ) VALUES ( 5, 50 );",*db);
+        // an update to the same value does not make the tuple differ
+        QueryCompiler::compileAndExecute("UPDATE t VERSION b SET v = 10 WHERE id = 1 ;",*db);
+
+        EXPECT_EQ(selectIntegers("select v from t diff a b;"), std::vector<int32_t>({ 20, 31, 50 }));
+        EXPECT_EQ(selectIntegers("select v from t diff b a;"), std::vector<int32_t>({ 21, 30, 40 }));
+        EXPECT_EQ(selectIntegers("select v from t diff a b where id = 3;"), std::vector<int32_t>({ 31 }));
+        EXPECT_TRUE(selectIntegers("select v from t diff master master;").empty());
+    }
+
+    TEST_F(QueryTest, MaterializedBranchAfterMasterWrite) {
+        QueryCompiler::compileAndExecute("create table t ( id INTEGER NOT NULL, v INTEGER NOT NULL );",*db);
+        for (int32_t id = 1; id <= 4; ++id) {
+            QueryCompiler::compileAndExecute("INSERT INTO t ( id, v ) VALUES ( " + std::to_string(id) + ", " +
+                    std::to_string(10*id) + " );",*db);
+        }
+        // the copy of b patches the master chunk, the copy of d borrows it
+        QueryCompiler::compileAndExecute("create branch b from master;",*db);
+        QueryCompiler::compileAndExecute("create branch d from master;",*db);
+        QueryCompiler::compileAndExecute("UPDATE t VERSION b SET v = 21 WHERE id = 2 ;",*db);
+        QueryCompiler::compileAndExecute("MATERIALIZE BRANCH b;",*db);
+        QueryCompiler::compileAndExecute("MATERIALIZE BRANCH d;",*db);
+        EXPECT_EQ(selectIntegers("select v from t version b;"), std::vector<int32_t>({ 10, 21, 30, 40 }));
+        EXPECT_EQ(selectIntegers("select v from t version d;"), std::vector<int32_t>({ 10, 20, 30, 40 }));
+
+        QueryCompiler::compileAndExecute("UPDATE t SET v = 11 WHERE id = 1 ;",*db);
+        QueryCompiler::compileAndExecute("DELETE FROM t WHERE id = 3 ;",*db);
+        QueryCompiler::compileAndExecute("INSERT INTO t ( id, v ) VALUES ( 5, 50 );",*db);
+        EXPECT_EQ(selectIntegers("select v from t;"), std::vector<int32_t>({ 11, 20, 40, 50 }));
+        EXPECT_EQ(selectIntegers("select v from t version b;"), std::vector<int32_t>({ 10, 21, 30, 40 }));
+        EXPECT_EQ(selectIntegers("select v from t version d;"), std::vector<int32_t>({ 10, 20, 30, 40 }));
+        EXPECT_EQ(selectIntegers("select id from t version b where v = 10;"), std::vector<int32_t>({ 1 }));
+
+        QueryCompiler::compileAndExecute("UPDATE t VERSION b SET v = 41 WHERE id = 4 ;",*db);
+        QueryCompiler::compileAndExecute("INSERT INTO t VERSION b ( id, v ) VALUES ( 6, 60 );",*db);
+        EXPECT_EQ(selectIntegers("select v from t version b;"), std::vector<int32_t>({ 10, 21, 30, 41, 60 }));
+        EXPECT_EQ(selectIntegers("select v from t version d;"), std::vector<int32_t>({ 10, 20, 30, 40 }));
+        EXPECT_EQ(selectIntegers("select v from t;"), std::vector<int32_t>({ 11, 20, 40, 50 }));
+    }
+
+    TEST_F(QueryTest, BranchGraphAfterDropBranch) {
+        QueryCompiler::compileAndExecute("create branch b1 from master;",*db);
+        QueryCompiler::compileAndExecute("create branch b2 from master;",*db);
+        QueryCompiler::compileAndExecute("DROP BRANCH b1;",*db);
+
+        QueryContext queryContext(*db);
+        std::string json = semanticalAnalysis::BranchAnalyser(queryContext.analyzingContext).returnJSON();
+        EXPECT_EQ(json.find("\"b1\""), std::string::npos);
+        EXPECT_NE(json.find("\"b2\""), std::string::npos);
+        EXPECT_EQ(db->_branches.size(), 2ul);
+    }
+
+    TEST_F(QueryTest, LoadSnapshotWithAndWithoutRelocation) {
+        const std::string longName = "a name which does not fit into the text value";
+        QueryCompiler::compileAndExecute("create table t ( id INTEGER NOT NULL, name TEXT NOT NULL );",*db);
+        QueryCompiler::compileAndExecute("INSERT INTO t ( id, name ) VALUES ( 1, '" + longName + "' );",*db);
+        QueryCompiler::compileAndExecute("INSERT INTO t ( id, name ) VALUES ( 2, 'short' );",*db);
+        QueryCompiler::compileAndExecute("INSERT INTO t ( id, name ) VALUES ( 3, 'short' );",*db);
+        QueryCompiler::compileAndExecute("create branch b from master;",*db);
+        QueryCompiler::compileAndExecute("UPDATE t VERSION b SET name = '" + longName + "' WHERE id = 2 ;",*db);
+        QueryCompiler::compileAndExecute("DELETE FROM t WHERE id = 3 ;",*db);
+
+        const std::string path = testing::TempDir() + "query_test.snapshot";
+        Snapshot::save(*db, path);
+
+        // the second snapshot cannot be mapped at the preferred base, which the first one occupies
+        auto first = std::make_unique<Database>();
+        auto second = std::make_unique<Database>();
+        Snapshot::load(*first, path);
+        Snapshot::load(*second, path);
+        std::remove(path.c_str());
+
+        for (auto * loaded : { &first, &second }) {
+            db = std::move(*loaded);
+            EXPECT_EQ(selectIntegers("select id from t where name = '" + longName + "';"), std::vector<int32_t>({ 1 }));
+            EXPECT_EQ(selectIntegers("select id from t version b where name = '" + longName + "';"),
+                    std::vector<int32_t>({ 1, 2 }));
+            EXPECT_EQ(selectIntegers("select id from t version b;"), std::vector<int32_t>({ 1, 2, 3 }));
+            QueryCompiler::compileAndExecute("INSERT INTO t ( id, name ) VALUES ( 4, '" + longName + "' );",*db);
+            EXPECT_EQ(selectIntegers("select id from t;"), std::vector<int32_t>({ 1, 2, 4 }));
+            *loaded = std::move(db);
+        }
+    }
+#endif
+}
@@ -111,6 +111,71 @@ namespace {
         ASSERT_EQ(stmt->selections[0].second, whereValue);
     }
 
+    TEST(SqlParserTest, SelectStatmentDiff) {
+        std::string statement = "SELECT title FROM page DIFF b1 b2 p WHERE p.id = 3;";
+
+        tardisParser::ParsingContext result;
+        tardisParser::SQLParser::parseStatement(result, statement);
+        tardisParser::SelectStatement* stmt = result.selectStmt;
+        ASSERT_EQ(result.opType, tardisParser::ParsingContext::OpType::Select);
+        ASSERT_EQ(stmt->relations[0].name, "page");
+        ASSERT_EQ(stmt->relations[0].alias, "p");
+        ASSERT_EQ(stmt->relations[0].diffVersion, "b1");
+        ASSERT_EQ(stmt->relations[0].version, "b2");
+        ASSERT_EQ(stmt->selections.size(), 1);
+    }
+
+    TEST(SqlParserTest, SnapshotStatement) {
+        std::string statement = "LOAD SNAPSHOT 'wiki.snapshot';";
+
+        tardisParser::ParsingContext::OpType opType = tardisParser::ParsingContext::OpType::Snapshot;
+        std::string filePath = "wiki.snapshot";
+
+        tardisParser::ParsingContext result;
+        tardisParser::SQLParser::parseStatement(result, statement);
+        tardisParser::SnapshotStatement* stmt = result.snapshotStmt;
+        ASSERT_EQ(result.opType, opType);
+        ASSERT_EQ(stmt->filePath, filePath);
+        ASSERT_TRUE(stmt->load);
+    }
+
+    TEST(SqlParserTest, MergeBranchStatement) {
+        std::string statement = "MERGE BRANCH b1 INTO master;";
+
+        tardisParser::ParsingContext::OpType opType = tardisParser::ParsingContext::OpType::MergeBranch;
+
+        tardisParser::ParsingContext result;
+        tardisParser::SQLParser::parseStatement(result, statement);
+        tardisParser::MergeBranchStatement* stmt = result.mergeBranchStmt;
+        ASSERT_EQ(result.opType, opType);
+        ASSERT_EQ(stmt->sourceBranchName, "b1");
+        ASSERT_EQ(stmt->destinationBranchName, "master");
+    }
+
+    TEST(SqlParserTest, MaterializeBranchStatement) {
+        std::string statement = "MATERIALIZE BRANCH b1;";
+
+        tardisParser::ParsingContext::OpType opType = tardisParser::ParsingContext::OpType::MaterializeBranch;
+
+        tardisParser::ParsingContext result;
+        tardisParser::SQLParser::parseStatement(result, statement);
+        tardisParser::MaterializeBranchStatement* stmt = result.materializeBranchStmt;
+        ASSERT_EQ(result.opType, opType);
+        ASSERT_EQ(stmt->branchName, "b1");
+    }
+
+    TEST(SqlParserTest, DropBranchStatement) {
+        std::string statement = "DROP BRANCH b1;";
+
+        tardisParser::ParsingContext::OpType opType = tardisParser::ParsingContext::OpType::DropBranch;
+
+        tardisParser::ParsingContext result;
+        tardisParser::SQLParser::parseStatement(result, statement);
+        tardisParser::DropBranchStatement* stmt = result.dropBranchStmt;
+        ASSERT_EQ(result.opType, opType);
+        ASSERT_EQ(stmt->branchName, "b1");
+    }
+
 }  // namespace
 
 #endif
@@ -0,0 +1,1280 @@
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <vector>
+
+#include "foundations/Allocator.hpp"
+#include "foundations/Database.hpp"
+#include "foundations/PackedIntegerColumn.hpp"
+#include "foundations/SlabAllocator.hpp"
+#include "foundations/StringDictionary.hpp"
+#include "foundations/StringPool.hpp"
+#include "foundations/TidSet.hpp"
+#include "foundations/Vector.hpp"
+#include "foundations/WriteAheadLog.hpp"
+#include "foundations/exceptions.hpp"
+#include "foundations/loader.hpp"
+#include "foundations/ZoneMap.hpp"
+#include "foundations/version_management.hpp"
+#include "gtest/gtest.h"
+
+namespace {
+
+    TEST(StorageTest, VectorAddressesAreStable) {
+        Vector vector(sizeof(uint64_t));
+
+        const size_t count = 3*(static_cast<size_t>(1) << Vector::defaultChunkShift) + 17;
+        std::vector<const void *> addresses;
+        for (uint64_t i = 0; i < count; ++i) {
+            vector.push_back(&i);
+            addresses.push_back(vector.back());
+        }
+
+        ASSERT_EQ(vector.size(), count);
+        ASSERT_EQ(vector.getChunkCount(), 4ul);
+        for (uint64_t i = 0; i < count; ++i) {
+            ASSERT_EQ(vector.at(i), addresses[i]);
+            ASSERT_EQ(*static_cast<const uint64_t *>(vector.at(i)), i);
+        }
+    }
+
+    TEST(StorageTest, VectorRemoveAcrossChunks) {
+        Vector vector(sizeof(uint64_t));
+
+        const size_t count = vector.getChunkCapacity() + 2;
+        for (uint64_t i = 0; i < count; ++i) {
+            vector.push_back(&i);
+        }
+
+        vector.remove_at(1);
+        ASSERT_EQ(vector.size(), count - 1);
+        ASSERT_EQ(*static_cast<const uint64_t *>(vector.at(0)), 0ul);
+        for (uint64_t i = 1; i < count - 1; ++i) {
+            ASSERT_EQ(*static_cast<const uint64_t *>(vector.at(i)), i + 1);
+        }
+        ASSERT_EQ(vector.getChunkSize(0), vector.getChunkCapacity());
+        ASSERT_EQ(vector.getChunkSize(1), 1ul);
+    }
+
+
+    TEST(StorageTest, VectorAdoptsBorrowedChunks) {
+        Vector vector(sizeof(uint64_t));
+
+        // chunks owned by someone else, e.g. a mapped snapshot
+        const size_t capacity = vector.getChunkCapacity();
+        std::vector<uint64_t> storage(2*capacity);
+        for (uint64_t i = 0; i < storage.size(); ++i) {
+            storage[i] = i;
+        }
+        uint8_t * chunks[] = { reinterpret_cast<uint8_t *>(storage.data()), reinterpret_cast<uint8_t *>(storage.data() + capacity) };
+
+        const size_t count = capacity + 5;
+        vector.adoptChunks(chunks, 2, count);
+        ASSERT_EQ(vector.size(), count);
+        ASSERT_EQ(vector.getBorrowedChunkCount(), 2ul);
+        ASSERT_EQ(vector.at(capacity + 1), &storage[capacity + 1]);
+
+        // appending fills the last borrowed chunk before a new chunk is allocated
+        for (uint64_t i = count; i < 2*capacity + 3; ++i) {
+            vector.push_back(&i);
+        }
+        ASSERT_EQ(storage[count], count);
+        ASSERT_EQ(*static_cast<const uint64_t *>(vector.at(2*capacity + 2)), 2*capacity + 2);
+
+        // borrowed chunks are never freed
+        while (vector.size() > capacity) {
+            vector.pop_back();
+        }
+        ASSERT_EQ(*static_cast<const uint64_t *>(vector.back()), capacity - 1);
+    }
+
+    TEST(StorageTest, VectorForkCopiesOnWrite) {
+        auto vector = std::make_unique<Vector>(sizeof(uint64_t));
+
+        const size_t count = vector->getChunkCapacity() + 5;
+        for (uint64_t i = 0; i < count; ++i) {
+            vector->push_back(&i);
+        }
+
+        auto forked = vector->fork();
+        ASSERT_EQ(forked->size(), count);
+        ASSERT_EQ(forked->getSharedChunkCount(), 2ul);
+        const Vector & constForked = *forked;
+        ASSERT_EQ(constForked.getChunk(0), static_cast<const Vector &>(*vector).getChunk(0));
+
+        // only the written chunk is copied
+        uint64_t value = 42;
+        std::memcpy(forked->at(1), &value, sizeof(value));
+        ASSERT_EQ(*static_cast<const uint64_t *>(forked->at(1)), 42ul);
+        ASSERT_EQ(*static_cast<const uint64_t *>(vector->at(1)), 1ul);
+        ASSERT_EQ(forked->getSharedChunkCount(), 1ul);
+        ASSERT_EQ(constForked.getChunk(1), static_cast<const Vector &>(*vector).getChunk(1));
+
+        // appending to the shared last chunk does not leak into the other vector
+        uint64_t appended = 7;
+        forked->push_back(&appended);
+        vector->push_back(&value);
+        ASSERT_EQ(*static_cast<const uint64_t *>(forked->back()), 7ul);
+        ASSERT_EQ(*static_cast<const uint64_t *>(vector->back()), 42ul);
+
+        ASSERT_EQ(forked->getSharedChunkCount(), 0ul);
+
+        // each vector releases only the chunks which are not referenced by the other one anymore
+        vector.reset();
+        ASSERT_EQ(*static_cast<const uint64_t *>(forked->at(2)), 2ul);
+    }
+
+    TEST(StorageTest, BitmapTableGrowsBeyondEightColumns) {
+        BitmapTable bitmap;
+        bitmap.addColumn();
+
+        const size_t rowCount = 200;
+        for (tid_t tid = 0; tid < rowCount; ++tid) {
+            bitmap.addRow();
+            bitmap.set(tid, 0, tid % 3 == 0);
+        }
+
+        // columns added after the rows have been populated start out cleared
+        for (unsigned i = 1; i < 20; ++i) {
+            ASSERT_EQ(bitmap.addColumn(), i);
+        }
+        ASSERT_EQ(bitmap.getColumnCount(), 20u);
+        for (tid_t tid = 0; tid < rowCount; ++tid) {
+            bitmap.set(tid, 19, tid % 5 == 0);
+        }
+
+        for (tid_t tid = 0; tid < rowCount; ++tid) {
+            ASSERT_EQ(bitmap.isSet(tid, 0), tid % 3 == 0);
+            ASSERT_FALSE(bitmap.isSet(tid, 10));
+            ASSERT_EQ(bitmap.isSet(tid, 19), tid % 5 == 0);
+        }
+    }
+
+    TEST(StorageTest, AllocatorHonorsPolicy) {
+        auto policy = AllocationPolicy::parse("thp,interleave");
+        ASSERT_EQ(policy.toString(), "thp,interleave");
+        ASSERT_THROW(AllocationPolicy::parse("tiny"), InvalidOperationException);
+
+        auto & allocator = Allocator::instance();
+
+        // small blocks are carved out of shared regions and recycled
+        void * block = allocator.allocateZeroed(1000, policy);
+        std::memset(block, 0xff, 1000);
+        allocator.release(block, 1000);
+        auto zeroed = static_cast<const uint8_t *>(allocator.allocateZeroed(1000, policy));
+        ASSERT_EQ(zeroed, block);
+        ASSERT_TRUE(std::all_of(zeroed, zeroed + 1000, [](uint8_t byte) { return byte == 0; }));
+        allocator.release(const_cast<uint8_t *>(zeroed), 1000);
+
+        // large allocations get a huge page aligned mapping of their own
+        size_t mappedBytes = allocator.getMappedBytes();
+        size_t largeSize = 3*Allocator::hugePageSize + 1;
+        void * large = allocator.allocate(largeSize, policy);
+        ASSERT_EQ(reinterpret_cast<uintptr_t>(large) % Allocator::hugePageSize, 0ul);
+        ASSERT_EQ(allocator.getMappedBytes(), mappedBytes + 4*Allocator::hugePageSize);
+        allocator.release(large, largeSize);
+        ASSERT_EQ(allocator.getMappedBytes(), mappedBytes);
+
+        Vector vector(sizeof(uint64_t), 0, Vector::defaultChunkShift, policy);
+        const size_t count = 3*vector.getChunkCapacity();
+        for (uint64_t i = 0; i < count; ++i) {
+            vector.push_back(&i);
+        }
+        for (uint64_t i = 0; i < count; ++i) {
+            ASSERT_EQ(*static_cast<const uint64_t *>(vector.at(i)), i);
+        }
+    }
+
+    TEST(StorageTest, SlabAllocatorGroupsBins) {
+        SlabAllocator allocator(40, AllocationPolicy());
+        ASSERT_EQ(allocator.getElementSize() % alignof(std::max_align_t), 0ul);
+
+        // the elements of a bin are adjacent, regardless of interleaved allocations of other bins
+        std::vector<uint8_t *> first;
+        std::vector<uint8_t *> second;
+        for (int i = 0; i < 100; ++i) {
+            first.push_back(static_cast<uint8_t *>(allocator.allocate(40, 1)));
+            second.push_back(static_cast<uint8_t *>(allocator.allocate(40, 2)));
+        }
+        ASSERT_EQ(first[1] - first[0], static_cast<ptrdiff_t>(allocator.getElementSize()));
+        ASSERT_EQ(second[99] - second[98], static_cast<ptrdiff_t>(allocator.getElementSize()));
+
+        // released elements are reused
+        allocator.release(first[10]);
+        ASSERT_EQ(allocator.allocate(40, 1), first[10]);
+
+        void * oversized = allocator.allocate(1000, 1);
+        ASSERT_EQ(allocator.getStats().oversizedElements, 1ul);
+        allocator.release(oversized);
+
+        const size_t capacity = SlabAllocator::slabSize/allocator.getElementSize();
+        std::vector<void *> more;
+        for (size_t i = 0; i < 2*capacity; ++i) {
+            more.push_back(allocator.allocate(40, 3));
+        }
+        ASSERT_EQ(allocator.getStats().slabCount, 4ul);
+        // a drained slab which is not in use for allocations is returned
+        for (size_t i = 0; i < capacity; ++i) {
+            allocator.release(more[i]);
+        }
+        auto stats = allocator.getStats();
+        ASSERT_EQ(stats.slabCount, 3ul);
+        ASSERT_EQ(stats.liveElements, 200 + capacity);
+        ASSERT_EQ(stats.oversizedElements, 0ul);
+    }
+
+    TEST(StorageTest, BranchSetSpillsBeyondInlineBits) {
+        BranchSet first;
+        BranchSet second;
+        first.set(3);
+        second.set(BranchSet::inlineBits + 5);
+        ASSERT_EQ(first.getWordCount(), 1ul);
+        ASSERT_EQ(second.getWordCount(), 2ul);
+        ASSERT_FALSE(first.intersects(second));
+
+        first.set(BranchSet::inlineBits + 5);
+        ASSERT_TRUE(first.intersects(second));
+        ASSERT_TRUE(second.intersects(first));
+
+        second.set(300);
+        BranchSet copy(second);
+        ASSERT_TRUE(copy.test(300));
+        ASSERT_TRUE(copy.test(BranchSet::inlineBits + 5));
+        ASSERT_FALSE(copy.test(3));
+        copy.reset(300);
+        ASSERT_FALSE(copy.test(300));
+        ASSERT_TRUE(second.test(300));
+
+        BranchSet moved(std::move(second));
+        ASSERT_TRUE(moved.test(300));
+        ASSERT_EQ(second.getWordCount(), 1ul);
+        moved.clear();
+        ASSERT_FALSE(moved.intersects(first));
+    }
+
+    TEST(StorageTest, TidSetSwitchesContainers) {
+        TidSet set;
+        ASSERT_TRUE(set.insert(5));
+        ASSERT_FALSE(set.insert(5));
+        ASSERT_TRUE(set.insert(TidSet::containerCapacity + 70));
+        ASSERT_TRUE(set.contains(5));
+        ASSERT_FALSE(set.contains(6));
+        ASSERT_EQ(set.size(), 2ul);
+        ASSERT_EQ(set.getBitmapContainerCount(), 0ul);
+
+        // the words may span several containers
+        std::vector<uint64_t> words(4);
+        size_t firstWord = TidSet::containerWords - 2;
+        ASSERT_TRUE(set.getWords(firstWord, words.size(), words.data()));
+        ASSERT_EQ(words, (std::vector<uint64_t>{ 0, 0, 0, static_cast<uint64_t>(1) << 6 }));
+        ASSERT_FALSE(set.getWords(4, words.size(), words.data()));
+
+        // dense containers become bitmaps
+        for (size_t tid = 0; tid < 2*TidSet::arrayLimit; tid += 2) {
+            set.insert(tid);
+        }
+        ASSERT_EQ(set.getBitmapContainerCount(), 1ul);
+        ASSERT_EQ(set.size(), TidSet::arrayLimit + 2);
+        ASSERT_TRUE(set.contains(5));
+        ASSERT_TRUE(set.contains(2*TidSet::arrayLimit - 2));
+        ASSERT_FALSE(set.contains(2*TidSet::arrayLimit - 1));
+        ASSERT_TRUE(set.getWords(0, 1, words.data()));
+        ASSERT_EQ(words[0], 0x5555555555555575ul);
+
+        ASSERT_TRUE(set.erase(5));
+        ASSERT_FALSE(set.erase(5));
+        ASSERT_TRUE(set.erase(TidSet::containerCapacity + 70));
+        ASSERT_FALSE(set.contains(TidSet::containerCapacity + 70));
+        ASSERT_EQ(set.size(), TidSet::arrayLimit);
+    }
+
+    TEST(StorageTest, BitmapTableCloneColumn) {
+        BitmapTable bitmap;
+        bitmap.addColumn();
+
+        const size_t rowCount = (BitmapTable::wordBits << BitmapTable::wordChunkShift) + 100;
+        for (tid_t tid = 0; tid < rowCount; ++tid) {
+            bitmap.addRow();
+            bitmap.set(tid, 0, tid % 7 == 0);
+        }
+
+        unsigned clone = bitmap.cloneColumn(0);
+        bitmap.set(0, clone, false);
+        bitmap.addRow();
+
+        ASSERT_TRUE(bitmap.isSet(0, 0));
+        ASSERT_FALSE(bitmap.isSet(0, clone));
+        for (tid_t tid = 1; tid < rowCount; ++tid) {
+            ASSERT_EQ(bitmap.isSet(tid, clone), tid % 7 == 0);
+        }
+        ASSERT_FALSE(bitmap.isSet(rowCount, clone));
+    }
+
+    TEST(StorageTest, BranchCreationSharesVisibility) {
+        using namespace Native::Sql;
+        ModuleGen moduleGen("StorageTestModule");
+        Database db;
+        auto & table = db.createTable("t");
+        table.addColumn("a", Sql::getIntegerTy());
+
+        QueryContext ctx(db);
+        const size_t rowCount = (BitmapTable::wordBits << BitmapTable::wordChunkShift) + 100;
+        for (size_t i = 0; i < rowCount; ++i) {
+            std::vector<value_op_t> values;
+            values.push_back(std::make_unique<Integer>(static_cast<int32_t>(i)));
+            SqlTuple tuple(std::move(values));
+            insert_tuple(tuple, table, ctx);
+        }
+
+        // the branch refers to the visibility words of its parent until it deletes
+        branch_id_t b1 = db.createBranch("b1", master_branch_id);
+        BitmapTable & bitmap = table.getBranchBitmap();
+        const Vector & masterWords = bitmap.getColumn(master_branch_id);
+        const Vector & branchWords = bitmap.getColumn(b1);
+        ASSERT_EQ(branchWords.getChunk(0), masterWords.getChunk(0));
+        ASSERT_EQ(table.getModifiedTids(b1), table.getModifiedTids(db.createBranch("b2", b1)));
+
+        ctx.executionContext.branchId = b1;
+        db.constructBranchLineage(b1, ctx.executionContext);
+        delete_tuple(0, table, ctx);
+        ASSERT_NE(branchWords.getChunk(0), masterWords.getChunk(0));
+        ASSERT_EQ(branchWords.getChunk(1), masterWords.getChunk(1));
+        ASSERT_FALSE(bitmap.isSet(0, b1));
+        ASSERT_TRUE(bitmap.isSet(0, master_branch_id));
+        ASSERT_TRUE(bitmap.isSet(rowCount - 1, b1));
+    }
+
+    TEST(StorageTest, StringDictionaryDeduplicates) {
+        StringDictionary dictionary(Sql::getVarcharTy(20));
+
+        auto alice = dictionary.encode(std::string("alice"));
+        auto bob = dictionary.encode(std::string("bob"));
+        ASSERT_NE(alice, bob);
+        ASSERT_EQ(dictionary.encode(std::string("alice")), alice);
+        ASSERT_EQ(dictionary.size(), 2ul);
+
+        ASSERT_EQ(dictionary.lookup("bob"), bob);
+        ASSERT_EQ(dictionary.lookup("carol"), StringDictionary::invalid_code);
+
+        // the decoded value has the regular Varchar layout: { uint8_t length, char[20] }
+        auto decoded = static_cast<const uint8_t *>(dictionary.decode(bob));
+        ASSERT_EQ(decoded[0], 3);
+        ASSERT_EQ(std::memcmp(decoded + 1, "bob", 3), 0);
+
+        // encoding the stored representation yields the same code
+        ASSERT_EQ(dictionary.encode(dictionary.decode(alice)), alice);
+    }
+
+    TEST(StorageTest, StringPoolInternsAndReclaims) {
+        auto & pool = StringPool::instance();
+        auto isPooled = [&pool](const uint8_t * str) {
+            for (auto & [begin, size] : pool.getRanges()) {
+                if (str >= begin && str < begin + size) {
+                    return true;
+                }
+            }
+            return false;
+        };
+
+        // oversized, hence the string occupies a page of its own
+        std::string str(StringPool::pageSize/2, 'x');
+        str += "StringPoolInternsAndReclaims";
+        const uint8_t * bytes = reinterpret_cast<const uint8_t *>(str.data());
+        const uint8_t * stored = pool.put(bytes, str.size());
+        ASSERT_EQ(pool.put(bytes, str.size()), stored);
+        ASSERT_EQ(std::memcmp(stored, bytes, str.size()), 0);
+
+        // strings handed out during the current epoch survive the first collection without any reference
+        pool.collect();
+        ASSERT_TRUE(isPooled(stored));
+
+        // an out-of-line Text value referencing the string keeps it alive
+        uintptr_t text[2] = {
+            reinterpret_cast<uintptr_t>(stored) | (static_cast<uintptr_t>(1) << 63),
+            reinterpret_cast<uintptr_t>(stored + str.size())
+        };
+        pool.addRoot(&text, [&text](StringPool::Marker & marker) {
+            marker.markText(text);
+        });
+        pool.collect();
+        ASSERT_TRUE(isPooled(stored));
+
+        pool.removeRoot(&text);
+        pool.collect();
+        ASSERT_FALSE(isPooled(stored));
+
+        const uint8_t * restored = pool.put(bytes, str.size());
+        ASSERT_EQ(std::memcmp(restored, bytes, str.size()), 0);
+    }
+
+    TEST(StorageTest, PackedIntegerColumnRoundTrip) {
+        PackedIntegerColumn column(Sql::getIntegerTy());
+
+        const size_t count = 2*PackedIntegerColumn::blockCapacity + 100;
+        std::vector<int64_t> expected;
+        for (size_t i = 0; i < count; ++i) {
+            int64_t value = 1000 + static_cast<int64_t>(i % 100);
+            column.push_back(value);
+            expected.push_back(value);
+        }
+
+        // completed blocks are packed with the minimal bit width
+        ASSERT_EQ(column.getBlock(0).reference, 1000);
+        ASSERT_EQ(column.getBlock(0).bitWidth, 7u);
+        ASSERT_EQ(column.getBlock(2).bitWidth, PackedIntegerColumn::wordBits);
+
+        // values outside of a block's range widen the block
+        column.set(1, -5);
+        expected[1] = -5;
+        column.remove_at(3);
+        expected.erase(expected.begin() + 3);
+
+        ASSERT_EQ(column.size(), expected.size());
+        std::vector<int32_t> unpacked(PackedIntegerColumn::blockCapacity);
+        for (size_t block = 0; block < column.getBlockCount(); ++block) {
+            column.unpack(block, unpacked.data());
+            for (size_t i = 0; i < column.getBlockSize(block); ++i) {
+                size_t row = (block << PackedIntegerColumn::blockShift) + i;
+                ASSERT_EQ(column.get(row), expected[row]);
+                ASSERT_EQ(unpacked[i], expected[row]);
+            }
+        }
+    }
+
+    TEST(StorageTest, ZoneMapBoundsPerBlock) {
+        using Sql::ComparisonMode;
+        ZoneMap zoneMap(Sql::getIntegerTy());
+
+        const int64_t capacity = static_cast<int64_t>(ZoneMap::zoneCapacity);
+        const int64_t count = capacity + 10;
+        for (int64_t row = 0; row < count; ++row) {
+            zoneMap.addRow();
+            zoneMap.include(row, row);
+        }
+
+        ASSERT_EQ(zoneMap.getZoneCount(), 2ul);
+        ASSERT_EQ(zoneMap.getZone(0).min, 0);
+        ASSERT_EQ(zoneMap.getZone(0).max, capacity - 1);
+        ASSERT_EQ(zoneMap.getZone(0).rowCount, ZoneMap::zoneCapacity);
+        ASSERT_EQ(zoneMap.getZone(1).min, capacity);
+        ASSERT_EQ(zoneMap.getZone(1).max, count - 1);
+        ASSERT_EQ(zoneMap.getZone(1).rowCount, 10ul);
+
+        // overwriting a value only widens the bounds
+        zoneMap.include(1, -5);
+        ASSERT_EQ(zoneMap.getZone(0).min, -5);
+        ASSERT_EQ(zoneMap.getZone(0).max, capacity - 1);
+
+        // 32 bit values are compared sign-extended
+        int32_t negative = -42;
+        ASSERT_EQ(zoneMap.toKey(&negative), -42);
+
+        const ZoneMap::Zone & second = zoneMap.getZone(1);
+        ASSERT_FALSE(ZoneMap::mayMatch(second, ComparisonMode::eq, capacity - 1));
+        ASSERT_TRUE(ZoneMap::mayMatch(second, ComparisonMode::eq, capacity + 3));
+        ASSERT_FALSE(ZoneMap::mayMatch(second, ComparisonMode::less, capacity));
+        ASSERT_TRUE(ZoneMap::mayMatch(second, ComparisonMode::leq, capacity));
+        ASSERT_FALSE(ZoneMap::mayMatch(second, ComparisonMode::gtr, count - 1));
+        ASSERT_TRUE(ZoneMap::mayMatch(second, ComparisonMode::geq, count - 1));
+
+        // empty zones do not match anything
+        zoneMap.reset(1);
+        ASSERT_FALSE(ZoneMap::mayMatch(zoneMap.getZone(1), ComparisonMode::geq, 0));
+
+        for (int i = 0; i < 10; ++i) {
+            zoneMap.removeRow();
+        }
+        ASSERT_EQ(zoneMap.getZoneCount(), 1ul);
+        ASSERT_EQ(zoneMap.size(), ZoneMap::zoneCapacity);
+    }
+
+    TEST(StorageTest, CompactionReclaimsTombstones) {
+        using namespace Native::Sql;
+        ModuleGen moduleGen("StorageTestModule");
+        Database db;
+        auto & table = db.createTable("t");
+        table.addColumn("a", Sql::getIntegerTy());
+        table.addColumn("b", Sql::getTextTy());
+
+        QueryContext ctx(db);
+        for (int32_t i = 0; i < 10; ++i) {
+            std::vector<value_op_t> values;
+            values.push_back(std::make_unique<Integer>(i));
+            values.push_back(Text::castString("a value which is too long to be stored inline " + std::to_string(i)));
+            SqlTuple tuple(std::move(values));
+            insert_tuple(tuple, table, ctx);
+        }
+
+        // deleting a row twice does not leave a second tombstone behind
+        for (tid_t tid : { 1, 4, 9, 4 }) {
+            delete_tuple(tid, table, ctx);
+        }
+        ASSERT_EQ(table.getDeadRowCount(), 3ul);
+        ASSERT_EQ(table.size(), 10ul);
+
+        // the last row is dead itself, the live row 8 fills hole 1
+        ASSERT_EQ(table.compact(2), 2ul);
+        ASSERT_EQ(table.getDeadRowCount(), 1ul);
+        ASSERT_EQ(table.size(), 8ul);
+        ASSERT_EQ(table.compact(), 1ul);
+        ASSERT_EQ(table.getDeadRowCount(), 0ul);
+        ASSERT_EQ(table.size(), 7ul);
+
+        std::vector<int32_t> remaining;
+        for (tid_t tid = 0; tid < table.size(); ++tid) {
+            auto row = get_current_master(tid, table);
+            int32_t a = static_cast<const Integer &>(*row->values[0]).value;
+            ASSERT_EQ(toString(*row->values[1]), "a value which is too long to be stored inline " + std::to_string(a));
+            remaining.push_back(a);
+        }
+        std::sort(remaining.begin(), remaining.end());
+        ASSERT_EQ(remaining, (std::vector<int32_t>{ 0, 2, 3, 5, 6, 7, 8 }));
+    }
+
+    TEST(StorageTest, VersionCollectionBoundsChains) {
+        using namespace Native::Sql;
+        ModuleGen moduleGen("StorageTestModule");
+        Database db;
+        auto & table = db.createTable("t");
+        table.addColumn("a", Sql::getIntegerTy());
+
+        auto makeTuple = [](int32_t a) {
+            std::vector<value_op_t> values;
+            values.push_back(std::make_unique<Integer>(a));
+            return SqlTuple(std::move(values));
+        };
+        auto chainLength = [&table]() {
+            VersionEntry * versionEntry = get_version_entry(0, table);
+            size_t length = 0;
+            for (const void * next = versionEntry->first; next != nullptr; length += 1) {
+                next = (next == versionEntry) ? versionEntry->next
+                        : static_cast<const VersionedTupleStorage *>(next)->next;
+            }
+            return length;
+        };
+        auto readA = [&table, &db](QueryContext & ctx, branch_id_t branch) {
+            ctx.executionContext.branchId = branch;
+            db.constructBranchLineage(branch, ctx.executionContext);
+            auto tuple = get_latest_tuple(0, table, ctx);
+            return static_cast<const Integer &>(*tuple->values[0]).value;
+        };
+
+        QueryContext ctx(db);
+        auto tuple = makeTuple(0);
+        insert_tuple(tuple, table, ctx);
+
+        branch_id_t b1 = db.createBranch("b1", master_branch_id);
+        ctx.executionContext.branchId = b1;
+        db.constructBranchLineage(b1, ctx.executionContext);
+        for (int32_t i = 1; i <= 100; ++i) {
+            auto updated = makeTuple(i);
+            update_tuple(0, updated, table, ctx);
+        }
+        ASSERT_EQ(chainLength(), 101ul);
+        ASSERT_EQ(db.collectVersions(), 99ul);
+        ASSERT_EQ(chainLength(), 2ul);
+        ASSERT_EQ(readA(ctx, b1), 100);
+        ASSERT_EQ(readA(ctx, master_branch_id), 0);
+
+        // the version of b1 at the time b2 forked off stays observable
+        branch_id_t b2 = db.createBranch("b2", b1);
+        ctx.executionContext.branchId = b1;
+        db.constructBranchLineage(b1, ctx.executionContext);
+        for (int32_t i = 101; i <= 110; ++i) {
+            auto updated = makeTuple(i);
+            update_tuple(0, updated, table, ctx);
+        }
+        ASSERT_EQ(db.collectVersions(), 9ul);
+        ASSERT_EQ(chainLength(), 3ul);
+        ASSERT_EQ(readA(ctx, b1), 110);
+        ASSERT_EQ(readA(ctx, b2), 100);
+        ASSERT_EQ(db.collectVersions(), 0ul);
+
+        // the freed versions have been returned to the slabs of the table
+        auto stats = table.getVersionAllocatorStats();
+        ASSERT_EQ(stats.allocations, 110ul);
+        ASSERT_EQ(stats.releases, 108ul);
+        ASSERT_EQ(stats.liveElements, 2ul);
+        ASSERT_EQ(stats.oversizedElements, 0ul);
+    }
+
+    TEST(StorageTest, DropBranchFreesItsVersions) {
+        using namespace Native::Sql;
+        ModuleGen moduleGen("StorageTestModule");
+        Database db;
+        auto & table = db.createTable("t");
+        table.addColumn("a", Sql::getIntegerTy());
+
+        auto makeTuple = [](int32_t a) {
+            std::vector<value_op_t> values;
+            values.push_back(std::make_unique<Integer>(a));
+            return SqlTuple(std::move(values));
+        };
+        auto readA = [&table, &db](QueryContext & ctx, branch_id_t branch) {
+            ctx.executionContext.branchId = branch;
+            db.constructBranchLineage(branch, ctx.executionContext);
+            auto tuple = get_latest_tuple(0, table, ctx);
+            return static_cast<const Integer &>(*tuple->values[0]).value;
+        };
+
+        QueryContext ctx(db);
+        auto tuple = makeTuple(0);
+        insert_tuple(tuple, table, ctx);
+
+        branch_id_t b1 = db.createBranch("b1", master_branch_id);
+        ctx.executionContext.branchId = b1;
+        db.constructBranchLineage(b1, ctx.executionContext);
+        for (int32_t i = 1; i <= 2; ++i) {
+            auto updated = makeTuple(i);
+            update_tuple(0, updated, table, ctx);
+        }
+        auto inserted = makeTuple(10);
+        insert_tuple(inserted, table, ctx);
+        ASSERT_EQ(table.getVersionAllocatorStats().liveElements, 2ul);
+
+        // only leaf branches can be dropped
+        branch_id_t b2 = db.createBranch("b2", b1);
+        ASSERT_THROW(db.dropBranch(b1), InvalidOperationException);
+        ASSERT_THROW(db.dropBranch(master_branch_id), InvalidOperationException);
+        ASSERT_EQ(db.dropBranch(b2), 0ul);
+
+        ASSERT_EQ(db.dropBranch(b1), 2ul);
+        ASSERT_EQ(table.getVersionAllocatorStats().liveElements, 0ul);
+        ASSERT_TRUE(table.getBranchBitmap().isReleased(b1));
+        ASSERT_EQ(db._branchMapping.count("b1"), 0ul);
+        ASSERT_EQ(readA(ctx, master_branch_id), 0);
+
+        // the tuple inserted by the branch has become a tombstone
+        ASSERT_EQ(table.getDeadRowCount(), 1ul);
+        ASSERT_EQ(table.compact(), 1ul);
+        ASSERT_EQ(table.size(), 1ul);
+
+        // the ids of dropped branches are not reused
+        branch_id_t b3 = db.createBranch("b3", master_branch_id);
+        ASSERT_EQ(b3, b2 + 1);
+        ctx.executionContext.branchId = b3;
+        db.constructBranchLineage(b3, ctx.executionContext);
+        auto updated = makeTuple(3);
+        update_tuple(0, updated, table, ctx);
+        ASSERT_EQ(readA(ctx, b3), 3);
+        ASSERT_EQ(readA(ctx, master_branch_id), 0);
+        ASSERT_EQ(db.createTable("u").getBranchBitmap().getColumnCount(), b3 + 1);
+    }
+
+    TEST(StorageTest, DeltaVersionsHoldChangedColumns) {
+        using namespace Native::Sql;
+        ModuleGen moduleGen("StorageTestModule");
+        Database db;
+        auto & table = db.createTable("t");
+        const size_t columnCount = 16;
+        for (size_t i = 0; i < columnCount; ++i) {
+            table.addColumn("c" + std::to_string(i), Sql::getIntegerTy());
+        }
+
+        auto read = [&table, &db](QueryContext & ctx, branch_id_t branch) {
+            ctx.executionContext.branchId = branch;
+            db.constructBranchLineage(branch, ctx.executionContext);
+            auto tuple = get_latest_tuple(0, table, ctx);
+            std::vector<int32_t> values;
+            for (auto & value : tuple->values) {
+                values.push_back(static_cast<const Integer &>(*value).value);
+            }
+            return values;
+        };
+        auto update = [&](QueryContext & ctx, branch_id_t branch, size_t column, int32_t value) {
+            auto values = read(ctx, branch);
+            values[column] = value;
+            std::vector<value_op_t> tupleValues;
+            for (int32_t v : values) {
+                tupleValues.push_back(std::make_unique<Integer>(v));
+            }
+            SqlTuple tuple(std::move(tupleValues));
+            update_tuple(0, tuple, table, ctx);
+        };
+
+        QueryContext ctx(db);
+        std::vector<int32_t> original;
+        std::vector<value_op_t> values;
+        for (size_t i = 0; i < columnCount; ++i) {
+            original.push_back(static_cast<int32_t>(i));
+            values.push_back(std::make_unique<Integer>(static_cast<int32_t>(i)));
+        }
+        SqlTuple tuple(std::move(values));
+        insert_tuple(tuple, table, ctx);
+
+        // a narrow branch update only stores the changed column
+        branch_id_t b1 = db.createBranch("b1", master_branch_id);
+        update(ctx, b1, 3, 300);
+        auto stats = table.getVersionAllocatorStats();
+        ASSERT_EQ(stats.elementSize, 48ul);
+        ASSERT_LT(stats.elementSize, sizeof(VersionedTupleStorage) + columnCount*sizeof(int32_t));
+
+        std::vector<int32_t> expected = original;
+        expected[3] = 300;
+        ASSERT_EQ(read(ctx, b1), expected);
+        ASSERT_EQ(read(ctx, master_branch_id), original);
+
+        // the unchanged columns of b1 still resolve to the master row as of the time b1 has been updated
+        update(ctx, master_branch_id, 5, 500);
+        ASSERT_EQ(read(ctx, b1), expected);
+        std::vector<int32_t> master = original;
+        master[5] = 500;
+        ASSERT_EQ(read(ctx, master_branch_id), master);
+
+        // the values of a superseded version are taken over, hence it can be freed
+        update(ctx, b1, 7, 700);
+        ASSERT_EQ(db.collectVersions(), 1ul);
+        expected[7] = 700;
+        ASSERT_EQ(read(ctx, b1), expected);
+        ASSERT_EQ(read(ctx, master_branch_id), master);
+
+        // copies of the master row only hold the changed columns, the values of freed copies are taken over
+        update(ctx, master_branch_id, 9, 900);
+        update(ctx, master_branch_id, 11, 1100);
+        master[9] = 900;
+        master[11] = 1100;
+        branch_id_t b2 = db.createBranch("b2", master_branch_id);
+        std::vector<int32_t> forked = master;
+        update(ctx, master_branch_id, 13, 1300);
+        master[13] = 1300;
+        ASSERT_EQ(db.collectVersions(), 2ul);
+        ASSERT_EQ(read(ctx, b2), forked);
+        ASSERT_EQ(read(ctx, b1), expected);
+        ASSERT_EQ(read(ctx, master_branch_id), master);
+        ASSERT_EQ(db.collectVersions(), 0ul);
+    }
+
+    TEST(StorageTest, BranchLineageCutoffs) {
+        ModuleGen moduleGen("StorageTestModule");
+        Database db;
+        branch_id_t b1 = db.createBranch("b1", master_branch_id);
+        branch_id_t b2 = db.createBranch("b2", master_branch_id);
+        branch_id_t b3 = db.createBranch("b3", b1);
+
+        QueryContext ctx(db);
+        db.constructBranchLineage(b3, ctx.executionContext);
+        const BranchLineage & lineage = *ctx.executionContext.branch_lineage;
+        ASSERT_EQ(lineage.branch, b3);
+        ASSERT_EQ(lineage.cutoffs.size(), 4ul);
+
+        // versions of the ancestors are visible if they predate the fork
+        ASSERT_TRUE(lineage.isVisible(master_branch_id, 0));
+        ASSERT_FALSE(lineage.isVisible(master_branch_id, b1));
+        ASSERT_TRUE(lineage.isVisible(b1, b2));
+        ASSERT_FALSE(lineage.isVisible(b1, b3));
+        ASSERT_TRUE(lineage.isVisible(b3, b3));
+        ASSERT_FALSE(lineage.isVisible(b2, 0));
+
+        // branches which have been created afterwards are no ancestors
+        branch_id_t b4 = db.createBranch("b4", b3);
+        ASSERT_FALSE(lineage.isVisible(b4, b4));
+        ASSERT_TRUE(lineage.branches.test(b1));
+        ASSERT_FALSE(lineage.branches.test(b2));
+        ASSERT_EQ(lineage.ancestors, (std::vector<branch_id_t>{ b3, b1, master_branch_id }));
+    }
+
+    TEST(StorageTest, ModifiedTidsFollowBranchWrites) {
+        using namespace Native::Sql;
+        ModuleGen moduleGen("StorageTestModule");
+        Database db;
+        auto & table = db.createTable("t");
+        table.addColumn("a", Sql::getIntegerTy());
+
+        auto update = [&](branch_id_t branch, tid_t tid, int32_t a) {
+            QueryContext ctx(db);
+            ctx.executionContext.branchId = branch;
+            db.constructBranchLineage(branch, ctx.executionContext);
+            std::vector<value_op_t> values;
+            values.push_back(std::make_unique<Integer>(a));
+            SqlTuple tuple(std::move(values));
+            update_tuple(tid, tuple, table, ctx);
+        };
+
+        QueryContext ctx(db);
+        for (int32_t i = 0; i < 4; ++i) {
+            std::vector<value_op_t> values;
+            values.push_back(std::make_unique<Integer>(i));
+            SqlTuple tuple(std::move(values));
+            insert_tuple(tuple, table, ctx);
+        }
+        ASSERT_EQ(table.getModifiedTids(master_branch_id), nullptr);
+
+        // a new branch inherits the modified tuples of its parent
+        branch_id_t b1 = db.createBranch("b1", master_branch_id);
+        update(b1, 1, 10);
+        branch_id_t b2 = db.createBranch("b2", b1);
+        branch_id_t b3 = db.createBranch("b3", master_branch_id);
+        ASSERT_TRUE(table.getModifiedTids(b1)->contains(1));
+        ASSERT_TRUE(table.getModifiedTids(b2)->contains(1));
+        ASSERT_TRUE(table.getModifiedTids(b3)->empty());
+
+        // the branches of a branch do not see its later versions
+        update(b1, 3, 30);
+        ASSERT_TRUE(table.getModifiedTids(b1)->contains(3));
+        ASSERT_FALSE(table.getModifiedTids(b2)->contains(3));
+
+        // a version of master hides the master row of all branches
+        update(master_branch_id, 2, 20);
+        for (branch_id_t branch : { b1, b2, b3 }) {
+            ASSERT_TRUE(table.getModifiedTids(branch)->contains(2));
+        }
+        ASSERT_EQ(table.getModifiedTids(b1)->size(), 3ul);
+        ASSERT_EQ(table.getModifiedTids(b3)->size(), 1ul);
+    }
+
+    TEST(StorageTest, BranchHeadsResolveLatestVersions) {
+        using namespace Native::Sql;
+        ModuleGen moduleGen("StorageTestModule");
+        Database db;
+        auto & table = db.createTable("t");
+        table.addColumn("a", Sql::getIntegerTy());
+
+        auto makeTuple = [](int32_t a) {
+            std::vector<value_op_t> values;
+            values.push_back(std::make_unique<Integer>(a));
+            return SqlTuple(std::move(values));
+        };
+        auto update = [&](branch_id_t branch, int32_t a) {
+            QueryContext ctx(db);
+            ctx.executionContext.branchId = branch;
+            db.constructBranchLineage(branch, ctx.executionContext);
+            auto tuple = makeTuple(a);
+            update_tuple(0, tuple, table, ctx);
+        };
+        auto readA = [&](branch_id_t branch) {
+            QueryContext ctx(db);
+            ctx.executionContext.branchId = branch;
+            db.constructBranchLineage(branch, ctx.executionContext);
+            auto tuple = get_latest_tuple(0, table, ctx);
+            return static_cast<const Integer &>(*tuple->values[0]).value;
+        };
+
+        QueryContext ctx(db);
+        auto tuple = makeTuple(0);
+        insert_tuple(tuple, table, ctx);
+        VersionEntry * versionEntry = get_version_entry(0, table);
+
+        // more writers than inline slots
+        std::vector<branch_id_t> branches;
+        for (unsigned i = 0; i <= BranchHeads::inlineCount; ++i) {
+            branches.push_back(db.createBranch("b" + std::to_string(i), master_branch_id));
+        }
+        for (int32_t round = 1; round <= 10; ++round) {
+            for (size_t i = 1; i < branches.size(); ++i) {
+                update(branches[i], round*100 + static_cast<int32_t>(i));
+            }
+        }
+        for (size_t i = 1; i < branches.size(); ++i) {
+            auto head = static_cast<const VersionedTupleStorage *>(versionEntry->heads.get(branches[i]));
+            ASSERT_NE(head, nullptr);
+            ASSERT_EQ(head->branch_id, branches[i]);
+            ASSERT_EQ(readA(branches[i]), 1000 + static_cast<int32_t>(i));
+        }
+        ASSERT_EQ(versionEntry->heads.get(branches[0]), nullptr);
+        ASSERT_EQ(readA(branches[0]), 0);
+
+        // the branch sees the master version which it has forked off from
+        update(master_branch_id, -1);
+        ASSERT_EQ(versionEntry->heads.get(master_branch_id), nullptr);
+        ASSERT_EQ(readA(master_branch_id), -1);
+        ASSERT_EQ(readA(branches[0]), 0);
+        update(branches[0], 7);
+        ASSERT_EQ(versionEntry->heads.get(branches[0]), versionEntry->first);
+        ASSERT_EQ(readA(branches[0]), 7);
+
+        // a child sees the version of its parent at the time of the fork, not the parent's newer ones
+        branch_id_t child = db.createBranch("child", branches[1]);
+        update(branches[1], 5000);
+        ASSERT_EQ(readA(child), 1001);
+        ASSERT_EQ(readA(branches[1]), 5000);
+
+        std::vector<const void *> heads;
+        for (branch_id_t branch : branches) {
+            heads.push_back(versionEntry->heads.get(branch));
+        }
+        rebuild_branch_heads(versionEntry);
+        for (size_t i = 0; i < branches.size(); ++i) {
+            ASSERT_EQ(versionEntry->heads.get(branches[i]), heads[i]);
+        }
+        ASSERT_EQ(versionEntry->heads.get(child), nullptr);
+    }
+
+    TEST(StorageTest, MergeBranchIntoParent) {
+        using namespace Native::Sql;
+        ModuleGen moduleGen("StorageTestModule");
+        Database db;
+        auto & table = db.createTable("t");
+        table.addColumn("a", Sql::getIntegerTy());
+
+        auto makeTuple = [](int32_t a) {
+            std::vector<value_op_t> values;
+            values.push_back(std::make_unique<Integer>(a));
+            return SqlTuple(std::move(values));
+        };
+        auto useBranch = [&db](QueryContext & ctx, branch_id_t branch) {
+            ctx.executionContext.branchId = branch;
+            db.constructBranchLineage(branch, ctx.executionContext);
+        };
+        auto readA = [&](QueryContext & ctx, branch_id_t branch, tid_t tid) {
+            useBranch(ctx, branch);
+            auto tuple = get_latest_tuple(tid, table, ctx);
+            return static_cast<const Integer &>(*tuple->values[0]).value;
+        };
+
+        QueryContext ctx(db);
+        for (int32_t i = 0; i < 3; ++i) {
+            auto tuple = makeTuple(i);
+            insert_tuple(tuple, table, ctx);
+        }
+
+        branch_id_t b1 = db.createBranch("b1", master_branch_id);
+        useBranch(ctx, b1);
+        auto merged = makeTuple(10);
+        update_tuple(0, merged, table, ctx);
+        auto conflicting = makeTuple(11);
+        update_tuple(1, conflicting, table, ctx);
+        auto inserted = makeTuple(3);
+        tid_t insertedTid = insert_tuple(inserted, table, ctx);
+
+        // tuple 1 has been modified on both sides
+        useBranch(ctx, master_branch_id);
+        auto kept = makeTuple(21);
+        update_tuple(1, kept, table, ctx);
+        ASSERT_FALSE(is_visible(insertedTid, table, ctx));
+
+        BranchMergeResult result = db.mergeBranch(b1, master_branch_id);
+        ASSERT_EQ(result.mergedCount, 2ul);
+        ASSERT_EQ(result.conflicts.size(), 1ul);
+        ASSERT_EQ(result.conflicts[0].first, &table);
+        ASSERT_EQ(result.conflicts[0].second, 1ul);
+
+        ASSERT_EQ(readA(ctx, master_branch_id, 0), 10);
+        ASSERT_EQ(readA(ctx, master_branch_id, 1), 21);
+        ASSERT_EQ(readA(ctx, master_branch_id, 2), 2);
+        ASSERT_TRUE(is_visible(insertedTid, table, ctx));
+        ASSERT_EQ(readA(ctx, master_branch_id, insertedTid), 3);
+        ASSERT_EQ(readA(ctx, b1, 0), 10);
+        ASSERT_EQ(readA(ctx, b1, 1), 11);
+        ASSERT_EQ(readA(ctx, b1, insertedTid), 3);
+
+        // the merged tuples are recognized, only the conflict remains
+        result = db.mergeBranch(b1, master_branch_id);
+        ASSERT_EQ(result.mergedCount, 0ul);
+        ASSERT_EQ(result.conflicts.size(), 1ul);
+        ASSERT_EQ(result.conflicts[0].second, 1ul);
+
+        ASSERT_THROW(db.mergeBranch(master_branch_id, b1), InvalidOperationException);
+    }
+
+    TEST(StorageTest, DiffBranchesComparesVisibleVersions) {
+        using namespace Native::Sql;
+        ModuleGen moduleGen("StorageTestModule");
+        Database db;
+        auto & table = db.createTable("t");
+        table.addColumn("a", Sql::getIntegerTy());
+
+        auto makeTuple = [](int32_t a) {
+            std::vector<value_op_t> values;
+            values.push_back(std::make_unique<Integer>(a));
+            return SqlTuple(std::move(values));
+        };
+        auto useBranch = [&db](QueryContext & ctx, branch_id_t branch) {
+            ctx.executionContext.branchId = branch;
+            db.constructBranchLineage(branch, ctx.executionContext);
+        };
+
+        QueryContext ctx(db);
+        for (int32_t i = 0; i < 4; ++i) {
+            auto tuple = makeTuple(i);
+            insert_tuple(tuple, table, ctx);
+        }
+        branch_id_t b1 = db.createBranch("b1", master_branch_id);
+        branch_id_t b2 = db.createBranch("b2", master_branch_id);
+
+        // distinct versions with equal values do not differ
+        useBranch(ctx, b1);
+        auto same = makeTuple(10);
+        update_tuple(0, same, table, ctx);
+        useBranch(ctx, b2);
+        update_tuple(0, same, table, ctx);
+        auto changed = makeTuple(11);
+        update_tuple(1, changed, table, ctx);
+        delete_tuple(2, table, ctx);
+        auto inserted = makeTuple(4);
+        tid_t insertedTid = insert_tuple(inserted, table, ctx);
+
+        // both branches have forked off before this version
+        useBranch(ctx, master_branch_id);
+        auto masterUpdate = makeTuple(33);
+        update_tuple(3, masterUpdate, table, ctx);
+
+        ASSERT_EQ(diff_branches(table, b1, b2), std::vector<tid_t>({ 1, insertedTid }));
+        ASSERT_EQ(diff_branches(table, b2, b1), std::vector<tid_t>({ 1, 2 }));
+        ASSERT_EQ(diff_branches(table, master_branch_id, b1), std::vector<tid_t>({ 0, 3 }));
+        ASSERT_TRUE(diff_branches(table, b1, b1).empty());
+    }
+
+    TEST(StorageTest, MaterializedBranchSharesUnchangedChunks) {
+        using namespace Native::Sql;
+        ModuleGen moduleGen("StorageTestModule");
+        Database db;
+        auto & table = db.createTable("t");
+        table.addColumn("a", Sql::getIntegerTy());
+        table.addColumn("b", Sql::getIntegerTy());
+
+        auto makeTuple = [](int32_t a, int32_t b) {
+            std::vector<value_op_t> values;
+            values.push_back(std::make_unique<Integer>(a));
+            values.push_back(std::make_unique<Integer>(b));
+            return SqlTuple(std::move(values));
+        };
+        auto valueAt = [](const MaterializedBranch & materialized, size_t column, tid_t tid) {
+            return *static_cast<const int32_t *>(materialized.columns[column]->column->at(tid));
+        };
+
+        QueryContext ctx(db);
+        for (int32_t i = 0; i < 3; ++i) {
+            auto tuple = makeTuple(i, 100 + i);
+            insert_tuple(tuple, table, ctx);
+        }
+
+        branch_id_t b1 = db.createBranch("b1", master_branch_id);
+        ctx.executionContext.branchId = b1;
+        db.constructBranchLineage(b1, ctx.executionContext);
+        auto updated = makeTuple(10, 100);
+        update_tuple(0, updated, table, ctx);
+
+        ASSERT_EQ(table.getMaterializedBranch(b1), nullptr);
+        db.materializeBranch(b1);
+        auto materialized = table.getMaterializedBranch(b1);
+        ASSERT_NE(materialized, nullptr);
+        ASSERT_EQ(materialized->rowCount, 3ul);
+        ASSERT_EQ(valueAt(*materialized, 0, 0), 10);
+        ASSERT_EQ(valueAt(*materialized, 0, 1), 1);
+        ASSERT_EQ(valueAt(*materialized, 1, 0), 100);
+
+        // only the changed column has been copied
+        ASSERT_NE(materialized->columns[0]->column->getChunk(0), table.getColumn(0).getChunk(0));
+        ASSERT_EQ(materialized->columns[1]->column->getChunk(0), table.getColumn(1).getChunk(0));
+
+        // master writes are applied to the copy, which keeps the values from before the fork in a private chunk
+        ctx.executionContext.branchId = master_branch_id;
+        db.constructBranchLineage(master_branch_id, ctx.executionContext);
+        auto masterUpdate = makeTuple(21, 121);
+        update_tuple(1, masterUpdate, table, ctx);
+        ASSERT_FALSE(materialized->stale);
+        ASSERT_EQ(table.getMaterializedBranch(b1), materialized);
+        ASSERT_EQ(valueAt(*materialized, 0, 1), 1);
+        ASSERT_EQ(valueAt(*materialized, 1, 1), 101);
+        ASSERT_EQ(valueAt(*materialized, 0, 0), 10);
+        ASSERT_NE(materialized->columns[1]->column->getChunk(0), table.getColumn(1).getChunk(0));
+
+        // writes to the branch patch the written tuple, inserts extend the copy
+        ctx.executionContext.branchId = b1;
+        db.constructBranchLineage(b1, ctx.executionContext);
+        auto branchUpdate = makeTuple(12, 102);
+        update_tuple(2, branchUpdate, table, ctx);
+        auto inserted = makeTuple(3, 103);
+        insert_tuple(inserted, table, ctx);
+        ASSERT_EQ(materialized->rowCount, 4ul);
+        ASSERT_EQ(valueAt(*materialized, 0, 2), 12);
+        ASSERT_EQ(valueAt(*materialized, 0, 3), 3);
+        ASSERT_EQ(valueAt(*materialized, 1, 3), 103);
+
+        // writes to other branches leave the copy alone
+        branch_id_t b2 = db.createBranch("b2", master_branch_id);
+        ctx.executionContext.branchId = b2;
+        db.constructBranchLineage(b2, ctx.executionContext);
+        auto siblingUpdate = makeTuple(30, 130);
+        update_tuple(1, siblingUpdate, table, ctx);
+        ASSERT_EQ(valueAt(*materialized, 0, 1), 1);
+
+        // stale copies are rebuilt, the copy which has been handed out before is left intact
+        table.invalidateMaterializedBranches();
+        ASSERT_TRUE(materialized->stale);
+        auto rebuilt = table.getMaterializedBranch(b1);
+        ASSERT_NE(rebuilt, materialized);
+        ASSERT_FALSE(rebuilt->stale);
+        ASSERT_EQ(valueAt(*rebuilt, 0, 1), 1);
+        ASSERT_EQ(valueAt(*rebuilt, 0, 2), 12);
+        ASSERT_EQ(valueAt(*materialized, 0, 0), 10);
+
+        ASSERT_THROW(db.materializeBranch(master_branch_id), InvalidOperationException);
+    }
+
+    TEST(StorageTest, PageVersionedBranchesShareColumns) {
+        using namespace Native::Sql;
+        ModuleGen moduleGen("StorageTestModule");
+        Database db;
+        db.setDefaultVersioningEngine(Table::VersioningEngine::Pages);
+        auto & table = db.createTable("t");
+        table.addColumn("a", Sql::getIntegerTy());
+        table.addColumn("b", Sql::getIntegerTy());
+        ASSERT_THROW(table.addColumn("c", Sql::getIntegerTy(), ColumnInformation::Encoding::BitPacked), InvalidOperationException);
+
+        auto makeTuple = [](int32_t a, int32_t b) {
+            std::vector<value_op_t> values;
+            values.push_back(std::make_unique<Integer>(a));
+            values.push_back(std::make_unique<Integer>(b));
+            return SqlTuple(std::move(values));
+        };
+        auto readA = [&](QueryContext & ctx, branch_id_t branch, tid_t tid) {
+            ctx.executionContext.branchId = branch;
+            auto tuple = get_latest_tuple(tid, table, ctx);
+            return static_cast<const Integer &>(*tuple->values[0]).value;
+        };
+
+        QueryContext ctx(db);
+        for (int32_t i = 0; i < 3; ++i) {
+            auto tuple = makeTuple(i, 100 + i);
+            insert_tuple(tuple, table, ctx);
+        }
+        ASSERT_THROW(table.setVersioningEngine(Table::VersioningEngine::Chains), InvalidOperationException);
+
+        // the branch reads the chunks of master until it writes them
+        branch_id_t b1 = db.createBranch("b1", master_branch_id);
+        auto columns = table.getBranchColumns(b1);
+        ASSERT_NE(columns, nullptr);
+        ASSERT_EQ(table.getBranchColumns(master_branch_id), nullptr);
+        const Vector & branchA = *(*columns)[0]->column;
+        ASSERT_EQ(branchA.getChunk(0), table.getColumn(0).getChunk(0));
+
+        ctx.executionContext.branchId = b1;
+        auto updated = makeTuple(10, 100);
+        update_tuple(0, updated, table, ctx);
+        auto inserted = makeTuple(3, 103);
+        tid_t insertedTid = insert_tuple(inserted, table, ctx);
+        ASSERT_NE(branchA.getChunk(0), table.getColumn(0).getChunk(0));
+        ASSERT_EQ(table._version_mgmt_column.size(), 0ul);
+
+        ctx.executionContext.branchId = master_branch_id;
+        auto masterUpdate = makeTuple(21, 121);
+        update_tuple(1, masterUpdate, table, ctx);
+
+        ASSERT_EQ(readA(ctx, master_branch_id, 0), 0);
+        ASSERT_EQ(readA(ctx, master_branch_id, 1), 21);
+        ASSERT_EQ(readA(ctx, b1, 0), 10);
+        ASSERT_EQ(readA(ctx, b1, 1), 1);
+        ASSERT_EQ(readA(ctx, b1, insertedTid), 3);
+        ctx.executionContext.branchId = master_branch_id;
+        ASSERT_FALSE(is_visible(insertedTid, table, ctx));
+
+        // a branch of the branch forks its columns
+        branch_id_t b2 = db.createBranch("b2", b1);
+        ASSERT_EQ(readA(ctx, b2, 0), 10);
+        ctx.executionContext.branchId = b2;
+        delete_tuple(0, table, ctx);
+        ASSERT_FALSE(is_visible(0, table, ctx));
+        ctx.executionContext.branchId = b1;
+        ASSERT_TRUE(is_visible(0, table, ctx));
+
+        ASSERT_THROW(db.mergeBranch(b1, master_branch_id), NotImplementedException);
+    }
+
+    TEST(StorageTest, WriteAheadLogReplay) {
+        using namespace Native::Sql;
+        ModuleGen moduleGen("StorageTestModule");
+        const std::string path = "storage_test.wal";
+        std::remove(path.c_str());
+
+        auto makeTuple = [](int32_t a, const std::string & b) {
+            std::vector<value_op_t> values;
+            values.push_back(std::make_unique<Integer>(a));
+            values.push_back(Text::castString(b));
+            return SqlTuple(std::move(values));
+        };
+
+        {
+            Database db;
+            db.setWriteAheadLog(std::make_unique<WriteAheadLog>(path, WriteAheadLog::Durability::Group));
+            WriteAheadLog & log = *db.getWriteAheadLog();
+
+            auto & table = db.createTable("t");
+            table.addColumn("a", Sql::getIntegerTy());
+            table.addColumn("b", Sql::getTextTy());
+            log.commit(log.logCreateTable(table));
+
+            QueryContext ctx(db);
+            for (int32_t i = 0; i < 3; ++i) {
+                auto tuple = makeTuple(i, "value " + std::to_string(i));
+                insert_tuple(tuple, table, ctx);
+            }
+            auto updated = makeTuple(10, "a value which is too long to be stored inline");
+            update_tuple(1, updated, table, ctx);
+            log.commit(ctx.executionContext.commitLsn);
+
+            db.createBranch("b1", master_branch_id);
+        }
+
+        // a torn record at the end of the log is cut off
+        {
+            std::ofstream out(path, std::ios::binary | std::ios::app);
+            out << "truncated";
+        }
+
+        Database db;
+        ASSERT_EQ(WriteAheadLog::replay(db, path), 6ul);
+        Table * table = db.getTable("t");
+        ASSERT_NE(table, nullptr);
+        ASSERT_EQ(table->size(), 3ul);
+        ASSERT_EQ(db._branchMapping.count("b1"), 1ul);
+
+        auto row = get_current_master(1, *table);
+        ASSERT_TRUE(row->values[0]->equals(Integer(10)));
+        ASSERT_EQ(toString(*row->values[1]), "a value which is too long to be stored inline");
+        auto first = get_current_master(0, *table);
+        ASSERT_EQ(toString(*first->values[1]), "value 0");
+
+        std::remove(path.c_str());
+    }
+
+    TEST(StorageTest, WriteAheadLogCoversLoadedRows) {
+        using namespace Native::Sql;
+        const std::string path = "storage_test_load.wal";
+        std::remove(path.c_str());
+
+        {
+            Database db;
+            db.setWriteAheadLog(std::make_unique<WriteAheadLog>(path, WriteAheadLog::Durability::Sync));
+            WriteAheadLog & log = *db.getWriteAheadLog();
+
+            auto & table = db.createTable("t");
+            table.addColumn("a", Sql::getIntegerTy());
+            log.commit(log.logCreateTable(table));
+            auto & paged = db.createTable("p");
+            paged.setVersioningEngine(Table::VersioningEngine::Pages);
+            paged.addColumn("a", Sql::getIntegerTy());
+            log.commit(log.logCreateTable(paged));
+            {
+                ModuleGen moduleGen("LoadTableModule");
+                std::istringstream rows("1\n2\n3\n");
+                loadTable(rows, table);
+            }
+
+            // the update addresses a loaded row by its tid
+            ModuleGen moduleGen("StorageTestModule");
+            QueryContext ctx(db);
+            std::vector<value_op_t> values;
+            values.push_back(std::make_unique<Integer>(20));
+            SqlTuple updated(std::move(values));
+            update_tuple(1, updated, table, ctx);
+            log.commit(ctx.executionContext.commitLsn);
+        }
+
+        ModuleGen moduleGen("StorageTestModule");
+        Database db;
+        ASSERT_EQ(WriteAheadLog::replay(db, path), 6ul);
+        Table * table = db.getTable("t");
+        ASSERT_NE(table, nullptr);
+        ASSERT_EQ(table->size(), 3ul);
+        ASSERT_TRUE(get_current_master(1, *table)->values[0]->equals(Integer(20)));
+        ASSERT_TRUE(get_current_master(2, *table)->values[0]->equals(Integer(3)));
+        ASSERT_EQ(table->getVersioningEngine(), Table::VersioningEngine::Chains);
+        ASSERT_EQ(db.getTable("p")->getVersioningEngine(), Table::VersioningEngine::Pages);
+
+        std::remove(path.c_str());
+    }
+
+}
@@ -136,6 +136,8 @@ void QueryContext::convertToParserResult(semanticalAnalysis::SQLParserResult &de
                     dest.createTableStmt->columns.back().length = length;
                     dest.createTableStmt->columns.back().precision = precision;
                     dest.createTableStmt->columns.back().nullable = column->nullable;
+                    dest.createTableStmt->columns.back().dictionaryEncoded = false;
+                    dest.createTableStmt->columns.back().bitPacked = false;
                 }
                 break;
             case hsql::kStmtCreateBranch:
@@ -283,6 +285,18 @@ void QueryContext::convertToParserResult(semanticalAnalysis::SQLParserResult &de
         case tardisParser::ParsingContext::Copy:
             dest.opType = semanticalAnalysis::SQLParserResult::OpType::Copy;
             break;
+        case tardisParser::ParsingContext::Snapshot:
+            dest.opType = semanticalAnalysis::SQLParserResult::OpType::Snapshot;
+            break;
+        case tardisParser::ParsingContext::MergeBranch:
+            dest.opType = semanticalAnalysis::SQLParserResult::OpType::MergeBranch;
+            break;
+        case tardisParser::ParsingContext::MaterializeBranch:
+            dest.opType = semanticalAnalysis::SQLParserResult::OpType::MaterializeBranch;
+            break;
+        case tardisParser::ParsingContext::DropBranch:
+            dest.opType = semanticalAnalysis::SQLParserResult::OpType::DropBranch;
+            break;
     }
     source = tardisParser::ParsingContext();
 }
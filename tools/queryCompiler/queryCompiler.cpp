@@ -4,6 +4,8 @@
 
 #include "queryCompiler/queryCompiler.hpp"
 
+#include <shared_mutex>
+
 #include <llvm/Support/raw_ostream.h>
 #include <llvm/IR/TypeBuilder.h>
 #include <llvm/IR/Verifier.h>
@@ -24,6 +26,7 @@
 #include "foundations/exceptions.hpp"
 #include "foundations/loader.hpp"
 #include "foundations/version_management.hpp"
+#include "foundations/WriteAheadLog.hpp"
 #include "queryExecutor/queryExecutor.hpp"
 
 #include "include/tardisdb/semanticAnalyser/SemanticAnalyser.hpp"
@@ -61,6 +64,8 @@ namespace QueryCompiler {
     }
 
     void compileAndExecute(const std::string &query, Database &db, void *callbackFunction) {
+        // the compiled code relies on the table sizes at compile time
+        std::shared_lock<std::shared_mutex> statementLock(db.getStatementLock());
         QueryContext queryContext(db);
 
         ModuleGen moduleGen("QueryModule");
@@ -81,19 +86,27 @@ namespace QueryCompiler {
         if (queryTree == nullptr) return;
         if (callbackFunction == nullptr) callbackFunction = (queryContext.analyzingContext.callback != nullptr) ? queryContext.analyzingContext.callback : (void*)&printFunction;
 
+        // the scans embed the lineages of their branches
+        QueryContext::constructBranchLineages(queryContext.analyzingContext.branchIds,queryContext);
+
         auto queryFunc = compileQuery(query, queryTree,queryContext);
         if (queryFunc == nullptr) return;
 
-        QueryContext::constructBranchLineages(queryContext.analyzingContext.branchIds,queryContext);
-
         std::vector<llvm::GenericValue> args(2);
         args[0].IntVal = llvm::APInt(64, 5);
         args[1].PointerVal = (void *) &queryContext;
 
         QueryExecutor::executeFunction(queryFunc, args, callbackFunction);
+
+        if (auto log = db.getWriteAheadLog()) {
+            log->commit(queryContext.executionContext.commitLsn);
+        }
+        statementLock.unlock();
+        db.collectIfDue();
     }
 
     BenchmarkResult compileAndBenchmark(const std::string &query, Database &db, void *callbackFunction) {
+        std::shared_lock<std::shared_mutex> statementLock(db.getStatementLock());
         QueryContext queryContext(db);
 
         ModuleGen moduleGen("QueryModule");
@@ -121,18 +134,23 @@ namespace QueryCompiler {
         result.columns = queryTree->getRoot()->getRequired();
 
         const auto translationStart = std::chrono::high_resolution_clock::now();
+        QueryContext::constructBranchLineages(queryContext.analyzingContext.branchIds,queryContext);
         auto queryFunc = compileQuery(query, queryTree, queryContext);
         const auto translationDuration = std::chrono::high_resolution_clock::now() - translationStart;
         if (queryFunc == nullptr) unreachable();
 
-        QueryContext::constructBranchLineages(queryContext.analyzingContext.branchIds,queryContext);
-
         std::vector<llvm::GenericValue> args(2);
         args[0].IntVal = llvm::APInt(64, 5);
         args[1].PointerVal = (void *) &queryContext;
 
         QueryExecutor::BenchmarkResult llvmresult = QueryExecutor::executeBenchmarkFunction(queryFunc, args, 1, callbackFunction);
 
+        if (auto log = db.getWriteAheadLog()) {
+            log->commit(queryContext.executionContext.commitLsn);
+        }
+        statementLock.unlock();
+        db.collectIfDue();
+
         result.parsingTime = std::chrono::duration_cast<std::chrono::microseconds>(parsingDuration).count();
         result.analysingTime = std::chrono::duration_cast<std::chrono::microseconds>(analysingDuration).count();
         result.translationTime = std::chrono::duration_cast<std::chrono::microseconds>(translationDuration).count();
@@ -33,7 +33,11 @@ namespace semanticalAnalysis {
         std::string nodes="\"nodes\": [", links ="\"links\": [";
         bool firstnode=true, firstlink=true;
         for(branch_id_t i=0; i<_context.db._next_branch_id; i++){
-            auto &branch = _context.db._branches[i];
+            // the ids of dropped branches are not reused
+            auto it = _context.db._branches.find(i);
+            if (it == _context.db._branches.end())
+               continue;
+            auto &branch = it->second;
             if (branch->id != 0){
                if (!firstlink)
                   links +=", ";
@@ -3,6 +3,7 @@
 //
 
 #include "semanticAnalyser/SemanticAnalyser.hpp"
+#include "foundations/WriteAheadLog.hpp"
 
 namespace semanticalAnalysis {
 
@@ -22,6 +23,10 @@ namespace semanticalAnalysis {
             definedColumnNames.push_back(column.name);
             if (std::find(typeNames.begin(),typeNames.end(),column.type) == typeNames.end())
                 throw semantic_sql_error("type '" + column.type + "' does not exist");
+            if (column.dictionaryEncoded && column.type.compare("text") != 0 && column.type.compare("varchar") != 0)
+                throw semantic_sql_error("not supported dictionary option for column '" + column.name + "' of type '" + column.type + "'");
+            if (column.bitPacked && column.type.compare("integer") != 0 && column.type.compare("int") != 0 && column.type.compare("longinteger") != 0)
+                throw semantic_sql_error("not supported packed option for column '" + column.name + "' of type '" + column.type + "'");
         }
 
         // Table already exists?
@@ -58,7 +63,17 @@ namespace semanticalAnalysis {
                 sqlType = Sql::getTextTy(columnSpec.nullable);
             }
 
-            createdTable.addColumn(columnSpec.name, sqlType);
+            auto encoding = ColumnInformation::Encoding::Plain;
+            if (columnSpec.dictionaryEncoded) {
+                encoding = ColumnInformation::Encoding::Dictionary;
+            } else if (columnSpec.bitPacked) {
+                encoding = ColumnInformation::Encoding::BitPacked;
+            }
+            createdTable.addColumn(columnSpec.name, sqlType, encoding);
+        }
+
+        if (auto log = _context.db.getWriteAheadLog()) {
+            log->commit(log->logCreateTable(createdTable));
         }
 
         _context.joinedTree = nullptr;
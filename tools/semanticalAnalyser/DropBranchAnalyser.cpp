@@ -0,0 +1,33 @@
+#include "semanticAnalyser/SemanticAnalyser.hpp"
+
+#include <iostream>
+
+namespace semanticalAnalysis {
+
+    void DropBranchAnalyser::verify() {
+        Database &db = _context.db;
+        DropBranchStatement* stmt = _context.parserResult.dropBranchStmt;
+        if (stmt == nullptr) throw semantic_sql_error("unknown statement type");
+
+        auto branch = db._branchMapping.find(stmt->branchName);
+        if (branch == db._branchMapping.end())
+            throw semantic_sql_error("branch '" + stmt->branchName + "' does not exist");
+        if (branch->second == master_branch_id)
+            throw semantic_sql_error("the master branch cannot be dropped");
+        for (auto &[id, other] : db._branches) {
+            if (other->parent_id == branch->second)
+                throw semantic_sql_error("branch '" + stmt->branchName + "' has child branches");
+        }
+    }
+
+    void DropBranchAnalyser::constructTree() {
+        DropBranchStatement* stmt = _context.parserResult.dropBranchStmt;
+        Database &db = _context.db;
+
+        size_t freed = db.dropBranch(db._branchMapping[stmt->branchName]);
+        std::cout << "Dropped branch '" << stmt->branchName << "' (" << freed << " versions freed)\n";
+
+        _context.joinedTree = nullptr;
+    }
+
+}
@@ -0,0 +1,29 @@
+#include "semanticAnalyser/SemanticAnalyser.hpp"
+
+#include <iostream>
+
+namespace semanticalAnalysis {
+
+    void MaterializeBranchAnalyser::verify() {
+        Database &db = _context.db;
+        MaterializeBranchStatement* stmt = _context.parserResult.materializeBranchStmt;
+        if (stmt == nullptr) throw semantic_sql_error("unknown statement type");
+
+        auto branch = db._branchMapping.find(stmt->branchName);
+        if (branch == db._branchMapping.end())
+            throw semantic_sql_error("branch '" + stmt->branchName + "' does not exist");
+        if (branch->second == master_branch_id)
+            throw semantic_sql_error("the master branch is always stored in columns");
+    }
+
+    void MaterializeBranchAnalyser::constructTree() {
+        MaterializeBranchStatement* stmt = _context.parserResult.materializeBranchStmt;
+        Database &db = _context.db;
+
+        db.materializeBranch(db._branchMapping[stmt->branchName]);
+        std::cout << "Materialized branch '" << stmt->branchName << "'\n";
+
+        _context.joinedTree = nullptr;
+    }
+
+}
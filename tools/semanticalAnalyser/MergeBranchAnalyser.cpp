@@ -0,0 +1,41 @@
+#include "semanticAnalyser/SemanticAnalyser.hpp"
+
+#include <iostream>
+
+namespace semanticalAnalysis {
+
+    void MergeBranchAnalyser::verify() {
+        Database &db = _context.db;
+        MergeBranchStatement* stmt = _context.parserResult.mergeBranchStmt;
+        if (stmt == nullptr) throw semantic_sql_error("unknown statement type");
+
+        auto source = db._branchMapping.find(stmt->sourceBranchName);
+        if (source == db._branchMapping.end())
+            throw semantic_sql_error("branch '" + stmt->sourceBranchName + "' does not exist");
+        auto destination = db._branchMapping.find(stmt->destinationBranchName);
+        if (destination == db._branchMapping.end())
+            throw semantic_sql_error("branch '" + stmt->destinationBranchName + "' does not exist");
+        if (source->second == master_branch_id)
+            throw semantic_sql_error("the master branch cannot be merged");
+        if (db._branches[source->second]->parent_id != destination->second)
+            throw semantic_sql_error("branch '" + stmt->sourceBranchName + "' can only be merged into its parent");
+    }
+
+    void MergeBranchAnalyser::constructTree() {
+        MergeBranchStatement* stmt = _context.parserResult.mergeBranchStmt;
+        Database &db = _context.db;
+
+        branch_id_t source = db._branchMapping[stmt->sourceBranchName];
+        branch_id_t destination = db._branchMapping[stmt->destinationBranchName];
+        BranchMergeResult result = db.mergeBranch(source, destination);
+
+        std::cout << "Merged " << result.mergedCount << " tuples of branch '" << stmt->sourceBranchName
+                  << "' into '" << stmt->destinationBranchName << "'\n";
+        for (auto & [table, tid] : result.conflicts) {
+            std::cout << "Conflict: tuple " << tid << " of table '" << table->getName() << "'\n";
+        }
+
+        _context.joinedTree = nullptr;
+    }
+
+}
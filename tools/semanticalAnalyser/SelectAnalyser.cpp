@@ -17,6 +17,8 @@ namespace semanticalAnalysis {
         for (auto &relation : stmt->relations) {
             if (!db.hasTable(relation.name)) throw semantic_sql_error("table '" + relation.name + "' does not exist");
             if (db._branchMapping.find(relation.version) == db._branchMapping.end()) throw semantic_sql_error("version '" + relation.version + "' does not exist");
+            if (!relation.diffVersion.empty() && db._branchMapping.find(relation.diffVersion) == db._branchMapping.end())
+                throw semantic_sql_error("version '" + relation.diffVersion + "' does not exist");
             if (relation.alias.compare("") == 0) {
                 if (relations.find(relation.name) != relations.end()) throw semantic_sql_error("relation '" + relation.name + "' is already specified - use bindings!");
             }
@@ -30,7 +30,14 @@ namespace semanticalAnalysis {
 
             //Construct the logical TableScan operator
             Table* table = context.db.getTable(relation.name);
-            std::unique_ptr<TableScan> scan = std::make_unique<TableScan>(context.iuFactory, *table, branchId);
+            std::unique_ptr<TableScan> scan;
+            if (relation.diffVersion.empty()) {
+                scan = std::make_unique<TableScan>(context.iuFactory, *table, branchId);
+            } else {
+                // a diff scan only produces the tuples of the branch which differ from the compared branch
+                branch_id_t diffBranchId = context.db._branchMapping[relation.diffVersion];
+                scan = std::make_unique<TableScan>(context.iuFactory, *table, branchId, diffBranchId);
+            }
 
             //Store the ius produced by this TableScan
             for (iu_p_t iu : scan->getProduced()) {
@@ -95,6 +102,14 @@ namespace semanticalAnalysis {
                 return std::make_unique<BranchAnalyser>(context);
             case SQLParserResult::OpType::Copy:
                 return std::make_unique<CopyTableAnalyser>(context);
+            case SQLParserResult::OpType::Snapshot:
+                return std::make_unique<SnapshotAnalyser>(context);
+            case SQLParserResult::OpType::MergeBranch:
+                return std::make_unique<MergeBranchAnalyser>(context);
+            case SQLParserResult::OpType::MaterializeBranch:
+                return std::make_unique<MaterializeBranchAnalyser>(context);
+            case SQLParserResult::OpType::DropBranch:
+                return std::make_unique<DropBranchAnalyser>(context);
             case SQLParserResult::OpType::Unknown:
                 return nullptr;
         }
@@ -0,0 +1,35 @@
+#include "semanticAnalyser/SemanticAnalyser.hpp"
+#include "foundations/Snapshot.hpp"
+
+#include <iostream>
+
+namespace semanticalAnalysis {
+
+    void SnapshotAnalyser::verify() {
+        Database &db = _context.db;
+        SnapshotStatement* stmt = _context.parserResult.snapshotStmt;
+        if (stmt == nullptr) throw semantic_sql_error("unknown statement type");
+
+        if (stmt->filePath.empty())
+            throw semantic_sql_error("snapshot path must not be empty");
+        if (stmt->load && db.getTableCount() > 0)
+            throw semantic_sql_error("snapshots can only be loaded into an empty database");
+        if (stmt->load && db.getWriteAheadLog() != nullptr)
+            throw semantic_sql_error("snapshots cannot be loaded while a write-ahead log is attached");
+    }
+
+    void SnapshotAnalyser::constructTree() {
+        SnapshotStatement* stmt = _context.parserResult.snapshotStmt;
+
+        if (stmt->load) {
+            Snapshot::load(_context.db, stmt->filePath);
+            std::cout << "Loaded snapshot '" << stmt->filePath << "'\n";
+        } else {
+            Snapshot::save(_context.db, stmt->filePath);
+            std::cout << "Saved snapshot '" << stmt->filePath << "'\n";
+        }
+
+        _context.joinedTree = nullptr;
+    }
+
+}
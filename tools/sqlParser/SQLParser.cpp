@@ -55,8 +55,116 @@ namespace tardisParser {
                     context.opType = ParsingContext::OpType::Copy;
                     context.copyStmt = new CopyStatement();
                     context.state = State::Copy;
+                } else if (token.equalsKeyword(Keyword::Save) || token.equalsKeyword(Keyword::Load)) {
+                    context.opType = ParsingContext::OpType::Snapshot;
+                    context.snapshotStmt = new SnapshotStatement();
+                    context.snapshotStmt->load = token.equalsKeyword(Keyword::Load);
+                    context.state = State::Snapshot;
+                } else if (token.equalsKeyword(Keyword::Merge)) {
+                    context.opType = ParsingContext::OpType::MergeBranch;
+                    context.mergeBranchStmt = new MergeBranchStatement();
+                    context.state = State::Merge;
+                } else if (token.equalsKeyword(Keyword::Materialize)) {
+                    context.opType = ParsingContext::OpType::MaterializeBranch;
+                    context.materializeBranchStmt = new MaterializeBranchStatement();
+                    context.state = State::Materialize;
+                } else if (token.equalsKeyword(Keyword::Drop)) {
+                    context.opType = ParsingContext::OpType::DropBranch;
+                    context.dropBranchStmt = new DropBranchStatement();
+                    context.state = State::Drop;
+                } else {
+                    throw syntactical_error("Expected 'Select', 'Insert', 'Update', 'Delete' , 'BRANCH', 'COPY', 'SAVE', 'LOAD', 'MERGE', 'MATERIALIZE', 'DROP' or 'Create', found '" + token.value + "'");
+                }
+                break;
+
+                //
+                //  Merge
+                //
+            case State::Merge:
+                if (token.equalsKeyword(Keyword::Branch)) {
+                    context.state = State::MergeBranch;
+                } else {
+                    throw syntactical_error("Expected 'BRANCH', found '" + token.value + "'");
+                }
+                break;
+            case State::MergeBranch:
+                if (token.type == Type::identifier) {
+                    context.mergeBranchStmt->sourceBranchName = token.value;
+                    context.state = State::MergeSource;
+                } else {
+                    throw syntactical_error("Expected branch name, found '" + token.value + "'");
+                }
+                break;
+            case State::MergeSource:
+                if (token.equalsKeyword(Keyword::Into)) {
+                    context.state = State::MergeInto;
+                } else {
+                    throw syntactical_error("Expected 'INTO', found '" + token.value + "'");
+                }
+                break;
+            case State::MergeInto:
+                if (token.type == Type::identifier) {
+                    context.mergeBranchStmt->destinationBranchName = token.value;
+                    context.state = State::MergeDestination;
                 } else {
-                    throw syntactical_error("Expected 'Select', 'Insert', 'Update', 'Delete' , 'BRANCH', 'COPY' or 'Create', found '" + token.value + "'");
+                    throw syntactical_error("Expected destination branch name, found '" + token.value + "'");
+                }
+                break;
+
+                //
+                //  Materialize
+                //
+            case State::Materialize:
+                if (token.equalsKeyword(Keyword::Branch)) {
+                    context.state = State::MaterializeBranch;
+                } else {
+                    throw syntactical_error("Expected 'BRANCH', found '" + token.value + "'");
+                }
+                break;
+            case State::MaterializeBranch:
+                if (token.type == Type::identifier) {
+                    context.materializeBranchStmt->branchName = token.value;
+                    context.state = State::MaterializeName;
+                } else {
+                    throw syntactical_error("Expected branch name, found '" + token.value + "'");
+                }
+                break;
+
+                //
+                //  Drop
+                //
+            case State::Drop:
+                if (token.equalsKeyword(Keyword::Branch)) {
+                    context.state = State::DropBranch;
+                } else {
+                    throw syntactical_error("Expected 'BRANCH', found '" + token.value + "'");
+                }
+                break;
+            case State::DropBranch:
+                if (token.type == Type::identifier) {
+                    context.dropBranchStmt->branchName = token.value;
+                    context.state = State::DropName;
+                } else {
+                    throw syntactical_error("Expected branch name, found '" + token.value + "'");
+                }
+                break;
+
+                //
+                //  Snapshot
+                //
+            case State::Snapshot:
+                if (token.equalsKeyword(Keyword::Snapshot)) {
+                    context.state = State::SnapshotKeyword;
+                } else {
+                    throw syntactical_error("Expected 'SNAPSHOT', found '" + token.value + "'");
+                }
+                break;
+            case State::SnapshotKeyword:
+                if (token.hasType(Type::literal)) {
+                    context.snapshotStmt->filePath = token.value;
+                    context.state = State::SnapshotPath;
+                } else {
+                    throw syntactical_error("Expected file path, found '" + token.value + "'");
                 }
                 break;
 
@@ -194,6 +302,8 @@ namespace tardisParser {
                 if (token.type == Type::identifier) {
                     context.createTableStmt->columns.push_back(ColumnSpec());
                     context.createTableStmt->columns.back().name = token.value;
+                    context.createTableStmt->columns.back().dictionaryEncoded = false;
+                    context.createTableStmt->columns.back().bitPacked = false;
                     context.state = CreateTableColumnName;
                 } else {
                     throw syntactical_error("Expected column name, found '" + token.value + "'");
@@ -286,6 +396,25 @@ namespace tardisParser {
                 }
                 break;
             case State::CreateTableTypeNotNull:
+                if (token.equalsKeyword(Keyword::Dictionary)) {
+                    context.createTableStmt->columns.back().dictionaryEncoded = true;
+                    context.state = State::CreateTableTypeEncoding;
+                    break;
+                }
+                if (token.equalsKeyword(Keyword::Packed)) {
+                    context.createTableStmt->columns.back().bitPacked = true;
+                    context.state = State::CreateTableTypeEncoding;
+                    break;
+                }
+                if (token.equalsControlSymbol(controlSymbols::closeBracket)) {
+                    context.state = CreateTableColumnsEnd;
+                } else if (token.equalsControlSymbol(controlSymbols::separator)) {
+                    context.state = CreateTableColumnSeperator;
+                } else {
+                    throw syntactical_error("Expected ',' , ')' , 'DICTIONARY' or 'PACKED', found '" + token.value + "'");
+                }
+                break;
+            case State::CreateTableTypeEncoding:
                 if (token.equalsControlSymbol(controlSymbols::closeBracket)) {
                     context.state = CreateTableColumnsEnd;
                 } else if (token.equalsControlSymbol(controlSymbols::separator)) {
@@ -620,6 +749,8 @@ namespace tardisParser {
             case State::SelectFromRelationName:
                 if (token.equalsKeyword(Keyword::Version)) {
                     context.state = SelectFromVersion;
+                } else if (token.equalsKeyword(Keyword::Diff)) {
+                    context.state = SelectFromDiff;
                 } else if (token.type == Type::identifier) {
                     context.selectStmt->relations.back().alias = token.value;
                     context.selectStmt->relations.back().version = "master";
@@ -630,7 +761,7 @@ namespace tardisParser {
                 } else if (token.equalsControlSymbol(controlSymbols::separator)) {
                     context.state = State::SelectFromSeparator;
                 } else {
-                    throw syntactical_error("Expected binding name, 'VERSION', 'WHERE' or ',' found '" + token.value + "'");
+                    throw syntactical_error("Expected binding name, 'VERSION', 'DIFF', 'WHERE' or ',' found '" + token.value + "'");
                 }
                 break;
             case State::SelectFromVersion:
@@ -641,6 +772,23 @@ namespace tardisParser {
                     throw syntactical_error("Expected version name, found '" + token.value + "'");
                 }
                 break;
+            case State::SelectFromDiff:
+                // DIFF base branch: the tuples of the second branch which differ from the first one
+                if (token.type == Type::identifier) {
+                    context.selectStmt->relations.back().diffVersion = token.value;
+                    context.state = SelectFromDiffBase;
+                } else {
+                    throw syntactical_error("Expected version name, found '" + token.value + "'");
+                }
+                break;
+            case State::SelectFromDiffBase:
+                if (token.type == Type::identifier) {
+                    context.selectStmt->relations.back().version = token.value;
+                    context.state = SelectFromTag;
+                } else {
+                    throw syntactical_error("Expected version name, found '" + token.value + "'");
+                }
+                break;
             case State::SelectFromTag:
                 if (token.equalsKeyword(Keyword::Where)) {
                     context.state = State::SelectWhere;